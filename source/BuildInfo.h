@@ -76,6 +76,8 @@
 
 #if CARRT_NAVIGATE_USING_INERTIAL
 #define CARRT_NAV_STR  "IMU"
+#elif CARRT_NAVIGATE_USING_DEADRECKONING && CARRT_NAVIGATE_USING_FIXED_POINT
+#define CARRT_NAV_STR  "DRQ"
 #elif CARRT_NAVIGATE_USING_DEADRECKONING
 #define CARRT_NAV_STR  "DR"
 #else
@@ -32,8 +32,10 @@
 #include "DriveProgram.h"
 #include "ErrorState.h"
 #include "EventClock.h"
+#include "MagCalibrator.h"
 #include "MainProcess.h"
 #include "Navigator.h"
+#include "TimerService.h"
 
 #include "Drivers/Battery.h"
 #include "Drivers/Beep.h"
@@ -74,6 +76,9 @@ int main()
         // Initialize all the various subsystems
         doInitialization();
 
+        // Start with no software timers running (states start them as needed)
+        TimerService::init( EventClock::getMilliseconds() );
+
         // Create the error state (so we don't have to create it when out of memory; reused throughout)
         ErrorState errorState;
         MainProcess::init( &errorState );
@@ -175,6 +180,9 @@ namespace
         Lidar::init();
         LSM303DLHC::init();
         L3GD20::init();
+
+        // Use the stored compass calibration, if there is one (see CompassCalibrationState)
+        MagCalibrator::loadCalibration();
     }
 
 
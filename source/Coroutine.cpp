@@ -0,0 +1,119 @@
+/*
+    Coroutine.cpp - Stackless (protothread-style) coroutines, so states can
+    write sequential logic that waits without blocking the event loop.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+
+#include "Coroutine.h"
+
+#include "ErrorCodes.h"
+#include "MainProcess.h"
+#include "TimerService.h"
+
+
+
+namespace
+{
+
+    // Each wait gets a fresh token, carried as the resume event's parameter,
+    // so a coroutine ignores resume events meant for another (or for a wait
+    // of its own that was since canceled)
+    int16_t sLastToken;
+
+    int16_t nextToken()
+    {
+        sLastToken = ( sLastToken + 1 ) & 0x7FFF;
+        if ( !sLastToken )
+        {
+            sLastToken = 1;
+        }
+        return sLastToken;
+    }
+
+};
+
+
+
+
+Coroutine::Coroutine() :
+mResumePoint( kStart ),
+mTimer( TimerService::kNoTimer ),
+mWaitToken( 0 )
+{
+}
+
+
+Coroutine::~Coroutine()
+{
+    stop();
+}
+
+
+void Coroutine::stop()
+{
+    if ( mTimer != TimerService::kNoTimer )
+    {
+        TimerService::cancel( mTimer );
+        mTimer = TimerService::kNoTimer;
+    }
+
+    mWaitToken = 0;
+    mResumePoint = kStart;
+}
+
+
+void Coroutine::startWait( uint16_t ms )
+{
+    mWaitToken = nextToken();
+    mTimer = TimerService::startOneShot( ms ? ms : 1, EventManager::kCoroutineResumeEvent, mWaitToken );
+
+    if ( mTimer == TimerService::kNoTimer )
+    {
+        MainProcess::postErrorEvent( kNoTimerAvailableError );
+    }
+}
+
+
+void Coroutine::startYield()
+{
+    mWaitToken = nextToken();
+    mTimer = TimerService::kNoTimer;
+
+    if ( EventManager::queueEvent( EventManager::kCoroutineResumeEvent, mWaitToken ) )
+    {
+        MainProcess::postErrorEvent( kEventQueueOverflowError );
+    }
+}
+
+
+bool Coroutine::isEndOfWait( uint8_t event, int16_t param )
+{
+    if ( event != EventManager::kCoroutineResumeEvent || !mWaitToken || param != mWaitToken )
+    {
+        return false;
+    }
+
+    // The timer (if any) has expired, so its ID is no longer ours
+    mTimer = TimerService::kNoTimer;
+    mWaitToken = 0;
+
+    return true;
+}
@@ -0,0 +1,161 @@
+/*
+    Coroutine.h - Stackless (protothread-style) coroutines, so states can
+    write sequential logic that waits without blocking the event loop.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef Coroutine_h
+#define Coroutine_h
+
+#include <stdint.h>
+
+
+
+/*
+ * A coroutine body is a member function of a state, with the signature
+ *
+ *      void body( uint8_t event, int16_t param )
+ *
+ * (the CORO_ macros rely on those names), written between CORO_BEGIN and
+ * CORO_END.  The state calls the body from onEntry() (to start it) and from
+ * onEvent() with each event it gets.  Each CORO_WAIT_ returns to the event
+ * loop, and a later call picks up where the body left off, once the wait is
+ * over.  In the meantime the event loop carries on:  navigation updates,
+ * the keypad, and other events are handled as usual.
+ *
+ * For example, a scan:
+ *
+ *      void ScanState::scan( uint8_t event, int16_t param )
+ *      {
+ *          CORO_BEGIN( mCoroutine );
+ *          for ( mAngle = -70; mAngle <= 70; mAngle += 5 )
+ *          {
+ *              Lidar::slew( mAngle );
+ *              CORO_WAIT_MS( mCoroutine, 250 );            // let the servo slew
+ *              getAndProcessRange();
+ *          }
+ *          CORO_END( mCoroutine );
+ *
+ *          MainProcess::changeState( new NextState );
+ *      }
+ *
+ * The rules of stackless coroutines apply:  local variables do NOT survive a
+ * wait (use members), and the CORO_ macros can't be used inside a switch
+ * statement.  A state may be deleted when it changes state, so the body must
+ * return right after any changeState() (or, as above, do it after CORO_END,
+ * which marks the coroutine done:  what follows CORO_END runs once, when the
+ * body finishes, and calls after that just return).
+ *
+ * Waiting on time uses a one-shot TimerService timer, which posts a
+ * kCoroutineResumeEvent only the waiting coroutine recognizes.  States that
+ * are deleted on exit release the timer automatically; states that are
+ * reused (e.g., drive program steps) must call stop() in onExit().
+ */
+
+class Coroutine
+{
+public:
+
+    Coroutine();
+    ~Coroutine();
+
+    // Stop (canceling any wait) and go back to the start of the body
+    void stop();
+
+    bool isDone() const
+    { return mResumePoint == kDone; }
+
+
+    // Used by the CORO_ macros
+
+    enum
+    {
+        kStart  = 0,
+        kDone   = 0xFFFF
+    };
+
+    // Start waiting for ms milliseconds; on failure (no timer), posts an error
+    void startWait( uint16_t ms );
+
+    // Ask to be resumed as soon as the events already queued are handled
+    void startYield();
+
+    // True (once) if this event ends the current wait
+    bool isEndOfWait( uint8_t event, int16_t param );
+
+    uint16_t    mResumePoint;
+
+private:
+
+    uint8_t     mTimer;
+    int16_t     mWaitToken;
+};
+
+
+
+#define CORO_BEGIN( co )                                                        \
+    switch ( ( co ).mResumePoint )                                              \
+    {                                                                           \
+        case Coroutine::kStart:
+
+// Return to the event loop; resume with the first event for which cond is true
+#define CORO_WAIT_UNTIL( co, cond )                                             \
+        do                                                                      \
+        {                                                                       \
+            ( co ).mResumePoint = __LINE__;                                     \
+            /* FALLTHRU */                                                      \
+        case __LINE__:                                                          \
+            if ( !( cond ) )                                                    \
+            {                                                                   \
+                return;                                                         \
+            }                                                                   \
+        } while ( 0 )
+
+// Return to the event loop; resume when the given event arrives
+#define CORO_WAIT_EVENT( co, code )                                             \
+        CORO_WAIT_UNTIL( co, event == ( code ) )
+
+// Return to the event loop; resume ms milliseconds from now
+#define CORO_WAIT_MS( co, ms )                                                  \
+        do                                                                      \
+        {                                                                       \
+            ( co ).startWait( ms );                                             \
+            CORO_WAIT_UNTIL( co, ( co ).isEndOfWait( event, param ) );          \
+        } while ( 0 )
+
+// Return to the event loop; resume once the events already queued are handled
+#define CORO_YIELD( co )                                                        \
+        do                                                                      \
+        {                                                                       \
+            ( co ).startYield();                                                \
+            CORO_WAIT_UNTIL( co, ( co ).isEndOfWait( event, param ) );          \
+        } while ( 0 )
+
+#define CORO_END( co )                                                          \
+            ( co ).mResumePoint = Coroutine::kDone;                             \
+            break;                                                              \
+                                                                                \
+        case Coroutine::kDone:                                                  \
+            return;                                                             \
+    }                                                                           \
+    do {} while ( 0 )
+
+
+#endif
@@ -106,11 +106,17 @@ namespace
 	const uint8_t kL3GD20_Address           = 0x6B;        // 1101001
 	const uint8_t kL3GD20_Id                = 0b11010100;
 
+	// Set by init() (L3DG20_DATA_RATE_190_Hz_CUTOFF_25_Hz)
+
+	const int kL3GD20_UpdateRate            = 190;         // Hz
+
 	// Key constants
 
 	const float kL3GD20_SENSITIVITY_250DPS      = 0.00875F;
 	const float kL3GD20_SENSITIVITY_500DPS      = 0.0175F;
 	const float kL3GD20_SENSITIVITY_2000DPS     = 0.070F;
+
+	const int32_t kL3GD20_SENSITIVITY_250DPS_MILLICENTIDPS  = 875;     // 8.75 mdps per LSB, for integer math
 	const float kL3GD20_DPS_TO_RADS             = 0.017453293F;     // degrees/s to rad/s multiplier
 
 	const float kL3GD20_TO_RADS_250DPS          = kL3GD20_SENSITIVITY_250DPS * kL3GD20_DPS_TO_RADS;
@@ -163,7 +169,7 @@ bool L3GD20::init()
 
 int L3GD20::gyroscopeUpdateRate()
 {
-    return 190;
+    return kL3GD20_UpdateRate;
 }
 
 
@@ -332,11 +338,46 @@ void L3GD20::getAngularRatesDataBlockSync( DataBlock* data, uint8_t nbr )
 
 
 // cppcheck-suppress unusedFunction
-void L3GD20::getAngularRatesDataBlockAsync( DataBlock* data, uint8_t nbr, volatile uint8_t* nbrRead, volatile uint8_t* status )
+uint8_t L3GD20::getAngularRatesDataBlockAsync( DataBlock* data, uint8_t nbr, volatile uint8_t* nbrRead, volatile uint8_t* status )
 {
     // In FIFO mode, can block-read up to 32 most recent values.
 
-    I2cMaster::readAsync( kL3GD20_Address, (L3GD20_REGISTER_OUT_X_L | 0x80), nbr * 6, data->buffer, nbrRead, status );
+    return I2cMaster::readAsync( kL3GD20_Address, (L3GD20_REGISTER_OUT_X_L | 0x80), nbr * 6, data->buffer, nbrRead, status );
+}
+
+
+uint8_t L3GD20::getFifoStatusAsync( uint8_t* fifoStatus, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    return I2cMaster::readAsync( kL3GD20_Address, L3GD20_REGISTER_FIFO_SRC_REG, 1, fifoStatus, nbrRead, status );
+}
+
+
+uint8_t L3GD20::convertFifoStatusToLevel( uint8_t fifoStatus )
+{
+    // FIFO_SRC_REG is FTH, OVRN, EMPTY, FSS4-0; FSS only counts to 31, so a full
+    // (overrun) FIFO holds 32
+    return ( fifoStatus & 0x40 ) ? 32 : ( fifoStatus & 0x1F );
+}
+
+
+bool L3GD20::isFifoOverrun( uint8_t fifoStatus )
+{
+    return fifoStatus & 0x40;
+}
+
+
+float L3GD20::convertRawSumToDegrees( int32_t sum )
+{
+    return sum * ( kL3GD20_SENSITIVITY_250DPS / kL3GD20_UpdateRate );
+}
+
+
+int16_t L3GD20::convertRawSumToCentiDegrees( int32_t sum )
+{
+    // Rounded; 875 / 1000 reduces to 7 / 8, so a full 255 full-scale readings fit in 32 bits
+    const int32_t kDivisor = ( 1000L / 125 ) * kL3GD20_UpdateRate;
+    int32_t scaled = sum * ( kL3GD20_SENSITIVITY_250DPS_MILLICENTIDPS / 125 );
+    return ( scaled + ( scaled >= 0 ? kDivisor / 2 : -kDivisor / 2 ) ) / kDivisor;
 }
 
 
@@ -48,10 +48,23 @@ namespace L3GD20
     Vector3Float getAngularRatesRadiansPerSecond();
 
     void getAngularRatesDataBlockSync( DataBlock* data, uint8_t nbr );
-    void getAngularRatesDataBlockAsync( DataBlock* data, uint8_t nbr, volatile uint8_t* nbrRead, volatile uint8_t* status );
+    uint8_t getAngularRatesDataBlockAsync( DataBlock* data, uint8_t nbr, volatile uint8_t* nbrRead, volatile uint8_t* status );
     Vector3Int convertDataBlockEntryToAngularRatesRaw( const DataBlock& data, uint8_t item );
     Vector3Float convertDataBlockEntryToAngularRatesRadiansPerSecond( const DataBlock& d, uint8_t item );
 
+    // Number of readings waiting in the FIFO, from its status register (read one byte)
+    uint8_t getFifoStatusAsync( uint8_t* fifoStatus, volatile uint8_t* nbrRead, volatile uint8_t* status );
+    uint8_t convertFifoStatusToLevel( uint8_t fifoStatus );
+
+    // True if the FIFO has filled up, in which case (in stream mode) it has been dropping
+    // its oldest readings
+    bool isFifoOverrun( uint8_t fifoStatus );
+
+    // Degrees turned over a run of consecutive FIFO readings (each good for one
+    // update period), given the sum of their raw rates about one axis
+    float convertRawSumToDegrees( int32_t sum );
+    int16_t convertRawSumToCentiDegrees( int32_t sum );
+
 };
 
 
@@ -147,11 +147,13 @@ namespace LSM303DLHC
     const float kEarthGravity                       = 9.80665;                  // Earth's gravity in m/s^2
     const float kConvertToMetersPerSec2             = kGravitiesPerLeastSignificantBit * kEarthGravity;  // (m/s^2)/G
 
+    const int   kAccelerometerUpdateRate            = 100;                      // Hz, as set by init()
+
     const float kConvertGaussToMicroTesla           = 100.0;                    // mT/G
 
 
 
-    // Calibration constants for the magnetometer
+    // Calibration constants for the magnetometer (used until a calibration is set)
 
     const int16_t kMagCalMinX          = -610;
     const int16_t kMagCalMinY          = -780;
@@ -161,6 +163,14 @@ namespace LSM303DLHC
     const int16_t kMagCalMaxY          = 500;
     const int16_t kMagCalMaxZ          = 625;
 
+    MagCalibration mMagCalibration =
+    {
+        Vector3Float( ( kMagCalMinX + kMagCalMaxX ) / 2.0, ( kMagCalMinY + kMagCalMaxY ) / 2.0,
+                      ( kMagCalMinZ + kMagCalMaxZ ) / 2.0 ),
+        Vector3Float( 2.0 / ( kMagCalMaxX - kMagCalMinX ), 2.0 / ( kMagCalMaxY - kMagCalMinY ),
+                      2.0 / ( kMagCalMaxZ - kMagCalMinZ ) )
+    };
+
 };
 
 
@@ -223,7 +233,7 @@ int LSM303DLHC::init()
 
 int LSM303DLHC::accelerometerUpdateRate()
 {
-    return 100;
+    return kAccelerometerUpdateRate;
 }
 
 
@@ -460,6 +470,28 @@ Vector3Int LSM303DLHC::convertDataBlockEntryToAccelerationRaw( const DataBlock&
 }
 
 
+uint8_t LSM303DLHC::getAccelerationFifoStatusAsync( uint8_t* fifoStatus, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    return I2cMaster::readAsync( kLSM303_AddressAccelerometer, LSM303_REGISTER_ACCEL_FIFO_SRC_REG_A, 1, fifoStatus,
+                           nbrRead, status );
+}
+
+
+uint8_t LSM303DLHC::convertAccelerationFifoStatusToLevel( uint8_t fifoStatus )
+{
+    // FIFO_SRC_REG_A is WTM, OVRN, EMPTY, FSS4-0; FSS only counts to 31, so a full
+    // (overrun) FIFO holds 32
+    return ( fifoStatus & 0x40 ) ? 32 : ( fifoStatus & 0x1F );
+}
+
+
+Vector2Float LSM303DLHC::convertRawSumToXYMetersPerSec( const Vector3Long& sum )
+{
+    const float kConvert = kConvertToMetersPerSec2 / kAccelerometerUpdateRate;
+    return Vector2Float( sum.x * kConvert, sum.y * kConvert );
+}
+
+
 // cppcheck-suppress unusedFunction
 Vector3Float LSM303DLHC::convertDataBlockEntryToAccelerationMetersPerSec2( const DataBlock& data, uint8_t i )
 {
@@ -500,19 +532,13 @@ int LSM303DLHC::setMagGain( LSM303MagnetometerGain gain )
 
 Vector3Int LSM303DLHC::getMagnetometerRaw()
 {
-    // Read the magnetometer (order is xh, xl, zh, zl, yh, yl)
+    // Read the magnetometer
     uint8_t data[6];
     int err = I2cMaster::readSync( kLSM303_AddessMagnetometer, LSM303_REGISTER_MAG_OUT_X_H_M, 6, data );
 
     if ( !err )
     {
-        // Shift values to create properly formed integer (low byte first)
-        return Vector3Int
-        (
-            static_cast<int16_t>( data[1] | static_cast<uint16_t>(data[0]) << 8 ),
-            static_cast<int16_t>( data[5] | static_cast<uint16_t>(data[4]) << 8 ),
-            static_cast<int16_t>( data[3] | static_cast<uint16_t>(data[2]) << 8 )
-        );
+        return convertMagnetometerDataToRaw( data );
     }
     else
     {
@@ -521,6 +547,27 @@ Vector3Int LSM303DLHC::getMagnetometerRaw()
 }
 
 
+uint8_t LSM303DLHC::getMagnetometerDataAsync( uint8_t* data, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    // Reads 6 bytes into data; convert with convertMagnetometerDataToRaw() once all have arrived
+
+    return I2cMaster::readAsync( kLSM303_AddessMagnetometer, LSM303_REGISTER_MAG_OUT_X_H_M, 6, data, nbrRead, status );
+}
+
+
+Vector3Int LSM303DLHC::convertMagnetometerDataToRaw( const uint8_t* data )
+{
+    // Order is xh, xl, zh, zl, yh, yl
+    // Shift values to create properly formed integer (low byte first)
+    return Vector3Int
+    (
+        static_cast<int16_t>( data[1] | static_cast<uint16_t>(data[0]) << 8 ),
+        static_cast<int16_t>( data[5] | static_cast<uint16_t>(data[4]) << 8 ),
+        static_cast<int16_t>( data[3] | static_cast<uint16_t>(data[2]) << 8 )
+    );
+}
+
+
 
 #if 0
 Vector3Float LSM303DLHC::getMagnetometerCalibrated()
@@ -566,14 +613,28 @@ Vector3Float LSM303DLHC::convertMagnetometerRawToCalibrated( const Vector3Int& i
 {
     return Vector3Float
     (
-        ( in.x - kMagCalMinX ) / static_cast<float>( kMagCalMaxX - kMagCalMinX ) * 2.0 - 1.0,
-        ( in.y - kMagCalMinY ) / static_cast<float>( kMagCalMaxY - kMagCalMinY ) * 2.0 - 1.0,
-        ( in.z - kMagCalMinZ ) / static_cast<float>( kMagCalMaxZ - kMagCalMinZ ) * 2.0 - 1.0
+        ( in.x - mMagCalibration.offset.x ) * mMagCalibration.scale.x,
+        ( in.y - mMagCalibration.offset.y ) * mMagCalibration.scale.y,
+        ( in.z - mMagCalibration.offset.z ) * mMagCalibration.scale.z
     );
 }
 
 
 
+void LSM303DLHC::setMagnetometerCalibration( const MagCalibration& calibration )
+{
+    mMagCalibration = calibration;
+}
+
+
+
+const LSM303DLHC::MagCalibration& LSM303DLHC::getMagnetometerCalibration()
+{
+    return mMagCalibration;
+}
+
+
+
 float LSM303DLHC::getHeading()
 {
     Vector3Int m( getMagnetometerRaw() );
@@ -57,6 +57,16 @@ namespace LSM303DLHC
 
     int init();
 
+
+    // Hard and soft iron calibration of the magnetometer:  calibrated = ( raw - offset ) * scale,
+    // which puts each axis of the field about -1 to 1 (see MagCalibrator.h)
+
+    struct MagCalibration
+    {
+        Vector3Float    offset;
+        Vector3Float    scale;
+    };
+
     int accelerometerUpdateRate();  // in Hz
 
     Vector3Int getAccelerationRaw();
@@ -72,6 +82,14 @@ namespace LSM303DLHC
     Vector3Int convertDataBlockEntryToAccelerationRaw( const DataBlock& data, uint8_t item );
     Vector3Float convertDataBlockEntryToAccelerationMetersPerSec2( const DataBlock& data, uint8_t item );
 
+    // Number of readings waiting in the FIFO, from its status register (read one byte)
+    uint8_t getAccelerationFifoStatusAsync( uint8_t* fifoStatus, volatile uint8_t* nbrRead, volatile uint8_t* status );
+    uint8_t convertAccelerationFifoStatusToLevel( uint8_t fifoStatus );
+
+    // Change in velocity (m/s) over a run of consecutive FIFO readings (each good
+    // for one update period), given the sum of their raw accelerations
+    Vector2Float convertRawSumToXYMetersPerSec( const Vector3Long& sum );
+
     inline Vector3Float getAccelerationG()
     { return convertRawToG( getAccelerationRaw() ); }
 
@@ -87,9 +105,14 @@ namespace LSM303DLHC
     int magnetometerUpdateRate();  // in Hz
 
     Vector3Int getMagnetometerRaw();
+    uint8_t getMagnetometerDataAsync( uint8_t* data, volatile uint8_t* nbrRead, volatile uint8_t* status );
+    Vector3Int convertMagnetometerDataToRaw( const uint8_t* data );
     Vector3Float convertMagnetometerRawToCalibrated( const Vector3Int& in );
     Vector3Float convertMagnetometerCalibratedToMicroTesla( const Vector3Float& in );
 
+    void setMagnetometerCalibration( const MagCalibration& calibration );
+    const MagCalibration& getMagnetometerCalibration();
+
     inline Vector3Float getMagnetometerCalibrated()
     { return convertMagnetometerRawToCalibrated( getMagnetometerRaw() ); }
 
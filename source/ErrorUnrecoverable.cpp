@@ -35,6 +35,10 @@
 
 #include "Utils/DebuggingMacros.h"
 
+#if CARRT_ENABLE_TRACE_RECORDER
+#include "TraceRecorder.h"
+#endif
+
 
 
 
@@ -59,6 +63,12 @@ void handleUnrecoverableError( int errCode )
     Display::displayBottomRowP16( PSTR( "Aborting..." ) );
 #endif
 
+#if CARRT_ENABLE_TRACE_RECORDER
+    // Leave the trace of what led up to this on the serial line
+    TraceRecorder::record( TraceRecorder::kTraceUnrecoverableError, errCode );
+    TraceRecorder::dumpToSerial();
+#endif
+
     // Put CARRT into an infinite delay loop
     while ( 1 )
     {
@@ -30,6 +30,12 @@
 
 
 
+#if kCarrtEventClockHz != 8 && kCarrtEventClockHz != 16 && kCarrtEventClockHz != 32 && kCarrtEventClockHz != 64
+#error "kCarrtEventClockHz must be 8, 16, 32, or 64"
+#endif
+
+
+
 // Select Timer2 or Timer5 to drive the Rover's internal clock
 
 #if !defined( CARRT_CLOCK_USE_TIMER2 ) && !defined( CARRT_CLOCK_USE_TIMER5 )
@@ -40,11 +46,140 @@
 
 
 
+namespace
+{
+    // Ticks counted since the clock first started
+    volatile uint32_t sTicksElapsed;
+
+
+    // The periodic events, each queued every so many ticks (at its code's default
+    // priority).  The event parameter counts the events, cycling from 0 to
+    // paramCycle - 1 (the nth event gets n % paramCycle, so a parameter of 0 marks
+    // the end of each cycle).
+
+    struct DerivedEvent
+    {
+        uint8_t     eventCode;
+        uint16_t    ticksPerEvent;
+        uint8_t     paramCycle;
+    };
+
+    const DerivedEvent kDerivedEvents[] =
+    {
+        // Parameter counts ticks within each second
+        { EventManager::kNavUpdateEvent,            1,                          kCarrtEventClockHz },
+
+        // Parameter counts quarter seconds ( 0, 1, 2, 3 )
+        { EventManager::kQuarterSecondTimerEvent,   kCarrtEventClockHz / 4,     4 },
+
+        // Parameter counts seconds to 8 ( 0, 1, 2, 3, 4, 5, 6, 7 )
+        { EventManager::kOneSecondTimerEvent,       kCarrtEventClockHz,         8 },
+
+        { EventManager::kEightSecondTimerEvent,     8 * kCarrtEventClockHz,     1 }
+    };
+
+    const uint8_t kNbrDerivedEvents = sizeof( kDerivedEvents ) / sizeof( kDerivedEvents[0] );
+
+    // Only touched by the interrupt handler
+    uint16_t    sTicksSinceEvent[ kNbrDerivedEvents ];
+    uint8_t     sEventCount[ kNbrDerivedEvents ];
+
+};
+
+
+
+
+void EventClock::doTickFromIsr()
+{
+    ++sTicksElapsed;
+
+    for ( uint8_t i = 0; i < kNbrDerivedEvents; ++i )
+    {
+        if ( ++sTicksSinceEvent[i] == kDerivedEvents[i].ticksPerEvent )
+        {
+            sTicksSinceEvent[i] = 0;
+
+            uint8_t count = sEventCount[i] + 1;
+            if ( count == kDerivedEvents[i].paramCycle )
+            {
+                count = 0;
+            }
+            sEventCount[i] = count;
+
+            EventManager::queueEventFromIsr( kDerivedEvents[i].eventCode, count );
+        }
+    }
+}
+
+
+
+
+uint32_t EventClock::getTicks()
+{
+    uint32_t ticks;
+
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+    {
+        ticks = sTicksElapsed;
+    }
+
+    return ticks;
+}
+
+
+
+uint32_t EventClock::getTickMilliseconds( uint32_t tick )
+{
+    // kCarrtEventClockHz is a power of 2, so these are shifts and masks
+    return ( tick / kCarrtEventClockHz ) * 1000 + ( ( tick % kCarrtEventClockHz ) * 1000 ) / kCarrtEventClockHz;
+}
+
+
+
+
+// The host simulation supplies its own timer (and so init(), stop(), and getMilliseconds())
+
+#if __AVR__
+
 
 
 #ifdef CARRT_CLOCK_USE_TIMER2
 
 
+// Timer2 is an 8-bit counter, so each tick is a run of full 256-count cycles plus
+// one short cycle.  The prescaler is chosen so a tick is a whole number of counts.
+
+namespace
+{
+#if kCarrtEventClockHz == 8
+    // Prescaler = 128 (set bits CS22 and CS20):  Timer2 counts at 125 kHz
+    const uint8_t   kTimer2Prescaler    = (1 << CS22) | (1 << CS20);
+    const uint16_t  kCountsPerMs        = 125;
+#elif kCarrtEventClockHz == 16
+    // Prescaler = 64 (set bit CS22):  Timer2 counts at 250 kHz
+    const uint8_t   kTimer2Prescaler    = (1 << CS22);
+    const uint16_t  kCountsPerMs        = 250;
+#elif kCarrtEventClockHz == 32
+    // Prescaler = 32 (set bits CS21 and CS20):  Timer2 counts at 500 kHz
+    const uint8_t   kTimer2Prescaler    = (1 << CS21) | (1 << CS20);
+    const uint16_t  kCountsPerMs        = 500;
+#else
+    // Prescaler = 8 (set bit CS21):  Timer2 counts at 2 MHz
+    const uint8_t   kTimer2Prescaler    = (1 << CS21);
+    const uint16_t  kCountsPerMs        = 2000;
+#endif
+
+    // 15625 counts (61 full cycles + 9) at up to 32 Hz; 31250 (122 + 18) at 64 Hz
+    const uint16_t  kCountsPerTick      = static_cast<uint32_t>( kCountsPerMs ) * 1000 / kCarrtEventClockHz;
+    const uint8_t   kFullCyclesPerTick  = kCountsPerTick / 256;
+    const uint8_t   kLastCycleCounts    = kCountsPerTick % 256;
+
+    // Counts Timer2 overflows within each tick (see the ISR)
+    volatile uint8_t sInterruptCount = -kFullCyclesPerTick;
+};
+
+
+
 void EventClock::init()
 {
     ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
@@ -57,8 +192,7 @@ void EventClock::init()
 
         // Normal mode already set (bits WGM22, WGM21, and WGM20 cleared)
 
-        // Set prescaler = 128 (set bits CS22 and CS20)
-        TCCR2B |= (1 << CS22) | (1 << CS20);
+        TCCR2B |= kTimer2Prescaler;
 
         // Enable timer overflow interrupt
         TIMSK2 |= (1 << TOIE2);
@@ -78,86 +212,49 @@ void EventClock::stop()
 
 
 
-
-ISR( TIMER2_OVF_vect )
+uint32_t EventClock::getMilliseconds()
 {
-    // Interrupts at 128 / 125,000 Hz = every 2.048 milliseconds.
-    // 1/8 second = 61 interrupts + count only 9 on the last interrupt
-
-    static uint8_t interruptCount = -61;
-    static uint8_t eighthSecCount = 0;
+    uint32_t ticks;
+    int8_t interruptCount;
+    uint8_t counts;
 
-    ++interruptCount;
-
-    // Count up from -61 to make the comparison that happens most the time a comparison to zero
-    if ( interruptCount == 0 )
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
     {
-        // On 62nd cycle, only count 9, not the full 256
-        TCNT2 = 256 - 9;
+        ticks = sTicksElapsed;
+        interruptCount = static_cast<int8_t>( sInterruptCount );
+        counts = TCNT2;
     }
-    else if ( interruptCount == 1 )
-    {
-        // Hit an eighth second
-        interruptCount = -61;       // Reset the count of interrupts
-
-#if 0
-
-        // Slower but more explicit implementation, retained as documentation of the logic
 
-        ++eighthSecCount;
-        eighthSecCount %= 64;
-
-        // Queue nav update events every 1/8 second
-        // Event parameter counts eighth seconds ( 0, 1, 2, 3, 4, 5, 6, 7 )
-        EventManager::queueEvent( EventManager::kNavUpdateEvent, eighthSecCount % 8, EventManager::kHighPriority );
-
-        if ( ( eighthSecCount % 2 ) == 0 )
-        {
-            // Event parameter counts quarter seconds ( 0, 1, 2, 3 )
-            EventManager::queueEvent( EventManager::kQuarterSecondTimerEvent, (eighthSecCount % 8) / 2 );
-        }
+    // The last cycle of each tick starts from 256 - kLastCycleCounts instead of 0
+    uint16_t countsThisTick = ( interruptCount == 0 ) ?
+        kFullCyclesPerTick * 256 + ( counts - ( 256 - kLastCycleCounts ) ) : ( interruptCount + kFullCyclesPerTick ) * 256 + counts;
 
-        if ( ( eighthSecCount % 8 ) == 0 )
-        {
-            // Event parameter counts seconds to 8 ( 0, 1, 2, 3, 4, 5, 6, 7 )
-            EventManager::queueEvent( EventManager::kOneSecondTimerEvent, ( eighthSecCount / 8 ) );
-        }
-
-        if ( eighthSecCount == 0 )
-        {
-            EventManager::queueEvent( EventManager::kEightSecondTimerEvent, 0 );
-        }
+    return getTickMilliseconds( ticks ) + countsThisTick / kCountsPerMs;
+}
 
-#else
 
-        ++eighthSecCount;
-        eighthSecCount &= 0x3F;                         // x &= 0x3F ==  x modulo 64
 
-        // Queue nav update events every 1/8 second
-        // Event parameter counts eighth seconds ( 0, 1, 2, 3, 4, 5, 6, 7 )
-        EventManager::queueEvent( EventManager::kNavUpdateEvent, eighthSecCount & 0x07, EventManager::kHighPriority );
 
-        if ( ( eighthSecCount & 0x01 ) == 0 )           // x & 0x01 == x modulo 2
-        {
-            // Event parameter counts quarter seconds ( 0, 1, 2, 3 )
-            // Note:  (x & 0x07) >> 1 == (x % 8) / 2
-            EventManager::queueEvent( EventManager::kQuarterSecondTimerEvent, (eighthSecCount & 0x07) >> 1 );
-        }
-
-        if ( ( eighthSecCount & 0x07 ) == 0 )           // x & 0x07 == x mod 8
-        {
-            // Event parameter counts seconds to 8 ( 0, 1, 2, 3, 4, 5, 6, 7 )
-            // Note: (x >> 3) = x / 8
-            EventManager::queueEvent( EventManager::kOneSecondTimerEvent, ( eighthSecCount >> 3 ) );
-        }
+ISR( TIMER2_OVF_vect )
+{
+    // Interrupts every 256 counts; each tick = kFullCyclesPerTick interrupts + count
+    // only kLastCycleCounts on the last interrupt
 
-        if ( eighthSecCount == 0 )
-        {
-            EventManager::queueEvent( EventManager::kEightSecondTimerEvent, 0 );
-        }
+    uint8_t interruptCount = sInterruptCount + 1;
+    sInterruptCount = interruptCount;
 
-#endif
+    // Count up from -kFullCyclesPerTick to make the comparison that happens most the time a comparison to zero
+    if ( interruptCount == 0 )
+    {
+        // On the last cycle, only count kLastCycleCounts, not the full 256
+        TCNT2 = 256 - kLastCycleCounts;
+    }
+    else if ( interruptCount == 1 )
+    {
+        // Hit a tick
+        sInterruptCount = -kFullCyclesPerTick;      // Reset the count of interrupts
 
+        EventClock::doTickFromIsr();
     }
 }
 
@@ -173,12 +270,30 @@ ISR( TIMER2_OVF_vect )
 #ifdef CARRT_CLOCK_USE_TIMER5
 
 
+namespace
+{
+#if kCarrtEventClockHz <= 16
+    // Prescaler = 64 (set bits CS51 and CS50):  Timer5 counts at 250 kHz
+    const uint8_t   kTimer5Prescaler    = (1 << CS51) | (1 << CS50);
+    const uint16_t  kCountsPerMs        = 250;
+#else
+    // Prescaler = 8 (set bit CS51):  Timer5 counts at 2 MHz
+    const uint8_t   kTimer5Prescaler    = (1 << CS51);
+    const uint16_t  kCountsPerMs        = 2000;
+#endif
+
+    // 31250 counts at 8 Hz, 15625 at 16 Hz, 62500 at 32 Hz, 31250 at 64 Hz
+    const uint16_t  kCountsPerTick      = static_cast<uint32_t>( kCountsPerMs ) * 1000 / kCarrtEventClockHz;
+};
+
+
+
 void EventClock::init()
 {
     ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
     {
-        // Set Timer5 for 8 Hz interrupts by using prescaler value 64 and
-        // compare match register 31249.
+        // Set Timer5 for kCarrtEventClockHz interrupts by using the prescaler
+        // and compare match register kCountsPerTick - 1.
 
         // Clear Timer5 and configure it for Compare Match mode
 
@@ -187,13 +302,9 @@ void EventClock::init()
         TCNT5  = 0;         // initialize counter value to 0
 
         // Set compare match register to desired timer count:
-        // 31249 = 8 Hz
-        OCR5A = 31249;
+        OCR5A = kCountsPerTick - 1;
 
-        // Clear CS52 and set CS51, CS50 bits for prescaler value: 64
-        TCCR5B |= (1 << CS50);
-        TCCR5B |= (1 << CS51);
-        TCCR5B |= (0 << CS52);
+        TCCR5B |= kTimer5Prescaler;
 
         // Set CTC mode (bit WGM52 set, bits WGM51, and WGM50 cleared)
         TCCR5B |= (1 << WGM52);
@@ -216,70 +327,33 @@ void EventClock::stop()
 
 
 
-ISR( TIMER5_COMPA_vect )
+uint32_t EventClock::getMilliseconds()
 {
-    // Interrupts at 8 Hz = every 0.125 secs.
-
-    static uint8_t eighthSecCount = 0;
-
-#if 0
-
-    // Slower but more explicit implementation, retained as documentation of the logic
+    uint32_t ticks;
+    uint16_t counts;
 
-    ++eighthSecCount;
-    eighthSecCount %= 64;
-
-    // Queue nav update events every 1/8 second
-    // Event parameter counts eighth seconds ( 0, 1, 2, 3, 4, 5, 6, 7 )
-    EventManager::queueEvent( EventManager::kNavUpdateEvent, eighthSecCount % 8, EventManager::kHighPriority );
-
-    if ( ( eighthSecCount % 2 ) == 0 )
-    {
-        // Event parameter counts quarter seconds ( 0, 1, 2, 3 )
-        EventManager::queueEvent( EventManager::kQuarterSecondTimerEvent, (eighthSecCount % 8) / 2 );
-    }
-
-    if ( ( eighthSecCount % 8 ) == 0 )
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
     {
-        // Event parameter counts seconds to 8 ( 0, 1, 2, 3, 4, 5, 6, 7 )
-        EventManager::queueEvent( EventManager::kOneSecondTimerEvent, ( eighthSecCount / 8 ) );
-    }
+        ticks = sTicksElapsed;
+        counts = TCNT5;
 
-    if ( eighthSecCount == 0 )
-    {
-        EventManager::queueEvent( EventManager::kEightSecondTimerEvent, 0 );
+        // If the counter just wrapped but the interrupt hasn't run yet, count that tick now
+        if ( ( TIFR5 & (1 << OCF5A) ) && counts < kCountsPerTick / 2 )
+        {
+            ++ticks;
+        }
     }
 
-#else
-
-    ++eighthSecCount;
-    eighthSecCount &= 0x3F;                         // x &= 0x3F ==  x modulo 64
-
-    // Queue nav update events every 1/8 second
-    // Event parameter counts eighth seconds ( 0, 1, 2, 3, 4, 5, 6, 7 )
-    EventManager::queueEvent( EventManager::kNavUpdateEvent, eighthSecCount & 0x07, EventManager::kHighPriority );
-
-    if ( ( eighthSecCount & 0x01 ) == 0 )           // x & 0x01 == x modulo 2
-    {
-        // Event parameter counts quarter seconds ( 0, 1, 2, 3 )
-        // Note:  (x & 0x07) >> 1 == (x % 8) / 2
-        EventManager::queueEvent( EventManager::kQuarterSecondTimerEvent, (eighthSecCount & 0x07) >> 1 );
-    }
+    return getTickMilliseconds( ticks ) + counts / kCountsPerMs;
+}
 
-    if ( ( eighthSecCount & 0x07 ) == 0 )           // x & 0x07 == x mod 8
-    {
-        // Event parameter counts seconds to 8 ( 0, 1, 2, 3, 4, 5, 6, 7 )
-        // Note: (x >> 3) = x / 8
-        EventManager::queueEvent( EventManager::kOneSecondTimerEvent, ( eighthSecCount >> 3 ) );
-    }
 
-    if ( eighthSecCount == 0 )
-    {
-        EventManager::queueEvent( EventManager::kEightSecondTimerEvent, 0 );
-    }
 
-#endif
+ISR( TIMER5_COMPA_vect )
+{
+    // Interrupts at kCarrtEventClockHz
 
+    EventClock::doTickFromIsr();
 }
 
 
@@ -288,3 +362,4 @@ ISR( TIMER5_COMPA_vect )
 
 
 
+#endif  // __AVR__
@@ -24,13 +24,44 @@
 #ifndef EventClock_h
 #define EventClock_h
 
+#include <stdint.h>
+
+
+
+// Rate of the clock's base tick, in Hz:  8, 16, 32, or 64.  Each tick queues a
+// kNavUpdateEvent, so this is also the navigation update rate.  The quarter
+// second, one second, and eight second events are derived from the tick.
+
+#ifndef kCarrtEventClockHz
+#define kCarrtEventClockHz                  8
+#endif
+
+
 
 namespace EventClock
 {
 
+    const uint8_t   kTicksPerSecond     = kCarrtEventClockHz;
+
+    // Time between ticks (and so between navigation updates)
+    const float     kSecondsPerTick     = 1.0 / kCarrtEventClockHz;
+
+
     void init();
 
     void stop();
+
+    // Milliseconds of clock time, read from the timer driving the clock
+    // (only advances while the clock runs)
+    uint32_t getMilliseconds();
+
+    // Ticks counted since the clock first started (each one stamped by the
+    // interrupt handler), and the clock time in milliseconds of a given tick
+    uint32_t getTicks();
+    uint32_t getTickMilliseconds( uint32_t tick );
+
+    // Queue the events due this tick; called by the clock's interrupt handler
+    void doTickFromIsr();
 };
 
 
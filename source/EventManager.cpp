@@ -21,17 +21,83 @@
 
 
 
-#define EVENTMANAGER_EVENT_QUEUE_SIZE		24
+#ifndef CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+#define CARRT_EVENTMANAGER_USE_SPSC_QUEUES     1
+#endif
+
+
+// The capacity of each priority level's queue(s).  In SPSC mode each level has one queue
+// for normal code and one for interrupt handlers, and each size must be a power of 2 (and
+// no more than 128).  The periodic timer and nav events queued by interrupt handlers are
+// coalesced, so each takes at most one slot however far behind the main loop falls.
+
+#if CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+
+#define EVENTMANAGER_LOW_PRIORITY_QUEUE_SIZE            16
+#define EVENTMANAGER_LOW_PRIORITY_ISR_QUEUE_SIZE        8
+#define EVENTMANAGER_TIMER_PRIORITY_QUEUE_SIZE          4
+#define EVENTMANAGER_TIMER_PRIORITY_ISR_QUEUE_SIZE      4
+#define EVENTMANAGER_NAV_PRIORITY_QUEUE_SIZE            4
+#define EVENTMANAGER_NAV_PRIORITY_ISR_QUEUE_SIZE        4
+#define EVENTMANAGER_HIGH_PRIORITY_QUEUE_SIZE           8
+#define EVENTMANAGER_HIGH_PRIORITY_ISR_QUEUE_SIZE       4
+
+#define EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( n )      ( !( n ) || ( ( n ) & ( ( n ) - 1 ) ) || ( n ) > 128 )
+
+#if EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_LOW_PRIORITY_QUEUE_SIZE )           \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_LOW_PRIORITY_ISR_QUEUE_SIZE )    \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_TIMER_PRIORITY_QUEUE_SIZE )      \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_TIMER_PRIORITY_ISR_QUEUE_SIZE )  \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_NAV_PRIORITY_QUEUE_SIZE )        \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_NAV_PRIORITY_ISR_QUEUE_SIZE )    \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_HIGH_PRIORITY_QUEUE_SIZE )       \
+    || EVTMGR_IS_BAD_SPSC_QUEUE_SIZE( EVENTMANAGER_HIGH_PRIORITY_ISR_QUEUE_SIZE )
+#error "Each EVENTMANAGER_*_QUEUE_SIZE must be a power of 2 no larger than 128"
+#endif
+
+#else
+
+#define EVENTMANAGER_LOW_PRIORITY_QUEUE_SIZE            20
+#define EVENTMANAGER_TIMER_PRIORITY_QUEUE_SIZE          8
+#define EVENTMANAGER_NAV_PRIORITY_QUEUE_SIZE            8
+#define EVENTMANAGER_HIGH_PRIORITY_QUEUE_SIZE           12
+
+#endif
 
 
 #include "EventManager.h"
 
+#include <avr/pgmspace.h>
+
+#if __AVR__ || !CARRT_EVENTMANAGER_USE_SPSC_QUEUES
 #include <util/atomic.h>
+#endif
+
+#if CARRT_ENABLE_EVENT_PROFILING
+#include "EventProfiler.h"
+#endif
+
+#if CARRT_ENABLE_TRACE_RECORDER
+#include "TraceRecorder.h"
+#endif
 
 #include "Utils/DebuggingMacros.h"
 
 
 
+// Keeps the compiler (and on a multi-core host, the CPU) from reordering the
+// data accesses around the index and counter updates shared with interrupt handlers.
+// Single-byte loads and stores are atomic on AVR, so a compiler barrier is all that
+// is needed there.
+
+#if __AVR__
+#define EVTMGR_MEMORY_BARRIER()             __asm__ __volatile__( "" ::: "memory" )
+#else
+#define EVTMGR_MEMORY_BARRIER()             __sync_synchronize()
+#endif
+
+
+
 #if CARRT_ENABLE_EVENTMANAGER_DEBUG
 
 #define EVTMGR_DEBUG_PRINT( x )             DEBUG_PRINT( x )
@@ -57,13 +123,177 @@
 namespace EventManager
 {
 
+    struct EventElement
+    {
+        int16_t param;  // each event has a single integer parameter
+        uint8_t code;   // each event is represented by an integer code
+#if CARRT_ENABLE_EVENT_PROFILING
+        uint16_t stamp; // when the event was queued (EventProfiler::timestamp())
+#endif
+    };
+
+
+    // The level each event code is queued at unless the caller says otherwise
+    // (codes from kFirstUserEvent up are all low priority)
+    const uint8_t kDefaultPriorities[] PROGMEM =
+    {
+        kLowPriority,           // kNullEvent
+
+        kTimerPriority,         // kQuarterSecondTimerEvent
+        kTimerPriority,         // kOneSecondTimerEvent
+        kTimerPriority,         // kEightSecondTimerEvent
+
+        kNavPriority,           // kNavUpdateEvent
+        kNavPriority,           // kNavDriftCorrectionEvent
+        kNavPriority,           // kNavSampleReadyEvent
+
+        kHighPriority,          // kErrorEvent
+
+        kLowPriority,           // kKeypadButtonHitEvent
+
+        kLowPriority            // kCoroutineResumeEvent
+    };
+
+    static_assert( sizeof( kDefaultPriorities ) == kLastEvent, "kDefaultPriorities needs one entry per event code" );
+
+
+    // The highest level with its bit set in a mask of levels (the entry for 0 is unused)
+    const uint8_t kHighestLevel[] PROGMEM =
+    {
+        0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+    };
+
+    static_assert( sizeof( kHighestLevel ) == ( 1 << kNbrPriorityLevels ), "kHighestLevel needs one entry per mask of levels" );
+
+
+    // The storage for each level's queue(s)
+    EventElement sLowPriorityEvents[ EVENTMANAGER_LOW_PRIORITY_QUEUE_SIZE ];
+    EventElement sTimerPriorityEvents[ EVENTMANAGER_TIMER_PRIORITY_QUEUE_SIZE ];
+    EventElement sNavPriorityEvents[ EVENTMANAGER_NAV_PRIORITY_QUEUE_SIZE ];
+    EventElement sHighPriorityEvents[ EVENTMANAGER_HIGH_PRIORITY_QUEUE_SIZE ];
+
+
+    uint8_t getLevel( uint8_t eventCode, EventPriority pri );
+
+    inline uint8_t getLevelBit( uint8_t level )
+    { return static_cast<uint8_t>( 1 << level ); }
+
+
+#if CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+
+    // Lock-free single-producer/single-consumer EventQueue used internally by EventManager.
+    //
+    // Only the producer writes mEventQueueTail and only the consumer writes mEventQueueHead.
+    // Both are free-running 8-bit counters; the slot is the counter masked by the queue size,
+    // and the number of events is simply their difference.  So no interrupt masking is needed,
+    // provided each queue has exactly one producer (an interrupt handler OR normal code) and
+    // one consumer (normal code).
+    class EventQueue
+    {
+
+    public:
+
+        // The storage is bound at compile time (constant initialization), so events can be
+        // queued before init() runs; size must be a power of 2 no larger than 128
+        constexpr EventQueue( EventElement* storage, uint8_t size ) :
+        mEventQueue( storage ), mEventQueueMask( size - 1 ), mEventQueueHead( 0 ), mEventQueueTail( 0 )
+        {}
+
+        // Queue initializer (so we control when this happens)
+        void init();
+
+        // Reset (empty) the queue; only the consumer may call this
+        void reset();
+
+        // Returns true if no events are in the queue
+        bool isEmpty();
+
+        // Returns true if no more events can be inserted into the queue
+        bool isFull();
+
+        // Actual number of events in queue
+        uint8_t getNumEvents();
+
+        // Tries to insert an event into the queue; only the producer may call this.
+        // Returns false if successful, true if the queue if full and the event cannot be inserted
+        bool queueEvent( uint8_t eventCode, int16_t eventParam );
+
+        // Tries to extract an event from the queue; only the consumer may call this.
+        // Returns true if successful, false if the queue is empty (the parameteres are not touched in this case)
+        bool popEvent( uint8_t* eventCode, int16_t* eventParam );
+
+    private:
+
+        // The event queue
+        EventElement* const mEventQueue;
+
+        // The queue size less one (the size is a power of 2, so this masks a counter to a slot)
+        const uint8_t mEventQueueMask;
+
+        // Free-running count of events popped (written only by the consumer)
+        volatile uint8_t mEventQueueHead;
+
+        // Free-running count of events queued (written only by the producer)
+        volatile uint8_t mEventQueueTail;
+    };
+
+
+    EventElement sLowPriorityIsrEvents[ EVENTMANAGER_LOW_PRIORITY_ISR_QUEUE_SIZE ];
+    EventElement sTimerPriorityIsrEvents[ EVENTMANAGER_TIMER_PRIORITY_ISR_QUEUE_SIZE ];
+    EventElement sNavPriorityIsrEvents[ EVENTMANAGER_NAV_PRIORITY_ISR_QUEUE_SIZE ];
+    EventElement sHighPriorityIsrEvents[ EVENTMANAGER_HIGH_PRIORITY_ISR_QUEUE_SIZE ];
+
+    // Separate queues at each level for events queued by normal code and by interrupt handlers
+    EventQueue  mQueues[ kNbrPriorityLevels ] =
+    {
+        EventQueue( sLowPriorityEvents, EVENTMANAGER_LOW_PRIORITY_QUEUE_SIZE ),
+        EventQueue( sTimerPriorityEvents, EVENTMANAGER_TIMER_PRIORITY_QUEUE_SIZE ),
+        EventQueue( sNavPriorityEvents, EVENTMANAGER_NAV_PRIORITY_QUEUE_SIZE ),
+        EventQueue( sHighPriorityEvents, EVENTMANAGER_HIGH_PRIORITY_QUEUE_SIZE )
+    };
+
+    EventQueue  mIsrQueues[ kNbrPriorityLevels ] =
+    {
+        EventQueue( sLowPriorityIsrEvents, EVENTMANAGER_LOW_PRIORITY_ISR_QUEUE_SIZE ),
+        EventQueue( sTimerPriorityIsrEvents, EVENTMANAGER_TIMER_PRIORITY_ISR_QUEUE_SIZE ),
+        EventQueue( sNavPriorityIsrEvents, EVENTMANAGER_NAV_PRIORITY_ISR_QUEUE_SIZE ),
+        EventQueue( sHighPriorityIsrEvents, EVENTMANAGER_HIGH_PRIORITY_ISR_QUEUE_SIZE )
+    };
+
+    // One bit per level that may have events waiting, so the highest is found without
+    // looking at every queue.  A bit may linger after its queues empty (the consumer clears
+    // it when it next looks), but is never clear while its queue holds events.
+    //
+    // Normal code both sets and clears sPendingLevels, so it needs no locking.  Interrupt
+    // handlers set sIsrPendingLevels and the consumer clears it (see clearIsrLevelPending()).
+    uint8_t             sPendingLevels;
+    volatile uint8_t    sIsrPendingLevels;
+
+    // Within a level, alternate between the two queues so neither starves the other
+    // (a bit per level; set means the interrupt handler queue goes first)
+    uint8_t sIsrFirstLevels;
+
+    uint8_t sQueueOverflowOccurred;
+
+
+    bool popEventFromEither( uint8_t level, uint8_t* eventCode, int16_t* eventParam );
+    void markIsrLevelPending( uint8_t levelBit );
+    void clearIsrLevelPending( uint8_t level );
+
+#else
+
     // EventQueue class used internally by EventManager
-    // cppcheck-suppress noConstructor
     class EventQueue
     {
 
     public:
 
+        // The storage is bound at compile time (constant initialization), so events can be
+        // queued before init() runs
+        constexpr EventQueue( EventElement* storage, uint8_t size ) :
+        mEventQueue( storage ), mEventQueueSize( size ), mEventQueueHead( 0 ), mEventQueueTail( 0 ), mNumEvents( 0 )
+        {}
+
         // Queue initializer (so we control when this happens)
         void init();
 
@@ -93,19 +323,11 @@ namespace EventManager
 
     private:
 
-        // Event queue size.
-        // The maximum number of events the queue can hold is kEventQueueSize
-        // Increasing this number will consume 3 bytes of RAM for each unit.
-        static const uint8_t kEventQueueSize = EVENTMANAGER_EVENT_QUEUE_SIZE;
-
-        struct EventElement
-        {
-            int16_t param;  // each event has a single integer parameter
-            uint8_t code;   // each event is represented by an integer code
-        };
-
         // The event queue
-        EventElement mEventQueue[ kEventQueueSize ];
+        EventElement* const mEventQueue;
+
+        // The maximum number of events the queue can hold
+        const uint8_t mEventQueueSize;
 
         // Index of event queue head
         uint8_t mEventQueueHead;
@@ -118,11 +340,67 @@ namespace EventManager
     };
 
 
-    EventQueue  mHighPriorityQueue;
-    EventQueue  mLowPriorityQueue;
+    // A single queue per level serves interrupt handlers and normal code alike
+    EventQueue  mQueues[ kNbrPriorityLevels ] =
+    {
+        EventQueue( sLowPriorityEvents, EVENTMANAGER_LOW_PRIORITY_QUEUE_SIZE ),
+        EventQueue( sTimerPriorityEvents, EVENTMANAGER_TIMER_PRIORITY_QUEUE_SIZE ),
+        EventQueue( sNavPriorityEvents, EVENTMANAGER_NAV_PRIORITY_QUEUE_SIZE ),
+        EventQueue( sHighPriorityEvents, EVENTMANAGER_HIGH_PRIORITY_QUEUE_SIZE )
+    };
+
+    // One bit per level that may have events waiting, so the highest is found without
+    // looking at every queue (updated with interrupts off)
+    uint8_t sPendingLevels;
 
     uint8_t sQueueOverflowOccurred;
 
+#endif  // CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+
+
+    // Periodic timer events queued by interrupt handlers are coalesced:  at most one
+    // marker per event code sits in the queue, and ticks arriving while it waits just
+    // update the record below.  The consumer turns the marker back into the event,
+    // with the missed tick count in the parameter's high byte.
+    //
+    // The interrupt handler owns ticksQueued, lastParam and markersQueued; the consumer
+    // owns ticksDelivered and markersPopped.  All are single bytes, so no locking needed.
+
+    const uint8_t kFirstCoalescedEvent  = kQuarterSecondTimerEvent;
+    const uint8_t kLastCoalescedEvent   = kNavUpdateEvent;
+    const uint8_t kNbrCoalescedEvents   = kLastCoalescedEvent - kFirstCoalescedEvent + 1;
+
+    const uint8_t kCoalescedEventFlag   = 0x80;
+
+    // Pending ticks saturate here, so the missed tick count fits in 7 bits
+    const uint8_t kMaxCoalescedTicks    = 128;
+
+    struct CoalescedEvent
+    {
+        volatile uint8_t    ticksQueued;
+        volatile uint8_t    lastParam;
+        volatile uint8_t    markersQueued;
+        volatile uint8_t    markersPopped;
+        uint8_t             ticksDelivered;
+    };
+
+    CoalescedEvent sCoalescedEvents[ kNbrCoalescedEvents ];
+
+#if CARRT_ENABLE_EVENT_PROFILING
+    // When the event most recently popped was queued
+    uint16_t sLastEventStamp;
+#endif
+
+
+    void initQueues();
+    bool popNextEvent( uint8_t* eventCode, int16_t* eventParam );
+    bool pushEvent( uint8_t eventCode, int16_t eventParam, uint8_t level );
+    bool pushEventFromIsr( uint8_t eventCode, int16_t eventParam, uint8_t level );
+
+    bool coalesceEventFromIsr( uint8_t eventCode, int16_t eventParam, uint8_t level );
+    bool resolveCoalescedEvent( uint8_t* eventCode, int16_t* eventParam );
+    void resetCoalescedEvents();
+
  };
 
 
@@ -130,6 +408,27 @@ namespace EventManager
 
 //*********  INLINES   EventManager::EventQueue::  ***********
 
+#if CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+
+inline bool EventManager::EventQueue::isEmpty()
+{
+    return ( mEventQueueHead == mEventQueueTail );
+}
+
+
+inline bool EventManager::EventQueue::isFull()
+{
+    return ( static_cast<uint8_t>( mEventQueueTail - mEventQueueHead ) > mEventQueueMask );
+}
+
+
+inline uint8_t EventManager::EventQueue::getNumEvents()
+{
+    return static_cast<uint8_t>( mEventQueueTail - mEventQueueHead );
+}
+
+#else
+
 inline bool EventManager::EventQueue::isEmpty()
 {
     return ( mNumEvents == 0 );
@@ -138,7 +437,7 @@ inline bool EventManager::EventQueue::isEmpty()
 
 inline bool EventManager::EventQueue::isFull()
 {
-    return ( mNumEvents == kEventQueueSize );
+    return ( mNumEvents == mEventQueueSize );
 }
 
 
@@ -147,44 +446,282 @@ inline uint8_t EventManager::EventQueue::getNumEvents()
     return mNumEvents;
 }
 
+#endif
 
 
 
 
 
 
-uint8_t EventManager::getNextEvent( uint8_t* eventCode, int16_t* param )
+EventManager::EventPriority EventManager::getDefaultPriority( uint8_t eventCode )
 {
-    if ( mHighPriorityQueue.popEvent( eventCode, param ) )
+    if ( eventCode < kLastEvent )
     {
-        return 1;
+        return static_cast<EventPriority>( pgm_read_byte( &kDefaultPriorities[ eventCode ] ) );
     }
 
-    // If  there are no high-pri events try low-pri...
-    if ( mLowPriorityQueue.popEvent( eventCode, param ) )
+    return kLowPriority;
+}
+
+
+
+uint8_t EventManager::getLevel( uint8_t eventCode, EventPriority pri )
+{
+    // kDefaultPriority (or anything else that isn't a level) means use the table
+    return static_cast<uint8_t>( ( pri < kNbrPriorityLevels ) ? pri : getDefaultPriority( eventCode ) );
+}
+
+
+
+void EventManager::init()
+{
+    initQueues();
+
+    resetCoalescedEvents();
+
+    sQueueOverflowOccurred = false;
+}
+
+
+
+bool EventManager::areEventQueuesEmpty()
+{
+    for ( uint8_t level = 0; level < kNbrPriorityLevels; ++level )
     {
-        return 1;
+        if ( !isEventQueueEmpty( static_cast<EventPriority>( level ) ) )
+        {
+            return false;
+        }
     }
 
-    return 0;
+    return true;
 }
 
 
 
-void EventManager::init()
+#if CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+
+void EventManager::initQueues()
 {
-    mHighPriorityQueue.init();
-    mLowPriorityQueue.init();
+    for ( uint8_t level = 0; level < kNbrPriorityLevels; ++level )
+    {
+        mQueues[ level ].init();
+        mIsrQueues[ level ].init();
+    }
+
+    sPendingLevels = 0;
+    sIsrPendingLevels = 0;
+    sIsrFirstLevels = 0xFF;
+}
+
+
+
+bool EventManager::popNextEvent( uint8_t* eventCode, int16_t* param )
+{
+    // Take the highest level with events waiting; if its bits turn out to be stale,
+    // clear them and try the next highest
+    uint8_t pending;
+    while ( ( pending = sPendingLevels | sIsrPendingLevels ) != 0 )
+    {
+        uint8_t level = pgm_read_byte( &kHighestLevel[ pending ] );
+
+        if ( popEventFromEither( level, eventCode, param ) )
+        {
+            return true;
+        }
+
+        sPendingLevels &= ~getLevelBit( level );
+        clearIsrLevelPending( level );
+    }
+
+    return false;
+}
+
+
+
+bool EventManager::popEventFromEither( uint8_t level, uint8_t* eventCode, int16_t* eventParam )
+{
+    uint8_t levelBit = getLevelBit( level );
+    bool isrFirst = sIsrFirstLevels & levelBit;
+
+    EventQueue* first   = isrFirst ? &mIsrQueues[ level ] : &mQueues[ level ];
+    EventQueue* second  = isrFirst ? &mQueues[ level ] : &mIsrQueues[ level ];
+
+    if ( first->popEvent( eventCode, eventParam ) )
+    {
+        // Give the other queue first shot next time
+        sIsrFirstLevels ^= levelBit;
+        return true;
+    }
+
+    return second->popEvent( eventCode, eventParam );
+}
+
+
+
+inline void EventManager::markIsrLevelPending( uint8_t levelBit )
+{
+#if __AVR__
+    // Interrupt handlers aren't themselves interrupted, so a plain read-modify-write is safe
+    sIsrPendingLevels |= levelBit;
+#else
+    __sync_fetch_and_or( &sIsrPendingLevels, levelBit );
+#endif
+}
+
+
+
+void EventManager::clearIsrLevelPending( uint8_t level )
+{
+    uint8_t levelBit = getLevelBit( level );
+
+#if __AVR__
+    // The only place interrupts go off in SPSC mode:  for the few instructions of the
+    // read-modify-write, so an interrupt handler can't set a bit (or queue an event)
+    // between the check and the clear
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+    {
+        if ( mIsrQueues[ level ].isEmpty() )
+        {
+            sIsrPendingLevels &= ~levelBit;
+        }
+    }
+#else
+    // Clear, then check again, so an event queued in the meantime isn't stranded
+    __sync_fetch_and_and( &sIsrPendingLevels, static_cast<uint8_t>( ~levelBit ) );
+    if ( !mIsrQueues[ level ].isEmpty() )
+    {
+        __sync_fetch_and_or( &sIsrPendingLevels, levelBit );
+    }
+#endif
+}
+
+
+
+void EventManager::reset()
+{
+    for ( uint8_t level = 0; level < kNbrPriorityLevels; ++level )
+    {
+        mQueues[ level ].reset();
+        mIsrQueues[ level ].reset();
+    }
+
+    // Bits for events interrupt handlers queue meanwhile stay set
+    sPendingLevels = 0;
+
+    resetCoalescedEvents();
 
     sQueueOverflowOccurred = false;
 }
 
 
 
+bool EventManager::isEventQueueEmpty( EventPriority pri )
+{
+    uint8_t level = getLevel( kNullEvent, pri );
+    return mQueues[ level ].isEmpty() && mIsrQueues[ level ].isEmpty();
+}
+
+
+
+bool EventManager::isEventQueueFull( EventPriority pri )
+{
+    return mQueues[ getLevel( kNullEvent, pri ) ].isFull();
+}
+
+
+
+uint8_t EventManager::getNumEventsInQueue( EventPriority pri )
+{
+    uint8_t level = getLevel( kNullEvent, pri );
+    return mQueues[ level ].getNumEvents() + mIsrQueues[ level ].getNumEvents();
+}
+
+
+
+bool EventManager::pushEvent( uint8_t eventCode, int16_t eventParam, uint8_t level )
+{
+    if ( mQueues[ level ].queueEvent( eventCode, eventParam ) )
+    {
+        return true;
+    }
+
+    sPendingLevels |= getLevelBit( level );
+
+    return false;
+}
+
+
+
+bool EventManager::pushEventFromIsr( uint8_t eventCode, int16_t eventParam, uint8_t level )
+{
+    if ( mIsrQueues[ level ].queueEvent( eventCode, eventParam ) )
+    {
+        return true;
+    }
+
+    // The event is published before its level is marked, so the consumer never clears
+    // the mark with the event still in the queue
+    markIsrLevelPending( getLevelBit( level ) );
+
+    return false;
+}
+
+#else
+
+void EventManager::initQueues()
+{
+    for ( uint8_t level = 0; level < kNbrPriorityLevels; ++level )
+    {
+        mQueues[ level ].init();
+    }
+
+    sPendingLevels = 0;
+}
+
+
+
+bool EventManager::popNextEvent( uint8_t* eventCode, int16_t* param )
+{
+    // Take the highest level with events waiting; if its bit turns out to be stale,
+    // clear it and try the next highest
+    uint8_t pending;
+    while ( ( pending = sPendingLevels ) != 0 )
+    {
+        uint8_t level = pgm_read_byte( &kHighestLevel[ pending ] );
+
+        if ( mQueues[ level ].popEvent( eventCode, param ) )
+        {
+            return true;
+        }
+
+        ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+        {
+            if ( mQueues[ level ].isEmpty() )
+            {
+                sPendingLevels &= ~getLevelBit( level );
+            }
+        }
+    }
+
+    return false;
+}
+
+
+
 void EventManager::reset()
 {
-    mHighPriorityQueue.reset();
-    mLowPriorityQueue.reset();
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+    {
+        for ( uint8_t level = 0; level < kNbrPriorityLevels; ++level )
+        {
+            mQueues[ level ].reset();
+        }
+
+        sPendingLevels = 0;
+    }
+
+    resetCoalescedEvents();
 
     sQueueOverflowOccurred = false;
 }
@@ -193,29 +730,196 @@ void EventManager::reset()
 
 bool EventManager::isEventQueueEmpty( EventPriority pri )
 {
-    return ( pri == kHighPriority ) ? mHighPriorityQueue.isEmpty() : mLowPriorityQueue.isEmpty();
+    return mQueues[ getLevel( kNullEvent, pri ) ].isEmpty();
 }
 
 
 
 bool EventManager::isEventQueueFull( EventPriority pri )
 {
-    return ( pri == kHighPriority ) ? mHighPriorityQueue.isFull() : mLowPriorityQueue.isFull();
+    return mQueues[ getLevel( kNullEvent, pri ) ].isFull();
 }
 
 
 
 uint8_t EventManager::getNumEventsInQueue( EventPriority pri )
 {
-    return ( pri == kHighPriority ) ? mHighPriorityQueue.getNumEvents() : mLowPriorityQueue.getNumEvents();
+    return mQueues[ getLevel( kNullEvent, pri ) ].getNumEvents();
+}
+
+
+
+bool EventManager::pushEvent( uint8_t eventCode, int16_t eventParam, uint8_t level )
+{
+    if ( mQueues[ level ].queueEvent( eventCode, eventParam ) )
+    {
+        return true;
+    }
+
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+    {
+        sPendingLevels |= getLevelBit( level );
+    }
+
+    return false;
+}
+
+
+
+bool EventManager::pushEventFromIsr( uint8_t eventCode, int16_t eventParam, uint8_t level )
+{
+    // A single queue per level serves interrupt handlers and normal code alike
+    return pushEvent( eventCode, eventParam, level );
 }
 
+#endif
+
 
 
 bool EventManager::queueEvent( uint8_t eventCode, int16_t eventParam, EventPriority pri )
 {
-    return ( pri == kHighPriority ) ?
-        mHighPriorityQueue.queueEvent( eventCode, eventParam ) : mLowPriorityQueue.queueEvent( eventCode, eventParam );
+    bool overflowed = pushEvent( eventCode, eventParam, getLevel( eventCode, pri ) );
+
+#if CARRT_ENABLE_TRACE_RECORDER
+    if ( overflowed )
+    {
+        TraceRecorder::record( TraceRecorder::kTraceQueueOverflow, eventCode );
+    }
+    else
+    {
+        TraceRecorder::record( eventCode, eventParam );
+    }
+#endif
+
+    return overflowed;
+}
+
+
+
+uint8_t EventManager::getNextEvent( uint8_t* eventCode, int16_t* param )
+{
+    while ( popNextEvent( eventCode, param ) )
+    {
+        if ( !( *eventCode & kCoalescedEventFlag ) || resolveCoalescedEvent( eventCode, param ) )
+        {
+            return 1;
+        }
+
+        // Otherwise a stale marker (its ticks were already delivered); skip it
+    }
+
+    return 0;
+}
+
+
+
+#if CARRT_ENABLE_EVENT_PROFILING
+
+uint16_t EventManager::getLastEventEnqueueTime()
+{
+    return sLastEventStamp;
+}
+
+#endif
+
+
+
+bool EventManager::queueEventFromIsr( uint8_t eventCode, int16_t eventParam, EventPriority pri )
+{
+    uint8_t level = getLevel( eventCode, pri );
+
+    if ( eventCode >= kFirstCoalescedEvent && eventCode <= kLastCoalescedEvent )
+    {
+        return coalesceEventFromIsr( eventCode, eventParam, level );
+    }
+
+    return pushEventFromIsr( eventCode, eventParam, level );
+}
+
+
+
+bool EventManager::coalesceEventFromIsr( uint8_t eventCode, int16_t eventParam, uint8_t level )
+{
+    CoalescedEvent* c = &sCoalescedEvents[ eventCode - kFirstCoalescedEvent ];
+
+    // Record the tick; the latest parameter always wins
+    c->lastParam = static_cast<uint8_t>( eventParam );
+    EVTMGR_MEMORY_BARRIER();
+    if ( static_cast<uint8_t>( c->ticksQueued - c->ticksDelivered ) < kMaxCoalescedTicks )
+    {
+        ++c->ticksQueued;
+    }
+    EVTMGR_MEMORY_BARRIER();
+
+    if ( c->markersQueued != c->markersPopped )
+    {
+        // A marker is still waiting in the queue, so this tick has been folded into it
+        return false;
+    }
+
+    // The marker carries its own sequence number so the consumer can acknowledge it.
+    // If the queue is full the tick stays recorded and goes out with a later marker.
+    uint8_t marker = c->markersQueued + 1;
+    if ( pushEventFromIsr( eventCode | kCoalescedEventFlag, marker, level ) )
+    {
+        return true;
+    }
+    c->markersQueued = marker;
+
+    return false;
+}
+
+
+
+bool EventManager::resolveCoalescedEvent( uint8_t* eventCode, int16_t* eventParam )
+{
+    uint8_t code = *eventCode & ~kCoalescedEventFlag;
+    CoalescedEvent* c = &sCoalescedEvents[ code - kFirstCoalescedEvent ];
+
+    // Markers come out in order, so after this the next tick queues a fresh marker
+    c->markersPopped = static_cast<uint8_t>( *eventParam );
+    EVTMGR_MEMORY_BARRIER();
+
+    // Take a consistent snapshot of the tick count and latest parameter
+    // (retry if a tick lands in the middle)
+    uint8_t ticks;
+    uint8_t lastParam;
+    do
+    {
+        ticks = c->ticksQueued;
+        EVTMGR_MEMORY_BARRIER();
+        lastParam = c->lastParam;
+        EVTMGR_MEMORY_BARRIER();
+    }
+    while ( ticks != c->ticksQueued );
+
+    uint8_t newTicks = ticks - c->ticksDelivered;
+    if ( !newTicks )
+    {
+        return false;
+    }
+
+    c->ticksDelivered = ticks;
+
+    *eventCode = code;
+    *eventParam = ( static_cast<int16_t>( newTicks - 1 ) << 8 ) | lastParam;
+
+    return true;
+}
+
+
+
+void EventManager::resetCoalescedEvents()
+{
+    // Called after the queues are purged; forget any pending ticks and markers.
+    // A marker queued by an interrupt in the meantime is harmless:  at worst it
+    // turns out stale and is skipped.
+    for ( uint8_t i = 0; i < kNbrCoalescedEvents; ++i )
+    {
+        CoalescedEvent* c = &sCoalescedEvents[i];
+        c->markersPopped = c->markersQueued;
+        c->ticksDelivered = c->ticksQueued;
+    }
 }
 
 
@@ -240,6 +944,109 @@ void EventManager::resetEventQueueOverflowFlag()
 
 
 
+#if CARRT_EVENTMANAGER_USE_SPSC_QUEUES
+
+void EventManager::EventQueue::init()
+{
+    mEventQueueHead = 0;
+    mEventQueueTail = 0;
+
+    for ( uint8_t i = 0; i <= mEventQueueMask; i++ )
+    {
+        mEventQueue[i].code = EventManager::kNullEvent;
+        mEventQueue[i].param = 0;
+    }
+}
+
+
+
+void EventManager::EventQueue::reset()
+{
+    // Only the consumer owns the head, so discard everything by catching it up to the tail.
+    // The producer may keep queueing while this happens.
+    mEventQueueHead = mEventQueueTail;
+}
+
+
+
+bool EventManager::EventQueue::queueEvent( uint8_t eventCode, int16_t eventParam )
+{
+    /*
+    * Only the producer ever writes the tail, and the consumer only ever makes
+    * room (never takes it away), so if the queue isn't full now it can't become
+    * full before we finish.  The slot is filled in BEFORE the tail is advanced,
+    * so the consumer never sees a half-written event.
+    *
+    * Because this function may be called from interrupt handlers, no debugging output.
+    */
+
+    uint8_t tail = mEventQueueTail;
+
+    if ( static_cast<uint8_t>( tail - mEventQueueHead ) > mEventQueueMask )
+    {
+        EventManager::sQueueOverflowOccurred = true;
+        return true;
+    }
+
+    // Store the event at the tail of the queue
+    mEventQueue[ tail & mEventQueueMask ].code = eventCode;
+    mEventQueue[ tail & mEventQueueMask ].param = eventParam;
+#if CARRT_ENABLE_EVENT_PROFILING
+    mEventQueue[ tail & mEventQueueMask ].stamp = EventProfiler::timestamp();
+#endif
+
+    // Publish the event
+    EVTMGR_MEMORY_BARRIER();
+    mEventQueueTail = tail + 1;
+
+    return false;
+}
+
+
+
+bool EventManager::EventQueue::popEvent( uint8_t* eventCode, int16_t* eventParam )
+{
+    /*
+    * Mirror image of queueEvent():  only the consumer ever writes the head, and the
+    * producer only ever adds events, so if the queue isn't empty now it stays that way.
+    * The slot is read BEFORE the head is advanced, so the producer can't overwrite it
+    * while we are reading it.
+    */
+
+    uint8_t head = mEventQueueHead;
+
+    if ( head == mEventQueueTail )
+    {
+        return false;
+    }
+
+    // Make sure the slot is read after seeing the tail that published it
+    EVTMGR_MEMORY_BARRIER();
+
+    // Pop the event from the head of the queue
+    // Store event code and event parameter into the user-supplied variables
+    *eventCode  = mEventQueue[ head & mEventQueueMask ].code;
+    *eventParam = mEventQueue[ head & mEventQueueMask ].param;
+#if CARRT_ENABLE_EVENT_PROFILING
+    EventManager::sLastEventStamp = mEventQueue[ head & mEventQueueMask ].stamp;
+#endif
+
+    // Clear the event (paranoia)
+    mEventQueue[ head & mEventQueueMask ].code = EventManager::kNullEvent;
+
+    // Release the slot
+    EVTMGR_MEMORY_BARRIER();
+    mEventQueueHead = head + 1;
+
+    EVTMGR_DEBUG_PRINT_P( PSTR( "popEvent() return " ) )
+    EVTMGR_DEBUG_PRINT( *eventCode )
+    EVTMGR_DEBUG_PRINT( ", " )
+    EVTMGR_DEBUG_PRINTLN( *eventParam )
+
+    return true;
+}
+
+#else
 
 void EventManager::EventQueue::init()
 {
@@ -247,7 +1054,7 @@ void EventManager::EventQueue::init()
     mEventQueueTail = 0;
     mNumEvents = 0;
 
-    for ( uint8_t i = 0; i < kEventQueueSize; i++ )
+    for ( uint8_t i = 0; i < mEventQueueSize; i++ )
     {
         mEventQueue[i].code = EventManager::kNullEvent;
         mEventQueue[i].param = 0;
@@ -303,9 +1110,12 @@ bool EventManager::EventQueue::queueEvent( uint8_t eventCode, int16_t eventParam
             // Store the event at the tail of the queue
             mEventQueue[ mEventQueueTail ].code = eventCode;
             mEventQueue[ mEventQueueTail ].param = eventParam;
+#if CARRT_ENABLE_EVENT_PROFILING
+            mEventQueue[ mEventQueueTail ].stamp = EventProfiler::timestamp();
+#endif
 
             // Update queue tail value
-            mEventQueueTail = ( mEventQueueTail + 1 ) % kEventQueueSize;;
+            mEventQueueTail = ( mEventQueueTail + 1 ) % mEventQueueSize;
 
             // Update number of events in queue
             mNumEvents++;
@@ -361,12 +1171,15 @@ bool EventManager::EventQueue::popEvent( uint8_t* eventCode, int16_t* eventParam
         // Store event code and event parameter into the user-supplied variables
         *eventCode  = mEventQueue[ mEventQueueHead ].code;
         *eventParam = mEventQueue[ mEventQueueHead ].param;
+#if CARRT_ENABLE_EVENT_PROFILING
+        EventManager::sLastEventStamp = mEventQueue[ mEventQueueHead ].stamp;
+#endif
 
         // Clear the event (paranoia)
         mEventQueue[ mEventQueueHead ].code = EventManager::kNullEvent;
 
         // Update the queue head value
-        mEventQueueHead = ( mEventQueueHead + 1 ) % kEventQueueSize;
+        mEventQueueHead = ( mEventQueueHead + 1 ) % mEventQueueSize;
 
         // Update number of events in queue
         mNumEvents--;
@@ -379,3 +1192,5 @@ bool EventManager::EventQueue::popEvent( uint8_t* eventCode, int16_t* eventParam
 
     return true;
 }
+
+#endif
@@ -37,6 +37,8 @@ namespace EventManager
         kNullEvent = 0,
 
         // Timer events
+        // (these and kNavUpdateEvent are coalesced when queued from an interrupt handler;
+        // they must stay contiguous)
         kQuarterSecondTimerEvent,
         kOneSecondTimerEvent,
         kEightSecondTimerEvent,
@@ -45,22 +47,63 @@ namespace EventManager
         kNavUpdateEvent,
         kNavDriftCorrectionEvent,
 
+        // A set of navigation sensor readings is ready (see ImuSampler.h)
+        kNavSampleReadyEvent,
+
         // Error event
         kErrorEvent,
 
         // Keypad events
         kKeypadButtonHitEvent,
 
-        kLastEvent
+        // Wakes a waiting coroutine (see Coroutine.h)
+        kCoroutineResumeEvent,
+
+        kLastEvent,
+
+        // Codes from here up (to 0x7F) are free for states to define for their
+        // own use, e.g., as the events posted by their timers (see TimerService.h)
+        kFirstUserEvent = kLastEvent
     };
 
 
-    // EventManager recognizes two kinds of events.  By default, events are
-    // are queued as low priority, but these constants can be used to explicitly
-    // set the priority when queueing events
+    // EventManager queues events at four priority levels, each with its own queue(s)
+    // and capacity.  By default an event is queued at the level a table (in
+    // EventManager.cpp) gives its code:  errors and other safety-relevant events
+    // high, navigation next, then the periodic timer events, and everything else
+    // (the keypad, coroutines, and the states' own events) low.  These constants
+    // can be used to explicitly set the priority when queueing events.
     //
-    // NOTE high priority events are always handled before any low priority events.
-    enum EventPriority { kLowPriority, kHighPriority };
+    // NOTE events at a higher level are always handled before any at a lower level,
+    // so a burst of keypad or timer events never delays an error event.
+    enum EventPriority
+    {
+        kLowPriority,
+        kTimerPriority,
+        kNavPriority,
+        kHighPriority,
+
+        kNbrPriorityLevels,
+
+        // Use the event code's level from the table
+        kDefaultPriority = 0xFF
+    };
+
+    // The level an event code is queued at by default
+    EventPriority getDefaultPriority( uint8_t eventCode );
+
+
+    // Periodic timer events (quarter-second through nav update) queued by interrupt
+    // handlers are coalesced, so a stalled main loop can't overflow the queue with them.
+    // If ticks were missed while the event waited, the parameter's low byte holds the
+    // latest tick's value and its high byte the number of ticks missed (0 - 127).
+    // The parameter is never negative, so tests like param % 2 keep working.
+
+    inline uint8_t getTimerTick( int16_t eventParam )
+    { return static_cast<uint8_t>( eventParam & 0xFF ); }
+
+    inline uint8_t getMissedTicks( int16_t eventParam )
+    { return static_cast<uint8_t>( eventParam >> 8 ); }
 
 
     void init();
@@ -68,23 +111,40 @@ namespace EventManager
     // Reset event manager by reseting (purging) queues and clearing overflow flag
     void reset();
 
-    // Returns true if no events are in the queue
+    // Returns true if no events are in the queue at the given level
     bool isEventQueueEmpty( EventPriority pri = kLowPriority );
 
-    // Returns true if no more events can be inserted into the queue
+    // Returns true if no events are in the queue at any level
+    bool areEventQueuesEmpty();
+
+    // Returns true if no more events can be inserted into the queue at the given level
+    // (by normal code; the interrupt handler queue is separate in SPSC mode)
     bool isEventQueueFull( EventPriority pri = kLowPriority );
 
-    // Actual number of events in queue
+    // Actual number of events in queue at the given level
     uint8_t getNumEventsInQueue( EventPriority pri = kLowPriority );
 
     // Tries to insert an event into the queue;
-    // returns true if successful, false if the
+    // returns false if successful, true if the
     // queue if full and the event cannot be inserted
-    bool queueEvent( uint8_t eventCode, int16_t eventParam, EventPriority pri = kLowPriority );
+    //
+    // NOTE: call this only from normal (non-interrupt) code; interrupt
+    // handlers must use queueEventFromIsr() instead.
+    bool queueEvent( uint8_t eventCode, int16_t eventParam, EventPriority pri = kDefaultPriority );
+
+    // Same as queueEvent(), but for use from interrupt handlers.  When
+    // CARRT_EVENTMANAGER_USE_SPSC_QUEUES is set, interrupt handlers and normal code
+    // each have their own lock-free queues, so the two must not be mixed up.
+    bool queueEventFromIsr( uint8_t eventCode, int16_t eventParam, EventPriority pri = kDefaultPriority );
 
     // This function returns the next event
     uint8_t getNextEvent( uint8_t* eventCode, int16_t* eventParam );
 
+#if CARRT_ENABLE_EVENT_PROFILING
+    // When the event last returned by getNextEvent() was queued, as an EventProfiler::timestamp()
+    uint16_t getLastEventEnqueueTime();
+#endif
+
     // Has the event queue overflowed?
     bool hasEventQueueOverflowed();
 
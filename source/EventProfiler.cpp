@@ -0,0 +1,256 @@
+/*
+    EventProfiler.cpp - Histograms of event dispatch latency and handler
+    duration, per event code and per state class.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#if CARRT_ENABLE_EVENT_PROFILING
+
+
+
+#include "EventProfiler.h"
+
+#include <string.h>
+
+#include "Utils/DebuggingMacros.h"
+
+
+
+
+namespace EventProfiler
+{
+
+    Histogram   sLatency[ kNbrEventRows ];
+    Histogram   sDispatch[ kNbrEventRows ];
+
+    uint16_t    sStateKeys[ kMaxStates ];
+    Histogram   sStateHandlers[ kMaxStates ];
+    uint8_t     sNbrStates;
+
+    uint8_t getBucket( uint16_t elapsed );
+    void addSample( Histogram* h, uint16_t elapsed );
+    void dumpHistogram( const Histogram& h );
+
+};
+
+
+
+
+void EventProfiler::reset()
+{
+    memset( sLatency, 0, sizeof( sLatency ) );
+    memset( sDispatch, 0, sizeof( sDispatch ) );
+    memset( sStateHandlers, 0, sizeof( sStateHandlers ) );
+    sNbrStates = 0;
+}
+
+
+
+void EventProfiler::recordLatency( uint8_t eventCode, uint16_t enqueueStamp, uint16_t dispatchStamp )
+{
+    addSample( &sLatency[ getEventRow( eventCode ) ], dispatchStamp - enqueueStamp );
+}
+
+
+
+void EventProfiler::recordDispatch( uint8_t eventCode, uint16_t startStamp, uint16_t endStamp )
+{
+    addSample( &sDispatch[ getEventRow( eventCode ) ], endStamp - startStamp );
+}
+
+
+
+void EventProfiler::recordStateHandler( uint16_t stateKey, uint16_t startStamp, uint16_t endStamp )
+{
+    uint8_t i = 0;
+    while ( i < sNbrStates && sStateKeys[i] != stateKey )
+    {
+        ++i;
+    }
+
+    if ( i == sNbrStates )
+    {
+        if ( sNbrStates == kMaxStates )
+        {
+            // Table full; states seen later aren't tracked
+            return;
+        }
+        sStateKeys[i] = stateKey;
+        ++sNbrStates;
+    }
+
+    addSample( &sStateHandlers[i], endStamp - startStamp );
+}
+
+
+
+uint8_t EventProfiler::getEventRow( uint8_t eventCode )
+{
+    return ( eventCode < EventManager::kFirstUserEvent ) ? eventCode : EventManager::kFirstUserEvent;
+}
+
+
+
+const EventProfiler::Histogram& EventProfiler::getLatencyHistogram( uint8_t eventRow )
+{
+    return sLatency[ eventRow ];
+}
+
+
+
+const EventProfiler::Histogram& EventProfiler::getDispatchHistogram( uint8_t eventRow )
+{
+    return sDispatch[ eventRow ];
+}
+
+
+
+uint8_t EventProfiler::getNbrStates()
+{
+    return sNbrStates;
+}
+
+
+
+uint16_t EventProfiler::getTrackedStateKey( uint8_t i )
+{
+    return sStateKeys[i];
+}
+
+
+
+const EventProfiler::Histogram& EventProfiler::getStateHistogram( uint8_t i )
+{
+    return sStateHandlers[i];
+}
+
+
+
+uint8_t EventProfiler::getPercentileBucket( const Histogram& h, uint8_t percent )
+{
+    uint16_t needed = ( static_cast<uint32_t>( getNbrSamples( h ) ) * percent + 99 ) / 100;
+
+    uint16_t sum = 0;
+    for ( uint8_t b = 0; b < kNbrBuckets; ++b )
+    {
+        sum += h.count[b];
+        if ( sum >= needed )
+        {
+            return b;
+        }
+    }
+
+    return kNbrBuckets - 1;
+}
+
+
+
+uint16_t EventProfiler::getNbrSamples( const Histogram& h )
+{
+    uint16_t total = 0;
+    for ( uint8_t b = 0; b < kNbrBuckets; ++b )
+    {
+        total += h.count[b];
+    }
+
+    return total;
+}
+
+
+
+void EventProfiler::dump()
+{
+    DEBUG_PRINTLN_P( PSTR( "Event profile (buckets <64us <256us <1ms <4ms <16ms <65ms <262ms >=262ms)" ) );
+
+    for ( uint8_t row = 0; row < kNbrEventRows; ++row )
+    {
+        DEBUG_PRINT_P( PSTR( "Event " ) );
+        DEBUG_PRINT( row );
+        DEBUG_PRINT_P( PSTR( " latency:" ) );
+        dumpHistogram( sLatency[row] );
+        DEBUG_PRINT_P( PSTR( "Event " ) );
+        DEBUG_PRINT( row );
+        DEBUG_PRINT_P( PSTR( " dispatch:" ) );
+        dumpHistogram( sDispatch[row] );
+    }
+
+    for ( uint8_t i = 0; i < sNbrStates; ++i )
+    {
+        DEBUG_PRINT_P( PSTR( "State vtable " ) );
+        DEBUG_PRINT( sStateKeys[i] );
+        DEBUG_PRINT_P( PSTR( " onEvent:" ) );
+        dumpHistogram( sStateHandlers[i] );
+    }
+}
+
+
+
+
+/******************************************************************************/
+
+
+
+
+uint8_t EventProfiler::getBucket( uint16_t elapsed )
+{
+    // elapsed is in 64 us units; each bucket covers two more bits
+    uint8_t bucket = 0;
+    while ( elapsed && bucket < kNbrBuckets - 1 )
+    {
+        elapsed >>= 2;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+
+
+void EventProfiler::addSample( Histogram* h, uint16_t elapsed )
+{
+    uint8_t bucket = getBucket( elapsed );
+
+    if ( h->count[ bucket ] == 0xFF )
+    {
+        for ( uint8_t b = 0; b < kNbrBuckets; ++b )
+        {
+            h->count[b] >>= 1;
+        }
+    }
+
+    ++h->count[ bucket ];
+}
+
+
+
+void EventProfiler::dumpHistogram( const Histogram& h )
+{
+    for ( uint8_t b = 0; b < kNbrBuckets; ++b )
+    {
+        DEBUG_PRINT( ' ' );
+        DEBUG_PRINT( h.count[b] );
+    }
+    DEBUG_PRINTLN( ' ' );
+}
+
+
+
+
+#endif  // CARRT_ENABLE_EVENT_PROFILING
@@ -0,0 +1,112 @@
+/*
+    EventProfiler.h - Histograms of event dispatch latency and handler
+    duration, per event code and per state class.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef EventProfiler_h
+#define EventProfiler_h
+
+
+#if CARRT_ENABLE_EVENT_PROFILING
+
+
+#include <stdint.h>
+
+#include "AVRTools/SystemClock.h"
+
+#include "EventManager.h"
+
+
+/*
+ * Each histogram has 8 buckets, each 4 times wider than the one before:
+ *
+ *   bucket:   0      1       2      3      4       5       6        7
+ *   time:   <64us  <256us  <1ms   <4ms   <16ms   <65ms   <262ms   >=262ms
+ *
+ * Counts are single bytes; when any bucket of a histogram would overflow,
+ * all of its buckets are halved, which keeps the shape of the distribution.
+ *
+ * Times are 16-bit stamps in units of 64 us, so they wrap after about 4 s
+ * (longer waits show up as shorter ones).
+ *
+ * States have no type IDs, so per-state histograms are keyed by the address of
+ * the state's vtable (see getStateClassKey() in State.h).
+ */
+
+namespace EventProfiler
+{
+
+    enum
+    {
+        kNbrBuckets     = 8,
+
+        // One row per system event code, plus one shared by all user event codes
+        kNbrEventRows   = EventManager::kFirstUserEvent + 1,
+
+        kMaxStates      = 8
+    };
+
+
+    struct Histogram
+    {
+        uint8_t count[ kNbrBuckets ];
+    };
+
+
+    inline uint16_t timestamp()
+    { return static_cast<uint16_t>( micros() >> 6 ); }
+
+    void reset();
+
+    // Time from queueing the event to the start of its dispatch
+    void recordLatency( uint8_t eventCode, uint16_t enqueueStamp, uint16_t dispatchStamp );
+
+    // Time for the whole dispatch of an event (system handlers included)
+    void recordDispatch( uint8_t eventCode, uint16_t startStamp, uint16_t endStamp );
+
+    // Time spent in a state's onEvent(), keyed by getStateClassKey()
+    void recordStateHandler( uint16_t stateKey, uint16_t startStamp, uint16_t endStamp );
+
+    uint8_t getEventRow( uint8_t eventCode );
+
+    const Histogram& getLatencyHistogram( uint8_t eventRow );
+    const Histogram& getDispatchHistogram( uint8_t eventRow );
+
+    uint8_t getNbrStates();
+    uint16_t getTrackedStateKey( uint8_t i );
+    const Histogram& getStateHistogram( uint8_t i );
+
+    // Smallest bucket holding at least the given percentage of the samples
+    uint8_t getPercentileBucket( const Histogram& h, uint8_t percent );
+
+    // Total samples in a histogram (approximate once its counts have been halved)
+    uint16_t getNbrSamples( const Histogram& h );
+
+    // Print all the histograms over the debug serial line
+    void dump();
+
+};
+
+
+#endif  // CARRT_ENABLE_EVENT_PROFILING
+
+
+#endif
@@ -460,5 +460,16 @@ namespace
 
 
 
+//****************************************************************************
+
+// States come from the state arena (see State.h)
+
+CARRT_CHECK_STATE_SIZE( GotoDriveMenuState );
+CARRT_CHECK_STATE_SIZE( GetGotoCoordinateState );
+CARRT_CHECK_STATE_SIZE( ReadyToGotoState );
+CARRT_CHECK_STATE_SIZE( GetNumberRangeMenuState );
+
+
+
 
 #endif  // CARRT_INCLUDE_GOTODRIVE_IN_BUILD
@@ -29,6 +29,8 @@
 #include <stdlib.h>
 #include <avr/pgmspace.h>
 
+#include "AVRTools/SystemClock.h"
+
 #include "Drivers/Beep.h"
 #include "Drivers/Display.h"
 #include "Drivers/DriveParam.h"
@@ -43,6 +45,7 @@
 #include "EventManager.h"
 #include "GotoDriveMenuStates.h"
 #include "MainProcess.h"
+#include "MappingScan.h"
 #include "Navigator.h"
 #include "NavigationMap.h"
 #include "WelcomeMenuStates.h"
@@ -109,7 +112,7 @@
  *          - Switch to PerformMappingScanState
  *
  *      2.2 PerformMappingScanState
- *          - Execute a scan and update the map
+ *          - Sweep the lidar across the scene, updating the map as it goes
  *          - Switch to DetermineNextWaypointState
  *
  *      2.3 DetermineNextWaypointState
@@ -544,7 +547,14 @@ namespace
 {
     const int8_t kScanLimitLeft         = -80;
     const int8_t kScanLimitRight        = 81;
-    const int8_t kScanIncrement         = 2;
+
+    // Time to allow the servo to slew to the start of the scan
+    const uint16_t kInitialSlewTimeMs   = 1000;
+
+    // Sweep in slices this long, giving the event loop a turn between them, and update
+    // the display every so many slices
+    const uint16_t kSweepSliceMs        = 20;
+    const uint8_t kSlicesPerDisplay     = 10;
 
     const PROGMEM char sLabelMapping[]  = "Mapping...";
     const PROGMEM char sLabelRng[]      = "Rng = ";
@@ -553,7 +563,8 @@ namespace
 };
 
 
-PerformMappingScanState::PerformMappingScanState()
+PerformMappingScanState::PerformMappingScanState() :
+mNbrSlices( 0 )
 {
     GOTO_DEBUG_PRINTLN_P( PSTR( "\nPerforming mapping scan" ) );
 
@@ -579,16 +590,16 @@ void PerformMappingScanState::onEntry()
     Display::clear();
     Display::displayTopRowP16( sLabelMapping );
 
-    mCurrentSlewAngle = kScanLimitLeft;
-    Lidar::slew( mCurrentSlewAngle );
-
-    // Allow time for the servo to slew (this might be a big slew)
-    CarrtCallback::yieldMilliseconds( 1000 );
+    mScan.stop();
+    scan( EventManager::kNullEvent, 0 );
 }
 
 
 void PerformMappingScanState::onExit()
 {
+    // Leave the lidar as it was if the scan was cut short
+    MappingScan::endSweep();
+
     Lidar::slew( 0 );
 
     delete this;
@@ -601,103 +612,75 @@ bool PerformMappingScanState::onEvent( uint8_t event, int16_t param )
     {
         MainProcess::changeState( new GotoDriveMenuState );
     }
-    else if ( event == EventManager::kOneSecondTimerEvent && (param % 2) == 0 )    // Every 2 secs....
+    else
     {
-        if ( mCurrentSlewAngle > kScanLimitRight )
-        {
-            // Done with scan
-            Lidar::slew( 0 );
-
-            GOTO_DEBUG_PRINTLN_P( PSTR( "Mapping done" ) );
-            GOTO_DEBUG_PRINTLN_P( PSTR( "Global map:" ) );
-            GOTO_DEBUG_DUMP_MAP_GLOBAL();
-            GOTO_DEBUG_PRINTLN_P( PSTR( "Local map:" ) );
-            GOTO_DEBUG_DUMP_MAP_LOCAL();
-            GOTO_DEBUG_BEEP();
-
-            MainProcess::changeState( new DetermineNextWaypointState );
-        }
-        else
-        {
-            // Slew radar into position for next read
-            Lidar::slew( mCurrentSlewAngle );
-
-            // Allow time for the servo to slew (this is a small slew)
-            CarrtCallback::yieldMilliseconds( 500 );
-
-            int rng = getAndProcessRange();
-            displayAngleRange( rng );
-        }
-
-        mCurrentSlewAngle += kScanIncrement;
+        scan( event, param );
     }
 
     return true;
 }
 
 
-int PerformMappingScanState::getAndProcessRange()
+void PerformMappingScanState::scan( uint8_t event, int16_t param )
 {
-    int rng;
-    int err = Lidar::getMedianDistanceInCm( &rng );
+    CORO_BEGIN( mScan );
 
-    if ( !err )
+    Lidar::slew( kScanLimitLeft );
+
+    // Allow time for the servo to slew (this might be a big slew)
+    CORO_WAIT_MS( mScan, kInitialSlewTimeMs );
+
+    // Sweep across, mapping as the readings come in (see MappingScan.h)
+    MappingScan::startSweep( kScanLimitLeft, kScanLimitRight );
+    while ( !MappingScan::isSweepDone() )
     {
-        float rad = mCurrentSlewAngle * kDegreesToRadians;
-        float cosine = cos( rad );
-        float sine = sin( rad );
+        MappingScan::continueSweep( kSweepSliceMs );
 
-        // First mark as clear everything between CARRT and the lidar obstacle
-        const int rngStepSize = kLocalCmPerGrid / 4;
-        for ( int r = rngStepSize; r < rng; r += rngStepSize )
+        if ( ++mNbrSlices == kSlicesPerDisplay )
         {
-            // Get relative coords
-            float xRel = static_cast<float>( r ) * cosine;
-            // Extra negative here because using compass headings instead of mathematical angles
-            // math_angle = 360 - compass_angle, which puts a negative on sin()
-            float yRel = -static_cast<float>( r ) * sine;
-
-            // Convert relative coordinates to absolute and mark as clear on map
-            Vector2Float coordsGlobal = Navigator::convertRelativeToAbsoluteCoordsCm( xRel, yRel );
-            NavigationMap::markClear( roundToInt( coordsGlobal.x ), roundToInt( coordsGlobal.y ) );
+            mNbrSlices = 0;
+            displayAngleRange();
         }
 
-        // Now mark the obstacle
-        float xRel = static_cast<float>( rng ) * cosine;
-        // Extra negative here because using compass headings instead of mathematical angles
-        // math_angle = 360 - compass_angle, which puts a negative on sin()
-        float yRel = -static_cast<float>( rng ) * sine;
-
-        // Convert relative coordinates to absolute and mark as obstacle on map
-        Vector2Float coordsGlobal = Navigator::convertRelativeToAbsoluteCoordsCm( xRel, yRel );
-        NavigationMap::markObstacle( roundToInt( coordsGlobal.x ), roundToInt( coordsGlobal.y ) );
-    }
-    else
-    {
-        rng = -1;
+        CORO_YIELD( mScan );
     }
+    MappingScan::endSweep();
+
+    // Done with scan
+    CORO_END( mScan );
 
-    return rng;
+    Lidar::slew( 0 );
+
+    GOTO_DEBUG_PRINTLN_P( PSTR( "Mapping done" ) );
+    GOTO_DEBUG_PRINTLN_P( PSTR( "Global map:" ) );
+    GOTO_DEBUG_DUMP_MAP_GLOBAL();
+    GOTO_DEBUG_PRINTLN_P( PSTR( "Local map:" ) );
+    GOTO_DEBUG_DUMP_MAP_LOCAL();
+    GOTO_DEBUG_BEEP();
+
+    MainProcess::changeState( new DetermineNextWaypointState );
 }
 
 
-void PerformMappingScanState::displayAngleRange( int rng )
+void PerformMappingScanState::displayAngleRange()
 {
+    const MappingScan::Reading& reading = MappingScan::getLastReading();
+
     Display::clear();
     Display::setCursor( 0, 0 );
     Display::printP16( sLabelAngle );
     Display::setCursor( 0, 8 );
-    Display::print( mCurrentSlewAngle );
+    Display::print( roundToInt( reading.angle ) );
     Display::setCursor( 1, 0 );
     Display::printP16( sLabelRng );
     Display::setCursor( 1, 6 );
-    if ( rng == -1 )
+    if ( reading.range == -1 )
     {
         Display::printP16( sUnknown );
     }
     else
     {
-        Display::print( rng );
+        Display::print( reading.range );
     }
 }
 
@@ -1335,6 +1318,18 @@ bool FinishedGotoDriveState::onEvent( uint8_t event, int16_t param )
 
 
 
+//****************************************************************************
+
+// States come from the state arena (see State.h)
+
+CARRT_CHECK_STATE_SIZE( InitiateGotoDriveState );
+CARRT_CHECK_STATE_SIZE( PointTowardsGoalState );
+CARRT_CHECK_STATE_SIZE( PerformMappingScanState );
+CARRT_CHECK_STATE_SIZE( DetermineNextWaypointState );
+CARRT_CHECK_STATE_SIZE( RotateTowardWaypointState );
+CARRT_CHECK_STATE_SIZE( DriveToWaypointState );
+CARRT_CHECK_STATE_SIZE( FinishedWaypointDriveState );
+CARRT_CHECK_STATE_SIZE( FinishedGotoDriveState );
 
 
 
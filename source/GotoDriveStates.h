@@ -29,6 +29,7 @@
 
 #include <avr/pgmspace.h>
 
+#include "Coroutine.h"
 #include "State.h"
 
 #include "PathSearch/Path.h"
@@ -130,11 +131,12 @@ public:
 
 private:
 
-    int getAndProcessRange();
-    void displayAngleRange( int rng );
+    void scan( uint8_t event, int16_t param );
+    void displayAngleRange();
 
-    int     mHeading;
-    int     mCurrentSlewAngle;
+    Coroutine   mScan;
+    int         mHeading;
+    uint8_t     mNbrSlices;
 };
 
 
@@ -0,0 +1,297 @@
+/*
+    HeadingFilter.cpp - Blends the gyroscope and compass into one heading
+    estimate, estimating the gyroscope's bias as it goes.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "HeadingFilter.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "EventClock.h"
+
+#include "Utils/FixedPoint.h"
+
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace HeadingFilter
+{
+
+    // The fixed-point versions of the gains
+    struct GainsFixed
+    {
+        int16_t     heading;            // Q1.15
+        int32_t     bias;               // Q16.16 (centi-degrees/s per centi-degree)
+        int16_t     gate;               // centi-degrees
+    };
+
+    // Iterations of the Riccati equation to reach steady state (it gets there in well under 100)
+    const int kNbrRiccatiIterations     = 200;
+
+    // Starting points from the data sheets and bench runs; HeadingFilterTuner fits them to logged runs
+    const NoiseParams kDefaultNoiseParams = { 0.1, 0.01, 2.0, 10.0 };
+
+
+    void computeAllGains();
+
+    float wrapHeading( float heading );
+    float wrapHeadingChange( float change );
+
+
+    NoiseParams     mNoiseParams        = kDefaultNoiseParams;
+
+    bool            mGainsReady;
+    Gains           mGains[2];          // straight, turning
+    GainsFixed      mGainsFixed[2];
+
+};
+
+
+
+
+void HeadingFilter::setNoiseParams( const NoiseParams& params )
+{
+    mNoiseParams = params;
+    computeAllGains();
+}
+
+
+
+const HeadingFilter::NoiseParams& HeadingFilter::getNoiseParams()
+{
+    return mNoiseParams;
+}
+
+
+
+const HeadingFilter::Gains& HeadingFilter::getGains( bool turning )
+{
+    if ( !mGainsReady )
+    {
+        computeAllGains();
+    }
+
+    return mGains[ turning ? 1 : 0 ];
+}
+
+
+
+HeadingFilter::Gains HeadingFilter::computeGains( float gyroNoise, float biasNoise, float compassNoise, float timeStep )
+{
+    // State is ( heading, bias ); heading += gyroChange - bias * timeStep
+    const float qHeading = gyroNoise * gyroNoise * timeStep;
+    const float qBias = biasNoise * biasNoise * timeStep;
+    const float r = compassNoise * compassNoise;
+
+    float p00 = r;
+    float p01 = 0;
+    float p11 = qBias;
+
+    float s = r;
+    float k0 = 0;
+    float k1 = 0;
+
+    for ( int i = 0; i < kNbrRiccatiIterations; ++i )
+    {
+        // Predict
+        p00 += timeStep * ( timeStep * p11 - 2 * p01 ) + qHeading;
+        p01 -= timeStep * p11;
+        p11 += qBias;
+
+        // Correct with the compass
+        s = p00 + r;
+        k0 = p00 / s;
+        k1 = p01 / s;
+
+        p11 -= k1 * p01;
+        p01 *= 1 - k0;
+        p00 *= 1 - k0;
+    }
+
+    Gains gains;
+    gains.heading = k0;
+    gains.bias = k1;
+    gains.innovationSigma = sqrt( s );
+    return gains;
+}
+
+
+
+void HeadingFilter::reset( State* state, float heading )
+{
+    state->heading = heading;
+    state->bias = 0;
+    state->innovation = 0;
+    state->nbrRejected = 0;
+}
+
+
+
+void HeadingFilter::reset( StateFixed* state, uint16_t heading )
+{
+    state->heading = heading;
+    state->bias = 0;
+    state->innovation = 0;
+    state->nbrRejected = 0;
+}
+
+
+
+float HeadingFilter::update( State* state, float gyroChange, float compassHeading, float timeStep, bool turning )
+{
+    const Gains& gains = getGains( turning );
+
+    float predicted = wrapHeading( state->heading + gyroChange - state->bias * timeStep );
+    float innovation = wrapHeadingChange( compassHeading - predicted );
+
+    if ( fabs( innovation ) > kGateSigmas * gains.innovationSigma && state->nbrRejected < kMaxNbrRejected )
+    {
+        // Probably a compass disturbance:  go with the gyro
+        ++state->nbrRejected;
+    }
+    else
+    {
+        state->nbrRejected = 0;
+        predicted = wrapHeading( predicted + gains.heading * innovation );
+        state->bias += gains.bias * innovation;
+    }
+
+    state->heading = predicted;
+    state->innovation = innovation;
+
+    return innovation;
+}
+
+
+
+int16_t HeadingFilter::update( StateFixed* state, int16_t gyroChange, uint16_t compassHeading, int16_t timeStep, bool turning )
+{
+    if ( !mGainsReady )
+    {
+        computeAllGains();
+    }
+
+    const GainsFixed& gains = mGainsFixed[ turning ? 1 : 0 ];
+    const int32_t kCircle = FixedPoint::kCentiDegreesPerCircle;
+
+    // Bias (Q16.16) times time step, rounded to centi-degrees
+    int32_t biasChange = FixedPoint::multiply( state->bias, timeStep, 12 );
+    int32_t predicted = static_cast<int32_t>( state->heading ) + gyroChange - ( ( biasChange + 0x8000 ) >> 16 );
+    if ( predicted < 0 )
+    {
+        predicted += kCircle;
+    }
+    else if ( predicted >= kCircle )
+    {
+        predicted -= kCircle;
+    }
+
+    int32_t innovation = static_cast<int32_t>( compassHeading ) - predicted;
+    if ( innovation > kCircle / 2 )
+    {
+        innovation -= kCircle;
+    }
+    else if ( innovation < -kCircle / 2 )
+    {
+        innovation += kCircle;
+    }
+
+    int16_t innov = innovation;
+    if ( abs( innov ) > gains.gate && state->nbrRejected < kMaxNbrRejected )
+    {
+        // Probably a compass disturbance:  go with the gyro
+        ++state->nbrRejected;
+    }
+    else
+    {
+        state->nbrRejected = 0;
+        predicted += ( static_cast<int32_t>( gains.heading ) * innov + 0x4000 ) >> 15;
+        state->bias += gains.bias * innov;
+
+        if ( predicted < 0 )
+        {
+            predicted += kCircle;
+        }
+        else if ( predicted >= kCircle )
+        {
+            predicted -= kCircle;
+        }
+    }
+
+    state->heading = predicted;
+    state->innovation = innov;
+
+    return innov;
+}
+
+
+
+
+void HeadingFilter::computeAllGains()
+{
+    const float compassNoise[2] = { mNoiseParams.compassNoise, mNoiseParams.compassNoiseTurning };
+
+    for ( uint8_t i = 0; i < 2; ++i )
+    {
+        mGains[i] = computeGains( mNoiseParams.gyroNoise, mNoiseParams.biasNoise, compassNoise[i],
+                                  EventClock::kSecondsPerTick );
+
+        mGainsFixed[i].heading = static_cast<int16_t>( mGains[i].heading * FixedPoint::kQ15One + 0.5 );
+        mGainsFixed[i].bias = FixedPoint::convertToQ16( mGains[i].bias );
+        mGainsFixed[i].gate = static_cast<int16_t>( kGateSigmas * mGains[i].innovationSigma * 100 + 0.5 );
+    }
+
+    mGainsReady = true;
+}
+
+
+
+float HeadingFilter::wrapHeading( float heading )
+{
+    if ( heading < 0 )
+    {
+        heading += 360;
+    }
+    else if ( heading >= 360 )
+    {
+        heading -= 360;
+    }
+    return heading;
+}
+
+
+
+float HeadingFilter::wrapHeadingChange( float change )
+{
+    // Handle the 360<->0, NE-NW crossing
+    if ( change > 180 )
+    {
+        change -= 360;
+    }
+    else if ( change < -180 )
+    {
+        change += 360;
+    }
+    return change;
+}
@@ -0,0 +1,118 @@
+/*
+    HeadingFilter.h - Blends the gyroscope and compass into one heading
+    estimate, estimating the gyroscope's bias as it goes.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef HeadingFilter_h
+#define HeadingFilter_h
+
+#include <stdint.h>
+
+
+
+/*
+ * The filter is a two-state (heading, gyroscope bias) Kalman filter run with
+ * its steady-state gains, i.e., a complementary filter with bias estimation:
+ *
+ *   predicted   = heading + gyroChange - bias * timeStep
+ *   innovation  = compassHeading - predicted        (wrapped to +/-180)
+ *   heading     = predicted + headingGain * innovation
+ *   bias        = bias + biasGain * innovation
+ *
+ * The gains follow from the noise parameters (worked out once, when they are
+ * set, not per update), so each update costs the same few multiplies.  The
+ * motors disturb the compass, so there is a separate, larger, compass noise
+ * while turning.  An innovation beyond the gate (a few standard deviations)
+ * is taken to be a disturbance and ignored, unless that goes on long enough
+ * that the heading has more likely drifted off, when the compass is trusted
+ * again.
+ *
+ * The Navigator keeps the filter state:  in degrees for the floating point
+ * navigators, and in centi-degrees (Q16.16 centi-degrees per second for the
+ * bias) for the fixed-point one.
+ */
+
+namespace HeadingFilter
+{
+
+    struct NoiseParams
+    {
+        float   gyroNoise;              // heading random walk from gyro noise (deg/sqrt(s))
+        float   biasNoise;              // gyro bias random walk (deg/s/sqrt(s))
+        float   compassNoise;           // compass heading noise driving straight (deg)
+        float   compassNoiseTurning;    // compass heading noise while turning (deg)
+    };
+
+    struct Gains
+    {
+        float   heading;                // fraction of the innovation added to the heading
+        float   bias;                   // change in bias (deg/s) per degree of innovation
+        float   innovationSigma;        // steady-state innovation standard deviation (deg)
+    };
+
+
+    struct State
+    {
+        float       heading;            // deg
+        float       bias;               // deg/s
+        float       innovation;         // the last one (deg), for the debug log
+        uint8_t     nbrRejected;        // consecutive innovations outside the gate
+    };
+
+    struct StateFixed
+    {
+        uint16_t    heading;            // centi-degrees
+        int32_t     bias;               // Q16.16 centi-degrees/s
+        int16_t     innovation;         // centi-degrees
+        uint8_t     nbrRejected;
+    };
+
+
+    // Innovations beyond this many standard deviations are ignored...
+    const float     kGateSigmas         = 3.0;
+    // ...unless there are this many in a row
+    const uint8_t   kMaxNbrRejected     = 8;
+
+
+    void setNoiseParams( const NoiseParams& params );
+    const NoiseParams& getNoiseParams();
+
+    // Steady-state gains for the nominal nav update time step
+    const Gains& getGains( bool turning );
+
+    // Steady-state gains for any noise (used by setNoiseParams() and the tuning tool)
+    Gains computeGains( float gyroNoise, float biasNoise, float compassNoise, float timeStep );
+
+    void reset( State* state, float heading );
+    void reset( StateFixed* state, uint16_t heading );
+
+    // One update:  gyroChange is the gyro heading change over timeStep (the filter
+    // takes out the bias) and compassHeading the compass reading at the end of it;
+    // returns the innovation
+    float update( State* state, float gyroChange, float compassHeading, float timeStep, bool turning );
+
+    // The same, in integers (centi-degrees; timeStep in Q4.12 seconds)
+    int16_t update( StateFixed* state, int16_t gyroChange, uint16_t compassHeading, int16_t timeStep, bool turning );
+
+};
+
+
+#endif
@@ -0,0 +1,410 @@
+/*
+    ImuSampler.cpp - Reads the navigation sensors (compass, accelerometer, and
+    gyroscope) in the background, for the Navigator.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "ImuSampler.h"
+
+#include "EventManager.h"
+
+#include "AVRTools/I2cMaster.h"
+
+#include "Drivers/L3GD20.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/NavSensorDataBlock.h"
+
+
+
+// Keeps the compiler from reading the buffer before the byte count that says
+// the data is there (the I2C interrupt handler fills in both)
+
+#if __AVR__
+#define IMUSAMPLER_MEMORY_BARRIER()         __asm__ __volatile__( "" ::: "memory" )
+#else
+#define IMUSAMPLER_MEMORY_BARRIER()         __sync_synchronize()
+#endif
+
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace ImuSampler
+{
+
+    // The reads, in order
+    enum Step
+    {
+        kIdle,
+        kMagBefore,
+        kAccelLevel,
+        kAccel,
+        kGyroLevel,
+        kGyro,
+        kMagAfter
+    };
+
+    // Bytes per FIFO entry and per compass reading (a FIFO level is one byte)
+    const uint8_t   kBytesPerReading    = 6;
+
+
+    void startRead( uint8_t step );
+    void reduceEntry( uint8_t entry );
+    void finishSample();
+    void skipSample();
+    void clearSums();
+
+
+    // The reads run one after the other, so they share a buffer
+    DataBlock           mRawData;
+    volatile uint8_t    mNbrBytesRead;
+    volatile uint8_t    mStatus;
+
+    uint8_t             mStep;
+    uint8_t             mBytesPerEntry;
+    uint8_t             mNbrEntries;
+    uint8_t             mNbrReduced;
+    uint8_t             mFifoLevel;
+
+    Vector3Long         mAccelSum;
+    Vector3Long         mAccelSumOfSums;
+    Vector3Long         mGyroSum;
+    uint8_t             mNbrAccel;
+    uint8_t             mNbrGyro;
+    bool                mGyroOverrun;
+    Vector3Int          mMagSum;
+
+    Vector3Int          mLastAccel;
+
+    float               mTimeStep;
+    float               mCarriedTime;
+    uint32_t            mStartMicros;
+
+    Sample              mSamples[2];
+    uint8_t             mNextSample;
+
+    uint16_t            mNbrSkipped;
+
+};
+
+
+
+
+void ImuSampler::start( float timeStep, uint32_t now )
+{
+    mCarriedTime += timeStep;
+
+    if ( mStep != kIdle )
+    {
+        // Last update's reads still running:  skip this one
+        ++mNbrSkipped;
+        return;
+    }
+
+    mTimeStep = mCarriedTime;
+    mCarriedTime = 0;
+    mStartMicros = now;
+
+    // The FIFO sums carry on from any sample that wasn't delivered, along with its time
+    mMagSum = Vector3Int( 0, 0, 0 );
+
+    startRead( kMagBefore );
+}
+
+
+
+void ImuSampler::poll()
+{
+    // With a fast bus (or the simulator), more than one read may complete per call
+
+    while ( mStep != kIdle )
+    {
+        uint8_t status = mStatus;
+        uint8_t nbrArrived = mNbrBytesRead / mBytesPerEntry;
+        IMUSAMPLER_MEMORY_BARRIER();
+
+        // Reduce the entries as they arrive, so little is left to do at the end
+        while ( mNbrReduced < nbrArrived )
+        {
+            reduceEntry( mNbrReduced++ );
+        }
+
+        if ( mNbrReduced < mNbrEntries )
+        {
+            if ( status == I2cMaster::kI2cError )
+            {
+                skipSample();
+            }
+
+            return;
+        }
+
+        switch ( mStep )
+        {
+            case kMagBefore:
+                startRead( kAccelLevel );
+                break;
+
+            case kAccelLevel:
+                startRead( kAccel );
+                break;
+
+            case kAccel:
+                startRead( kGyroLevel );
+                break;
+
+            case kGyroLevel:
+                startRead( kGyro );
+                break;
+
+            case kGyro:
+                startRead( kMagAfter );
+                break;
+
+            default:
+                finishSample();
+                break;
+        }
+    }
+}
+
+
+
+bool ImuSampler::isPollNeeded()
+{
+    return mStep != kIdle
+            && ( mNbrBytesRead / mBytesPerEntry > mNbrReduced || mStatus == I2cMaster::kI2cError );
+}
+
+
+
+bool ImuSampler::isBusy()
+{
+    return mStep != kIdle;
+}
+
+
+
+const ImuSampler::Sample& ImuSampler::getSample( int16_t eventParam )
+{
+    return mSamples[ eventParam & 0x01 ];
+}
+
+
+
+int16_t ImuSampler::replaySample( const Sample& sample )
+{
+    int16_t eventParam = mNextSample;
+
+    mSamples[ mNextSample ] = sample;
+    mNextSample ^= 0x01;
+
+    return eventParam;
+}
+
+
+
+void ImuSampler::reset()
+{
+    mCarriedTime = 0;
+    clearSums();
+}
+
+
+
+uint16_t ImuSampler::getNbrSkipped()
+{
+    return mNbrSkipped;
+}
+
+
+
+
+void ImuSampler::startRead( uint8_t step )
+{
+    mStep = step;
+    mNbrReduced = 0;
+    mNbrBytesRead = 0;
+    mBytesPerEntry = kBytesPerReading;
+    mNbrEntries = 1;
+
+    uint8_t err;
+    switch ( step )
+    {
+        case kAccelLevel:
+            mBytesPerEntry = 1;
+            err = LSM303DLHC::getAccelerationFifoStatusAsync( mRawData.buffer, &mNbrBytesRead, &mStatus );
+            break;
+
+        case kAccel:
+            // Nothing to read if the FIFO is empty
+            mNbrEntries = mFifoLevel;
+            err = mFifoLevel ? LSM303DLHC::getAccelerationDataBlockAsync( &mRawData, mFifoLevel, &mNbrBytesRead, &mStatus ) : 0;
+            break;
+
+        case kGyroLevel:
+            mBytesPerEntry = 1;
+            err = L3GD20::getFifoStatusAsync( mRawData.buffer, &mNbrBytesRead, &mStatus );
+            break;
+
+        case kGyro:
+            mNbrEntries = mFifoLevel;
+            err = mFifoLevel ? L3GD20::getAngularRatesDataBlockAsync( &mRawData, mFifoLevel, &mNbrBytesRead, &mStatus ) : 0;
+            break;
+
+        default:
+            err = LSM303DLHC::getMagnetometerDataAsync( mRawData.buffer, &mNbrBytesRead, &mStatus );
+            break;
+    }
+
+    if ( err )
+    {
+        // Couldn't queue the read
+        skipSample();
+    }
+}
+
+
+
+void ImuSampler::reduceEntry( uint8_t entry )
+{
+    switch ( mStep )
+    {
+        case kAccelLevel:
+            mFifoLevel = LSM303DLHC::convertAccelerationFifoStatusToLevel( mRawData.buffer[0] );
+            break;
+
+        case kAccel:
+            // The counts only fill up if samples keep going undelivered; drop what won't fit
+            if ( mNbrAccel < 0xFF )
+            {
+                mAccelSum += LSM303DLHC::convertDataBlockEntryToAccelerationRaw( mRawData, entry );
+                mAccelSumOfSums += mAccelSum;
+                ++mNbrAccel;
+            }
+            break;
+
+        case kGyroLevel:
+            mFifoLevel = L3GD20::convertFifoStatusToLevel( mRawData.buffer[0] );
+            if ( L3GD20::isFifoOverrun( mRawData.buffer[0] ) )
+            {
+                mGyroOverrun = true;
+            }
+            break;
+
+        case kGyro:
+            if ( mNbrGyro < 0xFF )
+            {
+                mGyroSum += L3GD20::convertDataBlockEntryToAngularRatesRaw( mRawData, entry );
+                ++mNbrGyro;
+            }
+            else
+            {
+                mGyroOverrun = true;
+            }
+            break;
+
+        default:
+            mMagSum += LSM303DLHC::convertMagnetometerDataToRaw( mRawData.buffer );
+            break;
+    }
+}
+
+
+
+void ImuSampler::finishSample()
+{
+    mStep = kIdle;
+
+    Sample* sample = &mSamples[ mNextSample ];
+
+    sample->accelSum = mAccelSum;
+    sample->accelSumOfSums = mAccelSumOfSums;
+    sample->gyroSum = mGyroSum;
+    sample->nbrAccel = mNbrAccel;
+    sample->nbrGyro = mNbrGyro;
+
+    if ( mGyroOverrun && mNbrGyro )
+    {
+        // Readings were lost:  if those left don't cover the time step, make them (at the
+        // same average rate) stand for the readings it should have had
+        float nbrDue = mTimeStep * L3GD20::gyroscopeUpdateRate();
+        if ( nbrDue > mNbrGyro + 0.5 )
+        {
+            uint8_t nbrGyro = nbrDue < 0xFF ? static_cast<uint8_t>( nbrDue + 0.5 ) : 0xFF;
+            float scale = static_cast<float>( nbrGyro ) / mNbrGyro;
+
+            sample->gyroSum = Vector3Long( static_cast<int32_t>( mGyroSum.x * scale ),
+                                           static_cast<int32_t>( mGyroSum.y * scale ),
+                                           static_cast<int32_t>( mGyroSum.z * scale ) );
+            sample->nbrGyro = nbrGyro;
+        }
+    }
+
+    if ( mNbrAccel )
+    {
+        Vector3Long average = mAccelSum;
+        average /= mNbrAccel;
+        mLastAccel = Vector3Int( average.x, average.y, average.z );
+    }
+    sample->accel = mLastAccel;
+
+    // Average the "before" and "after" compass readings
+    sample->mag = mMagSum;
+    sample->mag /= 2;
+
+    sample->timeStep = mTimeStep;
+    sample->micros = mStartMicros;
+
+    if ( EventManager::queueEvent( EventManager::kNavSampleReadyEvent, mNextSample ) )
+    {
+        // Queue full (the overflow is reported by the event loop); the time, and the
+        // readings drained from the FIFOs, go to the next sample
+        mCarriedTime += mTimeStep;
+        ++mNbrSkipped;
+        return;
+    }
+
+    mNextSample ^= 0x01;
+    clearSums();
+}
+
+
+
+void ImuSampler::skipSample()
+{
+    // Any readings already drained stay in the sums for the next sample
+    mStep = kIdle;
+    mCarriedTime += mTimeStep;
+    ++mNbrSkipped;
+}
+
+
+
+void ImuSampler::clearSums()
+{
+    mAccelSum = Vector3Long( 0, 0, 0 );
+    mAccelSumOfSums = Vector3Long( 0, 0, 0 );
+    mGyroSum = Vector3Long( 0, 0, 0 );
+    mNbrAccel = 0;
+    mNbrGyro = 0;
+    mGyroOverrun = false;
+}
@@ -0,0 +1,107 @@
+/*
+    ImuSampler.h - Reads the navigation sensors (compass, accelerometer, and
+    gyroscope) in the background, for the Navigator.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef ImuSampler_h
+#define ImuSampler_h
+
+#include <stdint.h>
+
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * A navigation update needs a compass reading, everything in the accelerometer
+ * and gyroscope FIFOs (each read as its level, then that many readings), and a
+ * second compass reading:  about 10 ms of I2C transfers.  Rather than wait
+ * them out, start() queues the first read and returns; each read that
+ * completes (the I2C interrupt handler fills the buffer) is reduced, and the
+ * next one queued, the next time the event loop calls poll().  When the last
+ * read completes, the sample goes in one of two sample buffers and a
+ * kNavSampleReadyEvent (at nav priority) says which.  The event loop is free
+ * to handle other events, or sleep, during the transfers.
+ *
+ * Draining the FIFOs means every reading the sensors take (190 Hz for the
+ * gyroscope, 100 Hz for the accelerometer) goes into one sample, so
+ * the Navigator can integrate each over its own update period rather than
+ * one reading over the whole time step.  The sums are kept in integers, as
+ * read.  The gyroscope's FIFO only holds 168 ms of readings, so after a late
+ * update it has lost the oldest:  then the sum is scaled up to cover the
+ * whole time step, at the average rate of the readings that are left.
+ *
+ * If a set of reads is still running when the next start() comes along, a
+ * read fails, or the sample can't be queued, that update is skipped and its
+ * time (and any readings drained from the FIFOs) go in the next sample, so the
+ * Navigator still integrates over all the time that passed.
+ */
+
+namespace ImuSampler
+{
+
+    struct Sample
+    {
+        // Every FIFO reading since the last sample (raw)
+        Vector3Long accelSum;
+        Vector3Long accelSumOfSums;     // the sum of the running sums, for a second integration
+        Vector3Long gyroSum;
+        uint8_t     nbrAccel;
+        uint8_t     nbrGyro;            // if the FIFO overran, the readings the time step should have had
+
+        Vector3Int  accel;              // average raw readings (the last ones if the FIFO was empty)
+        Vector3Int  mag;                // average of the "before" and "after" compass readings
+
+        float       timeStep;           // seconds since the last sample
+        uint32_t    micros;             // when the time step ended (as given to start())
+    };
+
+
+    // Start reading the sensors for a sample covering timeStep seconds, up to now (from micros())
+    void start( float timeStep, uint32_t now );
+
+    // Called from the event loop:  reduce the data that has arrived and start the next read
+    void poll();
+
+    // True if poll() has work to do (data has arrived, or a read failed)
+    bool isPollNeeded();
+
+    // True while a set of reads is running
+    bool isBusy();
+
+    // The sample a kNavSampleReadyEvent refers to (by its parameter); good until the
+    // second sample after it is ready
+    const Sample& getSample( int16_t eventParam );
+
+    // Put a recorded sample (see SensorLog.h) where getSample() finds it, returning the
+    // parameter a kNavSampleReadyEvent for it would have (for replaying on Linux)
+    int16_t replaySample( const Sample& sample );
+
+    // Forget any time (and readings) carried over from skipped samples
+    void reset();
+
+    // Number of samples skipped (overruns and failed reads)
+    uint16_t getNbrSkipped();
+
+};
+
+
+#endif
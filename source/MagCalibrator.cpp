@@ -0,0 +1,349 @@
+/*
+    MagCalibrator.cpp - Fits the magnetometer's hard and soft iron calibration
+    to readings taken while CARRT turns, and keeps it in EEPROM.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "MagCalibrator.h"
+
+#include <math.h>
+
+#include <avr/eeprom.h>
+
+#include "Utils/Checksum.h"
+
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace MagCalibrator
+{
+
+    // Terms of the fit:  x^2, y^2, z^2, x, y, z
+    const uint8_t kNbrTerms             = 6;
+    const uint8_t kNbrSums              = kNbrTerms * ( kNbrTerms + 1 ) / 2;
+
+    const uint8_t kMinNbrReadings       = 24;
+    const uint8_t kAllOctants           = 0xFF;
+
+    // Less spread in z than this (calibrated, so of about 2) and only x and y are fitted
+    const float   kMinZSpread           = 0.5;
+
+    const float   kSmallestPivot        = 1e-6;
+
+
+    struct StoredCalibration
+    {
+        uint16_t                        signature;
+        LSM303DLHC::MagCalibration      calibration;
+        uint16_t                        checksum;
+    };
+
+    const uint16_t kSignature           = 0x4D43;       // "MC"
+
+
+    uint8_t triangleIndex( uint8_t i, uint8_t j );
+    bool solve( float m[kNbrTerms][kNbrTerms + 1], uint8_t n );
+
+
+    LSM303DLHC::MagCalibration  mReference;
+
+    // Upper triangle of the sum of the terms' products, and sum of the terms
+    float           mSums[kNbrSums];
+    float           mTermSums[kNbrTerms];
+
+    uint8_t         mNbrReadings;
+    uint8_t         mOctantsSeen;
+    float           mMinZ;
+    float           mMaxZ;
+
+    StoredCalibration   mEepromCalibration EEMEM;
+
+};
+
+
+
+
+void MagCalibrator::start()
+{
+    mReference = LSM303DLHC::getMagnetometerCalibration();
+
+    for ( uint8_t i = 0; i < kNbrSums; ++i )
+    {
+        mSums[i] = 0;
+    }
+    for ( uint8_t i = 0; i < kNbrTerms; ++i )
+    {
+        mTermSums[i] = 0;
+    }
+
+    mNbrReadings = 0;
+    mOctantsSeen = 0;
+    mMinZ = 0;
+    mMaxZ = 0;
+}
+
+
+
+void MagCalibrator::addReading( const Vector3Int& magRaw )
+{
+    float x = ( magRaw.x - mReference.offset.x ) * mReference.scale.x;
+    float y = ( magRaw.y - mReference.offset.y ) * mReference.scale.y;
+    float z = ( magRaw.z - mReference.offset.z ) * mReference.scale.z;
+
+    const float terms[kNbrTerms] = { x * x, y * y, z * z, x, y, z };
+
+    uint8_t k = 0;
+    for ( uint8_t i = 0; i < kNbrTerms; ++i )
+    {
+        mTermSums[i] += terms[i];
+        for ( uint8_t j = i; j < kNbrTerms; ++j )
+        {
+            mSums[k++] += terms[i] * terms[j];
+        }
+    }
+
+    // Which way round it points (near enough, if the reference calibration isn't good)
+    uint8_t octant = ( x < 0 ? 4 : 0 ) | ( y < 0 ? 2 : 0 ) | ( fabs( x ) < fabs( y ) ? 1 : 0 );
+    mOctantsSeen |= 1 << octant;
+
+    if ( !mNbrReadings || z < mMinZ )
+    {
+        mMinZ = z;
+    }
+    if ( !mNbrReadings || z > mMaxZ )
+    {
+        mMaxZ = z;
+    }
+
+    if ( mNbrReadings < 255 )
+    {
+        ++mNbrReadings;
+    }
+}
+
+
+
+bool MagCalibrator::isComplete()
+{
+    return mOctantsSeen == kAllOctants && mNbrReadings >= kMinNbrReadings;
+}
+
+
+
+uint8_t MagCalibrator::nbrReadings()
+{
+    return mNbrReadings;
+}
+
+
+
+bool MagCalibrator::fit( LSM303DLHC::MagCalibration* calibration )
+{
+    // Which terms to fit
+    const uint8_t kAllTerms[] = { 0, 1, 2, 3, 4, 5 };
+    const uint8_t kXyTerms[] = { 0, 1, 3, 4 };
+
+    bool fitZ = ( mMaxZ - mMinZ ) >= kMinZSpread;
+    const uint8_t* terms = fitZ ? kAllTerms : kXyTerms;
+    uint8_t n = fitZ ? 6 : 4;
+    uint8_t nbrAxes = fitZ ? 3 : 2;
+
+    if ( mNbrReadings < n )
+    {
+        return false;
+    }
+
+    // The normal equations, with the sums of the terms as the right hand side
+    float m[kNbrTerms][kNbrTerms + 1];
+    for ( uint8_t i = 0; i < n; ++i )
+    {
+        for ( uint8_t j = 0; j < n; ++j )
+        {
+            m[i][j] = mSums[ triangleIndex( terms[i], terms[j] ) ];
+        }
+        m[i][n] = mTermSums[ terms[i] ];
+    }
+
+    if ( !solve( m, n ) )
+    {
+        return false;
+    }
+
+    // Coefficients of the squares are first, then of the axes
+    float coeffs[kNbrTerms] = { 0, 0, 0, 0, 0, 0 };
+    for ( uint8_t i = 0; i < n; ++i )
+    {
+        coeffs[ terms[i] ] = m[i][n];
+    }
+
+    // Complete the squares:  a ( x - x0 )^2 + ... = g
+    float center[3];
+    float g = 1;
+    for ( uint8_t k = 0; k < nbrAxes; ++k )
+    {
+        if ( coeffs[k] <= 0 )
+        {
+            return false;
+        }
+        center[k] = -coeffs[k + 3] / ( 2 * coeffs[k] );
+        g += coeffs[k] * center[k] * center[k];
+    }
+    if ( g <= 0 )
+    {
+        return false;
+    }
+
+    float radius[3];
+    for ( uint8_t k = 0; k < nbrAxes; ++k )
+    {
+        radius[k] = sqrt( g / coeffs[k] );
+    }
+
+    // Radii become scale factors relative to the reference; with only x and y
+    // fitted, their mean is kept so that they stay in proportion to z
+    float factor[3];
+    if ( fitZ )
+    {
+        for ( uint8_t k = 0; k < 3; ++k )
+        {
+            factor[k] = 1 / radius[k];
+        }
+    }
+    else
+    {
+        float mean = sqrt( radius[0] * radius[1] );
+        factor[0] = mean / radius[0];
+        factor[1] = mean / radius[1];
+        factor[2] = 1;
+        center[2] = 0;
+    }
+
+    calibration->offset.x = mReference.offset.x + center[0] / mReference.scale.x;
+    calibration->offset.y = mReference.offset.y + center[1] / mReference.scale.y;
+    calibration->offset.z = mReference.offset.z + center[2] / mReference.scale.z;
+    calibration->scale.x = mReference.scale.x * factor[0];
+    calibration->scale.y = mReference.scale.y * factor[1];
+    calibration->scale.z = mReference.scale.z * factor[2];
+
+    return true;
+}
+
+
+
+bool MagCalibrator::loadCalibration()
+{
+    StoredCalibration stored;
+    eeprom_read_block( &stored, &mEepromCalibration, sizeof( stored ) );
+
+    // Erased (or never written) EEPROM won't have the signature
+    if ( stored.signature != kSignature
+            || stored.checksum != computeChecksum( &stored.calibration, sizeof( stored.calibration ), kSignature ) )
+    {
+        return false;
+    }
+
+    LSM303DLHC::setMagnetometerCalibration( stored.calibration );
+    return true;
+}
+
+
+
+void MagCalibrator::saveCalibration( const LSM303DLHC::MagCalibration& calibration )
+{
+    LSM303DLHC::setMagnetometerCalibration( calibration );
+
+    StoredCalibration stored;
+    stored.signature = kSignature;
+    stored.calibration = calibration;
+    stored.checksum = computeChecksum( &calibration, sizeof( calibration ), kSignature );
+
+    eeprom_update_block( &stored, &mEepromCalibration, sizeof( stored ) );
+}
+
+
+
+
+uint8_t MagCalibrator::triangleIndex( uint8_t i, uint8_t j )
+{
+    if ( i > j )
+    {
+        uint8_t t = i;
+        i = j;
+        j = t;
+    }
+
+    // Rows before i hold kNbrTerms, kNbrTerms - 1, ... entries
+    return i * kNbrTerms - i * ( i - 1 ) / 2 + ( j - i );
+}
+
+
+
+bool MagCalibrator::solve( float m[kNbrTerms][kNbrTerms + 1], uint8_t n )
+{
+    // Gaussian elimination with partial pivoting; the solution ends up in column n
+
+    for ( uint8_t col = 0; col < n; ++col )
+    {
+        uint8_t pivot = col;
+        for ( uint8_t row = col + 1; row < n; ++row )
+        {
+            if ( fabs( m[row][col] ) > fabs( m[pivot][col] ) )
+            {
+                pivot = row;
+            }
+        }
+
+        if ( fabs( m[pivot][col] ) < kSmallestPivot * mNbrReadings )
+        {
+            return false;
+        }
+
+        if ( pivot != col )
+        {
+            for ( uint8_t j = col; j <= n; ++j )
+            {
+                float t = m[col][j];
+                m[col][j] = m[pivot][j];
+                m[pivot][j] = t;
+            }
+        }
+
+        for ( uint8_t row = 0; row < n; ++row )
+        {
+            if ( row != col )
+            {
+                float f = m[row][col] / m[col][col];
+                for ( uint8_t j = col; j <= n; ++j )
+                {
+                    m[row][j] -= f * m[col][j];
+                }
+            }
+        }
+    }
+
+    for ( uint8_t row = 0; row < n; ++row )
+    {
+        m[row][n] /= m[row][row];
+    }
+
+    return true;
+}
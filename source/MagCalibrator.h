@@ -0,0 +1,75 @@
+/*
+    MagCalibrator.h - Fits the magnetometer's hard and soft iron calibration
+    to readings taken while CARRT turns, and keeps it in EEPROM.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef MagCalibrator_h
+#define MagCalibrator_h
+
+#include <stdint.h>
+
+#include "Drivers/LSM303DLHC.h"
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * Iron near the sensor shifts (hard iron) and stretches (soft iron) the
+ * field it sees, so that turning traces an ellipsoid rather than a sphere
+ * centered on zero.  The calibrator fits an axis-aligned ellipsoid,
+ *
+ *   a x^2 + b y^2 + c z^2 + d x + e y + f z = 1,
+ *
+ * by least squares, keeping only the sums of the normal equations (27
+ * floats) as readings come in.  Readings are first put through the current
+ * calibration, which keeps those sums well scaled in single precision.
+ *
+ * Turning on the floor hardly changes z, which then can't be fitted; in that
+ * case only the ellipse in x and y is fitted and z keeps its calibration.
+ */
+
+namespace MagCalibrator
+{
+
+    // Start a new fit
+    void start();
+
+    void addReading( const Vector3Int& magRaw );
+
+    // Whether the readings so far go all the way around (and there are enough of them)
+    bool isComplete();
+
+    uint8_t nbrReadings();
+
+    // Fit the readings; false if they don't make an ellipse
+    bool fit( LSM303DLHC::MagCalibration* calibration );
+
+
+    // Set the magnetometer to the calibration in EEPROM; false if there is none
+    bool loadCalibration();
+
+    // Set the magnetometer to this calibration, and store it in EEPROM
+    void saveCalibration( const LSM303DLHC::MagCalibration& calibration );
+
+};
+
+
+#endif
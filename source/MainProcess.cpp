@@ -23,16 +23,32 @@
 
 #include "MainProcess.h"
 
+#include <string.h>
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
 #include "AVRTools/SystemClock.h"
 #include "AVRTools/MemUtils.h"
 
 #include "ErrorCodes.h"
 #include "ErrorState.h"
+#include "EventClock.h"
 #include "EventManager.h"
+#include "ImuSampler.h"
 #include "Navigator.h"
 #include "State.h"
+#include "TimerService.h"
 #include "WelcomeMenuStates.h"
 
+#if CARRT_ENABLE_EVENT_PROFILING
+#include "EventProfiler.h"
+#endif
+
+#if CARRT_ENABLE_TRACE_RECORDER
+#include "TraceRecorder.h"
+#endif
+
 #include "Drivers/Battery.h"
 #include "Drivers/Keypad.h"
 #include "Drivers/Motors.h"
@@ -60,6 +76,12 @@ namespace
 #endif
 
 
+// Put the CPU in idle sleep when the event loop has nothing to do
+#ifndef CARRT_ENABLE_IDLE_SLEEP
+#define CARRT_ENABLE_IDLE_SLEEP     1
+#endif
+
+
 
 
 // Expand the namespace with some additional functionality private to this module
@@ -69,13 +91,26 @@ namespace MainProcess
     void checkForErrors();
     void processEvent();
     bool checkForUserInputs();
+    void idleUntilInterrupt();
+    bool areEventsPending();
     void prepReset();
+    bool dispatchToState( uint8_t eventCode, int16_t eventParam );
     bool handleRequiredSystemEvents( uint8_t event, int parameter );
+    void doNavUpdate();
     void handleOptionalSystemEvents( uint8_t event, int parameter );
 
     State*          mState;
     ErrorState*     mErrorState;
     bool            mNotPaused;
+
+    LoopStats       mLoopStats;
+    unsigned long   mNextKeypadPollTime;
+
+    bool            mNavUpdatesStarted;
+    uint32_t        mLastNavTick;
+    uint32_t        mLastNavUpdateMs;
+
+    const unsigned int kKeypadPollInterval = 50;        // milliseconds
 };
 
 
@@ -89,6 +124,16 @@ void MainProcess::init( ErrorState* errorState )
 
     mNotPaused = true;
 
+    resetLoopStats();
+    mNextKeypadPollTime = 0;
+    mNavUpdatesStarted = false;
+
+#if CARRT_ENABLE_EVENT_PROFILING
+    EventProfiler::reset();
+#endif
+
+    set_sleep_mode( SLEEP_MODE_IDLE );
+
     // Error state is special -- we hold it here for the duration
     // Low on memory is one of the error states, so we don't want to have to create
     // an error state on the fly
@@ -102,6 +147,12 @@ void MainProcess::init( ErrorState* errorState )
         mState = mErrorState;
     }
 
+#if CARRT_ENABLE_TRACE_RECORDER
+    // The trace carries on across resets, so mark where this run starts
+    TraceRecorder::record( TraceRecorder::kTraceReset, 0 );
+    TraceRecorder::recordStateChange( mState );
+#endif
+
     mState->onEntry();
 }
 
@@ -130,19 +181,108 @@ void MainProcess::runEventLoop()
 
     while ( 1 )
     {
+        ++mLoopStats.loopIterations;
+
         checkForErrors();
+
+        // Keep the background navigation sensor reads moving
+        ImuSampler::poll();
+
         processEvent();
-        if ( checkForUserInputs() )
+
+        // Reading the keypad is a slow I2C transaction, so poll it periodically
+        // (not every time around the loop)
+        if ( millis() >= mNextKeypadPollTime )
         {
-            // Reset triggered -- get out of the event loop
-            break;
+            mNextKeypadPollTime = millis() + kKeypadPollInterval;
+            ++mLoopStats.keypadPolls;
+
+            if ( checkForUserInputs() )
+            {
+                // Reset triggered -- get out of the event loop
+                break;
+            }
         }
+
+        idleUntilInterrupt();
     }
 }
 
 
 
 
+void MainProcess::idleUntilInterrupt()
+{
+#if CARRT_ENABLE_IDLE_SLEEP
+
+    // Software timers only expire on a loop iteration, and the system clock interrupts
+    // every millisecond, so sleeping until the next interrupt never delays a timer
+    // by more than that.
+
+    unsigned long start = micros();
+
+    // Check for events with interrupts off:  if an interrupt queues an event after
+    // the check, it can't fire until sleep begins (sei() takes effect after the
+    // following instruction) and so will wake us right back up.
+    cli();
+    if ( areEventsPending() )
+    {
+        sei();
+        return;
+    }
+
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    // Woken by an interrupt (which has already run)
+    ++mLoopStats.nbrSleeps;
+    mLoopStats.sleepMicroseconds += micros() - start;
+
+    if ( areEventsPending() )
+    {
+        ++mLoopStats.wakesForEvent;
+    }
+    else if ( millis() >= mNextKeypadPollTime )
+    {
+        ++mLoopStats.wakesForKeypadPoll;
+    }
+    else
+    {
+        ++mLoopStats.wakesOther;
+    }
+
+#endif
+}
+
+
+
+
+bool MainProcess::areEventsPending()
+{
+    return !EventManager::areEventQueuesEmpty() || EventManager::hasEventQueueOverflowed() || ImuSampler::isPollNeeded();
+}
+
+
+
+
+const MainProcess::LoopStats& MainProcess::getLoopStats()
+{
+    return mLoopStats;
+}
+
+
+
+
+void MainProcess::resetLoopStats()
+{
+    memset( &mLoopStats, 0, sizeof( mLoopStats ) );
+}
+
+
+
+
 bool MainProcess::checkForUserInputs()
 {
     const int kMinTimeBetweenButtonChecks = 250;        // milliseconds
@@ -209,24 +349,60 @@ void MainProcess::processEvent()
     uint8_t eventCode;
     int16_t eventParam;
 
+    // Post events for any timers that have expired
+    TimerService::advanceTo( EventClock::getMilliseconds() );
+
     if ( EventManager::getNextEvent( &eventCode, &eventParam ) )
     {
+#if CARRT_ENABLE_EVENT_PROFILING
+        uint16_t dispatchStart = EventProfiler::timestamp();
+        EventProfiler::recordLatency( eventCode, EventManager::getLastEventEnqueueTime(), dispatchStart );
+#endif
+
         // We have an event to process -- start with required system events
         if ( handleRequiredSystemEvents( eventCode, eventParam ) )
         {
             //  If returned true, (and not paused) give the current state a chance at the event
-            if ( mNotPaused && mState->onEvent( eventCode, eventParam ) )
+            if ( mNotPaused && dispatchToState( eventCode, eventParam ) )
             {
                 // If the state returned true, pass the event back to the system
                 handleOptionalSystemEvents( eventCode, eventParam );
             }
         }
+
+#if CARRT_ENABLE_EVENT_PROFILING
+        EventProfiler::recordDispatch( eventCode, dispatchStart, EventProfiler::timestamp() );
+#endif
     }
 }
 
 
 
 
+bool MainProcess::dispatchToState( uint8_t eventCode, int16_t eventParam )
+{
+#if CARRT_ENABLE_EVENT_PROFILING
+
+    // Identify the state first: onEvent() may change state, deleting this one
+    uint16_t stateKey = getStateClassKey( mState );
+    uint16_t start = EventProfiler::timestamp();
+
+    bool passBack = mState->onEvent( eventCode, eventParam );
+
+    EventProfiler::recordStateHandler( stateKey, start, EventProfiler::timestamp() );
+
+    return passBack;
+
+#else
+
+    return mState->onEvent( eventCode, eventParam );
+
+#endif
+}
+
+
+
+
 void MainProcess::checkForErrors()
 {
     if ( MemUtils::freeMemoryBetweenHeapAndStack() < CARRT_MIN_MEMORY )
@@ -256,6 +432,8 @@ void MainProcess::yieldMilliseconds( uint16_t millisecs )
 
     while ( millis() < endTime )
     {
+        ImuSampler::poll();
+
         if ( EventManager::getNextEvent( &eventCode, &eventParam ) )
         {
             // We have an event to process -- start with required system events
@@ -285,6 +463,9 @@ void MainProcess::changeState( State* newState )
         // Design relies on states to delete themselves (if appropriate)
         mState->onExit();
         mState = newState;
+#if CARRT_ENABLE_TRACE_RECORDER
+        TraceRecorder::recordStateChange( mState );
+#endif
         mState->onEntry();
     }
 }
@@ -296,13 +477,19 @@ bool MainProcess::handleRequiredSystemEvents( uint8_t eventCode, int eventParam
 {
     if ( eventCode == EventManager::kNavUpdateEvent )
     {
-        Navigator::doNavUpdate();
+        doNavUpdate();
+        return false;
+    }
+
+    if ( eventCode == EventManager::kNavSampleReadyEvent )
+    {
+        Navigator::doNavSampleReady( eventParam );
         return false;
     }
 
     if ( eventCode == EventManager::kNavDriftCorrectionEvent )
     {
-        // gNavigator.doDriftCorrection();
+        // Nothing to do:  the heading filter tracks gyro drift (see HeadingFilter.h)
         return false;
     }
 
@@ -318,6 +505,50 @@ bool MainProcess::handleRequiredSystemEvents( uint8_t eventCode, int eventParam
 
 
 
+void MainProcess::doNavUpdate()
+{
+    // The clock's interrupt handler counts each tick as it happens, so the latest tick
+    // tells how late this update is, and how many ticks passed with no update at all
+    // (nav update events are coalesced, so a loop that falls behind just loses them)
+
+    uint32_t tick = EventClock::getTicks();
+    uint32_t nowMs = EventClock::getMilliseconds();
+
+    uint32_t latenessMs = nowMs - EventClock::getTickMilliseconds( tick );
+    if ( latenessMs > mLoopStats.maxNavLatenessMs )
+    {
+        mLoopStats.maxNavLatenessMs = ( latenessMs < 0xFFFF ) ? latenessMs : 0xFFFF;
+    }
+
+    // Integrate over the time actually elapsed since the last update
+    float timeStep = EventClock::kSecondsPerTick;
+
+    if ( mNavUpdatesStarted )
+    {
+        timeStep = ( nowMs - mLastNavUpdateMs ) / 1000.0;
+
+        uint32_t ticksMissed = tick - mLastNavTick;
+        if ( ticksMissed > 1 )
+        {
+            --ticksMissed;
+            mLoopStats.navDeadlinesMissed += ticksMissed;
+#if CARRT_ENABLE_TRACE_RECORDER
+            TraceRecorder::record( TraceRecorder::kTraceNavDeadlineMiss, ( ticksMissed < 0x7FFF ) ? ticksMissed : 0x7FFF );
+#endif
+        }
+    }
+
+    mNavUpdatesStarted = true;
+    mLastNavTick = tick;
+    mLastNavUpdateMs = nowMs;
+    ++mLoopStats.navUpdates;
+
+    Navigator::doNavUpdate( timeStep );
+}
+
+
+
+
 void MainProcess::handleOptionalSystemEvents( uint8_t eventCode, int parameter )
 {
     if ( eventCode == EventManager::kEightSecondTimerEvent )
@@ -335,7 +566,7 @@ void MainProcess::handleOptionalSystemEvents( uint8_t eventCode, int parameter )
 
 void MainProcess::postErrorEvent( int errorCode )
 {
-    EventManager::queueEvent( EventManager::kErrorEvent, errorCode, EventManager::kHighPriority );
+    EventManager::queueEvent( EventManager::kErrorEvent, errorCode );
 }
 
 
@@ -343,6 +574,10 @@ void MainProcess::postErrorEvent( int errorCode )
 
 void MainProcess::setErrorState( int errorCode )
 {
+#if CARRT_ENABLE_TRACE_RECORDER
+    TraceRecorder::record( TraceRecorder::kTraceError, errorCode );
+#endif
+
     mErrorState->setErrorCode( errorCode );
     changeState( mErrorState );
 }
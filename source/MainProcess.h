@@ -34,6 +34,24 @@ class ErrorState;
 
 namespace MainProcess
 {
+    // Event loop counters, to quantify the effect of idle sleep on power and latency
+    struct LoopStats
+    {
+        uint32_t    loopIterations;
+        uint32_t    keypadPolls;
+        uint32_t    nbrSleeps;
+        uint32_t    sleepMicroseconds;
+        uint32_t    wakesForEvent;          // an interrupt queued an event
+        uint32_t    wakesForKeypadPoll;     // time to poll the keypad
+        uint32_t    wakesOther;             // any other interrupt (e.g., the system clock)
+
+        // Navigation update deadlines:  each EventClock tick's update is due before
+        // the next tick, and a tick that passes with no update is a miss
+        uint32_t    navUpdates;
+        uint32_t    navDeadlinesMissed;
+        uint16_t    maxNavLatenessMs;       // longest from a tick to its update
+    };
+
     void init( ErrorState* errorState );
     void yieldMilliseconds( uint16_t milliseconds );
     void runEventLoop();
@@ -41,6 +59,8 @@ namespace MainProcess
     void postErrorEvent( int errorCode );
     void setErrorState( int errorCode );
     State* getErrorState( int errorCode );
+    const LoopStats& getLoopStats();
+    void resetLoopStats();
 };
 
 
@@ -0,0 +1,250 @@
+/*
+    MappingScan.cpp - Mapping scans for CARRT's Goto Drive:  sweep the lidar
+    across the scene without stopping, and put each range reading on the
+    NavigationMap as it comes in.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#if CARRT_INCLUDE_GOTODRIVE_IN_BUILD
+
+
+
+#include "MappingScan.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "AVRTools/SystemClock.h"
+
+#include "Drivers/Lidar.h"
+
+#include "NavigationMap.h"
+#include "Navigator.h"
+#include "PoseSnapshot.h"
+
+
+
+
+namespace MappingScan
+{
+
+    // Extend the namespace with functions and variables used internally in this module
+
+    const float     kDegreesToRadians           = 3.1415926536 / 180.0;
+
+    // How fast the lidar sweeps; at about 100 readings a second, that's a reading every
+    // 0.6 degrees (a stepped scan read every 2)
+    const float     kSweepDegreesPerSec         = 60.0;
+    const float     kSweepDegreesPerMicro       = kSweepDegreesPerSec / 1000000.0;
+
+    // How long the servo takes to point where it is told:  on average half a pulse (at 60 Hz)
+    // before it sees a new command, and then a few ms to move there
+    const int32_t   kServoLagMicros             = 12000;
+
+    // The lidar's receiver bias needs correcting from time to time, not every reading
+    const uint8_t   kReadingsPerBiasCorrection  = 100;
+
+
+    int         mFromAngle;
+    int         mToAngle;
+    int         mCommandedAngle;
+    uint32_t    mStartMicros;
+    int32_t     mSweepMicros;
+    uint8_t     mNbrReadings;
+    bool        mDone;
+
+    Reading     mLastReading = { 0, -1, 0 };
+
+
+    int roundToInt( float x )
+    { return static_cast<int>( x >= 0 ? x + 0.5 : x - 0.5 ); }
+
+    float getRampAngle( int32_t elapsedMicros );
+    void steer( uint32_t now );
+};
+
+
+
+
+void MappingScan::addToMap( const Reading& reading )
+{
+    float rad = reading.angle * kDegreesToRadians;
+    float cosine = cos( rad );
+    float sine = sin( rad );
+
+    // Where CARRT was when the range was read (the current pose if that isn't known)
+    PoseSnapshot pose;
+    if ( !Navigator::getPoseAt( reading.micros, &pose ) )
+    {
+        pose = Navigator::getPoseSnapshot();
+    }
+
+    // First mark as clear everything between CARRT and the lidar obstacle, stopping a grid
+    // cell short of it:  a ray that meets a wall at a shallow angle runs alongside it through
+    // the last cell or so, and would otherwise clear what the neighboring rays found
+    const int cmPerGrid = NavigationMap::getLocalMap().cmPerGrid();
+    const int rngStepSize = cmPerGrid / 4;
+    for ( int r = rngStepSize; r < reading.range - cmPerGrid; r += rngStepSize )
+    {
+        // Get relative coords
+        float xRel = static_cast<float>( r ) * cosine;
+        // Extra negative here because using compass headings instead of mathematical angles
+        // math_angle = 360 - compass_angle, which puts a negative on sin()
+        float yRel = -static_cast<float>( r ) * sine;
+
+        // Convert relative coordinates to absolute and mark as clear on map
+        Vector2Float coordsGlobal = pose.toAbsolute( xRel, yRel );
+        NavigationMap::markClear( roundToInt( coordsGlobal.x ), roundToInt( coordsGlobal.y ) );
+    }
+
+    // Now mark the obstacle
+    float xRel = static_cast<float>( reading.range ) * cosine;
+    // Extra negative here because using compass headings instead of mathematical angles
+    // math_angle = 360 - compass_angle, which puts a negative on sin()
+    float yRel = -static_cast<float>( reading.range ) * sine;
+
+    // Convert relative coordinates to absolute and mark as obstacle on map
+    Vector2Float coordsGlobal = pose.toAbsolute( xRel, yRel );
+    NavigationMap::markObstacle( roundToInt( coordsGlobal.x ), roundToInt( coordsGlobal.y ) );
+}
+
+
+
+
+void MappingScan::startSweep( int fromAngle, int toAngle )
+{
+    // Fewer acquisitions per reading (plenty at indoor ranges)
+    Lidar::setConfiguration( Lidar::kShortRangeAndHighestSpeed );
+
+    mFromAngle = fromAngle;
+    mToAngle = toAngle;
+    mCommandedAngle = fromAngle;
+    mSweepMicros = static_cast<int32_t>( abs( toAngle - fromAngle ) / kSweepDegreesPerMicro );
+    mNbrReadings = 0;
+    mDone = false;
+
+    mLastReading.angle = fromAngle;
+    mLastReading.range = -1;
+
+    mStartMicros = micros();
+}
+
+
+
+uint16_t MappingScan::continueSweep( uint16_t budgetMs )
+{
+    uint16_t nbrReadings = 0;
+
+    uint32_t start = micros();
+    uint32_t budget = budgetMs * 1000UL;
+
+    while ( !mDone && micros() - start < budget )
+    {
+        steer( micros() );
+
+        Reading reading;
+        uint32_t before = micros();
+        int err = Lidar::getDistanceInCm( &reading.range, mNbrReadings == 0 );
+        uint32_t after = micros();
+
+        if ( ++mNbrReadings == kReadingsPerBiasCorrection )
+        {
+            mNbrReadings = 0;
+        }
+
+        // Take the range as read half way through the reading
+        reading.micros = before + ( after - before ) / 2;
+        reading.angle = getSweepAngleAt( reading.micros );
+
+        if ( !err && reading.range != Lidar::kNoValidDistance )
+        {
+            addToMap( reading );
+            mLastReading = reading;
+        }
+        ++nbrReadings;
+
+        // Done once the lidar has got to the end
+        mDone = static_cast<int32_t>( after - mStartMicros ) >= mSweepMicros + kServoLagMicros;
+    }
+
+    return nbrReadings;
+}
+
+
+
+bool MappingScan::isSweepDone()
+{
+    return mDone;
+}
+
+
+
+void MappingScan::endSweep()
+{
+    Lidar::setConfiguration( Lidar::kDefault );
+}
+
+
+
+float MappingScan::getSweepAngleAt( uint32_t t )
+{
+    return getRampAngle( static_cast<int32_t>( t - mStartMicros ) - kServoLagMicros );
+}
+
+
+
+const MappingScan::Reading& MappingScan::getLastReading()
+{
+    return mLastReading;
+}
+
+
+
+
+float MappingScan::getRampAngle( int32_t elapsedMicros )
+{
+    if ( elapsedMicros <= 0 )
+    {
+        return mFromAngle;
+    }
+    if ( elapsedMicros >= mSweepMicros )
+    {
+        return mToAngle;
+    }
+
+    float degrees = elapsedMicros * kSweepDegreesPerMicro;
+    return mToAngle > mFromAngle ? mFromAngle + degrees : mFromAngle - degrees;
+}
+
+
+
+void MappingScan::steer( uint32_t now )
+{
+    // Command the servo to the nearest degree to the ramp (so, on average, it is on the ramp)
+    int angle = roundToInt( getRampAngle( static_cast<int32_t>( now - mStartMicros ) ) );
+
+    if ( angle != mCommandedAngle )
+    {
+        Lidar::slew( angle );
+        mCommandedAngle = angle;
+    }
+}
+
+
+#endif  // CARRT_INCLUDE_GOTODRIVE_IN_BUILD
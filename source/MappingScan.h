@@ -0,0 +1,95 @@
+/*
+    MappingScan.h - Mapping scans for CARRT's Goto Drive:  sweep the lidar
+    across the scene without stopping, and put each range reading on the
+    NavigationMap as it comes in.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#if CARRT_INCLUDE_GOTODRIVE_IN_BUILD
+
+
+
+#ifndef MappingScan_h
+#define MappingScan_h
+
+#include <stdint.h>
+
+
+
+/*
+ * Stepping the lidar a couple of degrees at a time, and waiting for the
+ * servo to settle before each (median) reading, takes over 40 seconds for
+ * a scan.  Instead, the sweep keeps the servo moving at a steady rate from
+ * one side to the other, with the lidar set for its fastest readings, and
+ * takes readings back to back the whole way.
+ *
+ * The servo is commanded along a ramp (one degree at a time, as the ramp
+ * passes each), so where it points at any moment is known from the time:
+ * each reading gets the angle of the ramp at the middle of the reading,
+ * less the servo's lag (a new command takes effect at the servo's next
+ * 60 Hz pulse, and the servo takes a little longer to get there).  Each
+ * reading goes on the map right away, placed from CARRT's pose at the time
+ * (see Navigator::getPoseAt()), so nothing needs to be stored.
+ *
+ * The sweep runs in slices (continueSweep()), so a state can give the event
+ * loop a turn between them.
+ */
+
+namespace MappingScan
+{
+
+    // A range reading and where the lidar pointed when it was taken
+    struct Reading
+    {
+        float       angle;          // degrees right of straight ahead
+        int         range;          // cm
+        uint32_t    micros;         // when (from micros())
+    };
+
+
+    // Mark the map clear along the reading's line of sight, and an obstacle where it ends
+    void addToMap( const Reading& reading );
+
+
+    // Start a sweep from fromAngle to toAngle (degrees right of straight ahead); the lidar
+    // should already be pointing at fromAngle
+    void startSweep( int fromAngle, int toAngle );
+
+    // Take readings (and map them) for about budgetMs, or until the sweep is done; returns the
+    // number of readings taken
+    uint16_t continueSweep( uint16_t budgetMs );
+
+    bool isSweepDone();
+
+    // Put the lidar back to its usual configuration (the lidar stays where the sweep ended)
+    void endSweep();
+
+    // Where the lidar pointed at a time (from micros()) during the sweep
+    float getSweepAngleAt( uint32_t micros );
+
+    // The last good reading (the range is -1 if there hasn't been one)
+    const Reading& getLastReading();
+
+};
+
+
+#endif
+
+
+#endif  // CARRT_INCLUDE_GOTODRIVE_IN_BUILD
@@ -0,0 +1,45 @@
+/*
+    NavModel.cpp - The interface the Navigator's models of motion (dead
+    reckoning, in floating or fixed point, and inertial) implement.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "NavModel.h"
+
+
+
+
+int32_t NavModel::getGyroSumZ( const ImuSampler::Sample& sample )
+{
+    // Step 1: "zero" it out -- subtract off rest-state gyro data from every reading
+    int32_t zeroedSumZ = sample.gyroSum.z - static_cast<int32_t>( mGyroZero.z ) * sample.nbrGyro;
+
+    // Step 2: Low-pass filter to ignore small noise and not treat it as rotation
+    // Limit derived from analysis of gyro noise data (applied to the average reading)
+    const int32_t kLowerLimitZ = -100;      // Negative (clockwise) rotation
+    const int32_t kUpperLimitZ =  100;      // Positive (counter-clockwise) rotation
+
+    if ( kLowerLimitZ * sample.nbrGyro < zeroedSumZ && zeroedSumZ < kUpperLimitZ * sample.nbrGyro )
+    {
+        zeroedSumZ = 0;
+    }
+
+    return zeroedSumZ;
+}
@@ -0,0 +1,88 @@
+/*
+    NavModel.h - The interface the Navigator's models of motion (dead
+    reckoning, in floating or fixed point, and inertial) implement.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef NavModel_h
+#define NavModel_h
+
+#include <stdint.h>
+
+#include "ImuSampler.h"
+#include "PoseSnapshot.h"
+
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * Each model keeps its own pose, from the samples the Navigator passes it
+ * (see Navigator.cpp, which reads the sensors and picks the model).  All of
+ * them are built in, so the model can be changed without reflashing.
+ *
+ * Positions are in meters and headings in compass degrees (see the
+ * coordinate system in Navigator.h), whatever a model keeps internally.
+ */
+
+class NavModel
+{
+public:
+
+    enum Motion { kStopped = 0, kStraightMove = 0x01, kTurnMove = 0x10 };
+
+    // Start at the origin, stopped, facing the heading of the compass reading mag (raw), with
+    // the gyro bias estimate afresh
+    virtual void init( const Vector3Int& accelZero, const Vector3Int& gyroZero, const Vector3Int& mag ) = 0;
+
+    // Back to the origin, stopped, facing mag's heading (the gyro bias estimate carries over)
+    virtual void reset( const Vector3Int& mag ) = 0;
+
+    // Take over from another model, moving as it was
+    virtual void setPose( const Vector2Float& position, const Vector2Float& velocity, float heading ) = 0;
+
+    virtual void setMotion( Motion motion ) = 0;
+
+    // Integrate a sample taken while moving
+    virtual void update( const ImuSampler::Sample& sample ) = 0;
+
+    virtual float getHeading() = 0;
+    virtual Vector2Float getPosition() = 0;
+    virtual Vector2Float getVelocity() = 0;
+    virtual Vector2Float getAcceleration() = 0;
+
+    // Position in cm (each model has its own way of getting the heading's sine and cosine)
+    virtual PoseSnapshot getPoseSnapshot() = 0;
+
+
+protected:
+
+    // The sample's sum of gyroscope z readings less the zero point, or 0 if the average
+    // is within the noise
+    int32_t getGyroSumZ( const ImuSampler::Sample& sample );
+
+    Vector3Int      mAccelerationZero;
+    Vector3Int      mGyroZero;
+
+    Motion          mMoving;
+};
+
+
+#endif
@@ -0,0 +1,210 @@
+/*
+    NavModelDR.cpp - An Dead-Reckoning Navigation model for CARRT.
+    It actually combines accelerometer, compass and gyroscope data to
+    maintain orientation and uses dead-reckoning for distance traveled.
+
+    Copyright (c) 2022 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+
+#include "NavModelDR.h"
+
+#include <math.h>
+
+#include "Utils/VectorUtils.h"
+#include "Drivers/DriveParam.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/L3GD20.h"
+
+
+
+#include "Utils/DebuggingMacros.h"
+
+
+#if CARRT_ENABLE_NAVIGATOR_DEBUG
+
+#define NAV_DEBUG_TABLE_HEADER( S )     DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )      DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )       DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )    DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_ITEM_V3( V )    DEBUG_TABLE_ITEM_V3( V )
+#define NAV_DEBUG_TABLE_END()           DEBUG_TABLE_END()
+
+#else
+
+#define NAV_DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_ITEM_V3( V )
+#define NAV_DEBUG_TABLE_END()
+
+#endif
+
+
+
+
+
+namespace
+{
+    const float kDegreesToRadians       = 3.14159265 / 180.0;
+};
+
+
+
+
+float NavModelDR::getHeading()
+{
+    return mHeading.heading;
+}
+
+
+Vector2Float NavModelDR::getPosition()
+{
+    return mCurrentPosition;
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float NavModelDR::getVelocity()
+{
+    return mCurrentVelocity;
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float NavModelDR::getAcceleration()
+{
+    return Vector2Float( 0, 0 );
+}
+
+
+PoseSnapshot NavModelDR::getPoseSnapshot()
+{
+    return PoseSnapshot( mCurrentPosition * 100.0, mHeading.heading );
+}
+
+
+
+
+
+
+
+
+void NavModelDR::init( const Vector3Int& accelZero, const Vector3Int& gyroZero, const Vector3Int& mag )
+{
+    mAccelerationZero = accelZero;
+    mGyroZero = gyroZero;
+
+    // Start clean
+    reset( mag );
+
+    // This starts the gyro bias estimate afresh
+    HeadingFilter::reset( &mHeading, mHeading.heading );
+
+    NAV_DEBUG_TABLE_HEADER( "time, label, vx, vy, sx, sy, hdg, chdg, innov, del-g, bias, dt, move" )
+}
+
+
+void NavModelDR::reset( const Vector3Int& mag )
+{
+    mCurrentVelocity.x = 0;
+    mCurrentVelocity.y = 0;
+    mCurrentPosition.x = 0;
+    mCurrentPosition.y = 0;
+
+    // Current heading estimate (the gyro bias estimate carries over)
+    mHeading.heading = LSM303DLHC::calculateHeadingFromRawData( mag, mAccelerationZero );
+    mHeading.nbrRejected = 0;
+
+    mMoving = kStopped;
+}
+
+
+void NavModelDR::setPose( const Vector2Float& position, const Vector2Float&, float heading )
+{
+    mCurrentPosition = position;
+    mHeading.heading = heading;
+    mHeading.nbrRejected = 0;
+
+    // Velocity follows from the heading
+    setMotion( mMoving );
+}
+
+
+void NavModelDR::setMotion( Motion kindOfMove )
+{
+    mMoving = kindOfMove;
+
+    if ( kindOfMove == kStraightMove )
+    {
+        // Get the components of velocity...
+        // N -> x; W -> y; compass -> radians flips direction from clockwise to counter-clockwise
+
+        float speed = DriveParam::getFullSpeedMetersPerSec();
+        mCurrentVelocity.x = speed * cos( mHeading.heading * kDegreesToRadians );           // cos(-x) == cos(x)
+        mCurrentVelocity.y = -speed * sin( mHeading.heading * kDegreesToRadians );          // sin(-x) == -sin(x)
+    }
+    else
+    {
+        // No net velocity
+        mCurrentVelocity.x = 0;
+        mCurrentVelocity.y = 0;
+    }
+}
+
+
+
+
+void NavModelDR::update( const ImuSampler::Sample& sample )
+{
+    const Vector3Int& magRaw = sample.mag;
+    const Vector3Int& accelRaw = sample.accel;
+    float timeStep = sample.timeStep;
+
+    // Blend the compass heading and gyro heading change (see HeadingFilter.h)
+    float compassHeading = LSM303DLHC::calculateHeadingFromRawData( magRaw, accelRaw );
+
+    // Degrees turned (each reading holds for one gyroscope update period)
+    float gyroHeadingChange = -L3GD20::convertRawSumToDegrees( getGyroSumZ( sample ) );
+
+    HeadingFilter::update( &mHeading, gyroHeadingChange, compassHeading, timeStep, mMoving == kTurnMove );
+
+    // How far; apply direct reconing
+    if ( mMoving == kStraightMove )
+    {
+        mCurrentPosition += ( mCurrentVelocity * timeStep );
+    }
+    else
+    {
+        // No net change in position in any other kind of kindOfMove
+    }
+
+    NAV_DEBUG_TABLE_START( "doNavUpdate" )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentVelocity )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentPosition )
+    NAV_DEBUG_TABLE_ITEM( mHeading.heading )
+    NAV_DEBUG_TABLE_ITEM( compassHeading )
+    NAV_DEBUG_TABLE_ITEM( mHeading.innovation )
+    NAV_DEBUG_TABLE_ITEM( gyroHeadingChange )
+    NAV_DEBUG_TABLE_ITEM( mHeading.bias )
+    NAV_DEBUG_TABLE_ITEM( timeStep )
+    NAV_DEBUG_TABLE_ITEM( static_cast<int>( mMoving ) )
+    NAV_DEBUG_TABLE_END()
+}
@@ -0,0 +1,62 @@
+/*
+    NavModelDR.h - The Dead-Reckoning model of motion for CARRT's Navigator.
+    It combines compass and gyroscope data to maintain orientation, and uses
+    dead-reckoning (the drive speed) for distance traveled.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef NavModelDR_h
+#define NavModelDR_h
+
+#include "HeadingFilter.h"
+#include "NavModel.h"
+
+
+
+class NavModelDR : public NavModel
+{
+public:
+
+    virtual void init( const Vector3Int& accelZero, const Vector3Int& gyroZero, const Vector3Int& mag );
+    virtual void reset( const Vector3Int& mag );
+    virtual void setPose( const Vector2Float& position, const Vector2Float& velocity, float heading );
+    virtual void setMotion( Motion motion );
+    virtual void update( const ImuSampler::Sample& sample );
+
+    virtual float getHeading();
+    virtual Vector2Float getPosition();
+    virtual Vector2Float getVelocity();
+    virtual Vector2Float getAcceleration();
+    virtual PoseSnapshot getPoseSnapshot();
+
+
+private:
+
+    // In DR model of motion, acceleration is always zero (treat as "instantaneous")
+    // Rotation handled by compass and gryo, not accelerometer.
+
+    Vector2Float    mCurrentVelocity;
+    Vector2Float    mCurrentPosition;
+
+    HeadingFilter::State    mHeading;
+};
+
+
+#endif
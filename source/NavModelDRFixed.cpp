@@ -0,0 +1,211 @@
+/*
+    NavModelDRFixed.cpp - The Dead-Reckoning Navigation model for CARRT, done
+    in fixed point (no floating point math in the navigation update).  Heading
+    is kept in centi-degrees, and position and velocity in Q16.16 meters and
+    meters per second.  See NavModelDR.cpp for the floating point version.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+
+#include "NavModelDRFixed.h"
+
+#include <math.h>
+
+#include "Utils/FixedPoint.h"
+#include "Utils/VectorUtils.h"
+#include "Drivers/DriveParam.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/L3GD20.h"
+
+
+
+#include "Utils/DebuggingMacros.h"
+
+
+#if CARRT_ENABLE_NAVIGATOR_DEBUG
+
+#define NAV_DEBUG_TABLE_HEADER( S )     DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )      DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )       DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )    DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_ITEM_V3( V )    DEBUG_TABLE_ITEM_V3( V )
+#define NAV_DEBUG_TABLE_END()           DEBUG_TABLE_END()
+
+#else
+
+#define NAV_DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_ITEM_V3( V )
+#define NAV_DEBUG_TABLE_END()
+
+#endif
+
+
+
+
+float NavModelDRFixed::getHeading()
+{
+    return mHeading.heading / 100.0;
+}
+
+
+Vector2Float NavModelDRFixed::getPosition()
+{
+    return mCurrentPosition.toFloat();
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float NavModelDRFixed::getVelocity()
+{
+    return mCurrentVelocity.toFloat();
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float NavModelDRFixed::getAcceleration()
+{
+    return Vector2Float( 0, 0 );
+}
+
+
+PoseSnapshot NavModelDRFixed::getPoseSnapshot()
+{
+    return PoseSnapshot( mCurrentPosition.toFloat() * 100.0, FixedPoint::sinCentiDegrees( mHeading.heading ),
+                         FixedPoint::cosCentiDegrees( mHeading.heading ) );
+}
+
+
+
+
+
+
+
+
+void NavModelDRFixed::init( const Vector3Int& accelZero, const Vector3Int& gyroZero, const Vector3Int& mag )
+{
+    mAccelerationZero = accelZero;
+    mGyroZero = gyroZero;
+
+    // Start clean
+    reset( mag );
+
+    // This starts the gyro bias estimate afresh
+    HeadingFilter::reset( &mHeading, mHeading.heading );
+
+    NAV_DEBUG_TABLE_HEADER( "time, label, vx, vy, sx, sy, hdg-cd, chdg-cd, innov-cd, del-g-cd, bias-q16, dt-q12, move" )
+}
+
+
+void NavModelDRFixed::reset( const Vector3Int& mag )
+{
+    mCurrentVelocity.x = 0;
+    mCurrentVelocity.y = 0;
+    mCurrentPosition.x = 0;
+    mCurrentPosition.y = 0;
+
+    // Current heading estimate (the gyro bias estimate carries over)
+    mHeading.heading = readCompassHeading( mag, mAccelerationZero );
+    mHeading.nbrRejected = 0;
+
+    mMoving = kStopped;
+}
+
+
+void NavModelDRFixed::setPose( const Vector2Float& position, const Vector2Float&, float heading )
+{
+    mCurrentPosition = Vector2Fixed( position );
+    mHeading.heading = FixedPoint::convertDegreesToCentiDegrees( heading );
+    mHeading.nbrRejected = 0;
+
+    // Velocity follows from the heading
+    setMotion( mMoving );
+}
+
+
+void NavModelDRFixed::setMotion( Motion kindOfMove )
+{
+    mMoving = kindOfMove;
+
+    if ( kindOfMove == kStraightMove )
+    {
+        // Get the components of velocity...
+        // N -> x; W -> y; compass -> radians flips direction from clockwise to counter-clockwise
+
+        int32_t speed = FixedPoint::convertToQ16( DriveParam::getFullSpeedMetersPerSec() );
+        mCurrentVelocity.x = FixedPoint::multiply( speed, FixedPoint::cosCentiDegrees( mHeading.heading ), 15 );     // cos(-x) == cos(x)
+        mCurrentVelocity.y = -FixedPoint::multiply( speed, FixedPoint::sinCentiDegrees( mHeading.heading ), 15 );    // sin(-x) == -sin(x)
+    }
+    else
+    {
+        // No net velocity
+        mCurrentVelocity.x = 0;
+        mCurrentVelocity.y = 0;
+    }
+}
+
+
+
+
+void NavModelDRFixed::update( const ImuSampler::Sample& sample )
+{
+    // Blend the compass heading and gyro heading change, in centi-degrees (see HeadingFilter.h)
+    uint16_t compassHeading = readCompassHeading( sample.mag, sample.accel );
+
+    // Centi-degrees turned (each reading holds for one gyroscope update period)
+    int16_t gyroHeadingChange = -L3GD20::convertRawSumToCentiDegrees( getGyroSumZ( sample ) );
+    int16_t timeStep = FixedPoint::convertToQ12( sample.timeStep );
+
+    HeadingFilter::update( &mHeading, gyroHeadingChange, compassHeading, timeStep, mMoving == kTurnMove );
+
+    // How far; apply direct reconing
+    if ( mMoving == kStraightMove )
+    {
+        mCurrentPosition.x += FixedPoint::multiply( mCurrentVelocity.x, timeStep, 12 );
+        mCurrentPosition.y += FixedPoint::multiply( mCurrentVelocity.y, timeStep, 12 );
+    }
+    else
+    {
+        // No net change in position in any other kind of kindOfMove
+    }
+
+    NAV_DEBUG_TABLE_START( "doNavUpdate" )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentVelocity )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentPosition )
+    NAV_DEBUG_TABLE_ITEM( mHeading.heading )
+    NAV_DEBUG_TABLE_ITEM( compassHeading )
+    NAV_DEBUG_TABLE_ITEM( mHeading.innovation )
+    NAV_DEBUG_TABLE_ITEM( gyroHeadingChange )
+    NAV_DEBUG_TABLE_ITEM( mHeading.bias )
+    NAV_DEBUG_TABLE_ITEM( timeStep )
+    NAV_DEBUG_TABLE_ITEM( static_cast<int>( mMoving ) )
+    NAV_DEBUG_TABLE_END()
+}
+
+
+
+uint16_t NavModelDRFixed::readCompassHeading( const Vector3Int& magRaw, const Vector3Int& accelRaw )
+{
+    // The tilt-compensated heading comes from the driver in floating point (one
+    // conversion per update)
+    return FixedPoint::convertDegreesToCentiDegrees( LSM303DLHC::calculateHeadingFromRawData( magRaw, accelRaw ) );
+}
@@ -0,0 +1,66 @@
+/*
+    NavModelDRFixed.h - The Dead-Reckoning model of motion for CARRT's
+    Navigator, done in fixed point (no floating point math in the navigation
+    update).  Heading is kept in centi-degrees, and position and velocity in
+    Q16.16 meters and meters per second.  See NavModelDR.h for the floating
+    point version.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef NavModelDRFixed_h
+#define NavModelDRFixed_h
+
+#include "HeadingFilter.h"
+#include "NavModel.h"
+
+
+
+class NavModelDRFixed : public NavModel
+{
+public:
+
+    virtual void init( const Vector3Int& accelZero, const Vector3Int& gyroZero, const Vector3Int& mag );
+    virtual void reset( const Vector3Int& mag );
+    virtual void setPose( const Vector2Float& position, const Vector2Float& velocity, float heading );
+    virtual void setMotion( Motion motion );
+    virtual void update( const ImuSampler::Sample& sample );
+
+    virtual float getHeading();
+    virtual Vector2Float getPosition();
+    virtual Vector2Float getVelocity();
+    virtual Vector2Float getAcceleration();
+    virtual PoseSnapshot getPoseSnapshot();
+
+
+private:
+
+    static uint16_t readCompassHeading( const Vector3Int& magRaw, const Vector3Int& accelRaw );
+
+    // In DR model of motion, acceleration is always zero (treat as "instantaneous")
+    // Rotation handled by compass and gryo, not accelerometer.
+
+    Vector2Fixed    mCurrentVelocity;           // Q16.16 m/s
+    Vector2Fixed    mCurrentPosition;           // Q16.16 m
+
+    HeadingFilter::StateFixed   mHeading;       // centi-degrees
+};
+
+
+#endif
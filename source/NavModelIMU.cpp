@@ -0,0 +1,283 @@
+/*
+    NavModelIMU.cpp - An Inertial Navigation model for CARRT
+
+    Copyright (c) 2022 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+
+
+
+#include "NavModelIMU.h"
+
+#include <math.h>
+
+#include "Utils/VectorUtils.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/L3GD20.h"
+
+
+
+#include "Utils/DebuggingMacros.h"
+
+
+#if CARRT_ENABLE_NAVIGATOR_DEBUG
+
+#define NAV_DEBUG_TABLE_HEADER( S )     DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )      DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )       DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )    DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_ITEM_V3( V )    DEBUG_TABLE_ITEM_V3( V )
+#define NAV_DEBUG_TABLE_END()           DEBUG_TABLE_END()
+
+#else
+
+#define NAV_DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_ITEM_V3( V )
+#define NAV_DEBUG_TABLE_END()
+
+#endif
+
+
+
+
+
+
+
+namespace
+{
+    const float kDegreesToRadians       = 3.14159265 / 180.0;
+};
+
+
+
+
+float NavModelIMU::getHeading()
+{
+    return mHeading.heading;
+}
+
+
+Vector2Float NavModelIMU::getPosition()
+{
+    return mCurrentPosition;
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float NavModelIMU::getVelocity()
+{
+    return mCurrentVelocity;
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float NavModelIMU::getAcceleration()
+{
+    return mCurrentAcceleration;
+}
+
+
+PoseSnapshot NavModelIMU::getPoseSnapshot()
+{
+    return PoseSnapshot( mCurrentPosition * 100.0, mHeading.heading );
+}
+
+
+
+
+
+
+
+
+void NavModelIMU::init( const Vector3Int& accelZero, const Vector3Int& gyroZero, const Vector3Int& mag )
+{
+    mAccelerationZero = accelZero;
+    mGyroZero = gyroZero;
+
+    // Start clean
+    reset( mag );
+
+    // This starts the gyro bias estimate afresh
+    HeadingFilter::reset( &mHeading, mHeading.heading );
+
+    NAV_DEBUG_TABLE_HEADER( "time, label, ax, ay, vx, vy, sx, sy, hdg, chdg, innov, del-g, bias, dt, move" )
+}
+
+
+void NavModelIMU::reset( const Vector3Int& mag )
+{
+    mCurrentAcceleration.x = 0;
+    mCurrentAcceleration.y = 0;
+    mCurrentVelocity.x = 0;
+    mCurrentVelocity.y = 0;
+    mCurrentPosition.x = 0;
+    mCurrentPosition.y = 0;
+
+    // Current heading estimate (the gyro bias estimate carries over)
+    mHeading.heading = LSM303DLHC::calculateHeadingFromRawData( mag, mAccelerationZero );
+    mHeading.nbrRejected = 0;
+
+    mMoving = kStopped;
+}
+
+
+void NavModelIMU::setPose( const Vector2Float& position, const Vector2Float& velocity, float heading )
+{
+    mCurrentAcceleration.x = 0;
+    mCurrentAcceleration.y = 0;
+    mCurrentVelocity = velocity;
+    mCurrentPosition = position;
+
+    mHeading.heading = heading;
+    mHeading.nbrRejected = 0;
+}
+
+
+void NavModelIMU::setMotion( Motion kindOfMove )
+{
+    mMoving = kindOfMove;
+
+    if ( kindOfMove == kStopped )
+    {
+        mCurrentAcceleration.x = 0;
+        mCurrentAcceleration.y = 0;
+        mCurrentVelocity.x = 0;
+        mCurrentVelocity.y = 0;
+    }
+}
+
+
+
+void NavModelIMU::update( const ImuSampler::Sample& sample )
+{
+    const Vector3Int& magRaw = sample.mag;
+    const Vector3Int& accelRaw = sample.accel;
+
+    // Blend the compass heading and gyro heading change (see HeadingFilter.h)
+    float compassHeading = LSM303DLHC::calculateHeadingFromRawData( magRaw, accelRaw );
+
+    // Degrees turned (each reading holds for one gyroscope update period)
+    float gyroHeadingChange = -L3GD20::convertRawSumToDegrees( getGyroSumZ( sample ) );
+
+    HeadingFilter::update( &mHeading, gyroHeadingChange, compassHeading, sample.timeStep, mMoving == kTurnMove );
+
+    // Compute the current N and W vectors based on heading
+    float cosHeading = cos( mHeading.heading * kDegreesToRadians );
+    float sinHeading = sin( mHeading.heading * kDegreesToRadians );
+    Vector2Float north( cosHeading, sinHeading );
+    Vector2Float west( -sinHeading, cosHeading );
+
+    // Now that we have N & W unit vectors; go ahead and integrate the accelerometer
+    // readings (zeroed and filtered) in the robot's frame, then turn the changes N & W
+    Vector2Float velocityChange, positionChange;
+    integrateAccelerationData( sample, &velocityChange, &positionChange );
+
+    Vector2Float velocityChangeNandW( velocityChange * north, velocityChange * west );
+    Vector2Float positionChangeNandW( positionChange * north, positionChange * west );
+
+    // The readings cover one accelerometer update period each
+    float accelTime = static_cast<float>( sample.nbrAccel ) / LSM303DLHC::accelerometerUpdateRate();
+
+    Vector2Float newVelocity = mCurrentVelocity + velocityChangeNandW;
+
+    // Limit the maximum speed (prevents run-away integration)
+    limitSpeed( &newVelocity );
+
+    // Update current information
+    mCurrentAcceleration    = ( sample.nbrAccel ? velocityChangeNandW / accelTime : Vector2Float( 0, 0 ) );
+    mCurrentPosition        += mCurrentVelocity * accelTime + positionChangeNandW;
+    mCurrentVelocity        = newVelocity;
+
+    NAV_DEBUG_TABLE_START( "doNavUpdate" )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentAcceleration )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentVelocity )
+    NAV_DEBUG_TABLE_ITEM_V2( mCurrentPosition )
+    NAV_DEBUG_TABLE_ITEM( mHeading.heading )
+    NAV_DEBUG_TABLE_ITEM( compassHeading )
+    NAV_DEBUG_TABLE_ITEM( mHeading.innovation )
+    NAV_DEBUG_TABLE_ITEM( gyroHeadingChange )
+    NAV_DEBUG_TABLE_ITEM( mHeading.bias )
+    NAV_DEBUG_TABLE_ITEM( sample.timeStep )
+    NAV_DEBUG_TABLE_ITEM( static_cast<int>( mMoving ) )
+    NAV_DEBUG_TABLE_END()
+}
+
+
+
+void NavModelIMU::integrateAccelerationData( const ImuSampler::Sample& sample, Vector2Float* velocityChange, Vector2Float* positionChange )
+{
+    const int32_t n = sample.nbrAccel;
+
+    // Step 1: "zero" it out -- subtract off rest-state acceleration (= gravity) from every reading
+    // (the k-th running sum holds k of them)
+    Vector3Long zeroedSum( sample.accelSum.x - mAccelerationZero.x * n,
+                           sample.accelSum.y - mAccelerationZero.y * n, 0 );
+    Vector3Long zeroedSumOfSums( sample.accelSumOfSums.x - mAccelerationZero.x * ( n * ( n + 1 ) / 2 ),
+                                 sample.accelSumOfSums.y - mAccelerationZero.y * ( n * ( n + 1 ) / 2 ), 0 );
+
+    // Step 2: Low-pass filter to ignore small noise and not treat it as acceleration
+    // (limits apply to the average reading).  Only care about x and y...
+    const int32_t kUpperLimitX = 15;
+    const int32_t kLowerLimitX = -20;
+    const int32_t kUpperLimitY = 15;
+    const int32_t kLowerLimitY = -20;
+
+    if ( kLowerLimitX * n < zeroedSum.x && zeroedSum.x < kUpperLimitX * n )
+    {
+        zeroedSum.x = 0;
+        zeroedSumOfSums.x = 0;
+    }
+
+    if ( kLowerLimitY * n < zeroedSum.y && zeroedSum.y < kUpperLimitY * n )
+    {
+        zeroedSum.y = 0;
+        zeroedSumOfSums.y = 0;
+    }
+
+    // Step 3: Integrate, each reading holding for one accelerometer update period dt.  The
+    // velocity changes by dt times the sum; by the trapezoid rule, the position (beyond what
+    // the starting velocity gives) by dt^2 times ( the sum of the running sums - half the sum ).
+    *velocityChange = LSM303DLHC::convertRawSumToXYMetersPerSec( zeroedSum );
+
+    Vector3Long twiceTrapezoidSum( 2 * zeroedSumOfSums.x - zeroedSum.x, 2 * zeroedSumOfSums.y - zeroedSum.y, 0 );
+    *positionChange = LSM303DLHC::convertRawSumToXYMetersPerSec( twiceTrapezoidSum )
+                        * ( 0.5 / LSM303DLHC::accelerometerUpdateRate() );
+}
+
+
+
+void NavModelIMU::limitSpeed( Vector2Float* v )
+{
+    // Top speed ~ 40 cm/s
+    const float kMaxSpeed = 0.40;        // m/s
+
+    float norm_v = norm( *v );
+    if ( norm_v > kMaxSpeed )
+    {
+        *v *= (kMaxSpeed/norm_v);
+    }
+}
+
+
+
+
+
@@ -75,7 +75,8 @@
 
 
 
-Map::Map( int cmPerGrid, int xCenterInCm, int yCenterInCm )
+Map::Map( int cmPerGrid, int xCenterInCm, int yCenterInCm ) :
+mVersion( 0 )
 {
     reset( cmPerGrid, xCenterInCm, yCenterInCm );
 }
@@ -100,6 +101,8 @@ void Map::reset( int cmPerGrid, int xCenterInCm, int yCenterInCm )
 void Map::erase()
 {
     memset( mMap, 0, kCarrtNavigationMapPhysicalSize );
+
+    markAllRowsDirty();
 }
 
 
@@ -121,6 +124,8 @@ void Map::setCmPerGrid( int cmPerGrid )
     // Spoil the map...
     // TODO: try to preserve parts of the map perhaps
     memset(  mMap, 0, kCarrtNavigationMapPhysicalSize );
+
+    markAllRowsDirty();
 }
 
 
@@ -152,6 +157,8 @@ bool Map::markMap( int navX, int navY, bool isObstacle )
 
     if ( getByteAndBitGridCoords( gridX, gridY, &byte, &bit ) )
     {
+        uint8_t before = mMap[ byte ];
+
         if ( isObstacle )
         {
             // Set the memory location
@@ -162,6 +169,13 @@ bool Map::markMap( int navX, int navY, bool isObstacle )
             // Clear the memory location
             mMap[ byte ] &= ~(1 << bit);
         }
+
+        // Only an actual change counts as a change
+        if ( mMap[ byte ] != before )
+        {
+            markRowDirty( gridX );
+        }
+
         return true;
     }
 
@@ -378,6 +392,12 @@ void Map::recenterMapOnNavCoords( int newNavCenterX, int newNavCenterY, int* pre
     // Adjust the origin
     mLowerLeftCornerNavX += shiftX * mCmPerGrid;
     mLowerLeftCornerNavY += shiftY * mCmPerGrid;
+
+    // Every row now holds different (shifted) content
+    if ( shiftX || shiftY )
+    {
+        markAllRowsDirty();
+    }
 }
 
 
@@ -390,6 +410,120 @@ void Map::doTotalMapShift( int shiftX, int shiftY )
 
     mLowerLeftCornerNavX += shiftX * mCmPerGrid;
     mLowerLeftCornerNavY += shiftY * mCmPerGrid;
+
+    markAllRowsDirty();
+}
+
+
+
+
+bool Map::isRowDirty( int gridX ) const
+{
+    if ( gridX < 0 || gridX >= kCarrtNavigationMapGridSizeX )
+    {
+        return false;
+    }
+
+    return mDirtyRows[ gridX / 8 ] & ( 1 << ( gridX % 8 ) );
+}
+
+
+
+
+bool Map::hasDirtyRows() const
+{
+    for ( int i = 0; i < kCarrtNavigationMapDirtyRowsSizeBytes; ++i )
+    {
+        if ( mDirtyRows[ i ] )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+
+bool Map::findDirtyRows( int fromGridX, int* firstGridX, int* lastGridX ) const
+{
+    if ( fromGridX < 0 )
+    {
+        fromGridX = 0;
+    }
+
+    int x = fromGridX;
+    while ( x < kCarrtNavigationMapGridSizeX )
+    {
+        // Skip whole clean bytes quickly
+        if ( ( x % 8 ) == 0 && !mDirtyRows[ x / 8 ] )
+        {
+            x += 8;
+            continue;
+        }
+
+        if ( isRowDirty( x ) )
+        {
+            break;
+        }
+
+        ++x;
+    }
+
+    if ( x >= kCarrtNavigationMapGridSizeX )
+    {
+        return false;
+    }
+
+    *firstGridX = x;
+    while ( x + 1 < kCarrtNavigationMapGridSizeX && isRowDirty( x + 1 ) )
+    {
+        ++x;
+    }
+    *lastGridX = x;
+
+    return true;
+}
+
+
+
+
+void Map::clearDirtyRows()
+{
+    memset( mDirtyRows, 0, kCarrtNavigationMapDirtyRowsSizeBytes );
+}
+
+
+
+
+void Map::clearDirtyRows( int firstGridX, int lastGridX )
+{
+    for ( int x = firstGridX; x <= lastGridX; ++x )
+    {
+        if ( x >= 0 && x < kCarrtNavigationMapGridSizeX )
+        {
+            mDirtyRows[ x / 8 ] &= ~( 1 << ( x % 8 ) );
+        }
+    }
+}
+
+
+
+
+void Map::markRowDirty( int gridX )
+{
+    mDirtyRows[ gridX / 8 ] |= ( 1 << ( gridX % 8 ) );
+    ++mVersion;
+}
+
+
+
+
+void Map::markAllRowsDirty()
+{
+    memset( mDirtyRows, 0xFF, kCarrtNavigationMapDirtyRowsSizeBytes );
+    ++mVersion;
 }
 
 
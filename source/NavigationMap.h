@@ -57,6 +57,7 @@
 #define kCarrtNavigationMapLogicalSize            ( kCarrtNavigationMapGridSizeX * kCarrtNavigationMapGridSizeY )
 #define kCarrtNavigationMapPhysicalSize           ( kCarrtNavigationMapLogicalSize / 8 )
 #define kCarrtNavigationMapRowSizeBytes           ( kCarrtNavigationMapGridSizeY / 8 )
+#define kCarrtNavigationMapDirtyRowsSizeBytes     ( kCarrtNavigationMapGridSizeX / 8 )
 
 
 
@@ -135,6 +136,27 @@ public:
     { return kCarrtNavigationMapPhysicalSize; }
 
 
+    // Change tracking.  The version increases every time the map contents change
+    // (any number of consumers can compare it against the version they last saw).
+    // Rows (grid X) that have changed are also flagged dirty until cleared;
+    // the dirty flags are intended for a single consumer that clears them.
+
+    uint32_t version() const
+    { return mVersion; }
+
+    bool isRowDirty( int gridX ) const;
+
+    bool hasDirtyRows() const;
+
+    // Find the next run of consecutive dirty rows at or after fromGridX;
+    // returns false if there are none
+    bool findDirtyRows( int fromGridX, int* firstGridX, int* lastGridX ) const;
+
+    void clearDirtyRows();
+
+    void clearDirtyRows( int firstGridX, int lastGridX );
+
+
 #if CARRT_ENABLE_NAVIGATION_MAP_DEBUG
 
     char* dumpToStr() const;
@@ -157,10 +179,15 @@ private:
     int mLowerLeftCornerNavX;
     int mLowerLeftCornerNavY;
 
+    uint32_t mVersion;
+
     uint8_t mMap[ kCarrtNavigationMapPhysicalSize ];
+    uint8_t mDirtyRows[ kCarrtNavigationMapDirtyRowsSizeBytes ];
 
     bool getByteAndBitGridCoords( int gridX, int gridY, int* byte, uint8_t* bit ) const;
     void doTotalMapShift( int x, int y );
+    void markRowDirty( int gridX );
+    void markAllRowsDirty();
 
 };
 
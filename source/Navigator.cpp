@@ -1,6 +1,7 @@
 /*
-    Navigator.cpp - A Navigation module for CARRT that selects the
-    appropriate Navigator implementation.
+    Navigator.cpp - The Navigation module for CARRT.  It reads the navigation
+    sensors and hands the readings to the model(s) of motion in use (see
+    NavModel.h), which can be changed at run time.
 
     Copyright (c) 2022 Igor Mikolic-Torreira.  All right reserved.
 
@@ -20,20 +21,548 @@
 
 
 
-#if CARRT_NAVIGATE_USING_INERTIAL
 
-#include "NavigatorIMU.cpp"
 
-#elif CARRT_NAVIGATE_USING_DEADRECKONING
+#include "Navigator.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <avr/eeprom.h>
+
+#include "ImuSampler.h"
+#include "NavModel.h"
+#include "NavModelDR.h"
+#include "NavModelDRFixed.h"
+#include "NavModelIMU.h"
+#include "PoseHistory.h"
+#include "SensorLog.h"
+#include "SensorZeroing.h"
+
+#include "AVRTools/SystemClock.h"
+#include "Utils/Checksum.h"
+#include "Utils/VectorUtils.h"
+#include "Drivers/LSM303DLHC.h"
+
+
+
+#include "Utils/DebuggingMacros.h"
+
+
+#if CARRT_ENABLE_NAVIGATOR_DEBUG
 
-#include "NavigatorDR.cpp"
+#define NAV_DEBUG_TABLE_HEADER( S )     DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )      DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )       DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )    DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_END()           DEBUG_TABLE_END()
 
 #else
 
+#define NAV_DEBUG_TABLE_HEADER( S )
+#define NAV_DEBUG_TABLE_START( S )
+#define NAV_DEBUG_TABLE_ITEM( X )
+#define NAV_DEBUG_TABLE_ITEM_V2( V )
+#define NAV_DEBUG_TABLE_END()
+
+#endif
+
+
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace Navigator
+{
+
+    const float kRadiansToDegrees       = 180.0 / 3.14159265;
+
+
+    // The models that run on their own index mModels
+    const uint8_t   kNbrSingleModels    = kModelInertial + 1;
+    const uint8_t   kAllSingleModels    = ( 1 << kNbrSingleModels ) - 1;
+
+    // The build options pick the model used until one is chosen from the menu
+#if CARRT_NAVIGATE_USING_INERTIAL
+    const uint8_t   kDefaultModel       = kModelInertial;
+#elif CARRT_NAVIGATE_USING_DEADRECKONING && CARRT_NAVIGATE_USING_FIXED_POINT
+    const uint8_t   kDefaultModel       = kModelDeadReckoningFixed;
+#elif CARRT_NAVIGATE_USING_DEADRECKONING
+    const uint8_t   kDefaultModel       = kModelDeadReckoning;
+#else
 #error "One of CARRT_NAVIGATE_USING_INERTIAL or CARRT_NAVIGATE_USING_DEADRECKONING must be defined."
+#endif
+
+
+    struct StoredModel
+    {
+        uint16_t        signature;
+        uint8_t         model;
+        uint16_t        checksum;
+    };
+
+    const uint16_t  kSignature          = 0x4E4D;       // "NM"
+    const uint8_t   kChecksummedSize    = offsetof( StoredModel, checksum );
+
+
+    void moving( NavModel::Motion kindOfMove );
+
+    void chooseActiveModel();
+
+    void clearDisagreement();
+    void updateDisagreement();
+
+    uint8_t loadModel();
+
+    int roundToInt( float x );
+
+
+    NavModelDR          mModelDR;
+    NavModelDRFixed     mModelDRFixed;
+    NavModelIMU         mModelIMU;
+
+    NavModel* const     mModels[ kNbrSingleModels ] = { &mModelDR, &mModelDRFixed, &mModelIMU };
+
+    uint8_t         mModel;                     // As chosen (a Model)
+    uint8_t         mActive;                    // The one reporting the pose (indexes mModels)
+    uint8_t         mInStep;                    // Bit i set if mModels[i] has the active model's pose
+
+    Vector3Int      mAccelerationZero;
+    Vector3Int      mGyroZero;
+
+    NavModel::Motion    mMoving;
+
+    PoseHistory     mPoseHistory;               // cm and degrees
+
+    Disagreement    mDisagreement[ kNbrSingleModels ];
+
+    StoredModel     mEepromModel EEMEM;
+
+};
+
+
+
+int Navigator::roundToInt( float x )
+{
+    return static_cast<int>( x >= 0 ? x + 0.5 : x - 0.5 );
+}
+
+
+float Navigator::getCurrentHeading()
+{
+    return mModels[ mActive ]->getHeading();
+}
+
+
+Vector2Float Navigator::getCurrentPosition()
+{
+    return mModels[ mActive ]->getPosition();
+}
+
+
+Vector2Float Navigator::getCurrentPositionCm()
+{
+    return mModels[ mActive ]->getPosition() * 100.0;
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float Navigator::getCurrentVelocity()
+{
+    return mModels[ mActive ]->getVelocity();
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector2Float Navigator::getCurrentAcceleration()
+{
+    return mModels[ mActive ]->getAcceleration();
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector3Int Navigator::getRestStateAcceleration()
+{
+    return mAccelerationZero;
+}
+
+
+// cppcheck-suppress unusedFunction
+Vector3Int Navigator::getRestStateAngularRate()
+{
+    return mGyroZero;
+}
+
+
+void Navigator::movingStraight()
+{
+#if CARRT_ENABLE_SENSOR_LOG
+    SensorLog::recordMotion( SensorLog::kStraight );
+#endif
+
+    moving( NavModel::kStraightMove );
+}
+
+
+void Navigator::movingTurning()
+{
+#if CARRT_ENABLE_SENSOR_LOG
+    SensorLog::recordMotion( SensorLog::kTurning );
+#endif
+
+    moving( NavModel::kTurnMove );
+}
+
+
+bool Navigator::isMoving()
+{
+    return mMoving;
+}
+
+
+
+
+
+
+
+// Forward and left are positive
+Vector2Float Navigator::convertRelativeToAbsoluteCoordsCm( int downRange, int crossRange )
+{
+    return getPoseSnapshot().toAbsolute( downRange, crossRange );
+}
+
 
+Vector2Float Navigator::convertRelativeToAbsoluteCoordsMeter( int downRange, int crossRange )
+{
+    return PoseSnapshot( getCurrentPosition(), getCurrentHeading() ).toAbsolute( downRange, crossRange );
+}
+
+
+PoseSnapshot Navigator::getPoseSnapshot()
+{
+    return mModels[ mActive ]->getPoseSnapshot();
+}
+
+
+bool Navigator::getPoseAt( uint32_t micros, PoseSnapshot* pose )
+{
+    // Stopped, there's no motion to extrapolate past the newest pose:  CARRT is still there
+    if ( !mMoving && mPoseHistory.nbrPoses()
+         && static_cast<int32_t>( micros - mPoseHistory.newestMicros() ) >= 0 )
+    {
+        *pose = getPoseSnapshot();
+        return true;
+    }
+
+    Vector2Float position;
+    float heading;
+
+    if ( !mPoseHistory.getPoseAt( micros, &position, &heading ) )
+    {
+        return false;
+    }
+
+    *pose = PoseSnapshot( position, heading );
+    return true;
+}
+
+
+
+int Navigator::convertToCompassAngle( float mathAngle )
+{
+    return ( roundToInt( 360.0 - mathAngle * kRadiansToDegrees ) + 360 ) % 360;
+}
+
+
+
+
+
+
+
+
+void Navigator::init()
+{
+    // Figure out the accelerometer and gyroscope zero points (see SensorZeroing.h)
+    SensorZeroing::ZeroPoints zero;
+    SensorZeroing::findZeroPoints( &zero );
+
+#if CARRT_ENABLE_SENSOR_LOG
+    // Everything a replay needs to start from the same place (see SensorLog.h)
+    SensorLog::recordStart( zero );
+#endif
+
+    mAccelerationZero = zero.accel;
+    mGyroZero = zero.gyro;
+
+    // Every model starts clean, so any of them can take over
+    for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+    {
+        mModels[ i ]->init( zero.accel, zero.gyro, zero.mag );
+    }
+
+    mMoving = NavModel::kStopped;
+    mPoseHistory.clear();
+
+    mInStep = kAllSingleModels;
+    clearDisagreement();
+
+    mModel = loadModel();
+    mActive = kModelDeadReckoning;
+    chooseActiveModel();
+}
+
+
+// cppcheck-suppress unusedFunction
+void Navigator::hardReset()
+{
+    init();
+}
+
+
+void Navigator::reset()
+{
+#if CARRT_ENABLE_SENSOR_LOG
+    SensorLog::recordMotion( SensorLog::kReset );
+#endif
+
+    // Get an estimate of the heading
+    Vector3Long mTmp( 0, 0, 0 );
+    for ( int i = 0; i < 16; ++i )
+    {
+        mTmp += LSM303DLHC::getMagnetometerRaw();
+    }
+    mTmp /= 16;
+    Vector3Int m( mTmp.x, mTmp.y, mTmp.z );
+
+    for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+    {
+        mModels[ i ]->reset( m );
+    }
+
+    mMoving = NavModel::kStopped;
+
+    // Where CARRT was no longer relates to where it is
+    mPoseHistory.clear();
+
+    mInStep = kAllSingleModels;
+    clearDisagreement();
+}
+
+
+void Navigator::moving( NavModel::Motion kindOfMove )
+{
+    mMoving = kindOfMove;
+
+    for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+    {
+        mModels[ i ]->setMotion( kindOfMove );
+    }
+
+    // The hybrid changes models with the kind of move
+    chooseActiveModel();
+}
+
+
+void Navigator::stopped()
+{
+#if CARRT_ENABLE_SENSOR_LOG
+    SensorLog::recordMotion( SensorLog::kStopped );
 #endif
 
+    // Time passed while stopped isn't integrated
+    ImuSampler::reset();
+
+    moving( NavModel::kStopped );
+
+    // Where CARRT stopped, so the history doesn't carry the last motion on past it
+    mPoseHistory.add( micros(), getCurrentPositionCm(), getCurrentHeading() );
+}
+
+
+
+
+void Navigator::setModel( uint8_t model )
+{
+    if ( model >= kNbrModels )
+    {
+        return;
+    }
+
+    mModel = model;
+    chooseActiveModel();
+
+    // Clear any padding, which the checksum covers
+    StoredModel stored;
+    memset( &stored, 0, sizeof( stored ) );
+    stored.signature = kSignature;
+    stored.model = model;
+    stored.checksum = computeChecksum( &stored, kChecksummedSize, kSignature );
+    eeprom_update_block( &stored, &mEepromModel, sizeof( stored ) );
+}
+
+
+uint8_t Navigator::getModel()
+{
+    return mModel;
+}
+
+
+Navigator::Disagreement Navigator::getDisagreement( uint8_t model )
+{
+    return model < kNbrSingleModels ? mDisagreement[ model ] : mDisagreement[ kModelDeadReckoning ];
+}
+
+
+uint8_t Navigator::loadModel()
+{
+    StoredModel stored;
+    eeprom_read_block( &stored, &mEepromModel, sizeof( stored ) );
+
+    if ( stored.signature == kSignature
+            && stored.checksum == computeChecksum( &stored, kChecksummedSize, kSignature )
+            && stored.model < kNbrModels )
+    {
+        return stored.model;
+    }
+
+    return kDefaultModel;
+}
+
+
+
+void Navigator::chooseActiveModel()
+{
+    uint8_t active;
+    if ( mModel < kNbrSingleModels )
+    {
+        active = mModel;
+    }
+    else if ( mModel == kModelHybrid )
+    {
+        // Dead reckoning's cheap update does well on straight drives; turns are where
+        // the inertial model earns its keep
+        active = ( mMoving == NavModel::kTurnMove ? kModelInertial : kModelDeadReckoning );
+    }
+    else
+    {
+        // Compare:  the others are measured against dead reckoning
+        active = kModelDeadReckoning;
+    }
+
+    uint8_t updated = ( mModel == kModelCompare ? kAllSingleModels : ( 1 << active ) );
+
+    // Models that fell behind pick up from the one that's been keeping the pose
+    NavModel* current = mModels[ mActive ];
+    for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+    {
+        if ( ( updated & ( 1 << i ) ) && !( mInStep & ( 1 << i ) ) )
+        {
+            mModels[ i ]->setPose( current->getPosition(), current->getVelocity(), current->getHeading() );
+            mModels[ i ]->setMotion( mMoving );
+            mInStep |= ( 1 << i );
+        }
+    }
+
+    mActive = active;
+}
+
+
+
+void Navigator::clearDisagreement()
+{
+    for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+    {
+        mDisagreement[ i ].distance = 0;
+        mDisagreement[ i ].heading = 0;
+    }
+}
+
+
+void Navigator::updateDisagreement()
+{
+    Vector2Float position = mModelDR.getPosition();
+    float heading = mModelDR.getHeading();
+
+    for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+    {
+        float distance = norm( mModels[ i ]->getPosition() - position ) * 100.0;
+
+        float headingDiff = fabs( mModels[ i ]->getHeading() - heading );
+        if ( headingDiff > 180 )
+        {
+            headingDiff = 360 - headingDiff;
+        }
+
+        if ( distance > mDisagreement[ i ].distance )
+        {
+            mDisagreement[ i ].distance = distance;
+        }
+        if ( headingDiff > mDisagreement[ i ].heading )
+        {
+            mDisagreement[ i ].heading = headingDiff;
+        }
+    }
+
+    NAV_DEBUG_TABLE_START( "navCompare" )
+    NAV_DEBUG_TABLE_ITEM_V2( position )
+    NAV_DEBUG_TABLE_ITEM( heading )
+    NAV_DEBUG_TABLE_ITEM_V2( mModelDRFixed.getPosition() )
+    NAV_DEBUG_TABLE_ITEM( mModelDRFixed.getHeading() )
+    NAV_DEBUG_TABLE_ITEM_V2( mModelIMU.getPosition() )
+    NAV_DEBUG_TABLE_ITEM( mModelIMU.getHeading() )
+    NAV_DEBUG_TABLE_END()
+}
+
+
+
+void Navigator::doNavUpdate( float timeStep )
+{
+    // Reading the sensors took 9.13 ms when done here; now they are read in
+    // the background and the readings come back with a kNavSampleReadyEvent
+
+    if ( mMoving )
+    {
+        ImuSampler::start( timeStep, micros() );
+    }
+    else
+    {
+        // Nothing to integrate, but the history still gets a pose each tick (a sample
+        // that was under way when CARRT stopped comes too late for it, see PoseHistory.h)
+        mPoseHistory.add( micros(), getCurrentPositionCm(), getCurrentHeading() );
+    }
+}
+
+
+
+void Navigator::doNavSampleReady( int16_t eventParam )
+{
+    const ImuSampler::Sample& sample = ImuSampler::getSample( eventParam );
+
+#if CARRT_ENABLE_SENSOR_LOG
+    SensorLog::recordSample( sample );
+#endif
 
+    if ( mMoving )
+    {
+        if ( mModel == kModelCompare )
+        {
+            for ( uint8_t i = 0; i < kNbrSingleModels; ++i )
+            {
+                mModels[ i ]->update( sample );
+            }
 
+            updateDisagreement();
+        }
+        else
+        {
+            // Only the active model keeps up (see chooseActiveModel())
+            mModels[ mActive ]->update( sample );
+            mInStep = ( 1 << mActive );
+        }
+    }
 
+    // Keep track of where CARRT was when (see PoseHistory.h)
+    mPoseHistory.add( sample.micros, getCurrentPositionCm(), getCurrentHeading() );
+}
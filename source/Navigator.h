@@ -25,6 +25,8 @@
 #define Navigator_h
 
 
+#include "PoseSnapshot.h"
+
 #include "Utils/VectorUtils.h"
 
 
@@ -59,11 +61,43 @@
 namespace Navigator
 {
 
+    // The models of motion (see NavModel.h).  The first few run on their own; the
+    // hybrid uses dead reckoning for straight drives and the inertial model for turns,
+    // and compare runs them all side by side, reporting dead reckoning's pose
+    enum Model
+    {
+        kModelDeadReckoning,
+        kModelDeadReckoningFixed,
+        kModelInertial,
+        kModelHybrid,
+        kModelCompare,
+
+        kNbrModels
+    };
+
+    // How far a model has strayed from dead reckoning (cm and degrees), the
+    // most since the last reset, in compare mode
+    struct Disagreement
+    {
+        float   distance;
+        float   heading;
+    };
+
     void init();
 
-    void doNavUpdate();
+    // Switch models (picking up where the current one is), and keep the choice in
+    // EEPROM for the next init()
+    void setModel( uint8_t model );
+    uint8_t getModel();
+
+    Disagreement getDisagreement( uint8_t model );
 
-    void doDriftCorrection();
+    // Start reading the sensors for an update over timeStep seconds, the time since
+    // the last update (see ImuSampler.h)
+    void doNavUpdate( float timeStep );
+
+    // Integrate the sensor readings a kNavSampleReadyEvent says are ready
+    void doNavSampleReady( int16_t eventParam );
 
     float getCurrentHeading();
 
@@ -73,6 +107,14 @@ namespace Navigator
     Vector2Float convertRelativeToAbsoluteCoordsCm( int downRange, int crossRange );
     Vector2Float convertRelativeToAbsoluteCoordsMeter( int downRange, int crossRange );
 
+    // Current position (cm) and heading, for converting many relative points at once
+    PoseSnapshot getPoseSnapshot();
+
+    // The pose at a time (from micros()) in the last couple of seconds, as getPoseSnapshot()
+    // would have had it; false if that's too long ago, or too far ahead (see PoseHistory.h).
+    // Stopped, it is the stop pose any time from the newest pose on
+    bool getPoseAt( uint32_t micros, PoseSnapshot* pose );
+
     Vector2Float getCurrentPosition();
     Vector2Float getCurrentPositionCm();
 
@@ -44,6 +44,7 @@ See http://aigamedev.com/open/tutorial/lazy-theta-star/
 #include "NavigationMap.h"
 
 #include "PathFinderMap.h"
+#include "QuadTreeMap.h"
 
 #include "ExploredList.h"
 #include "FrontierList.h"
@@ -126,15 +127,27 @@ namespace PathFinder
 
 
 
-    Path* findPathOnGrid( int startX, int startY, int goalX, int goalY, const Map& map );
+    // The search is identical on the dense grid and the quadtree map; only the
+    // map primitives in PathFinderMap differ, so the algorithm is a template
 
-    bool updateDistance( Vertex* v0, Vertex* v1, const Map& map );
+    template <class MapType> Path* findPathOnMap( int startX, int startY, int goalX, int goalY, const MapType& map );
 
-    void updateVertex( Vertex* v0, Vertex* v1, int goalX, int goalY, FrontierList* frontier, const Map& map );
+    template <class MapType> Path* findPathOnGrid( int startX, int startY, int goalX, int goalY, const MapType& map );
 
-    Path* finishedExtractPath( Vertex* v, ExploredList* el, FrontierList* fl, const Map& map );
+    template <class MapType> bool updateDistance( Vertex* v0, Vertex* v1, const MapType& map );
 
-    void checkForLineOfSightAndUpdate( Vertex* v, ExploredList* explored, const Map& map );
+    template <class MapType> void updateVertex( Vertex* v0, Vertex* v1, int goalX, int goalY, FrontierList* frontier, const MapType& map );
+
+    template <class MapType> Path* finishedExtractPath( Vertex* v, int goalX, int goalY, ExploredList* el, FrontierList* fl, const MapType& map );
+
+    template <class MapType> void checkForLineOfSightAndUpdate( Vertex* v, ExploredList* explored, const MapType& map );
+
+
+#if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG
+
+    int sNbrVerticesExpanded;
+
+#endif
 
 
 #if __AVR__
@@ -164,6 +177,41 @@ namespace PathFinder
 
 
 PathFinder::Path* PathFinder::findPath( int startX, int startY, int goalX, int goalY, const Map& map )
+{
+    return findPathOnMap( startX, startY, goalX, goalY, map );
+}
+
+
+
+
+
+
+PathFinder::Path* PathFinder::findPath( int startX, int startY, int goalX, int goalY, const QuadTreeMap& map )
+{
+    return findPathOnMap( startX, startY, goalX, goalY, map );
+}
+
+
+
+
+
+
+#if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG
+
+int PathFinder::getNbrVerticesExpanded()
+{
+    return sNbrVerticesExpanded;
+}
+
+#endif
+
+
+
+
+
+
+template <class MapType>
+PathFinder::Path* PathFinder::findPathOnMap( int startX, int startY, int goalX, int goalY, const MapType& map )
 {
     // Need to convert inputs to grid coords
     int gridStartX = map.convertToGridX( startX );
@@ -201,7 +249,8 @@ PathFinder::Path* PathFinder::findPath( int startX, int startY, int goalX, int g
 
 
 
-PathFinder::Path* PathFinder::findPathOnGrid( int startX, int startY, int goalX, int goalY, const Map& map )
+template <class MapType>
+PathFinder::Path* PathFinder::findPathOnGrid( int startX, int startY, int goalX, int goalY, const MapType& map )
 {
 
 #if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG || CARRT_ENABLE_AVR_PATHFINDER_DEBUG
@@ -236,6 +285,10 @@ PathFinder::Path* PathFinder::findPathOnGrid( int startX, int startY, int goalX,
 
     frontier.add( start );
 
+#if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG
+    sNbrVerticesExpanded = 0;
+#endif
+
     while ( !frontier.isEmpty() )
     {
 
@@ -268,11 +321,12 @@ PathFinder::Path* PathFinder::findPathOnGrid( int startX, int startY, int goalX,
         checkForLineOfSightAndUpdate( v0, &explored, map );
 
         // Are we done?
-        if ( v0->x() == goalX && v0->y() == goalY )
+        if ( isAtGoal( v0, goalX, goalY, map ) )
         {
-            Path* pathToGoal = finishedExtractPath( v0, &explored, &frontier, map );
+            Path* pathToGoal = finishedExtractPath( v0, goalX, goalY, &explored, &frontier, map );
 
 #if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG
+            std::cerr << "Vertices expanded:  " << sNbrVerticesExpanded << std::endl;
             std::cerr << "Peak explored list size:  " << maxSizeExploredList << std::endl;
             std::cerr << "Peak frontier list size:  " << maxSizeFrontierList << std::endl;
             std::cerr << "Peak combined list size:  " << maxSizeCombinedLists << std::endl;
@@ -289,7 +343,11 @@ PathFinder::Path* PathFinder::findPathOnGrid( int startX, int startY, int goalX,
         // We are exploring this vertex, so add to the explored list
         explored.add( v0 );
 
-        Point neighbors[8];
+#if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG
+        ++sNbrVerticesExpanded;
+#endif
+
+        Point neighbors[ MaxNeighbors<MapType>::kValue ];
 
         int nbrNeighbors = getNeighbors( v0, neighbors, map );
 
@@ -337,7 +395,8 @@ PathFinder::Path* PathFinder::findPathOnGrid( int startX, int startY, int goalX,
 
 
 
-void PathFinder::updateVertex( Vertex* v0, Vertex* v1, int goalX, int goalY, FrontierList* frontier, const Map& map )
+template <class MapType>
+void PathFinder::updateVertex( Vertex* v0, Vertex* v1, int goalX, int goalY, FrontierList* frontier, const MapType& map )
 {
     if ( updateDistance( v0, v1, map ) )
     {
@@ -363,7 +422,8 @@ void PathFinder::updateVertex( Vertex* v0, Vertex* v1, int goalX, int goalY, Fro
 
 
 
-bool PathFinder::updateDistance( Vertex* v0, Vertex* v1, const Map& map )
+template <class MapType>
+bool PathFinder::updateDistance( Vertex* v0, Vertex* v1, const MapType& map )
 {
     Vertex* parentV0 = v0->parent();
     if ( parentV0 )
@@ -386,7 +446,8 @@ bool PathFinder::updateDistance( Vertex* v0, Vertex* v1, const Map& map )
 
 
 
-void PathFinder::checkForLineOfSightAndUpdate( Vertex* v, ExploredList* explored, const Map& map )
+template <class MapType>
+void PathFinder::checkForLineOfSightAndUpdate( Vertex* v, ExploredList* explored, const MapType& map )
 {
     const float kBigValue = 1.0e6;
 
@@ -396,8 +457,9 @@ void PathFinder::checkForLineOfSightAndUpdate( Vertex* v, ExploredList* explored
     {
         // If we don't have line of sight, then find which of our
         // neighbors that has been explored provides the shortest path
+        // (getNeighbors() only returns neighbors in sight)
 
-        Point neighbors[8];
+        Point neighbors[ MaxNeighbors<MapType>::kValue ];
         uint8_t nbrNeighbors = getNeighbors( v, neighbors, map );
         int8_t vNearObstaclePenalty = getNearObstaclePenalty( v, map );
 
@@ -429,7 +491,8 @@ void PathFinder::checkForLineOfSightAndUpdate( Vertex* v, ExploredList* explored
 
 
 
-PathFinder::Path* PathFinder::finishedExtractPath( Vertex* v, ExploredList* el, FrontierList* fl, const Map& map )
+template <class MapType>
+PathFinder::Path* PathFinder::finishedExtractPath( Vertex* v, int goalX, int goalY, ExploredList* el, FrontierList* fl, const MapType& map )
 {
     int n = 0;
 
@@ -447,6 +510,14 @@ PathFinder::Path* PathFinder::finishedExtractPath( Vertex* v, ExploredList* el,
         doOutOfMemory( el, fl );
     }
 
+    // On a multi-resolution map the final vertex may stand for the goal's
+    // whole region, so make sure the path ends exactly at the goal
+    if ( v->x() != goalX || v->y() != goalY )
+    {
+        solution->add( goalX, goalY );
+        ++n;
+    }
+
     // Always add the final vertex
     solution->add( v->x(), v->y() );
     Vertex* vLastAdded = v;
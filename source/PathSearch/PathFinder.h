@@ -29,6 +29,7 @@
 
 
 class Map;
+class QuadTreeMap;
 
 
 namespace PathFinder
@@ -36,6 +37,15 @@ namespace PathFinder
 
     Path* findPath( int hereX, int hereY, int goalX, int goalY, const Map& map );
 
+    Path* findPath( int hereX, int hereY, int goalX, int goalY, const QuadTreeMap& map );
+
+#if CARRT_ENABLE_LINUX_PATHFINDER_DEBUG
+
+    // Number of vertices expanded by the most recent search
+    int getNbrVerticesExpanded();
+
+#endif
+
 };
 
 
@@ -43,6 +43,7 @@ http://aigamedev.com/open/tutorials/theta-star-any-angle-paths/
 #include <stdlib.h>
 
 #include "NavigationMap.h"
+#include "QuadTreeMap.h"
 
 
 
@@ -54,9 +55,18 @@ http://aigamedev.com/open/tutorials/theta-star-any-angle-paths/
 namespace PathFinder
 {
 
-    bool obstacle( int x, int y, const Map& map );
+    // The grid-level algorithms only need isThereAnObstacleGridCoords(), so
+    // they are written once and shared by the dense and quadtree maps
 
-    bool checkCellsAroundThisForObstacles( int x, int y, const Map& map );
+    template <class MapType> int8_t nearObstaclePenalty( int x, int y, const MapType& map );
+
+    template <class MapType> bool lineOfSight( int fromX, int fromY, int toX, int toY, bool withMargin, const MapType& map );
+
+    template <class MapType> bool obstacle( int x, int y, bool withMargin, const MapType& map );
+
+    template <class MapType> bool checkCellsForObstacles( int x, int y, bool withMargin, const MapType& map );
+
+    template <class MapType> bool checkCellsAroundThisForObstacles( int x, int y, const MapType& map );
 
 }
 
@@ -65,6 +75,23 @@ namespace PathFinder
 
 
 int8_t PathFinder::getNearObstaclePenalty( int x, int y, const Map& map )
+{
+    return nearObstaclePenalty( x, y, map );
+}
+
+
+
+
+int8_t PathFinder::getNearObstaclePenalty( int x, int y, const QuadTreeMap& map )
+{
+    return nearObstaclePenalty( x, y, map );
+}
+
+
+
+
+template <class MapType>
+int8_t PathFinder::nearObstaclePenalty( int x, int y, const MapType& map )
 {
     const int8_t    kFirstNeighborPenalty = 3;
     const int8_t    kSecondNeighborPenalty = 2;
@@ -139,16 +166,66 @@ uint8_t PathFinder::getNeighbors( Vertex* v, Point neighbors[], const Map& map )
 
 
 
+uint8_t PathFinder::getNeighbors( Vertex* v, Point neighbors[], const QuadTreeMap& map )
+{
+    uint8_t n = map.getNeighbors( v->x(), v->y(), neighbors, MaxNeighbors<QuadTreeMap>::kValue );
+
+    // Leaves of different sizes can touch at just a corner, and the line between their
+    // centers can then cut across an obstacle:  only keep the neighbors reached without
+    // crossing one (so, as on the grid, any neighbor is also good as a parent).  As with
+    // steps to a neighboring grid cell, this doesn't ask for a margin around obstacles.
+    uint8_t nbrInSight = 0;
+    for ( uint8_t i = 0; i < n; ++i )
+    {
+        if ( lineOfSight( v->x(), v->y(), neighbors[i].x, neighbors[i].y, false, map ) )
+        {
+            neighbors[ nbrInSight++ ] = neighbors[i];
+        }
+    }
+
+    return nbrInSight;
+}
+
+
+
+
+bool PathFinder::isAtGoal( Vertex* v, int goalX, int goalY, const QuadTreeMap& map )
+{
+    // Anywhere in the goal's leaf counts
+    return map.isSameLeaf( v->x(), v->y(), goalX, goalY );
+}
+
+
+
+
 bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map )
+{
+    return lineOfSight( v0->x(), v0->y(), v1->x(), v1->y(), true, map );
+}
+
+
+
+
+bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const QuadTreeMap& map )
+{
+    return lineOfSight( v0->x(), v0->y(), v1->x(), v1->y(), true, map );
+}
+
+
+
+
+template <class MapType>
+bool PathFinder::lineOfSight( int fromX, int fromY, int toX, int toY, bool withMargin, const MapType& map )
 {
     // Trick here is we need to check line-of-sight on a resolution twice as high
     // because our vertices are centers, not corners, and we want to drive a path
-    // that avoid corners of grid cells with obstacles.
+    // that avoid corners of grid cells with obstacles.  With a margin, the path also
+    // keeps a grid cell away from obstacles.
 
-    int x0 = 2 * v0->x();
-    int y0 = 2 * v0->y();
-    int x1 = 2 * v1->x();
-    int y1 = 2 * v1->y();
+    int x0 = 2 * fromX;
+    int y0 = 2 * fromY;
+    int x1 = 2 * toX;
+    int y1 = 2 * toY;
 
 
     int dx = x1 - x0;
@@ -179,7 +256,7 @@ bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map )
 
             if ( f >= dx )
             {
-                if ( obstacle( x0 + (sx -1)/2, y0 + (sy-1)/2, map ) )
+                if ( obstacle( x0 + (sx -1)/2, y0 + (sy-1)/2, withMargin, map ) )
                 {
                     return false;
                 }
@@ -187,12 +264,12 @@ bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map )
                 f -= dx;
             }
 
-            if ( f != 0 && obstacle( x0 + (sx-1)/2, y0 + (sy-1)/2, map ) )
+            if ( f != 0 && obstacle( x0 + (sx-1)/2, y0 + (sy-1)/2, withMargin, map ) )
             {
                 return false;
             }
 
-            if ( dy == 0 && obstacle( x0 + (sx-1)/2, y0, map ) && obstacle( x0 + (sx-1)/2, y0 - 1, map ) )
+            if ( dy == 0 && obstacle( x0 + (sx-1)/2, y0, withMargin, map ) && obstacle( x0 + (sx-1)/2, y0 - 1, withMargin, map ) )
             {
                 return false;
             }
@@ -207,7 +284,7 @@ bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map )
             f += dx;
             if ( f >= dy )
             {
-                if ( obstacle( x0 + (sx -1)/2, y0 + (sy-1)/2, map ) )
+                if ( obstacle( x0 + (sx -1)/2, y0 + (sy-1)/2, withMargin, map ) )
                 {
                     return false;
                 }
@@ -215,12 +292,12 @@ bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map )
                 f -= dy;
             }
 
-            if ( f != 0 && obstacle( x0 + (sx-1)/2, y0 + (sy-1)/2, map ) )
+            if ( f != 0 && obstacle( x0 + (sx-1)/2, y0 + (sy-1)/2, withMargin, map ) )
             {
                 return false;
             }
 
-            if ( dx == 0 && obstacle( x0, y0 + (sy-1)/2, map ) && obstacle( x0 - 1, y0 + (sy-1)/2, map ) )
+            if ( dx == 0 && obstacle( x0, y0 + (sy-1)/2, withMargin, map ) && obstacle( x0 - 1, y0 + (sy-1)/2, withMargin, map ) )
             {
                 return false;
             }
@@ -241,7 +318,8 @@ bool PathFinder::haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map )
 
 
 
-bool PathFinder::obstacle( int x, int y, const Map& map )
+template <class MapType>
+bool PathFinder::obstacle( int x, int y, bool withMargin, const MapType& map )
 {
     // Remember this function receives coordinates at double-scale
 
@@ -250,7 +328,7 @@ bool PathFinder::obstacle( int x, int y, const Map& map )
         if ( y % 2 == 0 )
         {
             // At the center of a grid cell -- check it
-            if ( checkCellsAroundThisForObstacles( x/2, y/2, map ) )
+            if ( checkCellsForObstacles( x/2, y/2, withMargin, map ) )
             {
                 return true;
             }
@@ -258,8 +336,8 @@ bool PathFinder::obstacle( int x, int y, const Map& map )
         else
         {
             // On the boundary between two grid cells -- check around both
-            if ( checkCellsAroundThisForObstacles( x/2, y/2, map )
-                || checkCellsAroundThisForObstacles( x/2, y/2 + 1, map ) )
+            if ( checkCellsForObstacles( x/2, y/2, withMargin, map )
+                || checkCellsForObstacles( x/2, y/2 + 1, withMargin, map ) )
             {
                 return true;
             }
@@ -270,8 +348,8 @@ bool PathFinder::obstacle( int x, int y, const Map& map )
         if ( y % 2 == 0 )
         {
             // On the boundary between two grid cells -- check around both
-            if ( checkCellsAroundThisForObstacles( x/2, y/2, map )
-                || checkCellsAroundThisForObstacles( x/2 + 1, y/2, map ) )
+            if ( checkCellsForObstacles( x/2, y/2, withMargin, map )
+                || checkCellsForObstacles( x/2 + 1, y/2, withMargin, map ) )
             {
                 return true;
             }
@@ -279,10 +357,10 @@ bool PathFinder::obstacle( int x, int y, const Map& map )
         else
         {
             // At the corner of 4 grid cells -- check around all of them
-            if ( checkCellsAroundThisForObstacles( x/2, y/2, map )
-                || checkCellsAroundThisForObstacles( x/2, y/2 + 1, map )
-                || checkCellsAroundThisForObstacles( x/2 + 1, y/2, map )
-                || checkCellsAroundThisForObstacles( x/2 + 1, y/2 + 1, map ) )
+            if ( checkCellsForObstacles( x/2, y/2, withMargin, map )
+                || checkCellsForObstacles( x/2, y/2 + 1, withMargin, map )
+                || checkCellsForObstacles( x/2 + 1, y/2, withMargin, map )
+                || checkCellsForObstacles( x/2 + 1, y/2 + 1, withMargin, map ) )
             {
                 return true;
             }
@@ -299,7 +377,29 @@ bool PathFinder::obstacle( int x, int y, const Map& map )
 
 
 
-bool PathFinder::checkCellsAroundThisForObstacles( int x, int y, const Map& map )
+template <class MapType>
+bool PathFinder::checkCellsForObstacles( int x, int y, bool withMargin, const MapType& map )
+{
+    if ( withMargin )
+    {
+        return checkCellsAroundThisForObstacles( x, y, map );
+    }
+
+    // Just the cell itself
+    bool obstacle;
+    bool isOnMap = map.isThereAnObstacleGridCoords( x, y, &obstacle );
+    return !isOnMap || obstacle;
+}
+
+
+
+
+
+
+
+
+template <class MapType>
+bool PathFinder::checkCellsAroundThisForObstacles( int x, int y, const MapType& map )
 {
     // Check center cell and grids immediately around it
     for ( int i = -1; i < 2; ++i )
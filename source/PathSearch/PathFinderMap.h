@@ -30,10 +30,30 @@
 
 #include <inttypes.h>
 
+#include "NavigationMap.h"
 #include "Vertex.h"
 
 
+// A quadtree leaf s cells on a side has at most 4s + 4 neighbors (every cell in the
+// ring around it).  The largest leaf that can have neighbors all around is a quarter
+// of the map on a side (a half-map leaf is on two edges of the map, for 2s + 1), so
+// no leaf has more than the grid size + 4.
+
+#ifndef kCarrtQuadTreeMapMaxNeighbors
+#define kCarrtQuadTreeMapMaxNeighbors       ( kCarrtNavigationMapGridSizeX + 4 )
+#endif
+
+#if kCarrtQuadTreeMapMaxNeighbors < kCarrtNavigationMapGridSizeX + 4
+#error "kCarrtQuadTreeMapMaxNeighbors must be at least kCarrtNavigationMapGridSizeX + 4"
+#endif
+
+#if kCarrtQuadTreeMapMaxNeighbors > 255
+#error "kCarrtQuadTreeMapMaxNeighbors must fit in a uint8_t"
+#endif
+
+
 class Map;
+class QuadTreeMap;
 
 
 namespace PathFinder
@@ -51,6 +71,17 @@ namespace PathFinder
 
 
 
+    // Largest neighbors[] array getNeighbors() needs for each kind of map
+    template <class MapType> struct MaxNeighbors;
+
+    template <> struct MaxNeighbors<Map>
+    { enum { kValue = 8 }; };
+
+    template <> struct MaxNeighbors<QuadTreeMap>
+    { enum { kValue = kCarrtQuadTreeMapMaxNeighbors }; };
+
+
+
     uint8_t getNeighbors( Vertex* v, Point neighbors[], const Map& map );
 
     bool haveLineOfSight( Vertex* v0, Vertex* v1, const Map& map );
@@ -60,6 +91,23 @@ namespace PathFinder
     inline int8_t getNearObstaclePenalty( Vertex* v, const Map& map )
     { return getNearObstaclePenalty( v->x(), v->y(), map ); }
 
+    inline bool isAtGoal( Vertex* v, int goalX, int goalY, const Map& /* map */ )
+    { return v->x() == goalX && v->y() == goalY; }
+
+
+    // Multi-resolution versions: a vertex stands for the whole quadtree leaf it is in
+
+    uint8_t getNeighbors( Vertex* v, Point neighbors[], const QuadTreeMap& map );
+
+    bool haveLineOfSight( Vertex* v0, Vertex* v1, const QuadTreeMap& map );
+
+    int8_t getNearObstaclePenalty( int x, int y, const QuadTreeMap& map );
+
+    inline int8_t getNearObstaclePenalty( Vertex* v, const QuadTreeMap& map )
+    { return getNearObstaclePenalty( v->x(), v->y(), map ); }
+
+    bool isAtGoal( Vertex* v, int goalX, int goalY, const QuadTreeMap& map );
+
 };
 
 
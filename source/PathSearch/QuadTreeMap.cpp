@@ -0,0 +1,504 @@
+/*
+    QuadTreeMap.cpp - A multi-resolution (region quadtree) navigation map
+    for use by the path finder.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#if CARRT_INCLUDE_GOTODRIVE_IN_BUILD || CARRT_INCLUDE_NAVMAP_IN_BUILD
+
+
+
+
+
+#include "QuadTreeMap.h"
+
+
+
+#if kCarrtQuadTreeMapMaxNodes >= 0xFFFE
+#error "kCarrtQuadTreeMapMaxNodes must be less than 0xFFFE"
+#endif
+
+
+
+
+/*
+
+    The tree is stored in mNodes[].  mNodes[0] is the root, covering the
+    entire kCarrtNavigationMapGridSizeX x kCarrtNavigationMapGridSizeY grid.
+
+    Each entry is one of:
+        kFreeLeaf       - the whole region is clear
+        kObstacleLeaf   - the whole region is an obstacle
+        anything else   - index of the first of four consecutive child entries
+
+    Children of a region with lower-left (x0, y0) and half-size h are ordered:
+
+        2 = ( x0,     y0 + h )      3 = ( x0 + h, y0 + h )
+        0 = ( x0,     y0     )      1 = ( x0 + h, y0     )
+
+    so the child index is ( x >= x0 + h ) | ( ( y >= y0 + h ) << 1 ).
+
+    Blocks of four children are carved sequentially out of the pool; blocks
+    released when four children merge back into a single leaf are kept on a
+    free list threaded through the first entry of each free block.
+
+*/
+
+
+
+
+QuadTreeMap::QuadTreeMap( int cmPerGrid, int xCenterInCm, int yCenterInCm )
+{
+    reset( cmPerGrid, xCenterInCm, yCenterInCm );
+}
+
+
+
+
+void QuadTreeMap::reset( int cmPerGrid, int xCenterInCm, int yCenterInCm )
+{
+    mCmPerGrid = cmPerGrid;
+    mHalfCmPerGrid = cmPerGrid / 2;
+
+    mLowerLeftCornerNavX = xCenterInCm - ( kCarrtNavigationMapGridSizeX * cmPerGrid ) / 2;
+    mLowerLeftCornerNavY = yCenterInCm  - ( kCarrtNavigationMapGridSizeY * cmPerGrid ) / 2;
+
+    erase();
+}
+
+
+
+
+void QuadTreeMap::erase()
+{
+    mNodes[0] = kFreeLeaf;
+    mNextUnused = 1;
+    mFreeBlocks = kNoBlock;
+    mOverflowed = false;
+}
+
+
+
+
+bool QuadTreeMap::build( const Map& map )
+{
+    // Adopt the geometry of the dense map
+    mCmPerGrid = map.cmPerGrid();
+    mHalfCmPerGrid = mCmPerGrid / 2;
+    mLowerLeftCornerNavX = map.minXCoord();
+    mLowerLeftCornerNavY = map.minYCoord();
+
+    erase();
+
+    // Only obstacles cause splits; everything else stays a coarse free leaf
+    for ( int x = 0; x < kCarrtNavigationMapGridSizeX; ++x )
+    {
+        for ( int y = 0; y < kCarrtNavigationMapGridSizeY; ++y )
+        {
+            bool isObstacle;
+            if ( map.isThereAnObstacleGridCoords( x, y, &isObstacle ) && isObstacle )
+            {
+                if ( !markMapGridCoords( x, y, true ) )
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+
+bool QuadTreeMap::isOnMap( int navX, int navY ) const
+{
+    int gridX = convertToGridX( navX );
+    int gridY = convertToGridY( navY );
+
+    return gridX >= 0 && gridX < kCarrtNavigationMapGridSizeX && gridY >= 0 && gridY < kCarrtNavigationMapGridSizeY;
+}
+
+
+
+
+bool QuadTreeMap::markMap( int navX, int navY, bool isObstacle )
+{
+    return markMapGridCoords( convertToGridX( navX ), convertToGridY( navY ), isObstacle );
+}
+
+
+
+
+bool QuadTreeMap::markMapGridCoords( int gridX, int gridY, bool isObstacle )
+{
+    // Check we are on the map
+    if (  gridX < 0 || gridX >= kCarrtNavigationMapGridSizeX
+        || gridY < 0 || gridY >= kCarrtNavigationMapGridSizeY )
+    {
+        return false;
+    }
+
+    const uint16_t desired = isObstacle ? kObstacleLeaf : kFreeLeaf;
+
+    // Remember the path down so we can merge on the way back up
+    uint16_t path[ kMaxDepth ];
+    uint8_t depth = 0;
+
+    uint16_t index = 0;
+    int x0 = 0;
+    int y0 = 0;
+    int size = kCarrtNavigationMapGridSizeX;
+
+    while ( 1 )
+    {
+        uint16_t node = mNodes[ index ];
+
+        if ( node == desired )
+        {
+            // Whole region already has the desired value; nothing changes
+            return true;
+        }
+
+        if ( size == 1 )
+        {
+            mNodes[ index ] = desired;
+            break;
+        }
+
+        if ( isLeaf( node ) )
+        {
+            // Split this leaf into four children with the same value
+            uint16_t block = allocateBlock();
+            if ( block == kNoBlock )
+            {
+                mOverflowed = true;
+                return false;
+            }
+
+            for ( uint8_t i = 0; i < 4; ++i )
+            {
+                mNodes[ block + i ] = node;
+            }
+            mNodes[ index ] = block;
+            node = block;
+        }
+
+        path[ depth++ ] = index;
+
+        size /= 2;
+        uint8_t child = 0;
+        if ( gridX >= x0 + size )
+        {
+            child |= 1;
+            x0 += size;
+        }
+        if ( gridY >= y0 + size )
+        {
+            child |= 2;
+            y0 += size;
+        }
+        index = node + child;
+    }
+
+    // Merge any parents whose four children are now identical leaves
+    while ( depth > 0 )
+    {
+        uint16_t parent = path[ --depth ];
+        uint16_t block = mNodes[ parent ];
+        uint16_t first = mNodes[ block ];
+
+        if ( !isLeaf( first ) || mNodes[ block + 1 ] != first || mNodes[ block + 2 ] != first || mNodes[ block + 3 ] != first )
+        {
+            break;
+        }
+
+        freeBlock( block );
+        mNodes[ parent ] = first;
+    }
+
+    return true;
+}
+
+
+
+
+bool QuadTreeMap::isThereAnObstacle( int navX, int navY, bool* isObstacle ) const
+{
+    return isThereAnObstacleGridCoords( convertToGridX( navX ), convertToGridY( navY ), isObstacle );
+}
+
+
+
+
+bool QuadTreeMap::isThereAnObstacleGridCoords( int gridX, int gridY, bool* isObstacle ) const
+{
+    // Check we are on the map
+    if (  gridX < 0 || gridX >= kCarrtNavigationMapGridSizeX
+        || gridY < 0 || gridY >= kCarrtNavigationMapGridSizeY )
+    {
+        return false;
+    }
+
+    int unusedX;
+    int unusedY;
+    int unusedSize;
+    *isObstacle = ( findLeaf( gridX, gridY, &unusedX, &unusedY, &unusedSize ) == kObstacleLeaf );
+
+    return true;
+}
+
+
+
+
+bool QuadTreeMap::getLeafGridCoords( int gridX, int gridY, int* leafX, int* leafY, int* leafSize, bool* isObstacle ) const
+{
+    // Check we are on the map
+    if (  gridX < 0 || gridX >= kCarrtNavigationMapGridSizeX
+        || gridY < 0 || gridY >= kCarrtNavigationMapGridSizeY )
+    {
+        return false;
+    }
+
+    *isObstacle = ( findLeaf( gridX, gridY, leafX, leafY, leafSize ) == kObstacleLeaf );
+
+    return true;
+}
+
+
+
+
+bool QuadTreeMap::isSameLeaf( int gridX0, int gridY0, int gridX1, int gridY1 ) const
+{
+    int x0, y0, size0;
+    int x1, y1, size1;
+    bool unused;
+
+    if ( !getLeafGridCoords( gridX0, gridY0, &x0, &y0, &size0, &unused )
+        || !getLeafGridCoords( gridX1, gridY1, &x1, &y1, &size1, &unused ) )
+    {
+        return false;
+    }
+
+    return x0 == x1 && y0 == y1 && size0 == size1;
+}
+
+
+
+
+uint8_t QuadTreeMap::getNeighbors( int gridX, int gridY, PathFinder::Point neighbors[], uint8_t maxNeighbors ) const
+{
+    int leafX;
+    int leafY;
+    int leafSize;
+    bool unused;
+
+    if ( !getLeafGridCoords( gridX, gridY, &leafX, &leafY, &leafSize, &unused ) )
+    {
+        return 0;
+    }
+
+    uint8_t n = 0;
+    int nextX;
+    int nextY;
+
+    // Walk the ring of cells just outside the leaf, jumping past each
+    // neighbor leaf once we've seen it.  Bottom and top rows include the corners.
+    for ( int x = leafX - 1; x <= leafX + leafSize; x = nextX )
+    {
+        addNeighbor( x, leafY - 1, &nextX, &nextY, neighbors, &n, maxNeighbors );
+    }
+
+    for ( int x = leafX - 1; x <= leafX + leafSize; x = nextX )
+    {
+        addNeighbor( x, leafY + leafSize, &nextX, &nextY, neighbors, &n, maxNeighbors );
+    }
+
+    // Left and right columns
+    for ( int y = leafY; y < leafY + leafSize; y = nextY )
+    {
+        addNeighbor( leafX - 1, y, &nextX, &nextY, neighbors, &n, maxNeighbors );
+    }
+
+    for ( int y = leafY; y < leafY + leafSize; y = nextY )
+    {
+        addNeighbor( leafX + leafSize, y, &nextX, &nextY, neighbors, &n, maxNeighbors );
+    }
+
+    return n;
+}
+
+
+
+
+void QuadTreeMap::addNeighbor( int gridX, int gridY, int* nextX, int* nextY, PathFinder::Point neighbors[], uint8_t* n, uint8_t maxNeighbors ) const
+{
+    int leafX;
+    int leafY;
+    int leafSize;
+    bool isObstacle;
+
+    if ( !getLeafGridCoords( gridX, gridY, &leafX, &leafY, &leafSize, &isObstacle ) )
+    {
+        // Off the map
+        *nextX = gridX + 1;
+        *nextY = gridY + 1;
+        return;
+    }
+
+    // First cells (along x and along y) beyond this leaf
+    *nextX = leafX + leafSize;
+    *nextY = leafY + leafSize;
+
+    if ( isObstacle )
+    {
+        return;
+    }
+
+    // The representative cell is the center of the leaf
+    int repX = leafX + leafSize / 2;
+    int repY = leafY + leafSize / 2;
+
+    // Corner leaves can be seen from two sides; only report once
+    for ( uint8_t i = 0; i < *n; ++i )
+    {
+        if ( neighbors[i].x == repX && neighbors[i].y == repY )
+        {
+            return;
+        }
+    }
+
+    if ( *n < maxNeighbors )
+    {
+        neighbors[ *n ].x = repX;
+        neighbors[ *n ].y = repY;
+        ++(*n);
+    }
+}
+
+
+
+
+int QuadTreeMap::nbrNodes() const
+{
+    return countNodes( 0, false );
+}
+
+
+
+
+int QuadTreeMap::nbrLeaves() const
+{
+    return countNodes( 0, true );
+}
+
+
+
+
+uint16_t QuadTreeMap::findLeaf( int gridX, int gridY, int* leafX, int* leafY, int* leafSize ) const
+{
+    int x0 = 0;
+    int y0 = 0;
+    int size = kCarrtNavigationMapGridSizeX;
+
+    uint16_t node = mNodes[0];
+
+    while ( !isLeaf( node ) )
+    {
+        size /= 2;
+        uint8_t child = 0;
+        if ( gridX >= x0 + size )
+        {
+            child |= 1;
+            x0 += size;
+        }
+        if ( gridY >= y0 + size )
+        {
+            child |= 2;
+            y0 += size;
+        }
+        node = mNodes[ node + child ];
+    }
+
+    *leafX = x0;
+    *leafY = y0;
+    *leafSize = size;
+
+    return node;
+}
+
+
+
+
+uint16_t QuadTreeMap::allocateBlock()
+{
+    // Reuse a released block first
+    if ( mFreeBlocks != kNoBlock )
+    {
+        uint16_t block = mFreeBlocks;
+        mFreeBlocks = mNodes[ block ];
+        return block;
+    }
+
+    if ( mNextUnused + 4 <= kCarrtQuadTreeMapMaxNodes )
+    {
+        uint16_t block = mNextUnused;
+        mNextUnused += 4;
+        return block;
+    }
+
+    return kNoBlock;
+}
+
+
+
+
+void QuadTreeMap::freeBlock( uint16_t block )
+{
+    mNodes[ block ] = mFreeBlocks;
+    mFreeBlocks = block;
+}
+
+
+
+
+int QuadTreeMap::countNodes( uint16_t index, bool leavesOnly ) const
+{
+    uint16_t node = mNodes[ index ];
+
+    if ( isLeaf( node ) )
+    {
+        return 1;
+    }
+
+    int count = leavesOnly ? 0 : 1;
+    for ( uint8_t i = 0; i < 4; ++i )
+    {
+        count += countNodes( node + i, leavesOnly );
+    }
+
+    return count;
+}
+
+
+
+
+#endif  // CARRT_INCLUDE_GOTODRIVE_IN_BUILD || CARRT_INCLUDE_NAVMAP_IN_BUILD
@@ -0,0 +1,203 @@
+/*
+    QuadTreeMap.h - A multi-resolution (region quadtree) navigation map
+    for use by the path finder.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#if CARRT_INCLUDE_GOTODRIVE_IN_BUILD || CARRT_INCLUDE_NAVMAP_IN_BUILD
+
+
+
+
+#ifndef QuadTreeMap_h
+#define QuadTreeMap_h
+
+#include <inttypes.h>
+
+#include "NavigationMap.h"
+
+#include "PathFinderMap.h"
+
+
+
+// The quadtree covers the same grid as Map, so it must be square
+// and a power of two on a side
+
+#if kCarrtNavigationMapGridSizeX != kCarrtNavigationMapGridSizeY
+#error "QuadTreeMap requires kCarrtNavigationMapGridSizeX == kCarrtNavigationMapGridSizeY"
+#endif
+
+#if kCarrtNavigationMapGridSizeX & ( kCarrtNavigationMapGridSizeX - 1 )
+#error "QuadTreeMap requires kCarrtNavigationMapGridSizeX to be a power of 2"
+#endif
+
+
+// Nodes are allocated four at a time (one block of children per split), plus the root.
+// Each node takes 2 bytes.  A dense grid never needs more than 4/3 of its cell count.
+
+#ifndef kCarrtQuadTreeMapMaxNodes
+#define kCarrtQuadTreeMapMaxNodes           ( 1 + 4 * 128 )
+#endif
+
+
+
+/*
+ * A region quadtree over the same grid as Map.  Uniform regions are stored as
+ * a single (coarse) leaf; regions containing obstacles are split down to single
+ * grid cells.  Nodes live in a fixed pool of 16-bit entries: a node is either
+ * a free leaf, an obstacle leaf, or the index of a block of four children.
+ *
+ * Each leaf is represented to the path finder by a single grid cell (its center),
+ * so the path finder can treat a large open leaf as a single vertex.
+ */
+
+class QuadTreeMap
+{
+public:
+
+    QuadTreeMap( int cmPerGrid, int xCenterInCm, int yCenterInCm );
+
+    void reset( int cmPerGrid, int xCenterInCm, int yCenterInCm );
+
+    void erase();
+
+    // Rebuild this quadtree from a dense grid map (adopts its geometry too);
+    // returns false if the node pool was exhausted
+    bool build( const Map& map );
+
+    bool isOnMap( int navX, int navY ) const;
+
+    bool markMap( int navX, int navY, bool isObstacle );
+
+    bool markMapGridCoords( int gridX, int gridY, bool isObstacle );
+
+    bool isThereAnObstacle( int navX, int navY, bool* isObstacle ) const;
+
+    bool isThereAnObstacleGridCoords( int gridX, int gridY, bool* isObstacle ) const;
+
+    // Find the leaf holding a grid cell; returns false if off the map
+    bool getLeafGridCoords( int gridX, int gridY, int* leafX, int* leafY, int* leafSize, bool* isObstacle ) const;
+
+    // Are two grid cells in the same leaf?
+    bool isSameLeaf( int gridX0, int gridY0, int gridX1, int gridY1 ) const;
+
+    // Enumerate the obstacle-free leaves that touch (edge or corner) the leaf
+    // containing the given grid cell; each is reported as its representative cell.
+    // Whether the representative cells are in sight of each other is up to the caller.
+    uint8_t getNeighbors( int gridX, int gridY, PathFinder::Point neighbors[], uint8_t maxNeighbors ) const;
+
+    bool markObstacle( int navX, int navY )
+    {
+        return markMap( navX, navY, true );
+    }
+
+    bool markClear( int navX, int navY )
+    {
+        return markMap( navX, navY, false );
+    }
+
+
+    int cmPerGrid() const
+    { return mCmPerGrid; }
+
+    int convertToGridX( int xInCm ) const
+    { return ( xInCm - mLowerLeftCornerNavX + mHalfCmPerGrid ) / mCmPerGrid; }
+
+    int convertToGridY( int yInCm ) const
+    { return ( yInCm - mLowerLeftCornerNavY + mHalfCmPerGrid ) / mCmPerGrid; }
+
+    int convertToNavX( int gridX ) const
+    { return mLowerLeftCornerNavX + gridX * mCmPerGrid; }
+
+    int convertToNavY( int gridY ) const
+    { return mLowerLeftCornerNavY + gridY * mCmPerGrid; }
+
+
+    int sizeGridX() const
+    { return kCarrtNavigationMapGridSizeX; }
+
+    int sizeGridY() const
+    { return kCarrtNavigationMapGridSizeY; }
+
+    int minXCoord() const
+    { return convertToNavX( 0 ); }
+
+    int maxXCoord() const
+    { return convertToNavX( kCarrtNavigationMapGridSizeX ); }
+
+    int minYCoord() const
+    { return convertToNavY( 0 ); }
+
+    int maxYCoord() const
+    { return convertToNavY( kCarrtNavigationMapGridSizeY ); }
+
+
+    // Number of nodes (and leaves) currently in the tree
+    int nbrNodes() const;
+    int nbrLeaves() const;
+
+    // Bytes actually used by the node pool
+    unsigned int memorySize() const
+    { return nbrNodes() * sizeof( uint16_t ); }
+
+    // Did a split ever fail for lack of nodes?
+    bool hasOverflowed() const
+    { return mOverflowed; }
+
+
+private:
+
+    enum
+    {
+        kFreeLeaf       = 0xFFFF,
+        kObstacleLeaf   = 0xFFFE,
+        kNoBlock        = 0xFFFF,
+        kMaxDepth       = 16
+    };
+
+    static bool isLeaf( uint16_t node )
+    { return node >= kObstacleLeaf; }
+
+    uint16_t findLeaf( int gridX, int gridY, int* leafX, int* leafY, int* leafSize ) const;
+    uint16_t allocateBlock();
+    void freeBlock( uint16_t block );
+    int countNodes( uint16_t node, bool leavesOnly ) const;
+    void addNeighbor( int gridX, int gridY, int* nextX, int* nextY, PathFinder::Point neighbors[], uint8_t* n, uint8_t maxNeighbors ) const;
+
+    int mCmPerGrid;
+    int mHalfCmPerGrid;
+
+    int mLowerLeftCornerNavX;
+    int mLowerLeftCornerNavY;
+
+    uint16_t mNextUnused;
+    uint16_t mFreeBlocks;
+    bool     mOverflowed;
+
+    uint16_t mNodes[ kCarrtQuadTreeMapMaxNodes ];
+};
+
+
+
+
+#endif
+
+
+#endif  // CARRT_INCLUDE_GOTODRIVE_IN_BUILD || CARRT_INCLUDE_NAVMAP_IN_BUILD
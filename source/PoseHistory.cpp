@@ -0,0 +1,139 @@
+/*
+    PoseHistory.cpp - The last couple of seconds of CARRT's poses, one per
+    navigation update, for finding where CARRT was when a reading was taken.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "PoseHistory.h"
+
+
+
+
+void PoseHistory::add( uint32_t micros, const Vector2Float& position, float heading )
+{
+    if ( mNbrPoses && static_cast<int32_t>( micros - getPose( 0 ).micros ) <= 0 )
+    {
+        return;
+    }
+
+    mNewest = ( mNewest + 1 ) % kSize;
+
+    TimedPose* pose = &mPoses[ mNewest ];
+    pose->micros = micros;
+    pose->position = position;
+    pose->heading = heading;
+
+    if ( mNbrPoses < kSize )
+    {
+        ++mNbrPoses;
+    }
+}
+
+
+
+bool PoseHistory::getPoseAt( uint32_t micros, Vector2Float* position, float* heading ) const
+{
+    if ( !mNbrPoses )
+    {
+        return false;
+    }
+
+    const TimedPose& newest = getPose( 0 );
+
+    // How long before the newest pose (negative if after it)
+    int32_t age = newest.micros - micros;
+
+    if ( age <= 0 )
+    {
+        if ( !age )
+        {
+            *position = newest.position;
+            *heading = newest.heading;
+            return true;
+        }
+
+        // Extrapolate, but no further ahead than the last update interval
+        if ( mNbrPoses < 2 )
+        {
+            return false;
+        }
+
+        const TimedPose& previous = getPose( 1 );
+        int32_t interval = newest.micros - previous.micros;
+        if ( -age > interval )
+        {
+            return false;
+        }
+
+        interpolate( previous, newest, interval - age, position, heading );
+        return true;
+    }
+
+    // Find the first pose at or before the time (the one after it is then the one before that)
+    for ( uint8_t i = 1; i < mNbrPoses; ++i )
+    {
+        const TimedPose& before = getPose( i );
+        int32_t beforeAge = newest.micros - before.micros;
+
+        if ( beforeAge >= age )
+        {
+            interpolate( before, getPose( i - 1 ), beforeAge - age, position, heading );
+            return true;
+        }
+    }
+
+    // Older than the oldest pose
+    return false;
+}
+
+
+
+
+void PoseHistory::interpolate( const TimedPose& from, const TimedPose& to, int32_t micros,
+                               Vector2Float* position, float* heading )
+{
+    // micros is the time after from (possibly past to, for extrapolation)
+    int32_t interval = to.micros - from.micros;
+    float fraction = interval ? static_cast<float>( micros ) / interval : 1.0;
+
+    *position = from.position + ( to.position - from.position ) * fraction;
+
+    // Take the short way round
+    float turn = to.heading - from.heading;
+    if ( turn > 180 )
+    {
+        turn -= 360;
+    }
+    else if ( turn < -180 )
+    {
+        turn += 360;
+    }
+
+    float hdg = from.heading + turn * fraction;
+    if ( hdg < 0 )
+    {
+        hdg += 360;
+    }
+    else if ( hdg >= 360 )
+    {
+        hdg -= 360;
+    }
+    *heading = hdg;
+}
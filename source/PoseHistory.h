@@ -0,0 +1,93 @@
+/*
+    PoseHistory.h - The last couple of seconds of CARRT's poses, one per
+    navigation update, for finding where CARRT was when a reading was taken.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef PoseHistory_h
+#define PoseHistory_h
+
+#include <stdint.h>
+
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * A ring buffer of timestamped poses (times from micros()).  The pose at any
+ * time between the oldest and newest is interpolated between the two
+ * either side of it, taking the short way round for the heading.  A little
+ * past the newest (up to the time between the last two, i.e., until the
+ * next update is due) the last motion is extrapolated.
+ *
+ * Times are compared as differences, so micros() wrapping around is fine.
+ */
+
+class PoseHistory
+{
+public:
+
+    // Two seconds of updates at 8 Hz
+    static const uint8_t kSize = 16;
+
+    PoseHistory()
+    : mNewest( 0 ), mNbrPoses( 0 ) { }
+
+    void clear()
+    { mNbrPoses = 0; }
+
+    // Times must increase from one pose to the next (a pose no later than the newest is
+    // ignored)
+    void add( uint32_t micros, const Vector2Float& position, float heading );
+
+    // False if there is nothing known about that time
+    bool getPoseAt( uint32_t micros, Vector2Float* position, float* heading ) const;
+
+    uint8_t nbrPoses() const
+    { return mNbrPoses; }
+
+    // Only meaningful if there are poses
+    uint32_t newestMicros() const
+    { return getPose( 0 ).micros; }
+
+
+private:
+
+    struct TimedPose
+    {
+        uint32_t        micros;
+        Vector2Float    position;
+        float           heading;
+    };
+
+    // The i-th newest pose (0 is the newest)
+    const TimedPose& getPose( uint8_t i ) const
+    { return mPoses[ ( mNewest + kSize - i ) % kSize ]; }
+
+    static void interpolate( const TimedPose& from, const TimedPose& to, int32_t micros,
+                             Vector2Float* position, float* heading );
+
+    TimedPose       mPoses[kSize];
+    uint8_t         mNewest;
+    uint8_t         mNbrPoses;
+};
+
+
+#endif
@@ -0,0 +1,114 @@
+/*
+    PoseSnapshot.cpp - CARRT's position and heading frozen at one moment, for
+    converting many points relative to CARRT into absolute coordinates.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "PoseSnapshot.h"
+
+#include <math.h>
+
+#include "Utils/FixedPoint.h"
+
+
+
+
+namespace
+{
+    const float     kDegreesToRadians   = M_PI / 180.0;
+
+    // Rounds a Q15 product sum to the nearest integer
+    const int32_t   kQ15Half            = 1L << 14;
+
+    int16_t toQ15( float x )
+    {
+        return static_cast<int16_t>( x >= 0 ? x * FixedPoint::kQ15One + 0.5 : x * FixedPoint::kQ15One - 0.5 );
+    }
+};
+
+
+
+
+PoseSnapshot::PoseSnapshot( const Vector2Float& position, float heading )
+: mPosition( position )
+{
+    // Compass headings run clockwise, so rotating by one flips the sign of the sine
+    float hdg = heading * kDegreesToRadians;
+    mSin = sin( hdg );
+    mCos = cos( hdg );
+
+    mSinQ15 = toQ15( mSin );
+    mCosQ15 = toQ15( mCos );
+
+    setIntegerPosition();
+}
+
+
+
+PoseSnapshot::PoseSnapshot( const Vector2Float& position, int16_t sinHeading, int16_t cosHeading )
+: mPosition( position ),
+  mSin( sinHeading * ( 1.0 / FixedPoint::kQ15One ) ),
+  mCos( cosHeading * ( 1.0 / FixedPoint::kQ15One ) ),
+  mSinQ15( sinHeading ),
+  mCosQ15( cosHeading )
+{
+    setIntegerPosition();
+}
+
+
+
+void PoseSnapshot::toAbsolute( const Vector2Float* relative, Vector2Float* absolute, uint8_t n ) const
+{
+    for ( uint8_t i = 0; i < n; ++i )
+    {
+        absolute[i] = toAbsolute( relative[i].x, relative[i].y );
+    }
+}
+
+
+
+void PoseSnapshot::toAbsolute( int16_t downRange, int16_t crossRange, int16_t* x, int16_t* y ) const
+{
+    int32_t dx = static_cast<int32_t>( downRange ) * mCosQ15 + static_cast<int32_t>( crossRange ) * mSinQ15;
+    int32_t dy = static_cast<int32_t>( crossRange ) * mCosQ15 - static_cast<int32_t>( downRange ) * mSinQ15;
+
+    // Arithmetic shifts round toward -infinity, so adding a half rounds to nearest
+    *x = mX + static_cast<int16_t>( ( dx + kQ15Half ) >> 15 );
+    *y = mY + static_cast<int16_t>( ( dy + kQ15Half ) >> 15 );
+}
+
+
+
+void PoseSnapshot::toAbsolute( const int16_t* downRange, const int16_t* crossRange, int16_t* x, int16_t* y, uint8_t n ) const
+{
+    for ( uint8_t i = 0; i < n; ++i )
+    {
+        toAbsolute( downRange[i], crossRange[i], x + i, y + i );
+    }
+}
+
+
+
+
+void PoseSnapshot::setIntegerPosition()
+{
+    mX = static_cast<int16_t>( mPosition.x >= 0 ? mPosition.x + 0.5 : mPosition.x - 0.5 );
+    mY = static_cast<int16_t>( mPosition.y >= 0 ? mPosition.y + 0.5 : mPosition.y - 0.5 );
+}
@@ -0,0 +1,90 @@
+/*
+    PoseSnapshot.h - CARRT's position and heading frozen at one moment, for
+    converting many points relative to CARRT into absolute coordinates.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef PoseSnapshot_h
+#define PoseSnapshot_h
+
+#include <stdint.h>
+
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * The sine and cosine of the heading are worked out once, when the snapshot
+ * is taken, so each point converted afterwards costs four multiply-adds
+ * (rather than an atan2(), a sqrt(), a sin() and a cos()).  The integer
+ * conversions use only 16 by 16 bit multiplies, for code that works in whole
+ * centimeters or grid cells anyway.
+ *
+ * Relative points are down range (forward positive) and cross range (left
+ * positive); absolute points use the Navigator's coordinates (x North, y
+ * West; see Navigator.h), in whatever units the position was given.
+ */
+
+class PoseSnapshot
+{
+public:
+
+    PoseSnapshot() {}
+
+    // Compass heading in degrees
+    PoseSnapshot( const Vector2Float& position, float heading );
+
+    // Sine and cosine (Q1.15) of the compass heading, as the fixed-point Navigator has them
+    PoseSnapshot( const Vector2Float& position, int16_t sinHeading, int16_t cosHeading );
+
+
+    Vector2Float toAbsolute( float downRange, float crossRange ) const
+    {
+        return Vector2Float( mPosition.x + downRange * mCos + crossRange * mSin,
+                             mPosition.y + crossRange * mCos - downRange * mSin );
+    }
+
+    void toAbsolute( const Vector2Float* relative, Vector2Float* absolute, uint8_t n ) const;
+
+    // Integer units (rounded), with the position rounded to them
+    void toAbsolute( int16_t downRange, int16_t crossRange, int16_t* x, int16_t* y ) const;
+    void toAbsolute( const int16_t* downRange, const int16_t* crossRange, int16_t* x, int16_t* y, uint8_t n ) const;
+
+
+    const Vector2Float& getPosition() const
+    { return mPosition; }
+
+
+private:
+
+    void setIntegerPosition();
+
+    Vector2Float    mPosition;
+    float           mSin;
+    float           mCos;
+
+    int16_t         mX;
+    int16_t         mY;
+    int16_t         mSinQ15;
+    int16_t         mCosQ15;
+};
+
+
+#endif
@@ -664,6 +664,23 @@ void ProgDriveAnyTimeMenuState::displaySecondsSetting()
 
 
 
+//****************************************************************************
+
+// States come from the state arena (see State.h)
+
+CARRT_CHECK_STATE_SIZE( ProgDriveProgramMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveFwdTimeMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveRevTimeMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveRotLTimeMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveRotRTimeMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDrivePauseTimeMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveBeepTimeMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveRotateAngleMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveForwardDistanceMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveReverseDistanceMenuState );
+CARRT_CHECK_STATE_SIZE( ProgDriveClearState );
+
+
 
 
 #endif  // CARRT_INCLUDE_PROGDRIVE_IN_BUILD
@@ -152,6 +152,19 @@ mNextStateInProgram( 0 )
 
 
 
+void* BaseProgDriveState::operator new( size_t size ) noexcept
+{
+    return malloc( size );
+}
+
+
+void BaseProgDriveState::operator delete( void* p )
+{
+    free( p );
+}
+
+
+
 // onExit() - tear-down the state, but in this class NEVER delete the case on Exit
 void BaseProgDriveState::onExit()
 {
@@ -491,56 +504,72 @@ void PgmDrvScanState::onEntry()
     Display::clear();
     Display::displayTopRowP16( sLabelScaning );
 
-    mCurrentSlewAngle = kScanLimitLeft;
-    Lidar::slew( mCurrentSlewAngle );
-
-    // Allow time for the servo to slew (this might be a big slew)
-    CarrtCallback::yieldMilliseconds( 500 );
-
-    displayAngleRange();
+    mScan.stop();
+    scan( EventManager::kNullEvent, 0 );
 }
 
 
 void PgmDrvScanState::onExit()
 {
+    // This state is reused, so cancel any wait in progress
+    mScan.stop();
+
     Lidar::slew( 0 );
 }
 
 
 bool PgmDrvScanState::onEvent( uint8_t event, int16_t param )
 {
-    const int kSlewTimePause = 250;     // Time for servo to slew in msec
-    
-    // Every 2 secs....
-    if ( event == EventManager::kOneSecondTimerEvent && (param % 2) == 0 )
+    if ( event == EventManager::kKeypadButtonHitEvent )
     {
-        mCurrentSlewAngle += kScanIncrement;
-        if ( mCurrentSlewAngle > kScanLimitRight )
-        {
-            // Done with Scan
-            Lidar::slew( 0 );
-            gotoNextActionInProgram();
-        }
-        else
-        {
-            // Slew radar into position for next read
-            Lidar::slew( mCurrentSlewAngle );
-
-            // Allow time for the servo to slew (this is a small slew)
-            CarrtCallback::yieldMilliseconds( kSlewTimePause );
-
-            displayAngleRange();
-        }
+        MainProcess::changeState( new ProgDriveProgramMenuState );
     }
-    else if ( event == EventManager::kKeypadButtonHitEvent )
+    else
     {
-        MainProcess::changeState( new ProgDriveProgramMenuState );
+        scan( event, param );
     }
 
     return true;
 }
 
 
+void PgmDrvScanState::scan( uint8_t event, int16_t param )
+{
+    const uint16_t kInitialSlewTimeMs   = 500;      // Time for servo to slew in msec
+    const uint16_t kStepSlewTimeMs      = 250;
+    const uint16_t kStepTimeMs          = 2000;     // Read a range every 2 secs
+
+    CORO_BEGIN( mScan );
+
+    mCurrentSlewAngle = kScanLimitLeft;
+    Lidar::slew( mCurrentSlewAngle );
+
+    // Allow time for the servo to slew (this might be a big slew)
+    CORO_WAIT_MS( mScan, kInitialSlewTimeMs );
+
+    displayAngleRange();
+
+    for ( mCurrentSlewAngle += kScanIncrement; mCurrentSlewAngle <= kScanLimitRight; mCurrentSlewAngle += kScanIncrement )
+    {
+        CORO_WAIT_MS( mScan, kStepTimeMs - kStepSlewTimeMs );
+
+        // Slew radar into position for next read
+        Lidar::slew( mCurrentSlewAngle );
+
+        // Allow time for the servo to slew (this is a small slew)
+        CORO_WAIT_MS( mScan, kStepSlewTimeMs );
+
+        displayAngleRange();
+    }
+
+    // Done with Scan
+    CORO_END( mScan );
+
+    Lidar::slew( 0 );
+    gotoNextActionInProgram();
+}
+
+
 void PgmDrvScanState::displayAngleRange()
 {
     int rng;
@@ -865,11 +894,12 @@ void PgmDrvDriveDistanceState::displayDistance()
 
 
 
+//****************************************************************************
 
+// States come from the state arena (see State.h)
 
-
-
-
+CARRT_CHECK_STATE_SIZE( PgmDrvFinishedState );
+CARRT_CHECK_STATE_SIZE( PgmDrvObstacleState );
 
 
 
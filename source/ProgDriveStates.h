@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 
+#include "Coroutine.h"
 #include "State.h"
 
 
@@ -40,6 +41,11 @@ public:
 
     BaseProgDriveState();
 
+    // Program steps live as long as the program, so they come from the heap and
+    // not the state arena
+    static void* operator new( size_t size ) noexcept;
+    static void operator delete( void* p );
+
     // onExit() - tear-down the state, but in these classes NEVER delete the case on Exit
     virtual void onExit();
 
@@ -164,10 +170,11 @@ public:
 
 private:
 
+    void scan( uint8_t event, int16_t param );
     void displayAngleRange();
-    bool updateSlewAngle();
 
-    int mCurrentSlewAngle;
+    Coroutine   mScan;
+    int         mCurrentSlewAngle;
 };
 
 
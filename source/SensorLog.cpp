@@ -0,0 +1,330 @@
+/*
+    SensorLog.cpp - Records the Navigator's raw sensor samples and motion
+    commands, as a compact binary stream over the debug serial line, so that
+    drives can be replayed through the Navigator on Linux.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "SensorLog.h"
+
+#include <string.h>
+
+#include "Utils/Checksum.h"
+
+#if CARRT_ENABLE_SENSOR_LOG
+#include "AVRTools/SystemClock.h"
+#endif
+
+#if CARRT_ENABLE_SENSOR_LOG && __AVR__
+#if !CARRT_ENABLE_DEBUG_SERIAL
+#error "CARRT_ENABLE_SENSOR_LOG needs the debug serial line (a debug build)"
+#endif
+#include "Utils/DebuggingMacros.h"
+#endif
+
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace SensorLog
+{
+
+    // Byte-at-a-time, so the format doesn't depend on how either end lays out its structs
+
+    class Encoder
+    {
+    public:
+
+        explicit Encoder( uint8_t* out )
+        : mOut( out ), mSize( 0 ) { }
+
+        void putU8( uint8_t x )
+        { mOut[ mSize++ ] = x; }
+
+        void putI16( int16_t x )
+        { putU8( x & 0xFF ); putU8( ( x >> 8 ) & 0xFF ); }
+
+        void putU32( uint32_t x )
+        { putI16( x & 0xFFFF ); putI16( ( x >> 16 ) & 0xFFFF ); }
+
+        void putI32( int32_t x )
+        { putU32( static_cast<uint32_t>( x ) ); }
+
+        void putFloat( float x )
+        { uint32_t bits; memcpy( &bits, &x, sizeof bits ); putU32( bits ); }
+
+        void putV3I16( const Vector3Int& v )
+        { putI16( v.x ); putI16( v.y ); putI16( v.z ); }
+
+        void putV3I32( const Vector3Long& v )
+        { putI32( v.x ); putI32( v.y ); putI32( v.z ); }
+
+        void putV3Float( const Vector3Float& v )
+        { putFloat( v.x ); putFloat( v.y ); putFloat( v.z ); }
+
+        uint8_t size() const
+        { return mSize; }
+
+    private:
+
+        uint8_t*    mOut;
+        uint8_t     mSize;
+    };
+
+
+    class Decoder
+    {
+    public:
+
+        explicit Decoder( const uint8_t* in )
+        : mIn( in ) { }
+
+        uint8_t getU8()
+        { return *mIn++; }
+
+        int16_t getI16()
+        { uint16_t x = getU8(); x |= static_cast<uint16_t>( getU8() ) << 8; return static_cast<int16_t>( x ); }
+
+        uint32_t getU32()
+        { uint32_t x = static_cast<uint16_t>( getI16() ); x |= static_cast<uint32_t>( static_cast<uint16_t>( getI16() ) ) << 16; return x; }
+
+        int32_t getI32()
+        { return static_cast<int32_t>( getU32() ); }
+
+        float getFloat()
+        { uint32_t bits = getU32(); float x; memcpy( &x, &bits, sizeof x ); return x; }
+
+        Vector3Int getV3I16()
+        { int16_t x = getI16(); int16_t y = getI16(); return Vector3Int( x, y, getI16() ); }
+
+        Vector3Long getV3I32()
+        { int32_t x = getI32(); int32_t y = getI32(); return Vector3Long( x, y, getI32() ); }
+
+        Vector3Float getV3Float()
+        { float x = getFloat(); float y = getFloat(); return Vector3Float( x, y, getFloat() ); }
+
+    private:
+
+        const uint8_t*  mIn;
+    };
+
+
+    uint8_t frameRecord( uint8_t type, uint8_t* record, uint8_t payloadSize );
+
+};
+
+
+
+
+uint8_t SensorLog::encodeStart( const Start& start, uint8_t* record )
+{
+    Encoder e( record + 3 );
+
+    e.putU8( start.version );
+    e.putV3Float( start.calibration.offset );
+    e.putV3Float( start.calibration.scale );
+    e.putV3I16( start.accelZero );
+    e.putV3I16( start.gyroZero );
+    e.putV3I16( start.mag );
+
+    return frameRecord( kStartRecord, record, e.size() );
+}
+
+
+
+uint8_t SensorLog::encodeSample( const ImuSampler::Sample& sample, uint8_t* record )
+{
+    Encoder e( record + 3 );
+
+    e.putU32( sample.micros );
+    e.putFloat( sample.timeStep );
+    e.putU8( sample.nbrAccel );
+    e.putU8( sample.nbrGyro );
+    e.putV3I32( sample.accelSum );
+    e.putV3I32( sample.accelSumOfSums );
+    e.putV3I32( sample.gyroSum );
+    e.putV3I16( sample.accel );
+    e.putV3I16( sample.mag );
+
+    return frameRecord( kSampleRecord, record, e.size() );
+}
+
+
+
+uint8_t SensorLog::encodeMotion( const MotionChange& motion, uint8_t* record )
+{
+    Encoder e( record + 3 );
+
+    e.putU32( motion.micros );
+    e.putU8( motion.motion );
+
+    return frameRecord( kMotionRecord, record, e.size() );
+}
+
+
+
+void SensorLog::decodeStart( const uint8_t* payload, Start* start )
+{
+    Decoder d( payload );
+
+    start->version = d.getU8();
+    start->calibration.offset = d.getV3Float();
+    start->calibration.scale = d.getV3Float();
+    start->accelZero = d.getV3I16();
+    start->gyroZero = d.getV3I16();
+    start->mag = d.getV3I16();
+}
+
+
+
+void SensorLog::decodeSample( const uint8_t* payload, ImuSampler::Sample* sample )
+{
+    Decoder d( payload );
+
+    sample->micros = d.getU32();
+    sample->timeStep = d.getFloat();
+    sample->nbrAccel = d.getU8();
+    sample->nbrGyro = d.getU8();
+    sample->accelSum = d.getV3I32();
+    sample->accelSumOfSums = d.getV3I32();
+    sample->gyroSum = d.getV3I32();
+    sample->accel = d.getV3I16();
+    sample->mag = d.getV3I16();
+}
+
+
+
+void SensorLog::decodeMotion( const uint8_t* payload, MotionChange* motion )
+{
+    Decoder d( payload );
+
+    motion->micros = d.getU32();
+    motion->motion = d.getU8();
+}
+
+
+
+bool SensorLog::findRecord( const uint8_t* data, uint32_t size, uint32_t* pos, uint8_t* type, const uint8_t** payload )
+{
+    for ( uint32_t i = *pos; i + kFramingSize <= size; ++i )
+    {
+        if ( data[i] != kSync )
+        {
+            continue;
+        }
+
+        uint8_t t = data[ i + 1 ];
+        uint8_t len = data[ i + 2 ];
+
+        bool known = ( t == kStartRecord && len == kStartPayloadSize )
+                        || ( t == kSampleRecord && len == kSamplePayloadSize )
+                        || ( t == kMotionRecord && len == kMotionPayloadSize );
+
+        if ( !known || i + kFramingSize + len > size )
+        {
+            continue;
+        }
+
+        const uint8_t* p = data + i + 3;
+        uint16_t checksum = p[ len ] | static_cast<uint16_t>( p[ len + 1 ] ) << 8;
+        if ( checksum != computeChecksum( p, len, t ) )
+        {
+            // A sync byte in the text (or a garbled record); look for the next one
+            continue;
+        }
+
+        *type = t;
+        *payload = p;
+        *pos = i + kFramingSize + len;
+        return true;
+    }
+
+    *pos = size;
+    return false;
+}
+
+
+
+
+uint8_t SensorLog::frameRecord( uint8_t type, uint8_t* record, uint8_t payloadSize )
+{
+    uint16_t checksum = computeChecksum( record + 3, payloadSize, type );
+
+    record[0] = kSync;
+    record[1] = type;
+    record[2] = payloadSize;
+    record[ 3 + payloadSize ] = checksum & 0xFF;
+    record[ 4 + payloadSize ] = checksum >> 8;
+
+    return payloadSize + kFramingSize;
+}
+
+
+
+
+#if CARRT_ENABLE_SENSOR_LOG
+
+void SensorLog::recordStart( const SensorZeroing::ZeroPoints& zero )
+{
+    Start start;
+    start.version = kFormatVersion;
+    start.calibration = LSM303DLHC::getMagnetometerCalibration();
+    start.accelZero = zero.accel;
+    start.gyroZero = zero.gyro;
+    start.mag = zero.mag;
+
+    uint8_t record[ kMaxRecordSize ];
+    writeRecord( record, encodeStart( start, record ) );
+}
+
+
+
+void SensorLog::recordSample( const ImuSampler::Sample& sample )
+{
+    uint8_t record[ kMaxRecordSize ];
+    writeRecord( record, encodeSample( sample, record ) );
+}
+
+
+
+void SensorLog::recordMotion( Motion motion )
+{
+    MotionChange change;
+    change.micros = micros();
+    change.motion = motion;
+
+    uint8_t record[ kMaxRecordSize ];
+    writeRecord( record, encodeMotion( change, record ) );
+}
+
+
+
+#if __AVR__
+
+void SensorLog::writeRecord( const uint8_t* record, uint8_t size )
+{
+    // Goes into the serial line's transmit buffer (about 60 bytes per sample)
+    gDebugSerial.write( record, size );
+}
+
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+/*
+    SensorLog.h - Records the Navigator's raw sensor samples and motion
+    commands, as a compact binary stream over the debug serial line, so that
+    drives can be replayed through the Navigator on Linux.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef SensorLog_h
+#define SensorLog_h
+
+#include <stdint.h>
+
+#include "ImuSampler.h"
+#include "SensorZeroing.h"
+
+#include "Drivers/LSM303DLHC.h"
+
+
+
+/*
+ * Records are framed so that a reader can pick them out of a serial capture
+ * that also has text (debugging output) in it:
+ *
+ *      0xA5, type, payload length, payload, checksum (2 bytes)
+ *
+ * where the checksum is Utils/Checksum.h's over the payload, seeded with the
+ * type.  Numbers are little-endian (as the AVR keeps them), floats IEEE
+ * single.
+ *
+ *      'H' start (Navigator::init()):
+ *              version (u8), magnetometer calibration offset and scale (6 x f32),
+ *              accelerometer and gyroscope zero points and the magnetometer's
+ *              reading (9 x i16)
+ *      'S' sample (each ImuSampler sample):
+ *              micros (u32), time step (f32), number of accelerometer and gyroscope
+ *              readings (2 x u8), sums of the accelerometer readings, of their
+ *              running sums, and of the gyroscope readings (9 x i32), average
+ *              accelerometer and magnetometer readings (6 x i16)
+ *      'M' motion (movingStraight(), movingTurning(), stopped(), reset()):
+ *              micros (u32), motion (u8)
+ *
+ * At 8 Hz that is about 500 bytes per second, well within what the 115200
+ * baud debug serial line carries.
+ *
+ * Recording is built in only with CARRT_ENABLE_SENSOR_LOG (and needs the debug
+ * serial line).  Encoding and decoding are always available, for the replay
+ * tool (NavReplay, in Test/TestOnLinux).
+ */
+
+namespace SensorLog
+{
+
+    enum
+    {
+        kFormatVersion          = 1,
+
+        kSync                   = 0xA5,
+
+        kStartRecord            = 'H',
+        kSampleRecord           = 'S',
+        kMotionRecord           = 'M',
+
+        kStartPayloadSize       = 1 + 6 * 4 + 9 * 2,
+        kSamplePayloadSize      = 4 + 4 + 2 + 9 * 4 + 6 * 2,
+        kMotionPayloadSize      = 4 + 1,
+
+        // Sync, type, length, and checksum
+        kFramingSize            = 5,
+        kMaxRecordSize          = kSamplePayloadSize + kFramingSize
+    };
+
+    enum Motion
+    {
+        kStopped,
+        kStraight,
+        kTurning,
+        kReset
+    };
+
+
+    struct Start
+    {
+        uint8_t                     version;
+        LSM303DLHC::MagCalibration  calibration;
+        Vector3Int                  accelZero;
+        Vector3Int                  gyroZero;
+        Vector3Int                  mag;
+    };
+
+    struct MotionChange
+    {
+        uint32_t                    micros;
+        uint8_t                     motion;
+    };
+
+
+    // Encode a whole record (framing and all) into record, returning its size
+    uint8_t encodeStart( const Start& start, uint8_t* record );
+    uint8_t encodeSample( const ImuSampler::Sample& sample, uint8_t* record );
+    uint8_t encodeMotion( const MotionChange& motion, uint8_t* record );
+
+    // Decode a payload (of the type's size)
+    void decodeStart( const uint8_t* payload, Start* start );
+    void decodeSample( const uint8_t* payload, ImuSampler::Sample* sample );
+    void decodeMotion( const uint8_t* payload, MotionChange* motion );
+
+    // Find the next good record in data, starting at *pos; false if there isn't one.
+    // Anything else in between is skipped.
+    bool findRecord( const uint8_t* data, uint32_t size, uint32_t* pos, uint8_t* type, const uint8_t** payload );
+
+
+#if CARRT_ENABLE_SENSOR_LOG
+
+    void recordStart( const SensorZeroing::ZeroPoints& zero );
+    void recordSample( const ImuSampler::Sample& sample );
+    void recordMotion( Motion motion );
+
+    // Where records go:  the debug serial line (the host simulation supplies its own)
+    void writeRecord( const uint8_t* record, uint8_t size );
+
+#endif
+
+};
+
+
+#endif
@@ -0,0 +1,246 @@
+/*
+    SensorZeroing.cpp - Finds the accelerometer's and gyroscope's zero points
+    (their readings at rest) for the Navigator.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "SensorZeroing.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <avr/eeprom.h>
+
+#include "AVRTools/SystemClock.h"
+
+#include "Drivers/L3GD20.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/NavSensorDataBlock.h"
+#include "Drivers/TempSensor.h"
+#include "Utils/Checksum.h"
+
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace SensorZeroing
+{
+
+    const uint8_t   kSamplesPerBlock    = 16;
+
+    // Never fewer readings than this from scratch, nor more than this (the old fixed number)
+    const uint16_t  kMinNbrReadings     = 48;
+    const uint16_t  kMaxNbrReadings     = 320;
+
+    // Standard errors good enough for the zero points (raw units:  1 mg and 4.4 mdps)
+    const float     kAccelTolerance     = 1.0;
+    const float     kGyroTolerance      = 0.5;
+
+    // Stored zero points are used at temperatures within this of where they were found...
+    const float     kMaxTempChange      = 3.0;
+    // ...if the first block's means are within this many standard errors (plus the tolerance) of them
+    const float     kReuseSigmas        = 3.0;
+
+
+    struct StoredZeroPoints
+    {
+        uint16_t        signature;
+        float           tempC;
+        Vector3Int      accel;
+        Vector3Int      gyro;
+        uint16_t        checksum;
+    };
+
+    const uint16_t  kSignature          = 0x5A50;       // "ZP"
+    const uint8_t   kChecksummedSize    = offsetof( StoredZeroPoints, checksum );
+
+
+    bool agrees( const Stats& stats, const Vector3Int& zero, float tolerance );
+    Vector3Int roundToInt( const Vector3Float& v );
+
+
+    StoredZeroPoints    mEepromZeroPoints EEMEM;
+
+};
+
+
+
+
+void SensorZeroing::reset( Stats* stats )
+{
+    stats->n = 0;
+    stats->mean = Vector3Float( 0, 0, 0 );
+    stats->m2 = Vector3Float( 0, 0, 0 );
+}
+
+
+
+void SensorZeroing::add( Stats* stats, const Vector3Int& reading )
+{
+    ++stats->n;
+
+    Vector3Float delta( reading.x - stats->mean.x, reading.y - stats->mean.y, reading.z - stats->mean.z );
+    stats->mean.x += delta.x / stats->n;
+    stats->mean.y += delta.y / stats->n;
+    stats->mean.z += delta.z / stats->n;
+
+    stats->m2.x += delta.x * ( reading.x - stats->mean.x );
+    stats->m2.y += delta.y * ( reading.y - stats->mean.y );
+    stats->m2.z += delta.z * ( reading.z - stats->mean.z );
+}
+
+
+
+float SensorZeroing::getStandardError( const Stats& stats )
+{
+    if ( stats.n < 2 )
+    {
+        return INFINITY;
+    }
+
+    // Variance of the mean is the sample variance over n
+    float largest = stats.m2.x;
+    if ( stats.m2.y > largest )
+    {
+        largest = stats.m2.y;
+    }
+    if ( stats.m2.z > largest )
+    {
+        largest = stats.m2.z;
+    }
+
+    return sqrt( largest / ( stats.n - 1 ) / stats.n );
+}
+
+
+
+void SensorZeroing::findZeroPoints( ZeroPoints* zero )
+{
+    DataBlock accelData;
+    DataBlock gyroData;
+
+    Stats accel;
+    Stats gyro;
+    reset( &accel );
+    reset( &gyro );
+
+    // The magnetometer has no FIFO:  one reading per block
+    Vector3Long magSum( 0, 0, 0 );
+    uint8_t nbrMag = 0;
+
+    StoredZeroPoints stored;
+    eeprom_read_block( &stored, &mEepromZeroPoints, sizeof( stored ) );
+    float tempC = TempSensor::getTempC();
+    bool mightReuse = stored.signature == kSignature
+                        && stored.checksum == computeChecksum( &stored, kChecksummedSize, kSignature )
+                        && fabs( tempC - stored.tempC ) <= kMaxTempChange;
+
+    const int delay1 = kSamplesPerBlock * 1000 / LSM303DLHC::accelerometerUpdateRate();
+    const int delay2 = kSamplesPerBlock * 1000 / L3GD20::gyroscopeUpdateRate();
+    const int neededDelay = ( delay1 > delay2 ) ? delay1 : delay2;
+
+    zero->fromEeprom = false;
+    bool converged = false;
+
+    while ( 1 )
+    {
+        LSM303DLHC::getAccelerationDataBlockSync( &accelData, kSamplesPerBlock );
+        L3GD20::getAngularRatesDataBlockSync( &gyroData, kSamplesPerBlock );
+        for ( uint8_t j = 0; j < kSamplesPerBlock; ++j )
+        {
+            add( &accel, LSM303DLHC::convertDataBlockEntryToAccelerationRaw( accelData, j ) );
+            add( &gyro, L3GD20::convertDataBlockEntryToAngularRatesRaw( gyroData, j ) );
+        }
+
+        magSum += LSM303DLHC::getMagnetometerRaw();
+        ++nbrMag;
+
+        if ( mightReuse )
+        {
+            // Only the first block decides
+            mightReuse = false;
+            if ( agrees( accel, stored.accel, kAccelTolerance ) && agrees( gyro, stored.gyro, kGyroTolerance ) )
+            {
+                zero->fromEeprom = true;
+                break;
+            }
+        }
+
+        converged = accel.n >= kMinNbrReadings
+                    && getStandardError( accel ) <= kAccelTolerance
+                    && getStandardError( gyro ) <= kGyroTolerance;
+
+        if ( converged || accel.n >= kMaxNbrReadings )
+        {
+            break;
+        }
+
+        // Wait for the FIFOs to refill
+        delay( neededDelay );
+    }
+
+    if ( zero->fromEeprom )
+    {
+        zero->accel = stored.accel;
+        zero->gyro = stored.gyro;
+    }
+    else
+    {
+        zero->accel = roundToInt( accel.mean );
+        zero->gyro = roundToInt( gyro.mean );
+
+        if ( converged )
+        {
+            // For next time (clearing any padding, which the checksum covers)
+            memset( static_cast<void*>( &stored ), 0, sizeof( stored ) );
+            stored.signature = kSignature;
+            stored.tempC = tempC;
+            stored.accel = zero->accel;
+            stored.gyro = zero->gyro;
+            stored.checksum = computeChecksum( &stored, kChecksummedSize, kSignature );
+            eeprom_update_block( &stored, &mEepromZeroPoints, sizeof( stored ) );
+        }
+    }
+
+    magSum /= nbrMag;
+    zero->mag = Vector3Int( magSum.x, magSum.y, magSum.z );
+    zero->nbrReadings = accel.n;
+}
+
+
+
+
+bool SensorZeroing::agrees( const Stats& stats, const Vector3Int& zero, float tolerance )
+{
+    float limit = kReuseSigmas * getStandardError( stats ) + tolerance;
+
+    return fabs( stats.mean.x - zero.x ) <= limit
+            && fabs( stats.mean.y - zero.y ) <= limit
+            && fabs( stats.mean.z - zero.z ) <= limit;
+}
+
+
+
+Vector3Int SensorZeroing::roundToInt( const Vector3Float& v )
+{
+    return Vector3Int( lround( v.x ), lround( v.y ), lround( v.z ) );
+}
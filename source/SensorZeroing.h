@@ -0,0 +1,77 @@
+/*
+    SensorZeroing.h - Finds the accelerometer's and gyroscope's zero points
+    (their readings at rest) for the Navigator.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef SensorZeroing_h
+#define SensorZeroing_h
+
+#include <stdint.h>
+
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * The zero points are running means of the readings, taken a FIFO block at
+ * a time until their standard errors are within tolerance (or a limit on
+ * the number of readings is reached), rather than a fixed number of
+ * readings.  Quiet sensors are done in a fraction of the time.
+ *
+ * Zero points found that way are stored in EEPROM with the temperature.  If
+ * CARRT starts at a similar temperature and the first block of readings
+ * agrees with the stored zero points, those are used without further ado.
+ */
+
+namespace SensorZeroing
+{
+
+    // Running mean and variance of each axis (Welford's method)
+    struct Stats
+    {
+        uint16_t        n;
+        Vector3Float    mean;
+        Vector3Float    m2;             // sum of squared differences from the mean
+    };
+
+    void reset( Stats* stats );
+    void add( Stats* stats, const Vector3Int& reading );
+
+    // Largest standard error (of the mean) of the three axes
+    float getStandardError( const Stats& stats );
+
+
+    struct ZeroPoints
+    {
+        Vector3Int      accel;
+        Vector3Int      gyro;
+        Vector3Int      mag;            // average reading (not a zero point, but taken alongside)
+        uint16_t        nbrReadings;
+        bool            fromEeprom;
+    };
+
+    // Read the sensors (CARRT must be at rest)
+    void findZeroPoints( ZeroPoints* zero );
+
+};
+
+
+#endif
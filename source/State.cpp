@@ -25,6 +25,63 @@
 
 
 
+namespace
+{
+
+    union StateArenaSlot
+    {
+        uint8_t     bytes[ kCarrtStateArenaSlotSize ];
+
+        // Alignment for whatever a state holds
+        void*       alignPtr;
+        long        alignLong;
+        float       alignFloat;
+    };
+
+    const uint8_t kNbrStateArenaSlots = 2;
+
+    StateArenaSlot  sStateArena[ kNbrStateArenaSlots ];
+    bool            sSlotInUse[ kNbrStateArenaSlots ];
+
+};
+
+
+
+
+void* State::operator new( size_t size ) noexcept
+{
+    if ( size > kCarrtStateArenaSlotSize )
+    {
+        return 0;
+    }
+
+    for ( uint8_t i = 0; i < kNbrStateArenaSlots; ++i )
+    {
+        if ( !sSlotInUse[i] )
+        {
+            sSlotInUse[i] = true;
+            return sStateArena[i].bytes;
+        }
+    }
+
+    return 0;
+}
+
+
+
+void State::operator delete( void* p )
+{
+    for ( uint8_t i = 0; i < kNbrStateArenaSlots; ++i )
+    {
+        if ( p == sStateArena[i].bytes )
+        {
+            sSlotInUse[i] = false;
+        }
+    }
+}
+
+
+
 
 // onEntry() Set up the state
 void State::onEntry()
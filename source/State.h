@@ -25,12 +25,39 @@
 #define State_h
 
 #include <inttypes.h>
+#include <stddef.h>
+
+
+
+// States live in a two-slot arena rather than on the heap (which is left to path
+// search):  only the outgoing and incoming states are ever alive at once.  Each
+// slot must hold the largest state; CARRT_CHECK_STATE_SIZE() checks that at
+// compile time, so every state class that is created with new must be listed
+// in its module.  (Host builds have wider ints and pointers, hence more room.)
+
+#ifndef kCarrtStateArenaSlotSize
+#if __AVR__
+#define kCarrtStateArenaSlotSize        112
+#else
+#define kCarrtStateArenaSlotSize        192
+#endif
+#endif
+
+#define CARRT_CHECK_STATE_SIZE( S )                                             \
+    static_assert( sizeof( S ) <= kCarrtStateArenaSlotSize,                     \
+                   #S " is too big for a state arena slot (kCarrtStateArenaSlotSize)" )
+
 
 
 class State
 {
 public:
 
+    // Allocate from the state arena; returns 0 if both slots are in use (or the
+    // state is too big), which changeState() turns into an error state
+    static void* operator new( size_t size ) noexcept;
+    static void operator delete( void* p );
+
     // onEntry() Set up the state
     virtual void onEntry();
 
@@ -47,4 +74,15 @@ public:
 };
 
 
+
+// Identifies the class of a state without RTTI:  the address of its vtable, which
+// is the first word of the object (states use single inheritance only).  Look the
+// address up in the ELF symbol table (e.g., avr-nm -C Carrt.elf | grep vtable).
+
+inline uint16_t getStateClassKey( const State* state )
+{
+    return static_cast<uint16_t>( reinterpret_cast<uintptr_t>( *reinterpret_cast<const void* const*>( state ) ) );
+}
+
+
 #endif
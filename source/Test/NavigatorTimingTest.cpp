@@ -24,6 +24,9 @@
 #include "AVRTools/SystemClock.h"
 #include "AVRTools/USART0.h"
 
+#include "EventClock.h"
+#include "EventManager.h"
+#include "ImuSampler.h"
 #include "Navigator.h"
 
 #include "Drivers/LSM303DLHC.h"
@@ -32,6 +35,9 @@
 
 
 
+unsigned long timeOneNavUpdate( unsigned long* busy );
+
+
 
 
 int main()
@@ -52,60 +58,83 @@ int main()
     out.println( "Nav update timing test..." );
 
     out.println( "Navigator initializing..." );
+    EventManager::init();
     Navigator::init();
 
     out.println( "Start timing..." );
 
     const int kN = 200;
 
-    // Compute overhead
-    unsigned long overhead = 0;
-    for ( int n = 0; n < kN; ++n )
-    {
-        unsigned long t0 = millis();
-        overhead += millis() - t0;
-    }
-    overhead /= kN;
-
-    out.print( "Overhead is:  " );
-    out.print( overhead / kN );
-    out.println( " ms" );
-
     while ( 1 )
     {
         // Time the navigator
         Navigator::movingStraight();
+        unsigned long busy = 0;
         unsigned long timing = 0;
         for ( int n = 0; n < kN; ++n )
         {
-            unsigned long t0 = millis();
-            Navigator::doNavUpdate();
-            timing += millis() - t0;
+            timing += timeOneNavUpdate( &busy );
         }
-        timing -= overhead;
-        float timingF = static_cast<float>( timing ) / kN;
 
         out.print( "Timing of a moving straight Nav Update is:  " );
-        out.print( timingF );
+        out.print( static_cast<float>( timing ) / kN / 1000 );
+        out.print( " ms, of which the event loop was busy " );
+        out.print( static_cast<float>( busy ) / kN / 1000 );
         out.println( " ms" );
 
         // Time the navigator
         Navigator::movingTurning();
+        busy = 0;
         timing = 0;
         for ( int n = 0; n < kN; ++n )
         {
-            unsigned long t0 = millis();
-            Navigator::doNavUpdate();
-            timing += millis() - t0;
+            timing += timeOneNavUpdate( &busy );
         }
-        timing -= overhead;
-        timingF = static_cast<float>( timing ) / kN;
 
         out.print( "Timing of a moving turning Nav Update is:  " );
-        out.print( timingF );
+        out.print( static_cast<float>( timing ) / kN / 1000 );
+        out.print( " ms, of which the event loop was busy " );
+        out.print( static_cast<float>( busy ) / kN / 1000 );
         out.println( " ms" );
 
         out.println();
     }
 }
 
+
+
+
+unsigned long timeOneNavUpdate( unsigned long* busy )
+{
+    // Time from the update's start to its sample being integrated (in us); add to busy the
+    // time the event loop actually spent on it (the rest it could spend on other events)
+
+    unsigned long t0 = micros();
+    Navigator::doNavUpdate( EventClock::kSecondsPerTick );
+    *busy += micros() - t0;
+
+    uint8_t event;
+    int16_t param;
+    while ( !EventManager::getNextEvent( &event, &param ) )
+    {
+        if ( !ImuSampler::isBusy() )
+        {
+            // A read failed and the sample was skipped
+            return micros() - t0;
+        }
+
+        if ( ImuSampler::isPollNeeded() )
+        {
+            unsigned long t1 = micros();
+            ImuSampler::poll();
+            *busy += micros() - t1;
+        }
+    }
+
+    unsigned long t1 = micros();
+    Navigator::doNavSampleReady( param );
+    unsigned long t2 = micros();
+    *busy += t2 - t1;
+
+    return t2 - t0;
+}
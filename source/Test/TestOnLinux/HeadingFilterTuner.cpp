@@ -0,0 +1,105 @@
+/*
+    HeadingFilterTuner.cpp - Fit the HeadingFilter's noise parameters to
+    logged runs.
+
+    Usage:  HeadingFilterTuner [nav-log ...]
+
+    Each log (or stdin) is the serial output of a run with the Navigator's
+    debug table turned on (CARRT_ENABLE_NAVIGATOR_DEBUG); other output in it
+    is skipped.  The fitted parameters are printed ready to paste in as
+    HeadingFilter's defaults.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "HeadingFilter.h"
+#include "HeadingFilterTuning.h"
+
+
+
+
+void printParams( const char* label, const HeadingFilter::NoiseParams& params, double fit );
+
+
+
+
+int main( int argc, char** argv )
+{
+    std::vector<HeadingFilterTuning::LogEntry> entries;
+
+    if ( argc > 1 )
+    {
+        for ( int i = 1; i < argc; ++i )
+        {
+            std::ifstream logFile( argv[i] );
+            if ( !logFile )
+            {
+                std::cerr << "Can't open " << argv[i] << std::endl;
+                return 1;
+            }
+            int n = HeadingFilterTuning::readNavLog( logFile, &entries );
+            std::cout << argv[i] << ": " << n << " nav updates" << std::endl;
+        }
+    }
+    else
+    {
+        int n = HeadingFilterTuning::readNavLog( std::cin, &entries );
+        std::cout << "stdin: " << n << " nav updates" << std::endl;
+    }
+
+    if ( entries.empty() )
+    {
+        std::cerr << "No nav updates found" << std::endl;
+        return 1;
+    }
+
+    // Several logs are replayed back to back, as one run; the jumps between them
+    // are mostly gated out and cost only a few updates' worth of fit
+    HeadingFilter::NoiseParams start = HeadingFilter::getNoiseParams();
+    printParams( "Current", start, HeadingFilterTuning::computeNegLogLikelihood( entries, start ) );
+
+    HeadingFilter::NoiseParams fitted = HeadingFilterTuning::fitNoiseParams( entries, start );
+    printParams( "Fitted", fitted, HeadingFilterTuning::computeNegLogLikelihood( entries, fitted ) );
+
+    std::cout << std::endl << "    const NoiseParams kDefaultNoiseParams = { "
+              << fitted.gyroNoise << ", " << fitted.biasNoise << ", "
+              << fitted.compassNoise << ", " << fitted.compassNoiseTurning << " };" << std::endl;
+
+    for ( int turning = 0; turning < 2; ++turning )
+    {
+        const HeadingFilter::Gains& gains = HeadingFilter::getGains( turning );
+        std::cout << ( turning ? "Turning" : "Straight" ) << " gains:  heading " << gains.heading
+                  << ", bias " << gains.bias << ", innovation sigma " << gains.innovationSigma << std::endl;
+    }
+
+    return 0;
+}
+
+
+
+
+void printParams( const char* label, const HeadingFilter::NoiseParams& params, double fit )
+{
+    std::cout << label << ":  gyro " << params.gyroNoise << ", bias " << params.biasNoise
+              << ", compass " << params.compassNoise << ", compass turning " << params.compassNoiseTurning
+              << ";  -log likelihood " << fit << std::endl;
+}
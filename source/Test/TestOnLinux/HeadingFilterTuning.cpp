@@ -0,0 +1,221 @@
+/*
+    HeadingFilterTuning.cpp - Fit the HeadingFilter's noise parameters to the
+    Navigator's debug log of a run.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "HeadingFilterTuning.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+
+
+
+
+namespace
+{
+    const int   kTurnMove           = 0x10;         // Navigator's kTurnMove
+
+    // The bias and heading take this many updates to settle from a reset
+    const int   kNbrSettlingUpdates = 40;
+
+    const double kSmallestParam     = 1e-4;
+    const double kLargestParam      = 100;
+
+
+    std::vector<std::string> split( const std::string& line );
+    int findColumn( const std::vector<std::string>& names, const char* name );
+};
+
+
+
+
+int HeadingFilterTuning::readNavLog( std::istream& in, std::vector<LogEntry>* entries )
+{
+    int nbrRead = 0;
+    int nbrColumns = 0;
+    int compass = -1;
+    int gyro = -1;
+    int timeStep = -1;
+    int move = -1;
+    float angleScale = 1;
+    float timeStepScale = 1;
+
+    std::string line;
+    while ( std::getline( in, line ) )
+    {
+        std::vector<std::string> fields = split( line );
+        if ( fields.size() < 2 )
+        {
+            continue;
+        }
+
+        if ( fields[0] == "time" )
+        {
+            // A (new) header
+            bool fixedPoint = findColumn( fields, "chdg-cd" ) >= 0;
+            compass = findColumn( fields, fixedPoint ? "chdg-cd" : "chdg" );
+            gyro = findColumn( fields, fixedPoint ? "del-g-cd" : "del-g" );
+            timeStep = findColumn( fields, fixedPoint ? "dt-q12" : "dt" );
+            move = findColumn( fields, "move" );
+            angleScale = fixedPoint ? 0.01 : 1.0;
+            timeStepScale = fixedPoint ? 1.0 / 4096 : 1.0;
+
+            bool usable = ( compass >= 0 && gyro >= 0 && timeStep >= 0 );
+            nbrColumns = usable ? fields.size() : 0;
+            continue;
+        }
+
+        if ( !nbrColumns || static_cast<int>( fields.size() ) != nbrColumns || fields[1] != "doNavUpdate" )
+        {
+            continue;
+        }
+
+        LogEntry entry;
+        entry.compassHeading = atof( fields[compass].c_str() ) * angleScale;
+        entry.gyroChange = atof( fields[gyro].c_str() ) * angleScale;
+        entry.timeStep = atof( fields[timeStep].c_str() ) * timeStepScale;
+        entry.turning = ( move >= 0 ) && ( atoi( fields[move].c_str() ) == kTurnMove );
+        entries->push_back( entry );
+        ++nbrRead;
+    }
+
+    return nbrRead;
+}
+
+
+
+double HeadingFilterTuning::computeNegLogLikelihood( const std::vector<LogEntry>& entries,
+                                                     const HeadingFilter::NoiseParams& params )
+{
+    if ( entries.empty() )
+    {
+        return 0;
+    }
+
+    HeadingFilter::setNoiseParams( params );
+
+    HeadingFilter::State state;
+    HeadingFilter::reset( &state, entries[0].compassHeading );
+
+    double sum = 0;
+    for ( size_t i = 1; i < entries.size(); ++i )
+    {
+        const LogEntry& e = entries[i];
+        float innovation = HeadingFilter::update( &state, e.gyroChange, e.compassHeading, e.timeStep, e.turning );
+
+        if ( i > kNbrSettlingUpdates )
+        {
+            double sigma = HeadingFilter::getGains( e.turning ).innovationSigma;
+            double normalized = fmin( fabs( innovation ) / sigma, HeadingFilter::kGateSigmas );
+            sum += 2 * log( sigma ) + normalized * normalized;
+        }
+    }
+
+    return sum;
+}
+
+
+
+HeadingFilter::NoiseParams HeadingFilterTuning::fitNoiseParams( const std::vector<LogEntry>& entries,
+                                                                const HeadingFilter::NoiseParams& start )
+{
+    HeadingFilter::NoiseParams best = start;
+    double bestFit = computeNegLogLikelihood( entries, best );
+
+    // Coordinate search, halving the (log) step when no move helps
+    float* const params[] = { &best.gyroNoise, &best.biasNoise, &best.compassNoise, &best.compassNoiseTurning };
+    const int kNbrParams = sizeof( params ) / sizeof( params[0] );
+
+    for ( double step = 2.0; step > 1.02; step = sqrt( step ) )
+    {
+        bool improved = true;
+        while ( improved )
+        {
+            improved = false;
+            for ( int i = 0; i < kNbrParams; ++i )
+            {
+                const double factors[] = { step, 1 / step };
+                for ( double factor : factors )
+                {
+                    float original = *params[i];
+                    double trial = original * factor;
+                    if ( trial < kSmallestParam || trial > kLargestParam )
+                    {
+                        continue;
+                    }
+
+                    *params[i] = trial;
+                    double fit = computeNegLogLikelihood( entries, best );
+                    if ( fit < bestFit )
+                    {
+                        bestFit = fit;
+                        improved = true;
+                        break;
+                    }
+                    *params[i] = original;
+                }
+            }
+        }
+    }
+
+    // Leave the filter as found best
+    HeadingFilter::setNoiseParams( best );
+
+    return best;
+}
+
+
+
+
+namespace
+{
+
+std::vector<std::string> split( const std::string& line )
+{
+    std::vector<std::string> fields;
+    std::istringstream in( line );
+    std::string field;
+    while ( std::getline( in, field, ',' ) )
+    {
+        size_t first = field.find_first_not_of( " \t\r" );
+        size_t last = field.find_last_not_of( " \t\r" );
+        fields.push_back( first == std::string::npos ? "" : field.substr( first, last - first + 1 ) );
+    }
+    return fields;
+}
+
+
+
+int findColumn( const std::vector<std::string>& names, const char* name )
+{
+    for ( size_t i = 0; i < names.size(); ++i )
+    {
+        if ( names[i] == name )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+};
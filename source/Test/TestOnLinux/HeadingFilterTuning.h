@@ -0,0 +1,71 @@
+/*
+    HeadingFilterTuning.h - Fit the HeadingFilter's noise parameters to the
+    Navigator's debug log of a run.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HeadingFilterTuning_h
+#define HeadingFilterTuning_h
+
+#include <istream>
+#include <vector>
+
+#include "HeadingFilter.h"
+
+
+
+/*
+ * The log is the serial output of a build with CARRT_ENABLE_NAVIGATOR_DEBUG:
+ * the Navigator's table header followed by a row per nav update.  Columns
+ * are found by name, so logs from the floating point and fixed-point
+ * Navigators both work (the latter in centi-degrees and Q4.12 seconds).
+ *
+ * The fit replays the log through the filter and minimizes the innovations'
+ * negative log-likelihood, sum( log( S ) + y^2 / S ), where y is an
+ * innovation and S its variance as the filter predicts it.  Innovations
+ * beyond the gate count as if they were on it, so compass disturbances
+ * don't pull the fit.
+ */
+
+namespace HeadingFilterTuning
+{
+
+    struct LogEntry
+    {
+        float   gyroChange;         // deg
+        float   compassHeading;     // deg
+        float   timeStep;           // s
+        bool    turning;
+    };
+
+
+    // Appends the entries in the log to entries; returns the number read (0 if there is no header)
+    int readNavLog( std::istream& in, std::vector<LogEntry>* entries );
+
+    // Replays the log through the filter, which is left set to params
+    double computeNegLogLikelihood( const std::vector<LogEntry>& entries, const HeadingFilter::NoiseParams& params );
+
+    // Searches (in log steps) from start for the parameters minimizing the above
+    HeadingFilter::NoiseParams fitNoiseParams( const std::vector<LogEntry>& entries,
+                                               const HeadingFilter::NoiseParams& start );
+
+};
+
+
+#endif
@@ -0,0 +1,200 @@
+/*
+    HostMain.cpp - Run CARRT on a Linux host against simulated hardware,
+    driven by a script of key presses, printing what the display shows.
+
+    Usage:  CarrtHost [script]
+
+    The script (or stdin) holds one command per line ('#' starts a comment):
+
+        <ms> <keys> [holdMs]    press keys (e.g., "select", "down", "left+right")
+                                at virtual time ms, for holdMs (default 150)
+        pose <x> <y> <heading>  place the robot (meters, compass degrees)
+        room <halfX> <halfY>    walls at +/- halfX and +/- halfY meters
+        end <ms>                stop at virtual time ms (default 60000)
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "HostSim.h"
+
+#include "MainProcess.h"
+
+#include "Drivers/Keypad.h"
+
+
+
+
+bool readScript( std::istream& in, uint32_t* endMs );
+int parseKeys( const std::string& keys );
+void showDisplay( uint32_t ms, const char* topRow, const char* bottomRow );
+
+
+
+
+int main( int argc, char** argv )
+{
+    HostSim::init();
+
+    std::ifstream scriptFile;
+    if ( argc > 1 )
+    {
+        scriptFile.open( argv[1] );
+        if ( !scriptFile )
+        {
+            std::cerr << "Can't open " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+    std::istream& script = ( argc > 1 ) ? static_cast<std::istream&>( scriptFile ) : std::cin;
+
+    uint32_t endMs = 60000;
+    if ( !readScript( script, &endMs ) )
+    {
+        return 1;
+    }
+
+    HostSim::setDisplayListener( showDisplay );
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    int err = HostSim::runCarrt( endMs );
+
+    double wallSecs = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    double virtualSecs = HostSim::getMicros() / 1e6;
+
+    if ( err )
+    {
+        std::cout << "CARRT halted with unrecoverable error " << err << std::endl;
+    }
+
+    const HostSim::Pose& pose = HostSim::getPose();
+    const MainProcess::LoopStats& stats = MainProcess::getLoopStats();
+
+    std::printf( "\nRobot at x %.2f m, y %.2f m, heading %.1f\n", pose.x, pose.y, pose.heading );
+    std::printf( "Event loop:  %u iterations, %u sleeps, %.1f%% asleep\n",
+                 stats.loopIterations, HostSim::getNbrSleeps(), 100.0 * HostSim::getMicrosAsleep() / HostSim::getMicros() );
+    std::printf( "Ran %.1f s of CARRT time in %.3f s (%.0fx real time)\n",
+                 virtualSecs, wallSecs, wallSecs > 0 ? virtualSecs / wallSecs : 0.0 );
+
+    return err ? 2 : 0;
+}
+
+
+
+
+bool readScript( std::istream& in, uint32_t* endMs )
+{
+    std::string line;
+    int lineNbr = 0;
+    while ( std::getline( in, line ) )
+    {
+        ++lineNbr;
+
+        std::string::size_type comment = line.find( '#' );
+        if ( comment != std::string::npos )
+        {
+            line.erase( comment );
+        }
+
+        std::istringstream fields( line );
+        std::string first;
+        if ( !( fields >> first ) )
+        {
+            continue;
+        }
+
+        bool okay = true;
+        if ( first == "end" )
+        {
+            okay = static_cast<bool>( fields >> *endMs );
+        }
+        else if ( first == "pose" )
+        {
+            HostSim::Pose pose;
+            okay = static_cast<bool>( fields >> pose.x >> pose.y >> pose.heading );
+            HostSim::setPose( pose );
+        }
+        else if ( first == "room" )
+        {
+            double halfX;
+            double halfY;
+            okay = static_cast<bool>( fields >> halfX >> halfY );
+            HostSim::setRoom( halfX, halfY );
+        }
+        else
+        {
+            std::string keys;
+            uint16_t holdMs = 150;
+            okay = static_cast<bool>( fields >> keys );
+            fields >> holdMs;
+
+            int buttons = parseKeys( keys );
+            okay = okay && buttons > 0;
+            if ( okay )
+            {
+                HostSim::pressKeys( std::stoul( first ), buttons, holdMs );
+            }
+        }
+
+        if ( !okay )
+        {
+            std::cerr << "Bad script line " << lineNbr << ": " << line << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+int parseKeys( const std::string& keys )
+{
+    int buttons = 0;
+
+    std::istringstream names( keys );
+    std::string name;
+    while ( std::getline( names, name, '+' ) )
+    {
+        if ( name == "select" )         buttons |= Keypad::kButton_Select;
+        else if ( name == "right" )     buttons |= Keypad::kButton_Right;
+        else if ( name == "down" )      buttons |= Keypad::kButton_Down;
+        else if ( name == "up" )        buttons |= Keypad::kButton_Up;
+        else if ( name == "left" )      buttons |= Keypad::kButton_Left;
+        else if ( name == "reset" )     buttons |= Keypad::kChord_Reset;
+        else                            return -1;
+    }
+
+    return buttons;
+}
+
+
+
+
+void showDisplay( uint32_t ms, const char* topRow, const char* bottomRow )
+{
+    std::printf( "%9.3f  |%s|  |%s|\n", ms / 1000.0, topRow, bottomRow );
+}
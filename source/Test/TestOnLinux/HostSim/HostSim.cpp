@@ -0,0 +1,1005 @@
+/*
+    HostSim.cpp - Runs CARRT's real event loop and states on a Linux host, against
+    simulated hardware and a virtual clock.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "HostSim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "AVRTools/MemUtils.h"
+#include "AVRTools/SystemClock.h"
+
+#include "DriveProgram.h"
+#include "ErrorState.h"
+#include "ErrorUnrecoverable.h"
+#include "EventClock.h"
+#include "EventManager.h"
+#include "ImuSampler.h"
+#include "MainProcess.h"
+#include "Navigator.h"
+#include "SensorLog.h"
+#include "TimerService.h"
+#include "TraceRecorder.h"
+
+#include "Drivers/Battery.h"
+#include "Drivers/Beep.h"
+#include "Drivers/Display.h"
+#include "Drivers/DriveParam.h"
+#include "Drivers/L3GD20.h"
+#include "Drivers/Lidar.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/Motors.h"
+
+
+
+
+namespace HostSim
+{
+    const uint32_t  kSystemTickMicros       = 1000;
+    const uint32_t  kEventClockTickMicros   = 1000000 / kCarrtEventClockHz;
+
+    // Virtual time charged for reading the system clock (keeps busy-wait loops finite)
+    const uint32_t  kClockReadMicros        = 4;
+
+    // Turn rate at full speed, degrees per second
+    const double    kFullSpeedTurnRate      = 90.0;
+
+    // How close the robot's center can get to a wall, meters
+    const double    kBumperMeters           = 0.15;
+
+    const double    kDegreesToRadians       = M_PI / 180.0;
+
+    // The navigation sensors' update rates (as CARRT sets them) and FIFO size
+    const uint32_t  kGyroReadingMicros      = 1000000 / 190;
+    const uint32_t  kAccelReadingMicros     = 1000000 / 100;
+    const uint8_t   kSensorFifoSize         = 32;
+
+    // The servo's pulse rate (as CARRT sets it) and how fast it turns, degrees per second
+    const uint32_t  kServoPulseMicros       = 1000000 / 60;
+    const double    kServoTurnRate          = 400.0;
+
+
+    struct SensorFifo
+    {
+        double      readings[ kSensorFifoSize ];
+        uint8_t     first;
+        uint8_t     level;
+        uint64_t    nextReading;
+    };
+
+
+    struct KeyPress
+    {
+        uint32_t    startMs;
+        uint32_t    endMs;
+        uint8_t     buttons;
+    };
+
+
+    uint64_t        sNow;
+    uint64_t        sEndOfRun;
+    bool            sInterruptsOn;
+
+    bool            sEventClockRunning;
+    bool            sEventClockPending;
+    uint64_t        sNextEventClockTick;
+    uint64_t        sEventClockMicros;
+
+    uint32_t        sNbrSleeps;
+    uint64_t        sMicrosAsleep;
+
+    std::vector<KeyPress>   sKeyPresses;
+
+    char            sDisplay[2][17];
+    bool            sDisplayChanged;
+    DisplayListener sDisplayListener;
+
+    SensorLogListener   sSensorLogListener;
+
+    double          sHalfLengthX;
+    double          sHalfLengthY;
+    Pose            sPose;
+    double          sSpeed;
+    double          sTurnRate;
+    double          sTempC;
+
+    double          sServoAngle;
+    double          sServoTarget;
+    double          sServoCommand;
+    bool            sServoCommandPending;
+    uint64_t        sServoCommandAt;
+    uint64_t        sServoUpdated;
+
+    NavSensorReadings   sNavSensorReadings;
+    bool                sNavSensorReadingsFixed;
+
+    SensorFifo      sGyroFifo;
+    SensorFifo      sAccelFifo;
+
+
+    void advanceTo( uint64_t t );
+    void runEventClockIsr();
+    void moveRobot( double seconds );
+    void moveServo( uint64_t t );
+    void turnServo( uint64_t us );
+    void takeReadings();
+    void resetFifo( SensorFifo* fifo, uint32_t interval );
+    void pushFifo( SensorFifo* fifo, double reading, uint32_t interval );
+    double popFifo( SensorFifo* fifo );
+    void notifyDisplayListener();
+    void bootCarrt();
+    void doResetActions();
+    bool getNavSample( int16_t* sample );
+};
+
+
+
+
+void HostSim::init()
+{
+    sNow = 0;
+    sEndOfRun = ~0ULL;
+    sInterruptsOn = true;
+
+    sEventClockRunning = false;
+    sEventClockPending = false;
+    sNextEventClockTick = 0;
+    sEventClockMicros = 0;
+
+    sNbrSleeps = 0;
+    sMicrosAsleep = 0;
+
+    sKeyPresses.clear();
+
+    clearDisplay();
+    sDisplayChanged = false;
+    sDisplayListener = 0;
+    sSensorLogListener = 0;
+
+    sHalfLengthX = 2.0;
+    sHalfLengthY = 2.0;
+    sPose.x = 0;
+    sPose.y = 0;
+    sPose.heading = 0;
+    sSpeed = 0;
+    sTurnRate = 0;
+    sTempC = 20.0;
+    sNavSensorReadingsFixed = false;
+
+    sServoAngle = 0;
+    sServoTarget = 0;
+    sServoCommand = 0;
+    sServoCommandPending = false;
+    sServoCommandAt = 0;
+    sServoUpdated = 0;
+
+    resetFifo( &sGyroFifo, kGyroReadingMicros );
+    resetFifo( &sAccelFifo, kAccelReadingMicros );
+}
+
+
+
+
+int HostSim::runCarrt( uint32_t endMs )
+{
+    sEndOfRun = static_cast<uint64_t>( endMs ) * 1000;
+
+    try
+    {
+        // Run/Reset loop
+        while ( 1 )
+        {
+            bootCarrt();
+
+            // Start with no software timers running (states start them as needed)
+            TimerService::init( EventClock::getMilliseconds() );
+
+            ErrorState errorState;
+            MainProcess::init( &errorState );
+
+            Beep::readyChime();
+
+            EventClock::init();
+
+            // Only ever returns on a reset
+            MainProcess::runEventLoop();
+
+            doResetActions();
+        }
+    }
+    catch ( EndOfRun& )
+    {
+        notifyDisplayListener();
+        return 0;
+    }
+    catch ( UnrecoverableError& e )
+    {
+        notifyDisplayListener();
+        return e.errorCode;
+    }
+}
+
+
+
+
+void HostSim::pressKeys( uint32_t atMs, uint8_t buttons, uint16_t holdMs )
+{
+    KeyPress k;
+    k.startMs = atMs;
+    k.endMs = atMs + holdMs;
+    k.buttons = buttons;
+    sKeyPresses.push_back( k );
+}
+
+
+
+uint8_t HostSim::getKeysDown()
+{
+    uint32_t now = getMillis();
+    uint8_t buttons = 0;
+    for ( size_t i = 0; i < sKeyPresses.size(); ++i )
+    {
+        if ( sKeyPresses[i].startMs <= now && now < sKeyPresses[i].endMs )
+        {
+            buttons |= sKeyPresses[i].buttons;
+        }
+    }
+    return buttons;
+}
+
+
+
+
+void HostSim::setDisplayListener( DisplayListener listener )
+{
+    sDisplayListener = listener;
+}
+
+
+
+void HostSim::setSensorLogListener( SensorLogListener listener )
+{
+    sSensorLogListener = listener;
+}
+
+
+
+const char* HostSim::getDisplayTopRow()
+{
+    return sDisplay[0];
+}
+
+
+
+const char* HostSim::getDisplayBottomRow()
+{
+    return sDisplay[1];
+}
+
+
+
+void HostSim::writeDisplay( uint8_t row, uint8_t col, const char* str, uint8_t len )
+{
+    if ( row > 1 )
+    {
+        return;
+    }
+
+    for ( uint8_t i = 0; i < len && col + i < 16; ++i )
+    {
+        if ( sDisplay[row][col + i] != str[i] )
+        {
+            sDisplay[row][col + i] = str[i];
+            sDisplayChanged = true;
+        }
+    }
+}
+
+
+
+void HostSim::clearDisplay()
+{
+    for ( int row = 0; row < 2; ++row )
+    {
+        memset( sDisplay[row], ' ', 16 );
+        sDisplay[row][16] = 0;
+    }
+    sDisplayChanged = true;
+}
+
+
+
+
+void HostSim::setRoom( double halfLengthX, double halfLengthY )
+{
+    sHalfLengthX = halfLengthX;
+    sHalfLengthY = halfLengthY;
+}
+
+
+
+void HostSim::setPose( const Pose& pose )
+{
+    sPose = pose;
+}
+
+
+
+const HostSim::Pose& HostSim::getPose()
+{
+    return sPose;
+}
+
+
+
+void HostSim::setTempC( double tempC )
+{
+    sTempC = tempC;
+}
+
+
+
+double HostSim::getTempC()
+{
+    return sTempC;
+}
+
+
+
+void HostSim::setNavSensorReadings( const NavSensorReadings* readings )
+{
+    sNavSensorReadingsFixed = readings;
+    if ( readings )
+    {
+        sNavSensorReadings = *readings;
+    }
+}
+
+
+
+const HostSim::NavSensorReadings* HostSim::getNavSensorReadings()
+{
+    return sNavSensorReadingsFixed ? &sNavSensorReadings : 0;
+}
+
+
+
+void HostSim::setMotors( MotorMotion motion, uint8_t speed )
+{
+    double fraction = speed / static_cast<double>( Motors::kFullSpeed );
+
+    sSpeed = 0;
+    sTurnRate = 0;
+    switch ( motion )
+    {
+        case kMotorsForward:
+            sSpeed = DriveParam::getFullSpeedMetersPerSec() * fraction;
+            break;
+
+        case kMotorsBackward:
+            sSpeed = -DriveParam::getFullSpeedMetersPerSec() * fraction;
+            break;
+
+        case kMotorsRotateLeft:
+            sTurnRate = -kFullSpeedTurnRate * fraction;
+            break;
+
+        case kMotorsRotateRight:
+            sTurnRate = kFullSpeedTurnRate * fraction;
+            break;
+
+        case kMotorsStopped:
+            break;
+    }
+}
+
+
+
+double HostSim::getTurnRate()
+{
+    return sTurnRate;
+}
+
+
+
+double HostSim::getSpeed()
+{
+    return sSpeed;
+}
+
+
+
+uint8_t HostSim::getGyroFifoLevel()
+{
+    return sGyroFifo.level;
+}
+
+
+
+double HostSim::popGyroFifo()
+{
+    // An empty FIFO just gives the current rate
+    return sGyroFifo.level ? popFifo( &sGyroFifo ) : sTurnRate;
+}
+
+
+
+uint8_t HostSim::getAccelFifoLevel()
+{
+    return sAccelFifo.level;
+}
+
+
+
+void HostSim::popAccelFifo()
+{
+    if ( sAccelFifo.level )
+    {
+        popFifo( &sAccelFifo );
+    }
+}
+
+
+
+double HostSim::getRangeCm( double angle )
+{
+    // N -> x; W -> y; compass angles run clockwise
+    double rad = ( sPose.heading + angle ) * kDegreesToRadians;
+    double ux = cos( rad );
+    double uy = -sin( rad );
+
+    double range = 1e9;
+    if ( ux > 1e-9 )
+    {
+        range = fmin( range, ( sHalfLengthX - sPose.x ) / ux );
+    }
+    else if ( ux < -1e-9 )
+    {
+        range = fmin( range, ( -sHalfLengthX - sPose.x ) / ux );
+    }
+    if ( uy > 1e-9 )
+    {
+        range = fmin( range, ( sHalfLengthY - sPose.y ) / uy );
+    }
+    else if ( uy < -1e-9 )
+    {
+        range = fmin( range, ( -sHalfLengthY - sPose.y ) / uy );
+    }
+
+    return 100 * range;
+}
+
+
+
+void HostSim::setServo( double angle )
+{
+    moveServo( sNow );
+
+    // The servo sees the new pulse width at the start of its next pulse
+    sServoCommand = angle;
+    sServoCommandPending = true;
+    sServoCommandAt = ( sNow / kServoPulseMicros + 1 ) * kServoPulseMicros;
+}
+
+
+
+double HostSim::getServoAngle()
+{
+    moveServo( sNow );
+    return sServoAngle;
+}
+
+
+
+void HostSim::moveServo( uint64_t t )
+{
+    if ( sServoCommandPending && sServoCommandAt <= t )
+    {
+        turnServo( sServoCommandAt - sServoUpdated );
+        sServoUpdated = sServoCommandAt;
+        sServoTarget = sServoCommand;
+        sServoCommandPending = false;
+    }
+
+    turnServo( t - sServoUpdated );
+    sServoUpdated = t;
+}
+
+
+
+void HostSim::turnServo( uint64_t us )
+{
+    double most = kServoTurnRate * us / 1e6;
+    double turn = sServoTarget - sServoAngle;
+
+    sServoAngle += fmax( -most, fmin( most, turn ) );
+}
+
+
+
+
+uint64_t HostSim::getMicros()
+{
+    return sNow;
+}
+
+
+
+void HostSim::spendMicros( uint32_t us )
+{
+    advanceTo( sNow + us );
+}
+
+
+
+uint32_t HostSim::getNbrSleeps()
+{
+    return sNbrSleeps;
+}
+
+
+
+uint64_t HostSim::getMicrosAsleep()
+{
+    return sMicrosAsleep;
+}
+
+
+
+
+bool HostSim::doNavTick( int16_t* sample )
+{
+    spendMicros( kEventClockTickMicros );
+
+    // Starts the sampler while moving, otherwise only adds to the pose history
+    Navigator::doNavUpdate( EventClock::kSecondsPerTick );
+
+    int16_t param;
+    if ( !getNavSample( &param ) )
+    {
+        return false;
+    }
+
+    Navigator::doNavSampleReady( param );
+    if ( sample )
+    {
+        *sample = param;
+    }
+    return true;
+}
+
+
+
+bool HostSim::takeNavSample( float timeStep, int16_t* sample )
+{
+    ImuSampler::start( timeStep, static_cast<uint32_t>( sNow ) );
+    return getNavSample( sample );
+}
+
+
+
+
+bool HostSim::getNavSample( int16_t* sample )
+{
+    // The simulated bus finishes the sampler's reads as soon as it polls
+    ImuSampler::poll();
+
+    uint8_t code;
+    int16_t param;
+    if ( !EventManager::getNextEvent( &code, &param ) || code != EventManager::kNavSampleReadyEvent )
+    {
+        return false;
+    }
+
+    *sample = param;
+    return true;
+}
+
+
+
+
+/******************************************************************************/
+
+
+
+
+void HostSim::advanceTo( uint64_t t )
+{
+    while ( sNow < t )
+    {
+        uint64_t next = t;
+        if ( sEventClockRunning && sNextEventClockTick < next )
+        {
+            next = sNextEventClockTick;
+        }
+        if ( sGyroFifo.nextReading < next )
+        {
+            next = sGyroFifo.nextReading;
+        }
+        if ( sAccelFifo.nextReading < next )
+        {
+            next = sAccelFifo.nextReading;
+        }
+
+        moveRobot( ( next - sNow ) / 1e6 );
+        if ( sEventClockRunning )
+        {
+            sEventClockMicros += next - sNow;
+        }
+        sNow = next;
+
+        takeReadings();
+
+        if ( sNow >= sEndOfRun )
+        {
+            throw EndOfRun();
+        }
+
+        if ( sEventClockRunning && sNow == sNextEventClockTick )
+        {
+            sNextEventClockTick += kEventClockTickMicros;
+            if ( sInterruptsOn )
+            {
+                runEventClockIsr();
+            }
+            else
+            {
+                sEventClockPending = true;
+            }
+        }
+    }
+}
+
+
+
+void HostSim::runEventClockIsr()
+{
+    // The real EventClock's interrupt handler
+    EventClock::doTickFromIsr();
+}
+
+
+
+void HostSim::moveRobot( double seconds )
+{
+    if ( sTurnRate )
+    {
+        sPose.heading = fmod( sPose.heading + sTurnRate * seconds + 360.0, 360.0 );
+    }
+
+    if ( sSpeed )
+    {
+        double rad = sPose.heading * kDegreesToRadians;
+        sPose.x += sSpeed * seconds * cos( rad );
+        sPose.y -= sSpeed * seconds * sin( rad );
+
+        // The walls stop the robot (the wheels keep turning)
+        sPose.x = fmax( -sHalfLengthX + kBumperMeters, fmin( sHalfLengthX - kBumperMeters, sPose.x ) );
+        sPose.y = fmax( -sHalfLengthY + kBumperMeters, fmin( sHalfLengthY - kBumperMeters, sPose.y ) );
+    }
+}
+
+
+
+void HostSim::takeReadings()
+{
+    // No linear acceleration to speak of (speed changes are instantaneous)
+    if ( sNow == sGyroFifo.nextReading )
+    {
+        pushFifo( &sGyroFifo, sTurnRate, kGyroReadingMicros );
+    }
+    if ( sNow == sAccelFifo.nextReading )
+    {
+        pushFifo( &sAccelFifo, 0, kAccelReadingMicros );
+    }
+}
+
+
+
+void HostSim::resetFifo( SensorFifo* fifo, uint32_t interval )
+{
+    fifo->first = 0;
+    fifo->level = 0;
+    fifo->nextReading = sNow + interval;
+}
+
+
+
+void HostSim::pushFifo( SensorFifo* fifo, double reading, uint32_t interval )
+{
+    // Stream mode:  a full FIFO drops its oldest reading
+    if ( fifo->level == kSensorFifoSize )
+    {
+        fifo->first = ( fifo->first + 1 ) % kSensorFifoSize;
+        --fifo->level;
+    }
+
+    fifo->readings[ ( fifo->first + fifo->level ) % kSensorFifoSize ] = reading;
+    ++fifo->level;
+    fifo->nextReading += interval;
+}
+
+
+
+double HostSim::popFifo( SensorFifo* fifo )
+{
+    double reading = fifo->readings[ fifo->first ];
+    fifo->first = ( fifo->first + 1 ) % kSensorFifoSize;
+    --fifo->level;
+    return reading;
+}
+
+
+
+void HostSim::notifyDisplayListener()
+{
+    if ( sDisplayChanged && sDisplayListener )
+    {
+        sDisplayListener( getMillis(), sDisplay[0], sDisplay[1] );
+    }
+    sDisplayChanged = false;
+}
+
+
+
+void HostSim::bootCarrt()
+{
+    // CarrtMain's start-up sequence, minus the CPU and I2C set up
+
+    sInterruptsOn = true;
+
+    Beep::initBeep();
+    delayMilliseconds( 500 );
+
+    Battery::initBatteryStatusDisplay();
+    Motors::init();
+
+    Display::init();
+    Display::clear();
+    Display::displayTopRowP16( PSTR( "CARRT is" ) );
+    Display::displayBottomRowP16( PSTR( "Initializing..." ) );
+
+    Lidar::init();
+    LSM303DLHC::init();
+    L3GD20::init();
+
+    delayMilliseconds( 2000 );
+
+    Display::displayTopRowP16( PSTR( "CARRT Nav is" ) );
+    Display::displayBottomRowP16( PSTR( "Initializing..." ) );
+    Navigator::init();
+
+    DriveProgram::init();
+}
+
+
+
+void HostSim::doResetActions()
+{
+    EventClock::stop();
+    DriveProgram::purge();
+    MemUtils::resetHeap();
+}
+
+
+
+
+/******************************************************************************/
+
+// The simulated system clock, interrupt control, and sleep
+
+
+void initSystemClock()
+{
+}
+
+
+
+unsigned long millis()
+{
+    HostSim::spendMicros( HostSim::kClockReadMicros );
+    return HostSim::getMillis();
+}
+
+
+
+unsigned long micros()
+{
+    HostSim::spendMicros( HostSim::kClockReadMicros );
+    return static_cast<unsigned long>( HostSim::getMicros() );
+}
+
+
+
+void delayMilliseconds( unsigned long ms )
+{
+    // Busy waiting, so the display has settled too
+    HostSim::notifyDisplayListener();
+    HostSim::spendMicros( ms * 1000 );
+}
+
+
+
+void delayMicroseconds( unsigned int us )
+{
+    HostSim::spendMicros( us );
+}
+
+
+
+void cli()
+{
+    HostSim::sInterruptsOn = false;
+}
+
+
+
+void sei()
+{
+    HostSim::sInterruptsOn = true;
+    if ( HostSim::sEventClockPending )
+    {
+        HostSim::sEventClockPending = false;
+        HostSim::runEventClockIsr();
+    }
+}
+
+
+
+void sleep_cpu()
+{
+    using namespace HostSim;
+
+    // The CPU is idle:  a good moment to report what the display settled on
+    notifyDisplayListener();
+
+    // Sleep until the next interrupt:  the system clock tick, or the EventClock tick
+    uint64_t wake = ( sNow / kSystemTickMicros + 1 ) * kSystemTickMicros;
+    if ( sEventClockRunning && sNextEventClockTick < wake )
+    {
+        wake = sNextEventClockTick;
+    }
+
+    ++sNbrSleeps;
+    sMicrosAsleep += wake - sNow;
+    advanceTo( wake );
+}
+
+
+
+
+/******************************************************************************/
+
+// The simulated EventClock
+
+
+void EventClock::init()
+{
+    HostSim::sEventClockRunning = true;
+    HostSim::sNextEventClockTick = HostSim::sNow + HostSim::kEventClockTickMicros;
+}
+
+
+
+void EventClock::stop()
+{
+    HostSim::sEventClockRunning = false;
+    HostSim::sEventClockPending = false;
+}
+
+
+
+uint32_t EventClock::getMilliseconds()
+{
+    return static_cast<uint32_t>( HostSim::sEventClockMicros / 1000 );
+}
+
+
+
+
+/******************************************************************************/
+
+// Memory and errors
+
+
+unsigned int MemUtils::freeSRAM()
+{
+    return 2048;
+}
+
+
+
+unsigned int MemUtils::freeMemoryBetweenHeapAndStack()
+{
+    return 2048;
+}
+
+
+
+void MemUtils::resetHeap()
+{
+}
+
+
+
+#if CARRT_ENABLE_TRACE_RECORDER
+
+// Trace dumps go to the serial line, which is stdout
+
+class StdoutWriter
+{
+public:
+
+    void print( char c )            { putchar( c ); }
+    void print( long n )            { printf( "%ld", n ); }
+    void print( unsigned long n )   { printf( "%lu", n ); }
+};
+
+
+void TraceRecorder::dumpToSerial()
+{
+    StdoutWriter out;
+    dump( out, TimerService::now() );
+}
+
+#endif
+
+
+
+#if CARRT_ENABLE_SENSOR_LOG
+
+// Sensor log records go to the listener, if any
+
+void SensorLog::writeRecord( const uint8_t* record, uint8_t size )
+{
+    if ( HostSim::sSensorLogListener )
+    {
+        HostSim::sSensorLogListener( record, size );
+    }
+}
+
+#endif
+
+
+
+void handleUnrecoverableError( int errCode )
+{
+    Display::clear();
+    Display::displayTopRowP16( PSTR( "! Err = " ) );
+    Display::setCursor( 0, 9 );
+    Display::print( errCode );
+    Display::displayBottomRowP16( PSTR( "Aborting..." ) );
+
+#if CARRT_ENABLE_TRACE_RECORDER
+    TraceRecorder::record( TraceRecorder::kTraceUnrecoverableError, errCode );
+    TraceRecorder::dumpToSerial();
+#endif
+
+    throw HostSim::UnrecoverableError{ errCode };
+}
@@ -0,0 +1,189 @@
+/*
+    HostSim.h - Runs CARRT's real event loop and states on a Linux host, against
+    simulated hardware and a virtual clock.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef HostSim_h
+#define HostSim_h
+
+
+#include <stdint.h>
+
+#include "Utils/VectorUtils.h"
+
+
+
+/*
+ * Time is virtual:  it only moves when CARRT spends it.  Reading the clock,
+ * talking to a (simulated) device, delaying, or sleeping all advance it, and
+ * the simulated interrupts (the 1 ms system clock tick and the EventClock's
+ * eighth-second tick) run at the virtual times they fall due, as long as
+ * interrupts are enabled.  Nothing ever waits on the wall clock, so minutes of
+ * CARRT's time run in a fraction of a second.
+ *
+ * The robot lives in an empty rectangular room.  The motors move it, the
+ * compass and gyroscope report its heading and turn rate, and the lidar and
+ * sonar report the range to the walls.
+ */
+
+namespace HostSim
+{
+
+    // Position in meters (x North, y West, as the Navigator uses) and compass heading in degrees
+    struct Pose
+    {
+        double  x;
+        double  y;
+        double  heading;
+    };
+
+
+    // Thrown out of CARRT's code when virtual time reaches the end of the run
+    struct EndOfRun {};
+
+    // Thrown by handleUnrecoverableError() instead of halting
+    struct UnrecoverableError
+    {
+        int errorCode;
+    };
+
+
+    // Called with the virtual time (ms) and both display rows whenever the display changes
+    typedef void (*DisplayListener)( uint32_t ms, const char* topRow, const char* bottomRow );
+
+    // Called with each record the sensor log writes (see SensorLog.h)
+    typedef void (*SensorLogListener)( const uint8_t* record, uint8_t size );
+
+    // Raw readings the navigation sensors give instead of the simulated robot's, for
+    // replaying sensor logs
+    struct NavSensorReadings
+    {
+        Vector3Int  accel;
+        Vector3Int  gyro;
+        Vector3Int  mag;
+    };
+
+
+    // Reset the simulation:  time 0, the robot stopped in the middle of a 4 m by 4 m room
+    // heading North (range servo straight ahead), no keys scripted, no listeners, no fixed
+    // sensor readings
+    void init();
+
+    // Boot CARRT (as CarrtMain does) and run it until virtual time reaches endMs.  Resets
+    // (the Reset chord) reboot CARRT as on the robot.  Returns the unrecoverable error code
+    // that stopped CARRT, or 0 if it ran to the end.
+    int runCarrt( uint32_t endMs );
+
+
+    // Script a key press:  buttons (Keypad::Keys) held from atMs for holdMs
+    void pressKeys( uint32_t atMs, uint8_t buttons, uint16_t holdMs = 150 );
+
+    void setDisplayListener( DisplayListener listener );
+
+    void setSensorLogListener( SensorLogListener listener );
+
+    const char* getDisplayTopRow();
+    const char* getDisplayBottomRow();
+
+
+    // The room's walls are at x = +/- halfLengthX, y = +/- halfLengthY (meters)
+    void setRoom( double halfLengthX, double halfLengthY );
+
+    void setPose( const Pose& pose );
+    const Pose& getPose();
+
+    // What the temperature sensor reads (20 C unless set)
+    void setTempC( double tempC );
+    double getTempC();
+
+    // Fix what the accelerometer, gyroscope, and compass read (0 goes back to the
+    // simulated robot); the FIFOs fill as usual
+    void setNavSensorReadings( const NavSensorReadings* readings );
+    const NavSensorReadings* getNavSensorReadings();
+
+
+    // Virtual time
+    uint64_t getMicros();
+    inline uint32_t getMillis()
+    { return static_cast<uint32_t>( getMicros() / 1000 ); }
+
+    // Spend virtual time (running any interrupts that fall due)
+    void spendMicros( uint32_t us );
+
+    // Number of times the event loop put the CPU to sleep, and total time asleep
+    uint32_t getNbrSleeps();
+    uint64_t getMicrosAsleep();
+
+
+    // Navigation without the event loop, for the tests
+
+    // One tick of navigation as MainProcess and the sampler do it:  spend the tick, update
+    // the Navigator, and hand it the sample that comes back (only while moving).  Returns
+    // true, and the sample's event parameter if sample isn't 0, if a sample came.
+    bool doNavTick( int16_t* sample = 0 );
+
+    // Sample the IMU now over the last timeStep seconds, without giving it to the Navigator.
+    // Returns true and the sample's event parameter if the sample came.
+    bool takeNavSample( float timeStep, int16_t* sample );
+
+
+    // Hooks for the simulated drivers
+
+    enum MotorMotion
+    {
+        kMotorsStopped,
+        kMotorsForward,
+        kMotorsBackward,
+        kMotorsRotateLeft,
+        kMotorsRotateRight
+    };
+
+    void setMotors( MotorMotion motion, uint8_t speed );
+
+    // Turn rate in degrees per second (clockwise positive) and speed in meters per second
+    double getTurnRate();
+    double getSpeed();
+
+    // The gyroscope's and accelerometer's FIFOs:  each sensor adds a reading at its update
+    // rate (190 Hz and 100 Hz), and a full FIFO (32 readings) drops its oldest.  Gyroscope
+    // readings are the turn rate when taken; the accelerometer only ever reads gravity.
+    uint8_t getGyroFifoLevel();
+    double popGyroFifo();
+    uint8_t getAccelFifoLevel();
+    void popAccelFifo();
+
+    // Range (cm) from the robot to the nearest wall, looking angle degrees right of the heading
+    double getRangeCm( double angle );
+
+    // The range sensors' servo (degrees right of the heading):  a new angle takes effect at
+    // the servo's next pulse (60 Hz), and the servo turns to it at 400 degrees per second
+    void setServo( double angle );
+    double getServoAngle();
+
+    uint8_t getKeysDown();
+
+    void writeDisplay( uint8_t row, uint8_t col, const char* str, uint8_t len );
+    void clearDisplay();
+
+};
+
+
+#endif
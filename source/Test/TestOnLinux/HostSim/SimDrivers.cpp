@@ -0,0 +1,1177 @@
+/*
+    SimDrivers.cpp - Simulated versions of CARRT's device drivers, for running
+    CARRT on a Linux host.  Each driver spends roughly the virtual time the
+    real device takes, and reports on the simulated robot and room.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "HostSim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "AVRTools/I2cMaster.h"
+#include "AVRTools/SystemClock.h"
+
+#include "CarrtCallback.h"
+
+#include "Drivers/Battery.h"
+#include "Drivers/Beep.h"
+#include "Drivers/Display.h"
+#include "Drivers/Keypad.h"
+#include "Drivers/L3GD20.h"
+#include "Drivers/Lidar.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/Motors.h"
+#include "Drivers/Servo.h"
+#include "Drivers/Sonar.h"
+#include "Drivers/TempSensor.h"
+
+
+
+
+namespace
+{
+    // Rough costs of talking to the devices, in microseconds
+    const uint32_t  kI2cTransactionMicros   = 250;
+    const uint32_t  kLcdCharacterMicros     = 100;
+    const uint32_t  kLidarReadingMicros     = 10000;
+    const uint32_t  kFastLidarReadingMicros = 4000;
+    const uint32_t  kSonarMicrosPerCm       = 58;
+
+    const float     kGyroDpsPerLsb          = 0.00875;
+    const float     kGravitiesPerLsb        = 0.001;
+    const float     kMetersPerSec2PerG      = 9.80665;
+    const int       kMagFieldLsb            = 500;
+
+    const int       kMotorBatteryMilliVolts = 7800;
+    const int       kCpuBatteryMilliVolts   = 8200;
+    const int       kBatteryMinMilliVolts   = 6000;
+
+    uint8_t         sCursorRow;
+    uint8_t         sCursorCol;
+
+    uint8_t         sMotorSpeed;
+
+    int             sServoAngle;
+    uint32_t        sLidarReadingMicros     = kLidarReadingMicros;
+
+    // The simulated magnetometer needs no calibration beyond scaling
+    LSM303DLHC::MagCalibration sMagCalibration =
+    {
+        Vector3Float( 0, 0, 0 ),
+        Vector3Float( 1.0 / kMagFieldLsb, 1.0 / kMagFieldLsb, 1.0 / kMagFieldLsb )
+    };
+
+
+    void setMotion( HostSim::MotorMotion motion )
+    {
+        HostSim::spendMicros( kI2cTransactionMicros );
+        HostSim::setMotors( motion, sMotorSpeed );
+    }
+
+
+    void putData( uint8_t* d, int16_t x, int16_t y, int16_t z )
+    {
+        // Order is xlo, xhi, ylo, yhi, zlo, zhi
+        d[0] = x & 0xFF;
+        d[1] = ( x >> 8 ) & 0xFF;
+        d[2] = y & 0xFF;
+        d[3] = ( y >> 8 ) & 0xFF;
+        d[4] = z & 0xFF;
+        d[5] = ( z >> 8 ) & 0xFF;
+    }
+
+
+    int16_t getData( const uint8_t* d )
+    {
+        return static_cast<int16_t>( d[0] | static_cast<uint16_t>( d[1] ) << 8 );
+    }
+
+
+    size_t writeToDisplay( const char* str, size_t len )
+    {
+        HostSim::spendMicros( kLcdCharacterMicros * len );
+        HostSim::writeDisplay( sCursorRow, sCursorCol, str, len );
+        sCursorCol += len;
+        return len;
+    }
+
+
+    size_t newLine()
+    {
+        sCursorRow = ( sCursorRow + 1 ) & 0x01;
+        sCursorCol = 0;
+        return 1;
+    }
+
+
+    int simulatedRangeCm( double angle )
+    {
+        return static_cast<int>( HostSim::getRangeCm( angle ) + 0.5 );
+    }
+
+
+    uint8_t encodeFifoStatus( uint8_t level )
+    {
+        // FIFO_SRC:  bit 6 full (with 31 in the level bits), bit 5 empty
+        return ( level == 32 ) ? 0x5F : ( level ? level : 0x20 );
+    }
+
+
+    uint8_t decodeFifoStatus( uint8_t fifoStatus )
+    {
+        return ( fifoStatus & 0x40 ) ? 32 : ( fifoStatus & 0x1F );
+    }
+};
+
+
+
+
+/******************************************************************************/
+
+// Display and keypad
+
+
+uint8_t Keypad::readButtons()
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+    return HostSim::getKeysDown();
+}
+
+
+
+int Display::init()
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+    clear();
+    return 0;
+}
+
+
+
+void Display::clear()
+{
+    HostSim::spendMicros( 2000 );
+    HostSim::clearDisplay();
+    sCursorRow = 0;
+    sCursorCol = 0;
+}
+
+
+
+void Display::home()
+{
+    setCursor( 0, 0 );
+}
+
+
+
+void Display::displayTopRow( const char* str )
+{
+    clearTopRow();
+    setCursor( 0, 0 );
+    print( str );
+}
+
+
+
+void Display::displayBottomRow( const char* str )
+{
+    clearBottomRow();
+    setCursor( 1, 0 );
+    print( str );
+}
+
+
+
+void Display::displayTopRowP16( PGM_P str )
+{
+    char tmp[17];
+    strncpy_P( tmp, str, 16 );
+    tmp[16] = 0;
+    displayTopRow( tmp );
+}
+
+
+
+void Display::displayBottomRowP16( PGM_P str )
+{
+    char tmp[17];
+    strncpy_P( tmp, str, 16 );
+    tmp[16] = 0;
+    displayBottomRow( tmp );
+}
+
+
+
+void Display::clearTopRow()
+{
+    setCursor( 0, 0 );
+    print( "                " );
+}
+
+
+
+void Display::clearBottomRow()
+{
+    setCursor( 1, 0 );
+    print( "                " );
+}
+
+
+
+void Display::displayOff()          {}
+void Display::displayOn()           {}
+void Display::blinkOff()            {}
+void Display::blinkOn()             {}
+void Display::cursorOff()           {}
+void Display::cursorOn()            {}
+void Display::scrollDisplayLeft()   {}
+void Display::scrollDisplayRight()  {}
+void Display::autoscrollOn()        {}
+void Display::autoscrollOff()       {}
+void Display::flush()               {}
+
+
+
+void Display::setCursor( uint8_t row, uint8_t col )
+{
+    HostSim::spendMicros( kLcdCharacterMicros );
+    sCursorRow = row & 0x01;
+    sCursorCol = col;
+}
+
+
+
+int Display::setBacklight( uint8_t )
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+    return 0;
+}
+
+
+
+size_t Display::print( const char* str, bool addLn )
+{
+    size_t n = writeToDisplay( str, strlen( str ) );
+    return addLn ? n + newLine() : n;
+}
+
+
+
+size_t Display::print( const uint8_t* buf, size_t size, bool addLn )
+{
+    size_t n = writeToDisplay( reinterpret_cast<const char*>( buf ), size );
+    return addLn ? n + newLine() : n;
+}
+
+
+
+size_t Display::print( char c, bool addLn )
+{
+    size_t n = writeToDisplay( &c, 1 );
+    return addLn ? n + newLine() : n;
+}
+
+
+
+size_t Display::print( long n, int base, bool addLn )
+{
+    if ( base == kDec )
+    {
+        char tmp[16];
+        snprintf( tmp, sizeof( tmp ), "%ld", n );
+        return print( tmp, addLn );
+    }
+
+    return print( static_cast<unsigned long>( n ), base, addLn );
+}
+
+
+
+size_t Display::print( unsigned long n, int base, bool addLn )
+{
+    char tmp[40];
+    switch ( base )
+    {
+        case kHex:
+        {
+            int len = snprintf( tmp, sizeof( tmp ), "%lx", n );
+            snprintf( tmp, sizeof( tmp ), ( len & 1 ) ? "0x0%lx" : "0x%lx", n );
+            break;
+        }
+
+        case kOct:
+            snprintf( tmp, sizeof( tmp ), "0%lo", n );
+            break;
+
+        case kBin:
+        {
+            char* p = tmp;
+            *p++ = '0';
+            *p++ = 'b';
+            int bit = 31;
+            while ( bit > 0 && !( n & ( 1UL << bit ) ) )
+            {
+                --bit;
+            }
+            for ( ; bit >= 0; --bit )
+            {
+                *p++ = ( n & ( 1UL << bit ) ) ? '1' : '0';
+            }
+            *p = 0;
+            break;
+        }
+
+        default:
+            snprintf( tmp, sizeof( tmp ), "%lu", n );
+            break;
+    }
+
+    return print( tmp, addLn );
+}
+
+
+
+size_t Display::print( double d, int digits, bool addLn )
+{
+    char tmp[40];
+    snprintf( tmp, sizeof( tmp ), "%.*f", digits, d );
+    return print( tmp, addLn );
+}
+
+
+
+size_t Display::printP16( PGM_P str, bool addLn )
+{
+    char tmp[17];
+    strncpy_P( tmp, str, 16 );
+    tmp[16] = 0;
+    return print( tmp, addLn );
+}
+
+
+
+size_t Display::println()
+{
+    return newLine();
+}
+
+
+
+
+/******************************************************************************/
+
+// Motors
+
+
+void Motors::init()
+{
+    sMotorSpeed = kFullSpeed;
+    stop();
+}
+
+
+
+void Motors::setSpeedAllMotors( uint8_t s )
+{
+    sMotorSpeed = s;
+}
+
+
+
+void Motors::goForward()
+{
+    setMotion( HostSim::kMotorsForward );
+}
+
+
+
+void Motors::goBackward()
+{
+    setMotion( HostSim::kMotorsBackward );
+}
+
+
+
+void Motors::stop()
+{
+    setMotion( HostSim::kMotorsStopped );
+}
+
+
+
+void Motors::rotateLeft()
+{
+    setMotion( HostSim::kMotorsRotateLeft );
+}
+
+
+
+void Motors::rotateRight()
+{
+    setMotion( HostSim::kMotorsRotateRight );
+}
+
+
+
+
+/******************************************************************************/
+
+// Battery, beeper, and temperature sensor
+
+
+void Battery::initBatteryStatusDisplay()
+{
+    checkAndDisplayBatteryStatus();
+}
+
+
+
+bool Battery::isChargerConnected()
+{
+    return false;
+}
+
+
+
+int Battery::getCpuBatteryMilliVoltage()
+{
+    return kCpuBatteryMilliVolts;
+}
+
+
+
+int Battery::getMotorBatteryMilliVoltage()
+{
+    return kMotorBatteryMilliVolts;
+}
+
+
+
+bool Battery::isMotorBatteryOkay( int milliVolts )
+{
+    return milliVolts >= kBatteryMinMilliVolts;
+}
+
+
+
+bool Battery::isCpuBatteryOkay( int milliVolts )
+{
+    return milliVolts >= kBatteryMinMilliVolts;
+}
+
+
+
+void Battery::displayMotorBatteryStatusLed( int )
+{
+}
+
+
+
+void Battery::displayCpuBatteryStatusLed( int )
+{
+}
+
+
+
+int Battery::checkAndDisplayBatteryStatus()
+{
+    return kBatteriesOkay;
+}
+
+
+
+// The beeper keeps the real driver's timing (and its yields), without the sound
+
+void Beep::initBeep()
+{
+    chirp();
+}
+
+
+
+void Beep::alert( unsigned int durationMs, unsigned int )
+{
+    delayMilliseconds( durationMs );
+}
+
+
+
+void Beep::beep( unsigned int durationMs, unsigned int )
+{
+    CarrtCallback::yieldMilliseconds( durationMs );
+}
+
+
+
+void Beep::chirp()
+{
+    delayMilliseconds( kBeepDefaultChirpDuration );
+}
+
+
+
+void Beep::errorChime()
+{
+    alert( 50 );
+    delayMilliseconds( 50 );
+    alert( 50 );
+    delayMilliseconds( 50 );
+    alert( 50 );
+}
+
+
+
+void Beep::triTone( unsigned int, unsigned int, unsigned int )
+{
+    CarrtCallback::yieldMilliseconds( 50 );
+    CarrtCallback::yieldMilliseconds( 75 );
+    CarrtCallback::yieldMilliseconds( 100 );
+    CarrtCallback::yieldMilliseconds( 75 );
+    CarrtCallback::yieldMilliseconds( 150 );
+}
+
+
+
+void Beep::beepOn( unsigned int )
+{
+}
+
+
+
+void Beep::beepOff()
+{
+}
+
+
+
+float TempSensor::getTempC()
+{
+    return HostSim::getTempC();
+}
+
+
+
+float TempSensor::getTempF()
+{
+    return HostSim::getTempC() * 9 / 5 + 32;
+}
+
+
+
+
+/******************************************************************************/
+
+// Range sensors and their servo
+
+
+void Servo::init()
+{
+    reset();
+}
+
+
+
+void Servo::reset()
+{
+    slew( 0 );
+}
+
+
+
+void Servo::setPWMFreq( float )
+{
+}
+
+
+
+void Servo::setPWM( uint16_t, uint16_t )
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+}
+
+
+
+int Servo::slew( int angleDegrees )
+{
+    if ( angleDegrees > 85 )
+    {
+        angleDegrees = 85;
+    }
+    if ( angleDegrees < -85 )
+    {
+        angleDegrees = -85;
+    }
+
+    // Same (reversed) sign convention as the real driver
+    sServoAngle = -angleDegrees;
+    setPWM( 0, 0 );
+    HostSim::setServo( angleDegrees );
+
+    return sServoAngle;
+}
+
+
+
+int Servo::getCurrentAngle()
+{
+    return sServoAngle;
+}
+
+
+
+void Lidar::init()
+{
+    Servo::init();
+    reset();
+}
+
+
+
+int Lidar::reset()
+{
+    delayMilliseconds( 25 );
+    return setConfiguration( kDefault );
+}
+
+
+
+int Lidar::setConfiguration( Configuration configuration )
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+
+    // Fewer acquisitions per reading
+    bool fast = ( configuration == kShortRangeAndHighSpeed || configuration == kShortRangeAndHighestSpeed );
+    sLidarReadingMicros = fast ? kFastLidarReadingMicros : kLidarReadingMicros;
+
+    return 0;
+}
+
+
+
+int Lidar::slew( int angleDegrees )
+{
+    return Servo::slew( angleDegrees );
+}
+
+
+
+int Lidar::getCurrentAngle()
+{
+    return Servo::getCurrentAngle();
+}
+
+
+
+int Lidar::getDistanceInCm( int* distInCm, bool )
+{
+    // The range is wherever the servo has got to half way through the reading
+    HostSim::spendMicros( sLidarReadingMicros / 2 );
+    *distInCm = simulatedRangeCm( HostSim::getServoAngle() );
+    HostSim::spendMicros( sLidarReadingMicros - sLidarReadingMicros / 2 );
+    return 0;
+}
+
+
+
+int Lidar::getMedianDistanceInCm( int* distInCm, uint8_t nbrMedianSamples, bool useBiasCorrection )
+{
+    // All samples are the same in an ideal room
+    for ( uint8_t i = 1; i < nbrMedianSamples; ++i )
+    {
+        getDistanceInCm( distInCm, useBiasCorrection );
+    }
+    return getDistanceInCm( distInCm, useBiasCorrection );
+}
+
+
+
+void Sonar::init()
+{
+}
+
+
+
+int Sonar::slew( int angleDegrees )
+{
+    return Servo::slew( angleDegrees );
+}
+
+
+
+int Sonar::getCurrentAngle()
+{
+    return Servo::getCurrentAngle();
+}
+
+
+
+int Sonar::getDistanceInCm( uint8_t nbrSamples )
+{
+    int cm = getSinglePingDistanceInCm();
+    for ( uint8_t i = 1; i < nbrSamples; ++i )
+    {
+        cm = getSinglePingDistanceInCm();
+    }
+    return cm;
+}
+
+
+
+int Sonar::getSinglePingDistanceInCm()
+{
+    // The sonar isn't on the servo; it always looks straight ahead
+    int cm = simulatedRangeCm( 0 );
+    HostSim::spendMicros( kSonarMicrosPerCm * cm );
+    return cm;
+}
+
+
+
+
+/******************************************************************************/
+
+// Navigation sensors
+
+
+bool L3GD20::init()
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+    return true;
+}
+
+
+
+int L3GD20::gyroscopeUpdateRate()
+{
+    return 190;
+}
+
+
+
+Vector3Int L3GD20::getAngularRatesRaw()
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+
+    const HostSim::NavSensorReadings* fixed = HostSim::getNavSensorReadings();
+    if ( fixed )
+    {
+        return fixed->gyro;
+    }
+
+    // z is up, so a clockwise (compass) turn is a negative rate
+    return Vector3Int( 0, 0, static_cast<int>( lround( -HostSim::getTurnRate() / kGyroDpsPerLsb ) ) );
+}
+
+
+
+Vector3Float L3GD20::convertRawToRadiansPerSecond( const Vector3Int& in )
+{
+    return Vector3Float( convertRawToRadiansPerSecond( in.x ), convertRawToRadiansPerSecond( in.y ),
+                         convertRawToRadiansPerSecond( in.z ) );
+}
+
+
+
+Vector3Float L3GD20::convertRawToDegreesPerSecond( const Vector3Int& in )
+{
+    return Vector3Float( in.x * kGyroDpsPerLsb, in.y * kGyroDpsPerLsb, in.z * kGyroDpsPerLsb );
+}
+
+
+
+float L3GD20::convertRawToRadiansPerSecond( int oneCoord )
+{
+    return oneCoord * kGyroDpsPerLsb * M_PI / 180.0;
+}
+
+
+
+float L3GD20::convertRawToDegreesPerSecond( int oneCoord )
+{
+    return oneCoord * kGyroDpsPerLsb;
+}
+
+
+
+Vector3Float L3GD20::getAngularRatesDegreesPerSecond()
+{
+    return convertRawToDegreesPerSecond( getAngularRatesRaw() );
+}
+
+
+
+Vector3Float L3GD20::getAngularRatesRadiansPerSecond()
+{
+    return convertRawToRadiansPerSecond( getAngularRatesRaw() );
+}
+
+
+
+void L3GD20::getAngularRatesDataBlockSync( DataBlock* data, uint8_t nbr )
+{
+    volatile uint8_t nbrRead;
+    volatile uint8_t status;
+
+    HostSim::spendMicros( kI2cTransactionMicros * nbr );
+    getAngularRatesDataBlockAsync( data, nbr, &nbrRead, &status );
+}
+
+
+
+uint8_t L3GD20::getAngularRatesDataBlockAsync( DataBlock* data, uint8_t nbr, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    // The transfer takes no time from the caller, and is done by the time it returns
+    const HostSim::NavSensorReadings* fixed = HostSim::getNavSensorReadings();
+    for ( uint8_t i = 0; i < nbr; ++i )
+    {
+        int z = static_cast<int>( lround( -HostSim::popGyroFifo() / kGyroDpsPerLsb ) );
+        if ( fixed )
+        {
+            putData( data->values[i], fixed->gyro.x, fixed->gyro.y, fixed->gyro.z );
+        }
+        else
+        {
+            putData( data->values[i], 0, 0, z );
+        }
+    }
+    *nbrRead = nbr * 6;
+    *status = I2cMaster::kI2cCompletedOk;
+    return 0;
+}
+
+
+
+Vector3Int L3GD20::convertDataBlockEntryToAngularRatesRaw( const DataBlock& data, uint8_t item )
+{
+    const uint8_t* d = data.values[item];
+    return Vector3Int( getData( d ), getData( d + 2 ), getData( d + 4 ) );
+}
+
+
+
+Vector3Float L3GD20::convertDataBlockEntryToAngularRatesRadiansPerSecond( const DataBlock& data, uint8_t item )
+{
+    return convertRawToRadiansPerSecond( convertDataBlockEntryToAngularRatesRaw( data, item ) );
+}
+
+
+
+uint8_t L3GD20::getFifoStatusAsync( uint8_t* fifoStatus, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    *fifoStatus = encodeFifoStatus( HostSim::getGyroFifoLevel() );
+    *nbrRead = 1;
+    *status = I2cMaster::kI2cCompletedOk;
+    return 0;
+}
+
+
+
+uint8_t L3GD20::convertFifoStatusToLevel( uint8_t fifoStatus )
+{
+    return decodeFifoStatus( fifoStatus );
+}
+
+
+
+bool L3GD20::isFifoOverrun( uint8_t fifoStatus )
+{
+    return fifoStatus & 0x40;
+}
+
+
+
+float L3GD20::convertRawSumToDegrees( int32_t sum )
+{
+    return sum * kGyroDpsPerLsb / gyroscopeUpdateRate();
+}
+
+
+
+int16_t L3GD20::convertRawSumToCentiDegrees( int32_t sum )
+{
+    // Same integer arithmetic as the real driver (8.75 mdps per LSB, as 7 / 8 centi-dps)
+    const int32_t kDivisor = 8L * gyroscopeUpdateRate();
+    int32_t scaled = sum * 7;
+    return ( scaled + ( scaled >= 0 ? kDivisor / 2 : -kDivisor / 2 ) ) / kDivisor;
+}
+
+
+
+
+int LSM303DLHC::init()
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+    return 0;
+}
+
+
+
+int LSM303DLHC::accelerometerUpdateRate()
+{
+    return 100;
+}
+
+
+
+Vector3Int LSM303DLHC::getAccelerationRaw()
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+
+    const HostSim::NavSensorReadings* fixed = HostSim::getNavSensorReadings();
+    if ( fixed )
+    {
+        return fixed->accel;
+    }
+
+    // Level, and no acceleration to speak of:  just gravity (1 mg per LSB)
+    return Vector3Int( 0, 0, static_cast<int>( 1 / kGravitiesPerLsb ) );
+}
+
+
+
+Vector3Float LSM303DLHC::convertRawToG( const Vector3Int& in )
+{
+    return Vector3Float( in.x * kGravitiesPerLsb, in.y * kGravitiesPerLsb, in.z * kGravitiesPerLsb );
+}
+
+
+
+Vector3Float LSM303DLHC::convertRawToMetersPerSec2( const Vector3Int& in )
+{
+    const float k = kGravitiesPerLsb * kMetersPerSec2PerG;
+    return Vector3Float( in.x * k, in.y * k, in.z * k );
+}
+
+
+
+Vector2Float LSM303DLHC::convertRawToXYMetersPerSec2( const Vector3Int& in )
+{
+    return convertRawToMetersPerSec2( in );
+}
+
+
+
+Vector3Float LSM303DLHC::convertRawToCentimetersPerSec2( const Vector3Int& in )
+{
+    const float k = kGravitiesPerLsb * kMetersPerSec2PerG * 100;
+    return Vector3Float( in.x * k, in.y * k, in.z * k );
+}
+
+
+
+Vector2Float LSM303DLHC::convertRawToXYCentimetersPerSec2( const Vector3Int& in )
+{
+    return convertRawToCentimetersPerSec2( in );
+}
+
+
+
+int LSM303DLHC::getAccelerationDataBlockSync( DataBlock* data, uint8_t nbr )
+{
+    volatile uint8_t nbrRead;
+    volatile uint8_t status;
+
+    HostSim::spendMicros( kI2cTransactionMicros * nbr );
+    return getAccelerationDataBlockAsync( data, nbr, &nbrRead, &status );
+}
+
+
+
+uint8_t LSM303DLHC::getAccelerationDataBlockAsync( volatile DataBlock* data, uint8_t nbrToRead, volatile uint8_t* nbrRead,
+                                                   volatile uint8_t* status )
+{
+    // The transfer takes no time from the caller, and is done by the time it returns
+    // (the real device left-justifies its 12-bit readings)
+    DataBlock* d = const_cast<DataBlock*>( data );
+    const HostSim::NavSensorReadings* fixed = HostSim::getNavSensorReadings();
+    Vector3Int a = fixed ? fixed->accel : Vector3Int( 0, 0, static_cast<int>( 1 / kGravitiesPerLsb ) );
+    for ( uint8_t i = 0; i < nbrToRead; ++i )
+    {
+        HostSim::popAccelFifo();
+        putData( d->values[i], a.x << 4, a.y << 4, a.z << 4 );
+    }
+    *nbrRead = nbrToRead * 6;
+    *status = I2cMaster::kI2cCompletedOk;
+    return 0;
+}
+
+
+
+Vector3Int LSM303DLHC::convertDataBlockEntryToAccelerationRaw( const DataBlock& data, uint8_t item )
+{
+    const uint8_t* d = data.values[item];
+    return Vector3Int( getData( d ) >> 4, getData( d + 2 ) >> 4, getData( d + 4 ) >> 4 );
+}
+
+
+
+Vector3Float LSM303DLHC::convertDataBlockEntryToAccelerationMetersPerSec2( const DataBlock& data, uint8_t item )
+{
+    return convertRawToMetersPerSec2( convertDataBlockEntryToAccelerationRaw( data, item ) );
+}
+
+
+
+uint8_t LSM303DLHC::getAccelerationFifoStatusAsync( uint8_t* fifoStatus, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    *fifoStatus = encodeFifoStatus( HostSim::getAccelFifoLevel() );
+    *nbrRead = 1;
+    *status = I2cMaster::kI2cCompletedOk;
+    return 0;
+}
+
+
+
+uint8_t LSM303DLHC::convertAccelerationFifoStatusToLevel( uint8_t fifoStatus )
+{
+    return decodeFifoStatus( fifoStatus );
+}
+
+
+
+Vector2Float LSM303DLHC::convertRawSumToXYMetersPerSec( const Vector3Long& sum )
+{
+    const float k = kGravitiesPerLsb * kMetersPerSec2PerG / accelerometerUpdateRate();
+    return Vector2Float( sum.x * k, sum.y * k );
+}
+
+
+
+int LSM303DLHC::setMagGain( LSM303MagnetometerGain )
+{
+    HostSim::spendMicros( kI2cTransactionMicros );
+    return 0;
+}
+
+
+
+int LSM303DLHC::magnetometerUpdateRate()
+{
+    return 30;
+}
+
+
+
+Vector3Int LSM303DLHC::getMagnetometerRaw()
+{
+    uint8_t data[6];
+    volatile uint8_t nbrRead;
+    volatile uint8_t status;
+
+    HostSim::spendMicros( kI2cTransactionMicros );
+    getMagnetometerDataAsync( data, &nbrRead, &status );
+    return convertMagnetometerDataToRaw( data );
+}
+
+
+
+uint8_t LSM303DLHC::getMagnetometerDataAsync( uint8_t* data, volatile uint8_t* nbrRead, volatile uint8_t* status )
+{
+    // Horizontal field points North (x); compass headings run clockwise (toward -y)
+    double rad = HostSim::getPose().heading * M_PI / 180.0;
+    int16_t x = lround( kMagFieldLsb * cos( rad ) );
+    int16_t y = lround( -kMagFieldLsb * sin( rad ) );
+    int16_t z = 0;
+
+    const HostSim::NavSensorReadings* fixed = HostSim::getNavSensorReadings();
+    if ( fixed )
+    {
+        x = fixed->mag.x;
+        y = fixed->mag.y;
+        z = fixed->mag.z;
+    }
+
+    // Order is xh, xl, zh, zl, yh, yl
+    data[0] = ( x >> 8 ) & 0xFF;
+    data[1] = x & 0xFF;
+    data[2] = ( z >> 8 ) & 0xFF;
+    data[3] = z & 0xFF;
+    data[4] = ( y >> 8 ) & 0xFF;
+    data[5] = y & 0xFF;
+
+    *nbrRead = 6;
+    *status = I2cMaster::kI2cCompletedOk;
+    return 0;
+}
+
+
+
+Vector3Int LSM303DLHC::convertMagnetometerDataToRaw( const uint8_t* d )
+{
+    return Vector3Int( static_cast<int16_t>( d[1] | static_cast<uint16_t>( d[0] ) << 8 ),
+                       static_cast<int16_t>( d[5] | static_cast<uint16_t>( d[4] ) << 8 ),
+                       static_cast<int16_t>( d[3] | static_cast<uint16_t>( d[2] ) << 8 ) );
+}
+
+
+
+Vector3Float LSM303DLHC::convertMagnetometerRawToCalibrated( const Vector3Int& in )
+{
+    return Vector3Float( ( in.x - sMagCalibration.offset.x ) * sMagCalibration.scale.x,
+                         ( in.y - sMagCalibration.offset.y ) * sMagCalibration.scale.y,
+                         ( in.z - sMagCalibration.offset.z ) * sMagCalibration.scale.z );
+}
+
+
+
+void LSM303DLHC::setMagnetometerCalibration( const MagCalibration& calibration )
+{
+    sMagCalibration = calibration;
+}
+
+
+
+const LSM303DLHC::MagCalibration& LSM303DLHC::getMagnetometerCalibration()
+{
+    return sMagCalibration;
+}
+
+
+
+Vector3Float LSM303DLHC::convertMagnetometerCalibratedToMicroTesla( const Vector3Float& in )
+{
+    // About 50 uT, a typical field strength
+    return Vector3Float( in.x * 50, in.y * 50, in.z * 50 );
+}
+
+
+
+float LSM303DLHC::getHeading()
+{
+    return calculateHeadingFromRawData( getMagnetometerRaw(), getAccelerationRaw() );
+}
+
+
+
+float LSM303DLHC::calculateHeadingFromRawData( const Vector3Int& magRaw, const Vector3Int& )
+{
+    // The simulated robot is always level, so no tilt compensation
+    Vector3Float m = convertMagnetometerRawToCalibrated( magRaw );
+    float heading = atan2( -m.y, m.x ) * 180 / M_PI;
+    if ( heading < 0 )
+    {
+        heading += 360;
+    }
+    return heading;
+}
@@ -0,0 +1,66 @@
+/*
+    AVRTools/ArduinoMegaPins.h - Host stand-in for the AVRTools pin definitions.
+    Pins are plain numbers and writing to them does nothing.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_ArduinoMegaPins_h
+#define HostSim_ArduinoMegaPins_h
+
+
+#define pPinA00     100
+#define pPinA01     101
+#define pPinA02     102
+
+#define pPin02      2
+#define pPin03      3
+#define pPin04      4
+#define pPin05      5
+#define pPin06      6
+#define pPin07      7
+#define pPin08      8
+#define pPin11      11
+#define pPin12      12
+#define pPin13      13
+#define pPin22      22
+#define pPin23      23
+#define pPin24      24
+#define pPin25      25
+#define pPin26      26
+#define pPin27      27
+#define pPin28      28
+#define pPin29      29
+
+
+enum
+{
+    kDigitalLow     = 0,
+    kDigitalHigh    = 1
+};
+
+
+#define setGpioPinModeOutput( pin )     ( (void) ( pin ) )
+#define setGpioPinModeInput( pin )      ( (void) ( pin ) )
+#define setGpioPinHigh( pin )           ( (void) ( pin ) )
+#define setGpioPinLow( pin )            ( (void) ( pin ) )
+#define writeGpioPinDigital( pin, v )   ( (void) ( pin ), (void) ( v ) )
+#define readGpioPinDigital( pin )       ( (void) ( pin ), 0 )
+
+
+#endif
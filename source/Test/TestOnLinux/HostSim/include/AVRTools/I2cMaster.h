@@ -0,0 +1,40 @@
+/*
+    AVRTools/I2cMaster.h - Host stand-in for the AVRTools I2C master (just the
+    status codes; the simulated drivers never touch a bus).
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_I2cMaster_h
+#define HostSim_I2cMaster_h
+
+
+namespace I2cMaster
+{
+    // Status of an asynchronous transaction
+    enum I2cStatusCodes
+    {
+        kI2cCompletedOk     = 0x00,
+        kI2cError           = 0x01,
+        kI2cNotStarted      = 0x02,
+        kI2cInTransmission  = 0x03
+    };
+};
+
+
+#endif
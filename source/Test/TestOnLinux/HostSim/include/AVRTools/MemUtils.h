@@ -0,0 +1,36 @@
+/*
+    AVRTools/MemUtils.h - Host stand-in for the AVRTools memory utilities.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_MemUtils_h
+#define HostSim_MemUtils_h
+
+
+namespace MemUtils
+{
+    unsigned int freeSRAM();
+
+    unsigned int freeMemoryBetweenHeapAndStack();
+
+    void resetHeap();
+};
+
+
+#endif
@@ -0,0 +1,41 @@
+/*
+    AVRTools/SystemClock.h - Host stand-in for the AVRTools system clock,
+    running on the simulator's virtual time.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_SystemClock_h
+#define HostSim_SystemClock_h
+
+
+void initSystemClock();
+
+unsigned long millis();
+
+unsigned long micros();
+
+void delayMilliseconds( unsigned long ms );
+
+void delayMicroseconds( unsigned int us );
+
+inline void delay( unsigned long ms )
+{ delayMilliseconds( ms ); }
+
+
+#endif
@@ -0,0 +1,32 @@
+/*
+    AvrLibcExtras.h - Host stand-ins for avr-libc's extensions to the standard
+    C headers.  Force-included into every host simulation source file.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_AvrLibcExtras_h
+#define HostSim_AvrLibcExtras_h
+
+
+// From avr-libc's math.h
+inline double square( double x )
+{ return x * x; }
+
+
+#endif
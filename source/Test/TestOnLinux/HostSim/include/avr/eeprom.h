@@ -0,0 +1,47 @@
+/*
+    avr/eeprom.h - Host stand-in for avr-libc's EEPROM access.  On the host,
+    EEPROM variables are just ordinary (zeroed, not erased) variables.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_avr_eeprom_h
+#define HostSim_avr_eeprom_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define EEMEM
+
+
+inline void eeprom_read_block( void* dst, const void* src, size_t n )
+{ memcpy( dst, src, n ); }
+
+inline void eeprom_update_block( const void* src, void* dst, size_t n )
+{ memcpy( dst, src, n ); }
+
+inline void eeprom_write_block( const void* src, void* dst, size_t n )
+{ memcpy( dst, src, n ); }
+
+inline void eeprom_busy_wait()
+{}
+
+
+#endif
@@ -0,0 +1,32 @@
+/*
+    avr/interrupt.h - Host stand-in for avr-libc's interrupt control.
+    Simulated interrupts only run when virtual time advances (see HostSim.h),
+    so these just track the global interrupt flag.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_avr_interrupt_h
+#define HostSim_avr_interrupt_h
+
+
+void cli();
+void sei();
+
+
+#endif
@@ -0,0 +1,52 @@
+/*
+    avr/pgmspace.h - Host stand-in for avr-libc's program memory access.
+    On the host, program memory is just ordinary memory.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_avr_pgmspace_h
+#define HostSim_avr_pgmspace_h
+
+#include <stdint.h>
+#include <string.h>
+
+
+#define PROGMEM
+
+#define PSTR( s )                   ( s )
+
+typedef const char* PGM_P;
+
+
+// These keep the type of what they read, so reading a pointer (which avr-libc
+// does with pgm_read_word) works with 64-bit host pointers
+
+#define pgm_read_byte( addr )       ( *( addr ) )
+#define pgm_read_word( addr )       ( *( addr ) )
+#define pgm_read_dword( addr )      ( *( addr ) )
+#define pgm_read_float( addr )      ( *( addr ) )
+
+#define strcpy_P                    strcpy
+#define strncpy_P                   strncpy
+#define strcmp_P                    strcmp
+#define strlen_P                    strlen
+#define memcpy_P                    memcpy
+
+
+#endif
@@ -0,0 +1,34 @@
+/*
+    util/atomic.h - Host stand-in for avr-libc's atomic blocks.
+    Simulated interrupts never preempt code inside a block (they only run when
+    virtual time advances), so a block just runs its body once.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef HostSim_util_atomic_h
+#define HostSim_util_atomic_h
+
+
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          1
+
+#define ATOMIC_BLOCK( type )    for ( int hostSimAtomicOnce = 1; hostSimAtomicOnce; hostSimAtomicOnce = 0 )
+
+
+#endif
@@ -0,0 +1,250 @@
+/*
+    LinuxCoroutineTest.cpp - Check that coroutines wait, yield, and resume in
+    the right order, ignore resume events meant for others, and stop cleanly.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+#include <string>
+
+#include "Coroutine.h"
+#include "EventManager.h"
+#include "TimerService.h"
+
+
+
+
+const uint8_t kGoEvent = EventManager::kFirstUserEvent;
+const uint8_t kOtherEvent = EventManager::kFirstUserEvent + 1;
+
+
+// Stands in for a state running a coroutine; logs each step with the time
+class Sequence
+{
+public:
+
+    explicit Sequence( char name ) : mName( name ), mCount( 0 ) {}
+
+    void run( uint8_t event, int16_t param );
+
+    Coroutine   mCo;
+    std::string mLog;
+
+private:
+
+    void log( const char* step );
+
+    char        mName;
+    int         mCount;
+};
+
+
+uint32_t gClock;
+int gNbrErrorEvents;
+
+
+void runUntil( uint32_t endMs, Sequence* a, Sequence* b );
+void reset();
+bool checkWaitsInOrder();
+bool checkTwoAtOnce();
+bool checkStop();
+bool check( const char* what, const std::string& got, const std::string& expected );
+
+
+
+
+int main()
+{
+    EventManager::init();
+
+    bool allOkay = checkWaitsInOrder();
+    allOkay = checkTwoAtOnce() && allOkay;
+    allOkay = checkStop() && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+void Sequence::run( uint8_t event, int16_t param )
+{
+    CORO_BEGIN( mCo );
+
+    log( "start" );
+
+    for ( mCount = 0; mCount < 2; ++mCount )
+    {
+        CORO_WAIT_MS( mCo, 100 );
+        log( "tick" );
+    }
+
+    CORO_YIELD( mCo );
+    log( "yield" );
+
+    CORO_WAIT_EVENT( mCo, kGoEvent );
+    log( "go" );
+
+    CORO_END( mCo );
+
+    log( "end" );
+}
+
+
+void Sequence::log( const char* step )
+{
+    mLog += mName;
+    mLog += step;
+    mLog += '@';
+    mLog += std::to_string( gClock );
+    mLog += ' ';
+}
+
+
+
+
+void runUntil( uint32_t endMs, Sequence* a, Sequence* b )
+{
+    while ( gClock < endMs )
+    {
+        ++gClock;
+        TimerService::advanceTo( gClock );
+
+        uint8_t code;
+        int16_t param;
+        while ( EventManager::getNextEvent( &code, &param ) )
+        {
+            if ( code == EventManager::kErrorEvent )
+            {
+                ++gNbrErrorEvents;
+            }
+
+            a->run( code, param );
+            if ( b )
+            {
+                b->run( code, param );
+            }
+        }
+    }
+}
+
+
+void reset()
+{
+    gClock = 0;
+    gNbrErrorEvents = 0;
+    TimerService::init( 0 );
+    EventManager::reset();
+}
+
+
+
+
+bool checkWaitsInOrder()
+{
+    reset();
+
+    Sequence s( 'a' );
+    s.run( EventManager::kNullEvent, 0 );
+
+    // Unrelated events neither resume nor upset a wait in progress
+    EventManager::queueEvent( kOtherEvent, 0 );
+    EventManager::queueEvent( EventManager::kCoroutineResumeEvent, 12345 );
+    runUntil( 250, &s, 0 );
+
+    // The yield resumes before later events; the wait for kGoEvent ends when it arrives
+    bool okay = check( "Waits end on time", s.mLog, "astart@0 atick@100 atick@200 ayield@200 " );
+    okay = check( "Done only at the end", s.mCo.isDone() ? "done" : "running", "running" ) && okay;
+    okay = check( "Waits and yields post no errors", std::to_string( gNbrErrorEvents ), "0" ) && okay;
+
+    EventManager::queueEvent( kGoEvent, 0 );
+    runUntil( 300, &s, 0 );
+    okay = check( "Resumes on event", s.mLog, "astart@0 atick@100 atick@200 ayield@200 ago@251 aend@251 " ) && okay;
+
+    // Finished coroutines just return
+    EventManager::queueEvent( kGoEvent, 0 );
+    runUntil( 500, &s, 0 );
+    okay = check( "Done stays done", s.mLog, "astart@0 atick@100 atick@200 ayield@200 ago@251 aend@251 " ) && okay;
+    okay = check( "Done", s.mCo.isDone() ? "done" : "running", "done" ) && okay;
+
+    return okay;
+}
+
+
+bool checkTwoAtOnce()
+{
+    reset();
+
+    // Each sees the other's resume events, but only acts on its own
+    Sequence a( 'a' );
+    Sequence b( 'b' );
+    a.run( EventManager::kNullEvent, 0 );
+    runUntil( 50, &a, &b );
+    b.run( EventManager::kNullEvent, 0 );
+    runUntil( 220, &a, &b );
+
+    std::string both = a.mLog + "| " + b.mLog;
+    return check( "Two at once keep apart", both, "astart@0 atick@100 atick@200 ayield@200 | bstart@50 btick@150 " );
+}
+
+
+bool checkStop()
+{
+    reset();
+
+    Sequence s( 's' );
+    s.run( EventManager::kNullEvent, 0 );
+    runUntil( 50, &s, 0 );
+
+    // Stopping mid-wait cancels the timer; the coroutine then starts afresh
+    s.mCo.stop();
+    bool okay = check( "Stop cancels timer", std::to_string( TimerService::getNbrRunningTimers() ), "0" );
+    runUntil( 120, &s, 0 );
+    okay = check( "No resume after stop", s.mLog, "sstart@0 " ) && okay;
+
+    s.run( EventManager::kNullEvent, 0 );
+    runUntil( 230, &s, 0 );
+    okay = check( "Restarts from the top", s.mLog, "sstart@0 sstart@120 stick@220 " ) && okay;
+
+    // Destroying a waiting coroutine releases its timer
+    {
+        Sequence t( 't' );
+        t.run( EventManager::kNullEvent, 0 );
+    }
+    s.mCo.stop();
+    okay = check( "Destructor cancels timer", std::to_string( TimerService::getNbrRunningTimers() ), "0" ) && okay;
+
+    return okay;
+}
+
+
+
+
+bool check( const char* what, const std::string& got, const std::string& expected )
+{
+    bool okay = ( got == expected );
+    std::cout << what << ": " << ( okay ? "okay" : "WRONG" ) << std::endl;
+    if ( !okay )
+    {
+        std::cout << "  got      " << got << std::endl << "  expected " << expected << std::endl;
+    }
+    return okay;
+}
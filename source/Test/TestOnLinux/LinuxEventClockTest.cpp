@@ -0,0 +1,108 @@
+/*
+    LinuxEventClockTest.cpp - Check the events the EventClock derives from its
+    tick (built for more than one kCarrtEventClockHz).
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+
+#include "EventClock.h"
+#include "EventManager.h"
+#include "TestSupport.h"
+
+
+
+
+struct Expected
+{
+    uint8_t     event;
+    const char* name;
+    uint32_t    ticksPerEvent;
+    int16_t     paramCycle;
+};
+
+
+
+
+int main()
+{
+    const Expected kExpected[] =
+    {
+        { EventManager::kNavUpdateEvent,            "Nav update",       1,                          kCarrtEventClockHz },
+        { EventManager::kQuarterSecondTimerEvent,   "Quarter second",   kCarrtEventClockHz / 4,     4 },
+        { EventManager::kOneSecondTimerEvent,       "One second",       kCarrtEventClockHz,         8 },
+        { EventManager::kEightSecondTimerEvent,     "Eight second",     8 * kCarrtEventClockHz,     1 }
+    };
+    const int kNbrExpected = sizeof( kExpected ) / sizeof( kExpected[0] );
+
+    std::cout << "Clock at " << kCarrtEventClockHz << " Hz" << std::endl;
+
+    EventManager::init();
+
+    bool allOkay = check( "Tick matches rate", EventClock::kSecondsPerTick * EventClock::kTicksPerSecond == 1.0f );
+
+    // Twenty seconds of ticks, one at a time, checking each event's timing and parameter
+    uint32_t nbrSeen[ kNbrExpected ] = {};
+    bool inOrder = true;
+    bool otherEvents = false;
+
+    const uint32_t kNbrTicks = 20 * kCarrtEventClockHz;
+    for ( uint32_t tick = 1; tick <= kNbrTicks; ++tick )
+    {
+        EventClock::doTickFromIsr();
+
+        uint8_t event;
+        int16_t param;
+        while ( EventManager::getNextEvent( &event, &param ) )
+        {
+            int i = 0;
+            while ( i < kNbrExpected && kExpected[i].event != event )
+            {
+                ++i;
+            }
+
+            if ( i == kNbrExpected )
+            {
+                otherEvents = true;
+                continue;
+            }
+
+            ++nbrSeen[i];
+            if ( tick != nbrSeen[i] * kExpected[i].ticksPerEvent || param != static_cast<int16_t>( nbrSeen[i] % kExpected[i].paramCycle ) )
+            {
+                std::cout << "  " << kExpected[i].name << " at tick " << tick << " with param " << param << std::endl;
+                inOrder = false;
+            }
+        }
+    }
+
+    allOkay = check( "Events on time with right params", inOrder ) && allOkay;
+    allOkay = check( "No other events", !otherEvents ) && allOkay;
+
+    bool allCounted = true;
+    for ( int i = 0; i < kNbrExpected; ++i )
+    {
+        allCounted = allCounted && ( nbrSeen[i] == kNbrTicks / kExpected[i].ticksPerEvent );
+    }
+    allOkay = check( "Every event counted", allCounted ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
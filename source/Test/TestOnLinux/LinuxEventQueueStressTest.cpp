@@ -0,0 +1,473 @@
+/*
+    LinuxEventQueueStressTest.cpp - Stress test the lock-free EventManager queues
+    and timer event coalescing, using a second thread to stand in for the timer
+    interrupt handler.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#include "EventManager.h"
+
+
+
+
+// Events queued by the "ISR" thread and by the main (consumer) thread
+// (the timer events are coalesced, so the queue tests avoid them)
+const uint8_t kIsrHighEvent     = EventManager::kNavDriftCorrectionEvent;
+const uint8_t kIsrLowEvent      = EventManager::kLastEvent;
+const uint8_t kMainHighEvent    = EventManager::kErrorEvent;
+const uint8_t kMainLowEvent     = EventManager::kKeypadButtonHitEvent;
+
+const long kNbrIsrEvents        = 500000L;
+const long kNbrIsrTicks         = 200000L;
+
+
+
+std::atomic<bool> gProducerDone( false );
+long gProducerRetries = 0;
+
+
+bool checkPrioritiesAndAlternation();
+bool checkLevels();
+bool checkCoalescing();
+bool stressTest();
+bool coalescingStressTest();
+void isrStandIn();
+void isrTimerStandIn();
+bool checkSequence( const char* label, int16_t param, long* expected );
+
+
+
+
+int main()
+{
+    EventManager::init();
+
+    bool allOkay = checkPrioritiesAndAlternation();
+
+    allOkay = checkLevels() && allOkay;
+
+    allOkay = checkCoalescing() && allOkay;
+
+    allOkay = stressTest() && allOkay;
+
+    allOkay = coalescingStressTest() && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+bool checkPrioritiesAndAlternation()
+{
+    EventManager::reset();
+
+    // Low priority first, from both producers, then high priority
+    EventManager::queueEventFromIsr( kIsrLowEvent, 0 );
+    EventManager::queueEventFromIsr( kIsrLowEvent, 1 );
+    EventManager::queueEvent( kMainLowEvent, 0 );
+    EventManager::queueEvent( kMainLowEvent, 1 );
+    EventManager::queueEventFromIsr( kIsrHighEvent, 0, EventManager::kHighPriority );
+    EventManager::queueEvent( kMainHighEvent, 0, EventManager::kHighPriority );
+
+    bool okay = ( EventManager::getNumEventsInQueue( EventManager::kLowPriority ) == 4 )
+                && ( EventManager::getNumEventsInQueue( EventManager::kHighPriority ) == 2 );
+
+    // Both high priority events come out before any low priority event...
+    uint8_t code;
+    int16_t param;
+    uint8_t nbrHigh = 0;
+    for ( int i = 0; i < 2; ++i )
+    {
+        EventManager::getNextEvent( &code, &param );
+        nbrHigh += ( code == kIsrHighEvent || code == kMainHighEvent );
+    }
+    okay = okay && ( nbrHigh == 2 );
+
+    // ... and the low priority events alternate between the two producers, each in order
+    uint8_t last = 0;
+    long nextIsr = 0;
+    long nextMain = 0;
+    for ( int i = 0; i < 4; ++i )
+    {
+        EventManager::getNextEvent( &code, &param );
+        okay = okay && ( code != last );
+        okay = okay && ( code == kIsrLowEvent ? param == nextIsr++ : param == nextMain++ );
+        last = code;
+    }
+
+    okay = okay && !EventManager::getNextEvent( &code, &param );
+    okay = okay && EventManager::isEventQueueEmpty( EventManager::kLowPriority );
+
+    std::cout << "Priority and alternation check: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkLevels()
+{
+    EventManager::reset();
+
+    // Queued lowest first, at each code's default level...
+    EventManager::queueEvent( kMainLowEvent, 0 );
+    EventManager::queueEvent( EventManager::kFirstUserEvent, 0 );
+    EventManager::queueEventFromIsr( EventManager::kOneSecondTimerEvent, 1 );
+    EventManager::queueEvent( EventManager::kNavDriftCorrectionEvent, 0 );
+    EventManager::queueEventFromIsr( EventManager::kNavUpdateEvent, 2 );
+    EventManager::queueEvent( EventManager::kErrorEvent, 0 );
+
+    bool okay = ( EventManager::getNumEventsInQueue( EventManager::kLowPriority ) == 2 )
+                && ( EventManager::getNumEventsInQueue( EventManager::kTimerPriority ) == 1 )
+                && ( EventManager::getNumEventsInQueue( EventManager::kNavPriority ) == 2 )
+                && ( EventManager::getNumEventsInQueue( EventManager::kHighPriority ) == 1 );
+
+    // ... come out highest first (and within a level, in the order queued)
+    const uint8_t kExpectedOrder[] =
+    {
+        EventManager::kErrorEvent,
+        EventManager::kNavUpdateEvent,
+        EventManager::kNavDriftCorrectionEvent,
+        EventManager::kOneSecondTimerEvent,
+        kMainLowEvent,
+        EventManager::kFirstUserEvent
+    };
+
+    uint8_t code;
+    int16_t param;
+    for ( uint8_t expected : kExpectedOrder )
+    {
+        okay = okay && EventManager::getNextEvent( &code, &param ) && ( code == expected );
+    }
+    okay = okay && !EventManager::getNextEvent( &code, &param ) && EventManager::areEventQueuesEmpty();
+
+    // An explicit priority overrides the table
+    EventManager::queueEvent( kMainLowEvent, 7, EventManager::kHighPriority );
+    okay = okay && ( EventManager::getNumEventsInQueue( EventManager::kHighPriority ) == 1 );
+    okay = okay && EventManager::getNextEvent( &code, &param ) && ( code == kMainLowEvent ) && ( param == 7 );
+
+    // Each level has its own capacity:  filling one leaves the others free
+    int nbrQueued = 0;
+    while ( !EventManager::queueEvent( EventManager::kNavDriftCorrectionEvent, nbrQueued ) )
+    {
+        ++nbrQueued;
+    }
+    okay = okay && ( nbrQueued > 0 ) && EventManager::isEventQueueFull( EventManager::kNavPriority );
+    okay = okay && !EventManager::isEventQueueFull( EventManager::kHighPriority );
+    okay = okay && !EventManager::queueEvent( EventManager::kErrorEvent, 0 );
+    okay = okay && EventManager::getNextEvent( &code, &param ) && ( code == EventManager::kErrorEvent );
+    for ( int i = 0; i < nbrQueued; ++i )
+    {
+        okay = okay && EventManager::getNextEvent( &code, &param ) && ( param == i );
+    }
+    okay = okay && EventManager::areEventQueuesEmpty();
+
+    EventManager::resetEventQueueOverflowFlag();
+
+    std::cout << "Priority level check: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkCoalescing()
+{
+    EventManager::reset();
+
+    // Twenty nav ticks while the main loop is stalled occupy a single queue slot...
+    for ( int i = 1; i <= 20; ++i )
+    {
+        EventManager::queueEventFromIsr( EventManager::kNavUpdateEvent, i & 0x07, EventManager::kHighPriority );
+    }
+    bool okay = ( EventManager::getNumEventsInQueue( EventManager::kHighPriority ) == 1 );
+
+    // ... and come out as one event carrying the latest tick and the number missed
+    uint8_t code;
+    int16_t param;
+    okay = okay && EventManager::getNextEvent( &code, &param );
+    okay = okay && ( code == EventManager::kNavUpdateEvent );
+    okay = okay && ( EventManager::getTimerTick( param ) == ( 20 & 0x07 ) );
+    okay = okay && ( EventManager::getMissedTicks( param ) == 19 );
+    okay = okay && !EventManager::getNextEvent( &code, &param );
+
+    // A long stall saturates the missed count without ever going negative
+    for ( int i = 1; i <= 300; ++i )
+    {
+        EventManager::queueEventFromIsr( EventManager::kOneSecondTimerEvent, i & 0x07 );
+    }
+    okay = okay && EventManager::getNextEvent( &code, &param );
+    okay = okay && ( code == EventManager::kOneSecondTimerEvent );
+    okay = okay && ( EventManager::getMissedTicks( param ) == 127 ) && ( param >= 0 );
+    okay = okay && ( EventManager::getTimerTick( param ) == ( 300 & 0x07 ) );
+
+    // After that, ticks are delivered one at a time again
+    EventManager::queueEventFromIsr( EventManager::kOneSecondTimerEvent, 5 );
+    okay = okay && EventManager::getNextEvent( &code, &param );
+    okay = okay && ( code == EventManager::kOneSecondTimerEvent ) && ( param == 5 );
+
+    // Reset drops pending ticks, and coalescing still works afterward
+    EventManager::queueEventFromIsr( EventManager::kQuarterSecondTimerEvent, 1 );
+    EventManager::reset();
+    okay = okay && !EventManager::getNextEvent( &code, &param );
+    EventManager::queueEventFromIsr( EventManager::kQuarterSecondTimerEvent, 2 );
+    EventManager::queueEventFromIsr( EventManager::kQuarterSecondTimerEvent, 3 );
+    okay = okay && EventManager::getNextEvent( &code, &param );
+    okay = okay && ( code == EventManager::kQuarterSecondTimerEvent ) && ( param == ( ( 1 << 8 ) | 3 ) );
+
+    okay = okay && !EventManager::hasEventQueueOverflowed();
+
+    std::cout << "Coalescing check: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool stressTest()
+{
+    EventManager::reset();
+
+    long expectedIsrHigh = 0;
+    long expectedIsrLow = 0;
+    long expectedMainHigh = 0;
+    long expectedMainLow = 0;
+    long queuedMainHigh = 0;
+    long queuedMainLow = 0;
+    long nbrLowAheadOfHigh = 0;
+    bool okay = true;
+
+    std::thread producer( isrStandIn );
+
+    uint8_t code;
+    int16_t param;
+    long iteration = 0;
+
+    while ( okay )
+    {
+        // The main loop queues its own events too
+        ++iteration;
+        if ( ( iteration & 0x07 ) == 0 && !EventManager::isEventQueueFull( EventManager::kHighPriority ) )
+        {
+            EventManager::queueEvent( kMainHighEvent, static_cast<int16_t>( queuedMainHigh++ & 0x7FFF ), EventManager::kHighPriority );
+        }
+        if ( ( iteration & 0x03 ) == 0 && !EventManager::isEventQueueFull( EventManager::kLowPriority ) )
+        {
+            EventManager::queueEvent( kMainLowEvent, static_cast<int16_t>( queuedMainLow++ & 0x7FFF ) );
+        }
+
+        bool producerDone = gProducerDone.load();
+
+        if ( !EventManager::getNextEvent( &code, &param ) )
+        {
+            if ( producerDone && EventManager::isEventQueueEmpty( EventManager::kHighPriority )
+                    && EventManager::isEventQueueEmpty( EventManager::kLowPriority ) )
+            {
+                break;
+            }
+
+            // Let the producer run (matters on a single core host)
+            std::this_thread::yield();
+            continue;
+        }
+
+        switch ( code )
+        {
+            case kIsrHighEvent:
+                okay = checkSequence( "ISR high", param, &expectedIsrHigh );
+                break;
+
+            case kIsrLowEvent:
+                okay = checkSequence( "ISR low", param, &expectedIsrLow );
+                break;
+
+            case kMainHighEvent:
+                okay = checkSequence( "Main high", param, &expectedMainHigh );
+                break;
+
+            case kMainLowEvent:
+                okay = checkSequence( "Main low", param, &expectedMainLow );
+                break;
+
+            default:
+                std::cout << "  Unexpected event code " << static_cast<int>( code ) << std::endl;
+                okay = false;
+                break;
+        }
+
+        // The main loop's own high priority events are never still waiting when a low one comes out
+        if ( code == kIsrLowEvent || code == kMainLowEvent )
+        {
+            if ( expectedMainHigh != queuedMainHigh )
+            {
+                ++nbrLowAheadOfHigh;
+            }
+        }
+    }
+
+    producer.join();
+
+    okay = okay && ( nbrLowAheadOfHigh == 0 );
+    okay = okay && ( expectedIsrHigh + expectedIsrLow == kNbrIsrEvents );
+    okay = okay && ( expectedMainHigh == queuedMainHigh ) && ( expectedMainLow == queuedMainLow );
+
+    std::cout << "Stress test:" << std::endl;
+    std::cout << "  ISR events received:   " << expectedIsrHigh << " high, " << expectedIsrLow << " low" << std::endl;
+    std::cout << "  Main events received:  " << expectedMainHigh << " high, " << expectedMainLow << " low" << std::endl;
+    std::cout << "  Producer retries (queue full):  " << gProducerRetries << std::endl;
+    std::cout << "  Low events ahead of high:       " << nbrLowAheadOfHigh << std::endl;
+    std::cout << "  " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+void isrStandIn()
+{
+    long nbrHigh = 0;
+    long nbrLow = 0;
+
+    for ( long i = 0; i < kNbrIsrEvents; ++i )
+    {
+        // Same mix as the event clock: a high priority nav event plus some low priority timer events
+        bool isHigh = ( i % 3 ) == 0;
+        uint8_t code = isHigh ? kIsrHighEvent : kIsrLowEvent;
+        EventManager::EventPriority pri = isHigh ? EventManager::kHighPriority : EventManager::kLowPriority;
+        int16_t param = static_cast<int16_t>( ( isHigh ? nbrHigh++ : nbrLow++ ) & 0x7FFF );
+
+        // A real ISR would drop the event; here retry so every event can be accounted for
+        while ( EventManager::queueEventFromIsr( code, param, pri ) )
+        {
+            ++gProducerRetries;
+            std::this_thread::yield();
+        }
+    }
+
+    gProducerDone.store( true );
+}
+
+
+
+
+bool coalescingStressTest()
+{
+    EventManager::reset();
+    gProducerDone.store( false );
+
+    long ticksSeen = 0;
+    long nbrEvents = 0;
+    uint8_t maxQueued = 0;
+    bool saturated = false;
+    bool okay = true;
+
+    std::thread producer( isrTimerStandIn );
+
+    uint8_t code;
+    int16_t param;
+
+    while ( okay )
+    {
+        uint8_t n = EventManager::getNumEventsInQueue( EventManager::kHighPriority );
+        if ( n > maxQueued )
+        {
+            maxQueued = n;
+        }
+
+        bool producerDone = gProducerDone.load();
+
+        if ( !EventManager::getNextEvent( &code, &param ) )
+        {
+            if ( producerDone && EventManager::isEventQueueEmpty( EventManager::kHighPriority ) )
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        okay = ( code == EventManager::kNavUpdateEvent ) && ( param >= 0 );
+
+        ++nbrEvents;
+        ticksSeen += 1 + EventManager::getMissedTicks( param );
+        saturated = saturated || ( EventManager::getMissedTicks( param ) == 127 );
+    }
+
+    producer.join();
+
+    // Unless the count saturated, every tick is accounted for exactly once
+    okay = okay && ( saturated ? ticksSeen <= kNbrIsrTicks : ticksSeen == kNbrIsrTicks );
+    okay = okay && ( maxQueued <= 1 ) && !EventManager::hasEventQueueOverflowed();
+
+    std::cout << "Coalescing stress test:" << std::endl;
+    std::cout << "  Ticks sent:       " << kNbrIsrTicks << std::endl;
+    std::cout << "  Ticks accounted:  " << ticksSeen << " in " << nbrEvents << " events"
+              << ( saturated ? " (saturated)" : "" ) << std::endl;
+    std::cout << "  Max queued:       " << static_cast<int>( maxQueued ) << std::endl;
+    std::cout << "  " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+void isrTimerStandIn()
+{
+    for ( long i = 1; i <= kNbrIsrTicks; ++i )
+    {
+        // Never fails: coalescing keeps at most one nav event in the queue
+        EventManager::queueEventFromIsr( EventManager::kNavUpdateEvent, i & 0x07, EventManager::kHighPriority );
+
+        if ( ( i & 0x0F ) == 0 )
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    gProducerDone.store( true );
+}
+
+
+
+
+bool checkSequence( const char* label, int16_t param, long* expected )
+{
+    if ( param != static_cast<int16_t>( *expected & 0x7FFF ) )
+    {
+        std::cout << "  " << label << " event out of sequence: got " << param
+                  << ", expected " << ( *expected & 0x7FFF ) << std::endl;
+        return false;
+    }
+
+    ++*expected;
+    return true;
+}
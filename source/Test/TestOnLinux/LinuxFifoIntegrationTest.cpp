@@ -0,0 +1,160 @@
+/*
+    LinuxFifoIntegrationTest.cpp - Replay a known turning profile through the
+    simulated gyroscope, and compare the heading change from integrating every
+    FIFO reading with that from one reading per nav update.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <cmath>
+#include <iostream>
+
+#include "EventManager.h"
+#include "HostSim.h"
+#include "ImuSampler.h"
+#include "TestSupport.h"
+
+#include "Drivers/L3GD20.h"
+#include "Drivers/Motors.h"
+
+
+
+namespace
+{
+    const uint32_t  kMicrosPerTick      = 125000;
+    const float     kSecondsPerTick     = 0.125;
+    const int       kNbrTicks           = 80;
+
+    // The turns, one change per nav update, somewhere in the middle of it
+    struct Turn
+    {
+        HostSim::MotorMotion    motion;
+        uint8_t                 speed;
+    };
+
+    const Turn kTurns[] =
+    {
+        { HostSim::kMotorsRotateRight,  Motors::kFullSpeed },
+        { HostSim::kMotorsStopped,      0 },
+        { HostSim::kMotorsRotateLeft,   Motors::kHalfSpeed },
+        { HostSim::kMotorsRotateRight,  160 },
+        { HostSim::kMotorsStopped,      0 },
+        { HostSim::kMotorsRotateRight,   96 }
+    };
+    const int kNbrTurns = sizeof( kTurns ) / sizeof( kTurns[0] );
+
+    uint64_t    sLastMicros;
+    double      sTrueHeadingChange;
+};
+
+
+void updateTruth();
+double sampleHeadingChange( float timeStep );
+
+
+
+
+int main()
+{
+    HostSim::init();
+    EventManager::init();
+
+    sLastMicros = HostSim::getMicros();
+
+    double fifoHeadingChange = 0;
+    double singleHeadingChange = 0;
+    bool allOkay = true;
+
+    for ( int tick = 0; tick < kNbrTicks; ++tick )
+    {
+        // Change the turn at an irregular point in the nav update
+        uint32_t changeMicros = ( ( 17 + 41 * tick ) % 120 ) * 1000L;
+        const Turn& turn = kTurns[ tick % kNbrTurns ];
+
+        HostSim::spendMicros( changeMicros );
+        updateTruth();
+        HostSim::setMotors( turn.motion, turn.speed );
+        HostSim::spendMicros( kMicrosPerTick - changeMicros );
+        updateTruth();
+
+        // One reading for the whole nav update...
+        singleHeadingChange -= L3GD20::convertRawToDegreesPerSecond( L3GD20::getAngularRatesRaw().z ) * kSecondsPerTick;
+        updateTruth();
+
+        // ...versus everything in the FIFO
+        fifoHeadingChange += sampleHeadingChange( kSecondsPerTick );
+    }
+
+    double fifoError = std::fabs( fifoHeadingChange - sTrueHeadingChange );
+    double singleError = std::fabs( singleHeadingChange - sTrueHeadingChange );
+
+    std::cout << "True heading change: " << sTrueHeadingChange << std::endl;
+    std::cout << "Full FIFO: " << fifoHeadingChange << " (error " << fifoError << ")" << std::endl;
+    std::cout << "Single reading: " << singleHeadingChange << " (error " << singleError << ")" << std::endl;
+
+    allOkay = check( "Every nav update sampled", allOkay && ImuSampler::getNbrSkipped() == 0 ) && allOkay;
+    // Each reading stands for a whole update period, so a change in turn rate costs
+    // up to a period's worth of error
+    allOkay = check( "Full FIFO within 1%", fifoError < 0.01 * std::fabs( sTrueHeadingChange ) ) && allOkay;
+    allOkay = check( "Full FIFO beats a single reading", fifoError * 5 < singleError ) && allOkay;
+
+    // A late nav update:  the gyroscope's FIFO fills up and drops its oldest readings
+    const uint32_t kLateMicros = 300000;
+    updateTruth();
+    HostSim::setMotors( HostSim::kMotorsRotateRight, Motors::kFullSpeed );
+    double trueBefore = sTrueHeadingChange;
+
+    HostSim::spendMicros( kLateMicros );
+    updateTruth();
+    bool overran = HostSim::getGyroFifoLevel() == 32;
+    double lateHeadingChange = sampleHeadingChange( kLateMicros / 1e6 );
+    double lateTrueChange = sTrueHeadingChange - trueBefore;
+    double lateError = std::fabs( lateHeadingChange - lateTrueChange );
+
+    std::cout << "Late update:  true " << lateTrueChange << ", FIFO " << lateHeadingChange << " (error " << lateError << ")" << std::endl;
+    allOkay = check( "Late update overran the FIFO", overran ) && allOkay;
+    allOkay = check( "Late update within 2%", lateError < 0.02 * std::fabs( lateTrueChange ) ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+void updateTruth()
+{
+    // The turn rate is constant between changes
+    uint64_t now = HostSim::getMicros();
+    sTrueHeadingChange += HostSim::getTurnRate() * ( now - sLastMicros ) / 1e6;
+    sLastMicros = now;
+}
+
+
+double sampleHeadingChange( float timeStep )
+{
+    // The heading change over a nav update, from the gyroscope FIFO
+    int16_t param;
+    if ( !HostSim::takeNavSample( timeStep, &param ) )
+    {
+        return NAN;
+    }
+
+    return -L3GD20::convertRawSumToDegrees( ImuSampler::getSample( param ).gyroSum.z );
+}
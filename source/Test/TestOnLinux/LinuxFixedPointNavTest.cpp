@@ -0,0 +1,136 @@
+/*
+    LinuxFixedPointNavTest.cpp - Drive a course in the host simulator, feed
+    the same sensor samples to the floating point and fixed-point
+    dead-reckoning models (the Navigator's compare mode), and check they
+    track the same trajectory.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <iostream>
+
+#include "EventClock.h"
+#include "EventManager.h"
+#include "HostSim.h"
+#include "Navigator.h"
+#include "TestSupport.h"
+
+#include "AVRTools/SystemClock.h"
+#include "Drivers/DriveParam.h"
+#include "Drivers/L3GD20.h"
+#include "Drivers/LSM303DLHC.h"
+#include "Drivers/Motors.h"
+#include "Utils/DebuggingMacros.h"
+#include "Utils/FixedPoint.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    struct Leg
+    {
+        HostSim::MotorMotion    motion;
+        int                     nbrTicks;
+    };
+
+    const Leg kCourse[] =
+    {
+        { HostSim::kMotorsForward,      24 },
+        { HostSim::kMotorsRotateRight,   8 },
+        { HostSim::kMotorsForward,      16 },
+        { HostSim::kMotorsRotateLeft,   13 },
+        { HostSim::kMotorsForward,      20 },
+        { HostSim::kMotorsRotateRight,  30 },
+        { HostSim::kMotorsForward,      12 }
+    };
+    const int kNbrLegs = sizeof( kCourse ) / sizeof( kCourse[0] );
+};
+
+
+
+
+int main()
+{
+    HostSim::init();
+    EventManager::init();
+
+    HostSim::Pose pose = { 0, 0, 30 };
+    HostSim::setPose( pose );
+
+    // Compare mode runs the floating and fixed point models side by side on the
+    // same samples, and keeps track of how far apart they get
+    Navigator::init();
+    Navigator::setModel( Navigator::kModelCompare );
+
+    bool allSampled = true;
+
+    for ( int leg = 0; leg < kNbrLegs; ++leg )
+    {
+        HostSim::setMotors( kCourse[leg].motion, Motors::kFullSpeed );
+        if ( kCourse[leg].motion == HostSim::kMotorsForward )
+        {
+            Navigator::movingStraight();
+        }
+        else
+        {
+            Navigator::movingTurning();
+        }
+
+        for ( int tick = 0; tick < kCourse[leg].nbrTicks; ++tick )
+        {
+            // Both get the same sample
+            if ( !HostSim::doNavTick() )
+            {
+                allSampled = false;
+            }
+        }
+    }
+
+    Navigator::stopped();
+
+    Vector2Float p = Navigator::getCurrentPosition();
+    Navigator::Disagreement diff = Navigator::getDisagreement( Navigator::kModelDeadReckoningFixed );
+    double maxHeadingDiff = diff.heading;
+    double maxPositionDiff = diff.distance / 100.0;
+    std::cout << "Float:  heading " << Navigator::getCurrentHeading() << ", position " << p.x << ", " << p.y << std::endl;
+    std::cout << "Max differences:  heading " << maxHeadingDiff << " deg, position " << maxPositionDiff * 1000 << " mm" << std::endl;
+
+    bool allOkay = check( "Every update sampled", allSampled );
+    allOkay = check( "Headings within 0.1 deg", maxHeadingDiff < 0.1 ) && allOkay;
+    allOkay = check( "Positions within 5 mm", maxPositionDiff < 0.005 ) && allOkay;
+
+    // The integer trig agrees with the library's
+    double maxTrigError = 0;
+    for ( uint16_t angle = 0; angle < FixedPoint::kCentiDegreesPerCircle; angle += 7 )
+    {
+        double rad = angle / 100.0 * M_PI / 180.0;
+        double sinError = fabs( FixedPoint::sinCentiDegrees( angle ) / 32767.0 - sin( rad ) );
+        double cosError = fabs( FixedPoint::cosCentiDegrees( angle ) / 32767.0 - cos( rad ) );
+        maxTrigError = fmax( maxTrigError, fmax( sinError, cosError ) );
+    }
+    allOkay = check( "Integer sin and cos within 1e-4", maxTrigError < 1e-4 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
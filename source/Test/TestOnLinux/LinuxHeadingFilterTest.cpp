@@ -0,0 +1,294 @@
+/*
+    LinuxHeadingFilterTest.cpp - Run the HeadingFilter and the heading rules
+    it replaced on a synthetic nav log with a known gyro bias, compass noise,
+    and compass disturbances, and check the tuner recovers the noise.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "EventClock.h"
+#include "HeadingFilter.h"
+#include "HeadingFilterTuning.h"
+#include "TestSupport.h"
+
+
+
+
+namespace
+{
+    const float     kTimeStep           = EventClock::kSecondsPerTick;
+    const int       kNbrUpdates         = 4000;
+
+    const float     kStartingBias       = 0.5;          // deg/s (it then wanders)
+    const float     kTurnRate           = 30;           // deg/s
+
+    // Straight for a while, then a turn, alternating left and right
+    const int       kStraightUpdates    = 60;
+    const int       kTurnUpdates        = 16;
+
+    // Every so often the compass is pulled off for a few updates (steel in the floor, the motors...)
+    const int       kDisturbanceEvery   = 250;
+    const int       kDisturbanceUpdates = 5;
+    const float     kDisturbance        = 25;           // deg
+
+
+    struct TrueRun
+    {
+        std::vector<float>  heading;
+        std::vector<HeadingFilterTuning::LogEntry> log;
+        float               finalBias;
+    };
+
+
+    const int       kStraightMove       = 0x01;         // Navigator's Motion values
+    const int       kTurnMove           = 0x10;
+};
+
+
+float wrap( float heading );
+float wrapChange( float change );
+TrueRun makeRun( const HeadingFilter::NoiseParams& noise, unsigned seed );
+std::string writeNavLog( const TrueRun& run, bool fixedPoint );
+float runOldRules( const TrueRun& run );
+float runFilter( const TrueRun& run, float* finalBias );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    // Noise as the default parameters assume it
+    const HeadingFilter::NoiseParams kDefaults = HeadingFilter::getNoiseParams();
+    TrueRun run = makeRun( kDefaults, 1 );
+
+    // The run, through the debug log and back, in both Navigators' formats
+    std::vector<HeadingFilterTuning::LogEntry> fromLog;
+    std::istringstream floatLog( writeNavLog( run, false ) );
+    int nbrFloat = HeadingFilterTuning::readNavLog( floatLog, &fromLog );
+    std::istringstream fixedLog( writeNavLog( run, true ) );
+    int nbrFixed = HeadingFilterTuning::readNavLog( fixedLog, &fromLog );
+
+    bool sameEntries = ( nbrFloat == kNbrUpdates && nbrFixed == kNbrUpdates );
+    for ( int i = 0; sameEntries && i < kNbrUpdates; ++i )
+    {
+        const HeadingFilterTuning::LogEntry& a = fromLog[i];
+        const HeadingFilterTuning::LogEntry& b = fromLog[i + kNbrUpdates];
+        sameEntries = fabs( a.compassHeading - run.log[i].compassHeading ) < 0.01
+                        && fabs( a.compassHeading - b.compassHeading ) < 0.01
+                        && fabs( a.gyroChange - b.gyroChange ) < 0.01
+                        && fabs( a.timeStep - b.timeStep ) < 0.001
+                        && a.turning == run.log[i].turning && b.turning == a.turning;
+    }
+    allOkay = check( "Float and fixed-point logs read back the same", sameEntries ) && allOkay;
+
+    // Against the rules it replaced
+    float bias;
+    float filterError = runFilter( run, &bias );
+    float oldError = runOldRules( run );
+    std::cout << "RMS heading error:  filter " << filterError << " deg, old rules " << oldError << " deg" << std::endl;
+    std::cout << "Bias:  estimated " << bias << " deg/s, true " << run.finalBias << " deg/s" << std::endl;
+
+    allOkay = check( "Filter error less than half the old rules'", filterError < 0.5 * oldError ) && allOkay;
+    allOkay = check( "Filter error under 2 deg", filterError < 2 ) && allOkay;
+    allOkay = check( "Bias estimated within 0.1 deg/s", fabs( bias - run.finalBias ) < 0.1 ) && allOkay;
+
+    // The tuner recovers the compass noise of a run noisier than the defaults
+    const HeadingFilter::NoiseParams kNoisier = { 0.2, 0.01, 3.0, 15.0 };
+    TrueRun noisyRun = makeRun( kNoisier, 2 );
+
+    HeadingFilter::NoiseParams fitted = HeadingFilterTuning::fitNoiseParams( noisyRun.log, kDefaults );
+    std::cout << "Fitted:  gyro " << fitted.gyroNoise << ", bias " << fitted.biasNoise << ", compass "
+              << fitted.compassNoise << ", compass turning " << fitted.compassNoiseTurning << std::endl;
+
+    allOkay = check( "Compass noise within 20%", fabs( fitted.compassNoise / kNoisier.compassNoise - 1 ) < 0.2 ) && allOkay;
+    allOkay = check( "Turning compass noise within 20%",
+                     fabs( fitted.compassNoiseTurning / kNoisier.compassNoiseTurning - 1 ) < 0.2 ) && allOkay;
+
+    float fittedError = runFilter( noisyRun, &bias );
+    HeadingFilter::setNoiseParams( kDefaults );
+    float defaultError = runFilter( noisyRun, &bias );
+    std::cout << "Noisier run RMS heading error:  fitted " << fittedError << " deg, defaults " << defaultError << " deg" << std::endl;
+    allOkay = check( "Fitted no worse than the defaults", fittedError <= defaultError * 1.02 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+float wrap( float heading )
+{
+    heading = fmod( heading, 360 );
+    return heading < 0 ? heading + 360 : heading;
+}
+
+
+
+float wrapChange( float change )
+{
+    change = wrap( change );
+    return change > 180 ? change - 360 : change;
+}
+
+
+
+TrueRun makeRun( const HeadingFilter::NoiseParams& noise, unsigned seed )
+{
+    std::mt19937 random( seed );
+    std::normal_distribution<float> normal( 0, 1 );
+
+    TrueRun run;
+    float heading = 30;
+    float bias = kStartingBias;
+    int turnDirection = 1;
+
+    for ( int i = 0; i < kNbrUpdates; ++i )
+    {
+        int phase = i % ( kStraightUpdates + kTurnUpdates );
+        bool turning = phase >= kStraightUpdates;
+        if ( phase == kStraightUpdates )
+        {
+            turnDirection = -turnDirection;
+        }
+
+        float change = turning ? turnDirection * kTurnRate * kTimeStep : 0;
+        heading = wrap( heading + change );
+        bias += noise.biasNoise * sqrt( kTimeStep ) * normal( random );
+
+        HeadingFilterTuning::LogEntry entry;
+        entry.gyroChange = change + bias * kTimeStep + noise.gyroNoise * sqrt( kTimeStep ) * normal( random );
+        entry.compassHeading = heading
+                                + ( turning ? noise.compassNoiseTurning : noise.compassNoise ) * normal( random );
+        if ( i % kDisturbanceEvery >= kDisturbanceEvery - kDisturbanceUpdates )
+        {
+            entry.compassHeading += kDisturbance;
+        }
+        entry.compassHeading = wrap( entry.compassHeading );
+        entry.timeStep = kTimeStep;
+        entry.turning = turning;
+
+        run.heading.push_back( heading );
+        run.log.push_back( entry );
+    }
+    run.finalBias = bias;
+
+    return run;
+}
+
+
+
+std::string writeNavLog( const TrueRun& run, bool fixedPoint )
+{
+    // Only the columns the tuner reads matter
+    std::ostringstream out;
+    out << "Some other output" << std::endl;
+    if ( fixedPoint )
+    {
+        out << "time, label, vx, vy, sx, sy, hdg-cd, chdg-cd, innov-cd, del-g-cd, bias-q16, dt-q12, move" << std::endl;
+    }
+    else
+    {
+        out << "time, label, vx, vy, sx, sy, hdg, chdg, innov, del-g, bias, dt, move" << std::endl;
+    }
+
+    for ( size_t i = 0; i < run.log.size(); ++i )
+    {
+        const HeadingFilterTuning::LogEntry& e = run.log[i];
+        int move = e.turning ? kTurnMove : kStraightMove;
+        out << i * 125 << ", doNavUpdate, 0, 0, 0, 0, ";
+        if ( fixedPoint )
+        {
+            out << lround( run.heading[i] * 100 ) << ", " << lround( e.compassHeading * 100 ) << ", 0, "
+                << lround( e.gyroChange * 100 ) << ", 0, " << lround( e.timeStep * 4096 ) << ", " << move << std::endl;
+        }
+        else
+        {
+            out << run.heading[i] << ", " << e.compassHeading << ", 0, "
+                << e.gyroChange << ", 0, " << e.timeStep << ", " << move << std::endl;
+        }
+    }
+
+    return out.str();
+}
+
+
+
+float runOldRules( const TrueRun& run )
+{
+    // Navigator::determineNewHeading() as it was
+    float heading = run.log[0].compassHeading;
+    double sumSquares = 0;
+
+    for ( size_t i = 1; i < run.log.size(); ++i )
+    {
+        const HeadingFilterTuning::LogEntry& e = run.log[i];
+        float compassChange = wrapChange( e.compassHeading - heading );
+        float change = e.gyroChange;
+
+        if ( !e.turning )
+        {
+            if ( fabs( compassChange ) < 4 )
+            {
+                change = ( compassChange + e.gyroChange ) / 2.0;
+            }
+        }
+        else if ( fabs( compassChange ) < fabs( e.gyroChange ) )
+        {
+            change = compassChange;
+        }
+
+        heading = wrap( heading + change );
+
+        float error = wrapChange( heading - run.heading[i] );
+        sumSquares += error * error;
+    }
+
+    return sqrt( sumSquares / ( run.log.size() - 1 ) );
+}
+
+
+
+float runFilter( const TrueRun& run, float* finalBias )
+{
+    HeadingFilter::State state;
+    HeadingFilter::reset( &state, run.log[0].compassHeading );
+    double sumSquares = 0;
+
+    for ( size_t i = 1; i < run.log.size(); ++i )
+    {
+        const HeadingFilterTuning::LogEntry& e = run.log[i];
+        HeadingFilter::update( &state, e.gyroChange, e.compassHeading, e.timeStep, e.turning );
+
+        float error = wrapChange( state.heading - run.heading[i] );
+        sumSquares += error * error;
+    }
+
+    *finalBias = state.bias;
+    return sqrt( sumSquares / ( run.log.size() - 1 ) );
+}
@@ -0,0 +1,164 @@
+/*
+    LinuxHostSimTest.cpp - Run CARRT's real event loop and states on the host
+    simulation:  boot, navigate the menus, reset, then idle for ten minutes of
+    virtual time, checking what the display shows along the way.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HostSim.h"
+#include "TestSupport.h"
+
+#include "MainProcess.h"
+#include "TraceRecorder.h"
+
+#include "Drivers/Keypad.h"
+
+
+
+
+struct Snapshot
+{
+    uint32_t    ms;
+    std::string top;
+    std::string bottom;
+};
+
+std::vector<Snapshot> gSnapshots;
+
+
+void recordDisplay( uint32_t ms, const char* topRow, const char* bottomRow );
+const Snapshot& displayAt( uint32_t ms );
+bool displayShowed( uint32_t fromMs, uint32_t toMs, const std::string& top );
+
+
+
+
+int main()
+{
+    const uint32_t kEndMs = 600000;
+
+    HostSim::init();
+    HostSim::setDisplayListener( recordDisplay );
+
+    HostSim::Pose pose = { 0.5, -0.25, 90 };
+    HostSim::setPose( pose );
+
+    // Down to "Nav Info...", select it, then back to the welcome menu
+    HostSim::pressKeys( 10000, Keypad::kButton_Down );
+    HostSim::pressKeys( 10500, Keypad::kButton_Down );
+    HostSim::pressKeys( 11000, Keypad::kButton_Down );
+    HostSim::pressKeys( 11500, Keypad::kButton_Select );
+    HostSim::pressKeys( 14000, Keypad::kButton_Select );
+
+    // Reset
+    HostSim::pressKeys( 20000, Keypad::kChord_Reset );
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int err = HostSim::runCarrt( kEndMs );
+    double wallSecs = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    bool allOkay = check( "Ran to the end", err == 0 && HostSim::getMillis() == kEndMs );
+
+    allOkay = check( "Booted to welcome menu", displayAt( 9000 ).top == "Welcome to CARRT" ) && allOkay;
+
+    // The Navigator's heading comes from the simulated compass
+    allOkay = check( "Nav info shows heading", displayAt( 13000 ).bottom == "Heading   90    " ) && allOkay;
+
+    allOkay = check( "Back to welcome menu", displayAt( 16000 ).top == "Welcome to CARRT" ) && allOkay;
+
+    allOkay = check( "Reset rebooted", displayShowed( 20000, 22000, "CARRT is        " )
+                                       && displayAt( 30000 ).top == "Welcome to CARRT" ) && allOkay;
+
+    allOkay = check( "Still on welcome menu at the end", displayAt( kEndMs ).top == "Welcome to CARRT" ) && allOkay;
+
+#if CARRT_ENABLE_TRACE_RECORDER
+    int nbrResets = 0;
+    for ( uint8_t i = 0; i < TraceRecorder::getNbrRecords(); ++i )
+    {
+        if ( TraceRecorder::getRecord( i ).code == TraceRecorder::kTraceReset )
+        {
+            ++nbrResets;
+        }
+    }
+    allOkay = check( "Trace shows both starts", nbrResets == 2 ) && allOkay;
+#endif
+
+    // Idle, the loop sleeps until each 1 ms system clock tick
+    const MainProcess::LoopStats& stats = MainProcess::getLoopStats();
+    allOkay = check( "Event loop slept", HostSim::getNbrSleeps() > ( kEndMs - 30000 )
+                                         && stats.wakesForEvent > 8 * ( kEndMs - 30000 ) / 1000 ) && allOkay;
+
+    // Idle, every nav update runs on time
+    allOkay = check( "Nav updates on time", stats.navUpdates > 8 * ( kEndMs - 30000 ) / 1000
+                                            && stats.navDeadlinesMissed == 0
+                                            && stats.maxNavLatenessMs < 125 ) && allOkay;
+
+    double speedup = ( kEndMs / 1000.0 ) / wallSecs;
+    std::cout << "Ran " << kEndMs / 1000 << " s of CARRT time in " << wallSecs << " s (" << speedup << "x real time)" << std::endl;
+    allOkay = check( "Faster than real time", speedup > 10 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+void recordDisplay( uint32_t ms, const char* topRow, const char* bottomRow )
+{
+    Snapshot s;
+    s.ms = ms;
+    s.top = topRow;
+    s.bottom = bottomRow;
+    gSnapshots.push_back( s );
+}
+
+
+
+const Snapshot& displayAt( uint32_t ms )
+{
+    static const Snapshot kNone = { 0, "", "" };
+
+    const Snapshot* last = &kNone;
+    for ( size_t i = 0; i < gSnapshots.size() && gSnapshots[i].ms <= ms; ++i )
+    {
+        last = &gSnapshots[i];
+    }
+    return *last;
+}
+
+
+
+bool displayShowed( uint32_t fromMs, uint32_t toMs, const std::string& top )
+{
+    for ( size_t i = 0; i < gSnapshots.size(); ++i )
+    {
+        if ( fromMs <= gSnapshots[i].ms && gSnapshots[i].ms <= toMs && gSnapshots[i].top == top )
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,155 @@
+/*
+    LinuxImuSamplerTest.cpp - Check that the background sensor reads deliver
+    samples through the event queue, alternate buffers, and carry the time of
+    skipped samples over to the next.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+
+#include "EventManager.h"
+#include "HostSim.h"
+#include "ImuSampler.h"
+#include "TestSupport.h"
+
+#include "Drivers/LSM303DLHC.h"
+
+
+
+
+bool getSampleEvent( int16_t* param );
+
+
+
+
+int main()
+{
+    HostSim::init();
+    EventManager::init();
+
+    HostSim::Pose pose = { 0, 0, 90 };
+    HostSim::setPose( pose );
+
+    // Let the sensors fill their FIFOs for a nav update's worth of time
+    HostSim::spendMicros( 125000 );
+
+    // Starting only queues the first read; the event loop's polls do the rest
+    uint64_t startMicros = HostSim::getMicros();
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    bool allOkay = check( "Start leaves reads running", ImuSampler::isBusy() && ImuSampler::isPollNeeded()
+                                                        && EventManager::areEventQueuesEmpty() );
+
+    ImuSampler::poll();
+    int16_t first;
+    allOkay = check( "Sample ready after polls", !ImuSampler::isBusy() && getSampleEvent( &first ) ) && allOkay;
+    allOkay = check( "No time taken from the event loop", HostSim::getMicros() == startMicros ) && allOkay;
+    allOkay = check( "Ready event at nav priority",
+                     EventManager::getDefaultPriority( EventManager::kNavSampleReadyEvent ) == EventManager::kNavPriority ) && allOkay;
+
+    const ImuSampler::Sample& s = ImuSampler::getSample( first );
+    float heading = LSM303DLHC::calculateHeadingFromRawData( s.mag, s.accel );
+    allOkay = check( "FIFOs drained", s.nbrGyro == 23 && s.nbrAccel == 12
+                                      && HostSim::getGyroFifoLevel() == 0 && HostSim::getAccelFifoLevel() == 0 ) && allOkay;
+    allOkay = check( "Readings match synchronous ones", s.accel.z == LSM303DLHC::getAccelerationRaw().z
+                                                        && s.accelSum.z == 12L * s.accel.z && s.gyroSum.z == 0
+                                                        && heading > 89.5 && heading < 90.5 ) && allOkay;
+    allOkay = check( "Time step kept", s.timeStep == 0.125f ) && allOkay;
+
+    // The next sample goes in the other buffer, leaving this one alone
+    pose.heading = 180;
+    HostSim::setPose( pose );
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::poll();
+    int16_t second;
+    allOkay = check( "Second sample in the other buffer", getSampleEvent( &second )
+                                                          && ImuSampler::getSample( second ).mag.x < 0
+                                                          && &ImuSampler::getSample( second ) != &s
+                                                          && s.mag.x == 0 ) && allOkay;
+
+    // A start while reads are still running is skipped, and its time goes to the next sample
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::start( 0.100, HostSim::getMicros() );
+    ImuSampler::poll();
+    int16_t third;
+    allOkay = check( "Overrun skipped", getSampleEvent( &third ) && ImuSampler::getNbrSkipped() == 1
+                                        && ImuSampler::getSample( third ).timeStep == 0.125f ) && allOkay;
+
+    ImuSampler::start( 0.150, HostSim::getMicros() );
+    ImuSampler::poll();
+    int16_t fourth;
+    allOkay = check( "Skipped time carried over", getSampleEvent( &fourth )
+                                                  && ImuSampler::getSample( fourth ).timeStep > 0.2499
+                                                  && ImuSampler::getSample( fourth ).timeStep < 0.2501 ) && allOkay;
+
+    // Reset drops time carried over (e.g., while stopped)
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::poll();
+    int16_t fifth;
+    getSampleEvent( &fifth );
+    ImuSampler::reset();
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::poll();
+    int16_t sixth;
+    allOkay = check( "Reset drops carried time", getSampleEvent( &sixth )
+                                                 && ImuSampler::getSample( sixth ).timeStep == 0.125f ) && allOkay;
+
+    // A sample that can't be queued carries its readings, as well as its time, to the next
+    while ( !EventManager::queueEvent( EventManager::kNullEvent, 0, EventManager::kNavPriority ) )
+    {
+    }
+    HostSim::spendMicros( 125000 );
+    int nbrGyro = HostSim::getGyroFifoLevel();
+    int nbrAccel = HostSim::getAccelFifoLevel();
+    uint16_t nbrSkipped = ImuSampler::getNbrSkipped();
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::poll();
+    bool wasSkipped = ImuSampler::getNbrSkipped() == nbrSkipped + 1;
+
+    uint8_t code;
+    int16_t param;
+    while ( EventManager::getNextEvent( &code, &param ) )
+    {
+    }
+    HostSim::spendMicros( 125000 );
+    nbrGyro += HostSim::getGyroFifoLevel();
+    nbrAccel += HostSim::getAccelFifoLevel();
+    ImuSampler::start( 0.125, HostSim::getMicros() );
+    ImuSampler::poll();
+    int16_t seventh;
+    allOkay = check( "Unqueued readings carried over", wasSkipped && getSampleEvent( &seventh )
+                                                       && ImuSampler::getSample( seventh ).nbrGyro == nbrGyro
+                                                       && ImuSampler::getSample( seventh ).nbrAccel == nbrAccel
+                                                       && ImuSampler::getSample( seventh ).timeStep == 0.25f ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+bool getSampleEvent( int16_t* param )
+{
+    // Exactly one event, and it's a sample ready event
+    uint8_t code;
+    bool gotOne = EventManager::getNextEvent( &code, param ) && code == EventManager::kNavSampleReadyEvent;
+    return gotOne && EventManager::areEventQueuesEmpty();
+}
@@ -0,0 +1,178 @@
+/*
+    LinuxMagCalibratorTest.cpp - Fit the magnetometer calibration to
+    synthetic readings from a sensor with known hard and soft iron errors,
+    and check the calibration survives a trip through EEPROM.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+
+#include <iostream>
+#include <random>
+
+#include "MagCalibrator.h"
+#include "TestSupport.h"
+
+#include "Drivers/LSM303DLHC.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    // The field (raw units, before the iron) has a horizontal and a downward part
+    const float     kHorizontalField    = 250;
+    const float     kVerticalField      = 420;
+
+    // What the iron does to it
+    const Vector3Float  kHardIron( 130, -85, 40 );
+    const Vector3Float  kSoftIron( 1.25, 0.8, 1.1 );
+
+    const float     kReadingNoise       = 2;
+
+    std::mt19937    gRandom( 1 );
+};
+
+
+Vector3Int readMagnetometer( float heading, float pitch, float roll );
+float maxHeadingError();
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    allOkay = check( "Nothing to load before a save", !MagCalibrator::loadCalibration() ) && allOkay;
+
+    const LSM303DLHC::MagCalibration original = LSM303DLHC::getMagnetometerCalibration();
+    float errorBefore = maxHeadingError();
+
+    // Turning on the floor, one reading every 12 deg
+    MagCalibrator::start();
+    bool completeHalfWay = true;
+    for ( int heading = 0; heading < 360; heading += 12 )
+    {
+        if ( heading == 180 )
+        {
+            completeHalfWay = MagCalibrator::isComplete();
+        }
+        MagCalibrator::addReading( readMagnetometer( heading, 0, 0 ) );
+    }
+    allOkay = check( "Not complete half way round", !completeHalfWay ) && allOkay;
+    allOkay = check( "Complete all the way round", MagCalibrator::isComplete() ) && allOkay;
+
+    LSM303DLHC::MagCalibration flat;
+    bool fitted = MagCalibrator::fit( &flat );
+    allOkay = check( "Flat readings fit", fitted ) && allOkay;
+
+    LSM303DLHC::setMagnetometerCalibration( flat );
+    float errorFlat = maxHeadingError();
+    std::cout << "Max heading error:  uncalibrated " << errorBefore << " deg, flat fit " << errorFlat << " deg" << std::endl;
+    // The reading noise alone is worth about 0.6 deg rms
+    allOkay = check( "Flat fit heading within 2 deg", errorFlat < 2 ) && allOkay;
+    allOkay = check( "Flat fit leaves z alone", flat.offset.z == original.offset.z && flat.scale.z == original.scale.z ) && allOkay;
+
+    // Tumbled every which way (on the bench), so z is fitted too
+    LSM303DLHC::setMagnetometerCalibration( original );
+    MagCalibrator::start();
+    std::uniform_real_distribution<float> angle( -180, 180 );
+    for ( int i = 0; i < 200; ++i )
+    {
+        MagCalibrator::addReading( readMagnetometer( angle( gRandom ), angle( gRandom ) / 2, angle( gRandom ) ) );
+    }
+
+    LSM303DLHC::MagCalibration full;
+    fitted = MagCalibrator::fit( &full );
+    allOkay = check( "Tumbled readings fit", fitted ) && allOkay;
+
+    std::cout << "Offsets:  " << full.offset.x << ", " << full.offset.y << ", " << full.offset.z << std::endl;
+    float offsetError = norm( full.offset - kHardIron );
+    allOkay = check( "Offsets within 3", offsetError < 3 ) && allOkay;
+
+    // The scales undo the soft iron (to a common field strength)
+    float field = sqrt( kHorizontalField * kHorizontalField + kVerticalField * kVerticalField );
+    Vector3Float scaleError( full.scale.x * kSoftIron.x * field - 1, full.scale.y * kSoftIron.y * field - 1,
+                             full.scale.z * kSoftIron.z * field - 1 );
+    std::cout << "Scale errors:  " << scaleError.x << ", " << scaleError.y << ", " << scaleError.z << std::endl;
+    allOkay = check( "Scales within 2%", norm( scaleError ) < 0.02 ) && allOkay;
+
+    LSM303DLHC::setMagnetometerCalibration( full );
+    float errorFull = maxHeadingError();
+    std::cout << "Max heading error:  full fit " << errorFull << " deg" << std::endl;
+    allOkay = check( "Full fit heading within 2 deg", errorFull < 2 ) && allOkay;
+
+    // Too few readings to fit
+    MagCalibrator::start();
+    MagCalibrator::addReading( readMagnetometer( 0, 0, 0 ) );
+    MagCalibrator::addReading( readMagnetometer( 90, 0, 0 ) );
+    allOkay = check( "Two readings don't fit", !MagCalibrator::fit( &full ) ) && allOkay;
+
+    // Through EEPROM
+    MagCalibrator::saveCalibration( flat );
+    LSM303DLHC::setMagnetometerCalibration( original );
+    bool loaded = MagCalibrator::loadCalibration();
+    const LSM303DLHC::MagCalibration& now = LSM303DLHC::getMagnetometerCalibration();
+    allOkay = check( "Saved calibration loads", loaded && now.offset.x == flat.offset.x && now.scale.y == flat.scale.y ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+Vector3Int readMagnetometer( float heading, float pitch, float roll )
+{
+    // Field in CARRT's frame, as the simulated magnetometer has it (compass headings run clockwise)
+    float h = heading * M_PI / 180;
+    Vector3Float b( kHorizontalField * cos( h ), -kHorizontalField * sin( h ), -kVerticalField );
+
+    // Pitch about y, then roll about x
+    float p = pitch * M_PI / 180;
+    float r = roll * M_PI / 180;
+    Vector3Float bp( b.x * cos( p ) - b.z * sin( p ), b.y, b.x * sin( p ) + b.z * cos( p ) );
+    Vector3Float br( bp.x, bp.y * cos( r ) - bp.z * sin( r ), bp.y * sin( r ) + bp.z * cos( r ) );
+
+    std::normal_distribution<float> noise( 0, kReadingNoise );
+    return Vector3Int( lround( br.x * kSoftIron.x + kHardIron.x + noise( gRandom ) ),
+                       lround( br.y * kSoftIron.y + kHardIron.y + noise( gRandom ) ),
+                       lround( br.z * kSoftIron.z + kHardIron.z + noise( gRandom ) ) );
+}
+
+
+
+float maxHeadingError()
+{
+    float maxError = 0;
+    for ( int heading = 0; heading < 360; heading += 5 )
+    {
+        float error = fabs( LSM303DLHC::calculateHeadingFromRawData( readMagnetometer( heading, 0, 0 ),
+                                                                     Vector3Int( 0, 0, 1000 ) ) - heading );
+        if ( error > 180 )
+        {
+            error = 360 - error;
+        }
+        maxError = fmax( maxError, error );
+    }
+    return maxError;
+}
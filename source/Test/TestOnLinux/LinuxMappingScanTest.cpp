@@ -0,0 +1,262 @@
+/*
+    LinuxMappingScanTest.cpp - Check the sweeping mapping scan against the
+    stepped scan it replaces:  in the host simulator's room (with a servo that
+    takes time to move), the sweep should map the same walls, in a fraction of
+    the time, and put nothing where there isn't a wall.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+
+#include <iostream>
+
+#include "EventManager.h"
+#include "HostSim.h"
+#include "MappingScan.h"
+#include "NavigationMap.h"
+#include "Navigator.h"
+#include "TestSupport.h"
+
+#include "Drivers/Lidar.h"
+
+
+
+namespace
+{
+    const int   kGlobalCmPerGrid    = 32;
+    const int   kLocalCmPerGrid     = 16;
+
+    const int   kScanLimitLeft      = -80;
+    const int   kScanLimitRight     = 81;
+
+    // The stepped scan, as PerformMappingScanState used to do it
+    const int       kScanIncrement      = 2;
+    const uint32_t  kStepSlewMicros     = 500000;
+
+    const uint32_t  kInitialSlewMicros  = 1000000;
+    const uint16_t  kSweepSliceMs       = 20;
+
+    // A room CARRT isn't in the middle of, at an angle to the walls (meters, degrees)
+    const double    kHalfLengthX        = 1.6;
+    const double    kHalfLengthY        = 2.2;
+    const HostSim::Pose kPose           = { 0.3, -0.2, 25 };
+
+    const int       kMapSize            = kCarrtNavigationMapGridSizeX * kCarrtNavigationMapGridSizeY;
+
+    typedef bool Obstacles[ kMapSize ];
+};
+
+
+void startScan();
+uint64_t steppedScan();
+uint64_t sweepScan( int fromAngle, int toAngle, uint16_t sliceMs, float* maxAngleError );
+void getObstacles( Obstacles obstacles );
+bool isNear( const Obstacles obstacles, int gridX, int gridY );
+float distanceToWall( int gridX, int gridY );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    // The reference:  a stepped scan
+    startScan();
+    uint64_t steppedMicros = steppedScan();
+
+    static Obstacles stepped;
+    getObstacles( stepped );
+
+    // The same scene swept
+    startScan();
+    float maxAngleError;
+    uint64_t sweepMicros = sweepScan( kScanLimitLeft, kScanLimitRight, kSweepSliceMs, &maxAngleError );
+
+    static Obstacles swept;
+    getObstacles( swept );
+
+    std::cout << "Stepped scan " << steppedMicros / 1000 << " ms, sweep " << sweepMicros / 1000 << " ms" << std::endl;
+    allOkay = check( "Sweep takes under 5 seconds", sweepMicros < 5000000 ) && allOkay;
+
+    // Every wall the stepped scan found, the sweep found (give or take a cell)...
+    int nbrStepped = 0;
+    int nbrFound = 0;
+    int nbrSwept = 0;
+    float worstDistance = 0;
+    for ( int gridX = 0; gridX < kCarrtNavigationMapGridSizeX; ++gridX )
+    {
+        for ( int gridY = 0; gridY < kCarrtNavigationMapGridSizeY; ++gridY )
+        {
+            if ( stepped[ gridX * kCarrtNavigationMapGridSizeY + gridY ] )
+            {
+                ++nbrStepped;
+                if ( isNear( swept, gridX, gridY ) )
+                {
+                    ++nbrFound;
+                }
+            }
+
+            if ( swept[ gridX * kCarrtNavigationMapGridSizeY + gridY ] )
+            {
+                ++nbrSwept;
+                worstDistance = fmax( worstDistance, distanceToWall( gridX, gridY ) );
+            }
+        }
+    }
+
+    std::cout << "Obstacle cells:  stepped " << nbrStepped << ", swept " << nbrSwept << ", " << nbrFound
+              << " of the stepped matched; farthest swept cell " << worstDistance << " cm from a wall" << std::endl;
+
+    allOkay = check( "Stepped scan found walls", nbrStepped > 20 ) && allOkay;
+    allOkay = check( "Sweep finds the same walls", nbrFound >= 0.95 * nbrStepped ) && allOkay;
+
+    // ...and nothing that isn't a wall
+    allOkay = check( "Sweep finds only walls", worstDistance <= 1.5 * kLocalCmPerGrid ) && allOkay;
+
+    // Readings are tagged with where the servo actually was (either way)
+    startScan();
+    sweepScan( kScanLimitRight, kScanLimitLeft, 1, &maxAngleError );
+    std::cout << "Sweep angle at most " << maxAngleError << " deg from the servo's" << std::endl;
+    allOkay = check( "Sweep angle tracks the servo", maxAngleError < 1.5 ) && allOkay;
+    allOkay = check( "Sweep goes all the way", fabs( MappingScan::getLastReading().angle - kScanLimitLeft ) < 1 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+void startScan()
+{
+    HostSim::init();
+    EventManager::init();
+
+    HostSim::setRoom( kHalfLengthX, kHalfLengthY );
+    HostSim::setPose( kPose );
+
+    Navigator::init();
+    NavigationMap::init( kGlobalCmPerGrid, kLocalCmPerGrid );
+}
+
+
+
+uint64_t steppedScan()
+{
+    uint64_t start = HostSim::getMicros();
+
+    Lidar::slew( kScanLimitLeft );
+    HostSim::spendMicros( kInitialSlewMicros );
+
+    for ( int angle = kScanLimitLeft; angle <= kScanLimitRight; angle += kScanIncrement )
+    {
+        Lidar::slew( angle );
+        HostSim::spendMicros( kStepSlewMicros );
+
+        MappingScan::Reading reading;
+        reading.angle = angle;
+        reading.micros = static_cast<uint32_t>( HostSim::getMicros() );
+        if ( !Lidar::getMedianDistanceInCm( &reading.range ) )
+        {
+            MappingScan::addToMap( reading );
+        }
+    }
+
+    Lidar::slew( 0 );
+
+    return HostSim::getMicros() - start;
+}
+
+
+
+uint64_t sweepScan( int fromAngle, int toAngle, uint16_t sliceMs, float* maxAngleError )
+{
+    uint64_t start = HostSim::getMicros();
+
+    Lidar::slew( fromAngle );
+    HostSim::spendMicros( kInitialSlewMicros );
+
+    *maxAngleError = 0;
+    MappingScan::startSweep( fromAngle, toAngle );
+    while ( !MappingScan::isSweepDone() )
+    {
+        MappingScan::continueSweep( sliceMs );
+
+        float error = MappingScan::getSweepAngleAt( static_cast<uint32_t>( HostSim::getMicros() ) ) - HostSim::getServoAngle();
+        *maxAngleError = fmax( *maxAngleError, fabs( error ) );
+    }
+    MappingScan::endSweep();
+
+    Lidar::slew( 0 );
+
+    return HostSim::getMicros() - start;
+}
+
+
+
+void getObstacles( Obstacles obstacles )
+{
+    const Map& map = NavigationMap::getLocalMap();
+
+    for ( int gridX = 0; gridX < kCarrtNavigationMapGridSizeX; ++gridX )
+    {
+        for ( int gridY = 0; gridY < kCarrtNavigationMapGridSizeY; ++gridY )
+        {
+            bool isObstacle;
+            map.isThereAnObstacleGridCoords( gridX, gridY, &isObstacle );
+            obstacles[ gridX * kCarrtNavigationMapGridSizeY + gridY ] = isObstacle;
+        }
+    }
+}
+
+
+
+bool isNear( const Obstacles obstacles, int gridX, int gridY )
+{
+    for ( int x = gridX - 1; x <= gridX + 1; ++x )
+    {
+        for ( int y = gridY - 1; y <= gridY + 1; ++y )
+        {
+            if ( x >= 0 && x < kCarrtNavigationMapGridSizeX && y >= 0 && y < kCarrtNavigationMapGridSizeY
+                 && obstacles[ x * kCarrtNavigationMapGridSizeY + y ] )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+
+float distanceToWall( int gridX, int gridY )
+{
+    // The Navigator starts at 0, 0, wherever CARRT is in the room
+    const Map& map = NavigationMap::getLocalMap();
+    float x = map.convertToNavX( gridX ) + 100 * kPose.x;
+    float y = map.convertToNavY( gridY ) + 100 * kPose.y;
+
+    float toWallX = fmin( fabs( x - 100 * kHalfLengthX ), fabs( x + 100 * kHalfLengthX ) );
+    float toWallY = fmin( fabs( y - 100 * kHalfLengthY ), fabs( y + 100 * kHalfLengthY ) );
+
+    return fmin( toWallX, toWallY );
+}
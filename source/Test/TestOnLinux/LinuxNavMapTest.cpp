@@ -37,6 +37,7 @@ void goLeft();
 void goRight();
 void goRightDown();
 void goLeftUp();
+void checkChangeTracking();
 
 int main()
 {
@@ -57,6 +58,8 @@ int main()
 
     goLeftUp();
 
+    checkChangeTracking();
+
     std::cout << std::endl << "Done" << std::endl;
 }
 
@@ -65,6 +68,47 @@ int main()
 
 
 
+void checkChangeTracking()
+{
+    std::cout << "\nChange tracking" << std::endl;
+
+    Map m( 25, 0, 0 );
+    m.clearDirtyRows();
+    unsigned long v0 = m.version();
+
+    // Marking two obstacles far apart in x should dirty exactly two rows
+    m.markObstacle( -300, 0 );
+    m.markObstacle( 300, 50 );
+    // Re-marking is not a change
+    m.markObstacle( 300, 50 );
+
+    int from = 0;
+    int first;
+    int last;
+    int nbrRuns = 0;
+    while ( m.findDirtyRows( from, &first, &last ) )
+    {
+        std::cout << "Dirty rows " << first << " to " << last << std::endl;
+        ++nbrRuns;
+        from = last + 1;
+    }
+
+    std::cout << "Version advanced by " << ( m.version() - v0 ) << " (expect 2); "
+              << nbrRuns << " dirty runs (expect 2)" << std::endl;
+
+    m.clearDirtyRows();
+    std::cout << "After clear, has dirty rows = " << m.hasDirtyRows() << " (expect 0)" << std::endl;
+
+    int xMin, xMax, yMin, yMax;
+    m.recenterMapOnNavCoords( 100, 0, &xMin, &xMax, &yMin, &yMax );
+    std::cout << "After recenter, row 0 dirty = " << m.isRowDirty( 0 ) << " (expect 1)" << std::endl;
+}
+
+
+
+
+
+
 void goLeft()
 {
     NavigationMap::init();
@@ -0,0 +1,227 @@
+/*
+    LinuxNavModelTest.cpp - Check choosing the Navigator's model at run time:
+    the choice survives a restart (in EEPROM), the hybrid hands the pose over
+    between models without a jump, and compare mode measures how far the
+    models drift apart.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+
+#include <iostream>
+
+#include "EventClock.h"
+#include "EventManager.h"
+#include "HostSim.h"
+#include "Navigator.h"
+#include "TestSupport.h"
+
+#include "Drivers/DriveParam.h"
+#include "Drivers/Motors.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    struct Leg
+    {
+        HostSim::MotorMotion    motion;
+        int                     nbrTicks;
+    };
+
+    const Leg kCourse[] =
+    {
+        { HostSim::kMotorsForward,      16 },
+        { HostSim::kMotorsRotateRight,   8 },
+        { HostSim::kMotorsForward,      12 },
+        { HostSim::kMotorsRotateLeft,   13 },
+        { HostSim::kMotorsForward,      10 }
+    };
+    const int kNbrLegs = sizeof( kCourse ) / sizeof( kCourse[0] );
+
+
+    struct Drive
+    {
+        Vector2Float    position;           // cm, at the end
+        float           heading;
+        float           maxStep;            // cm, the most the position moved in one update
+        float           maxTurn;            // deg, the most the heading changed in one update
+    };
+};
+
+
+void startNavigator();
+Drive driveCourse();
+float headingDifference( float a, float b );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    // Nothing chosen yet:  the build's default (dead reckoning in the host simulator)
+    startNavigator();
+    allOkay = check( "Default model", Navigator::getModel() == Navigator::kModelDeadReckoning ) && allOkay;
+
+    Drive deadReckoning = driveCourse();
+
+    // The choice is kept for next time...
+    Navigator::setModel( Navigator::kModelHybrid );
+    startNavigator();
+    allOkay = check( "Model kept in EEPROM", Navigator::getModel() == Navigator::kModelHybrid ) && allOkay;
+
+    // ...and nonsense doesn't replace it
+    Navigator::setModel( Navigator::kNbrModels );
+    allOkay = check( "Unknown model ignored", Navigator::getModel() == Navigator::kModelHybrid ) && allOkay;
+
+    // The hybrid turns with the inertial model and drives straight with dead reckoning; with
+    // no sensor noise, turns don't move CARRT in either, so it ends up where dead reckoning does
+    Drive hybrid = driveCourse();
+
+    std::cout << "Dead reckoning:  " << deadReckoning.position.x << ", " << deadReckoning.position.y << " cm, heading "
+              << deadReckoning.heading << std::endl;
+    std::cout << "Hybrid:          " << hybrid.position.x << ", " << hybrid.position.y << " cm, heading "
+              << hybrid.heading << "; largest step " << hybrid.maxStep << " cm and " << hybrid.maxTurn << " deg" << std::endl;
+
+    allOkay = check( "Hybrid ends where dead reckoning does",
+                     norm( hybrid.position - deadReckoning.position ) < 0.1
+                     && headingDifference( hybrid.heading, deadReckoning.heading ) < 0.1 ) && allOkay;
+
+    // No jumps at the handovers:  no more than a tick's travel (or turn) between updates
+    float tickTravel = DriveParam::getFullSpeedMetersPerSec() * 100 * EventClock::kSecondsPerTick;
+    allOkay = check( "Hybrid hands over without jumping",
+                     hybrid.maxStep < deadReckoning.maxStep + 0.01 && hybrid.maxStep < 1.5 * tickTravel
+                     && hybrid.maxTurn <= deadReckoning.maxTurn + 0.1 ) && allOkay;
+
+    // Compare mode reports dead reckoning, and how far the others strayed from it (in the
+    // host simulator the accelerometer doesn't feel the drive, so the inertial model doesn't move)
+    Navigator::setModel( Navigator::kModelCompare );
+    startNavigator();
+    Drive compared = driveCourse();
+
+    Navigator::Disagreement fixed = Navigator::getDisagreement( Navigator::kModelDeadReckoningFixed );
+    Navigator::Disagreement inertial = Navigator::getDisagreement( Navigator::kModelInertial );
+    std::cout << "Compared:  fixed point " << fixed.distance << " cm and " << fixed.heading << " deg, inertial "
+              << inertial.distance << " cm and " << inertial.heading << " deg" << std::endl;
+
+    allOkay = check( "Compare reports dead reckoning",
+                     norm( compared.position - deadReckoning.position ) == 0 && compared.heading == deadReckoning.heading ) && allOkay;
+    allOkay = check( "Fixed point agrees", fixed.distance < 1 && fixed.heading < 0.5 ) && allOkay;
+    allOkay = check( "Inertial disagreement measured", inertial.distance > 50 ) && allOkay;
+
+    Navigator::reset();
+    inertial = Navigator::getDisagreement( Navigator::kModelInertial );
+    allOkay = check( "Reset clears the disagreement", inertial.distance == 0 && inertial.heading == 0 ) && allOkay;
+
+    // Switching part way picks up where the last model was
+    Navigator::setModel( Navigator::kModelDeadReckoning );
+    startNavigator();
+    HostSim::setMotors( HostSim::kMotorsForward, Motors::kFullSpeed );
+    Navigator::movingStraight();
+    for ( int tick = 0; tick < 8; ++tick )
+    {
+        HostSim::doNavTick();
+    }
+    Vector2Float before = Navigator::getCurrentPositionCm();
+    Navigator::setModel( Navigator::kModelDeadReckoningFixed );
+    Vector2Float after = Navigator::getCurrentPositionCm();
+    Navigator::stopped();
+    HostSim::setMotors( HostSim::kMotorsStopped, Motors::kFullSpeed );
+
+    allOkay = check( "Switching keeps the pose", norm( before ) > 10 && norm( after - before ) < 0.01 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+void startNavigator()
+{
+    // As if CARRT had been switched off and on (but the EEPROM stays)
+    HostSim::init();
+    EventManager::init();
+
+    HostSim::Pose pose = { 0, 0, 30 };
+    HostSim::setPose( pose );
+
+    Navigator::init();
+}
+
+
+
+Drive driveCourse()
+{
+    Drive drive = { Vector2Float( 0, 0 ), 0, 0, 0 };
+
+    Vector2Float lastPosition = Navigator::getCurrentPositionCm();
+    float lastHeading = Navigator::getCurrentHeading();
+
+    for ( int leg = 0; leg < kNbrLegs; ++leg )
+    {
+        HostSim::setMotors( kCourse[leg].motion, Motors::kFullSpeed );
+        if ( kCourse[leg].motion == HostSim::kMotorsForward )
+        {
+            Navigator::movingStraight();
+        }
+        else
+        {
+            Navigator::movingTurning();
+        }
+
+        for ( int tick = 0; tick < kCourse[leg].nbrTicks; ++tick )
+        {
+            if ( !HostSim::doNavTick() )
+            {
+                continue;
+            }
+
+            Vector2Float position = Navigator::getCurrentPositionCm();
+            float heading = Navigator::getCurrentHeading();
+
+            drive.maxStep = fmax( drive.maxStep, norm( position - lastPosition ) );
+            drive.maxTurn = fmax( drive.maxTurn, headingDifference( heading, lastHeading ) );
+
+            lastPosition = position;
+            lastHeading = heading;
+        }
+    }
+
+    Navigator::stopped();
+    HostSim::setMotors( HostSim::kMotorsStopped, Motors::kFullSpeed );
+
+    drive.position = Navigator::getCurrentPositionCm();
+    drive.heading = Navigator::getCurrentHeading();
+
+    return drive;
+}
+
+
+
+float headingDifference( float a, float b )
+{
+    float d = fabs( a - b );
+    return d > 180 ? 360 - d : d;
+}
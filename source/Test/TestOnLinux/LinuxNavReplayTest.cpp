@@ -0,0 +1,185 @@
+/*
+    LinuxNavReplayTest.cpp - Record a drive in the host simulator to a sensor
+    log, mixed in with other serial output, and check that replaying it puts
+    the Navigator exactly where it was during the drive.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+#include <string.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "EventClock.h"
+#include "EventManager.h"
+#include "HostSim.h"
+#include "ImuSampler.h"
+#include "Navigator.h"
+#include "NavReplay.h"
+#include "SensorLog.h"
+#include "TestSupport.h"
+
+#include "Drivers/Motors.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    struct Leg
+    {
+        HostSim::MotorMotion    motion;
+        int                     nbrTicks;
+    };
+
+    const Leg kCourse[] =
+    {
+        { HostSim::kMotorsForward,      16 },
+        { HostSim::kMotorsRotateRight,   8 },
+        { HostSim::kMotorsStopped,       4 },
+        { HostSim::kMotorsForward,      12 },
+        { HostSim::kMotorsRotateLeft,   13 },
+        { HostSim::kMotorsForward,      10 }
+    };
+    const int kNbrLegs = sizeof( kCourse ) / sizeof( kCourse[0] );
+
+
+    // The serial capture:  records with debugging text between them
+    std::vector<uint8_t>    sCapture;
+    int                     sNbrRecords;
+};
+
+
+void captureRecord( const uint8_t* record, uint8_t size );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    HostSim::init();
+    EventManager::init();
+    HostSim::setSensorLogListener( captureRecord );
+
+    Navigator::init();
+    Navigator::setModel( Navigator::kModelDeadReckoning );
+
+    std::vector<NavReplay::TrajectoryPoint> live;
+
+    for ( int leg = 0; leg < kNbrLegs; ++leg )
+    {
+        HostSim::setMotors( kCourse[leg].motion, Motors::kFullSpeed );
+        switch ( kCourse[leg].motion )
+        {
+            case HostSim::kMotorsForward:
+                Navigator::movingStraight();
+                break;
+
+            case HostSim::kMotorsStopped:
+                Navigator::stopped();
+                break;
+
+            default:
+                Navigator::movingTurning();
+                break;
+        }
+
+        for ( int tick = 0; tick < kCourse[leg].nbrTicks; ++tick )
+        {
+            int16_t param;
+            if ( HostSim::doNavTick( &param ) )
+            {
+                Vector2Float position = Navigator::getCurrentPositionCm();
+                NavReplay::TrajectoryPoint point = { ImuSampler::getSample( param ).micros, position.x, position.y,
+                                                     Navigator::getCurrentHeading() };
+                live.push_back( point );
+            }
+        }
+    }
+
+    HostSim::setSensorLogListener( 0 );
+
+    std::cout << "Live drive:  " << live.size() << " updates, " << sNbrRecords << " records in "
+              << sCapture.size() << " bytes captured" << std::endl;
+
+
+    // Only the records come back out of the capture
+    std::vector<NavReplay::LogEntry> entries;
+    int nbrRead = NavReplay::readLog( sCapture, &entries );
+    allOkay = check( "All records found", nbrRead == sNbrRecords ) && allOkay;
+    allOkay = check( "Starts with the start record", !entries.empty() && entries[0].type == SensorLog::kStartRecord ) && allOkay;
+
+    NavReplay::Result results[ NavReplay::kNbrVariants ];
+    for ( int v = 0; v < NavReplay::kNbrVariants; ++v )
+    {
+        results[v] = NavReplay::replay( entries, v );
+
+        NavReplay::Divergence d = NavReplay::compare( results[v].trajectory, live );
+        std::cout << NavReplay::getVariantName( v ) << ":  " << results[v].trajectory.size() << " updates, "
+                  << results[v].meanNsPerUpdate << " ns per update, " << d.maxDistance << " cm and "
+                  << d.maxHeading << " deg from the live drive" << std::endl;
+
+        allOkay = check( "  Zero points as recorded", results[v].zeroPointsMatch ) && allOkay;
+        allOkay = check( "  Every update replayed", results[v].trajectory.size() == live.size() ) && allOkay;
+    }
+
+    // Same code, same inputs:  the same answers, to the bit
+    NavReplay::Divergence d = NavReplay::compare( results[ Navigator::kModelDeadReckoning ].trajectory, live );
+    allOkay = check( "Replay matches the live drive exactly",
+                     d.nbrCompared == static_cast<int>( live.size() ) && d.maxDistance == 0 && d.maxHeading == 0 ) && allOkay;
+
+    // Compare mode reports dead reckoning's pose, whatever the others do
+    d = NavReplay::compare( results[ Navigator::kModelCompare ].trajectory, live );
+    allOkay = check( "Compare mode reports dead reckoning",
+                     d.nbrCompared == static_cast<int>( live.size() ) && d.maxDistance == 0 && d.maxHeading == 0 ) && allOkay;
+
+    // The fixed-point model tracks the floating point one
+    d = NavReplay::compare( results[ Navigator::kModelDeadReckoningFixed ].trajectory, live );
+    allOkay = check( "Fixed-point model close to the live drive", d.maxDistance < 2 && d.maxHeading < 1 ) && allOkay;
+
+    // Trajectories survive the round trip through CSV (as reference runs are kept)
+    std::stringstream csv;
+    NavReplay::writeTrajectory( csv, live );
+    std::vector<NavReplay::TrajectoryPoint> readBack;
+    NavReplay::readTrajectory( csv, &readBack );
+    d = NavReplay::compare( readBack, live );
+    allOkay = check( "Trajectory CSV round trip", d.nbrCompared == static_cast<int>( live.size() ) && d.maxDistance == 0 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+void captureRecord( const uint8_t* record, uint8_t size )
+{
+    // Navigator debugging output in between, with a stray sync byte in it now and then
+    const char* text = ( sNbrRecords % 3 ) ? "1234, doNavUpdate, 0.5, 1.5\r\n" : "note \xA5 S\r\n";
+    sCapture.insert( sCapture.end(), text, text + strlen( text ) );
+
+    sCapture.insert( sCapture.end(), record, record + size );
+    ++sNbrRecords;
+}
@@ -0,0 +1,218 @@
+/*
+    LinuxPoseHistoryTest.cpp - Check interpolation in the pose history, and
+    that the Navigator's history in the host simulator gives back the poses
+    it had at each update.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+
+#include <iostream>
+#include <vector>
+
+#include "EventClock.h"
+#include "EventManager.h"
+#include "HostSim.h"
+#include "ImuSampler.h"
+#include "Navigator.h"
+#include "PoseHistory.h"
+#include "TestSupport.h"
+
+#include "Drivers/Motors.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    const uint32_t  kMicrosPerTick      = 1000000 / kCarrtEventClockHz;
+
+    struct NavPose
+    {
+        uint32_t        micros;
+        Vector2Float    position;
+        float           heading;
+    };
+};
+
+
+bool near( float a, float b );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    Vector2Float p;
+    float h;
+
+    PoseHistory history;
+    allOkay = check( "Nothing known when empty", !history.getPoseAt( 0, &p, &h ) ) && allOkay;
+
+    // Times just short of micros() wrapping, turning through North
+    const uint32_t t0 = 0xFFFFFFFFUL - 150000UL;
+    history.add( t0, Vector2Float( 0, 0 ), 350 );
+    history.add( t0 + 100000, Vector2Float( 10, 0 ), 10 );
+    history.add( t0 + 200000, Vector2Float( 10, 20 ), 30 );
+
+    bool okay = history.getPoseAt( t0 + 50000, &p, &h );
+    allOkay = check( "Half way through the first interval", okay && near( p.x, 5 ) && near( p.y, 0 ) && near( h, 0 ) ) && allOkay;
+
+    okay = history.getPoseAt( t0 + 175000, &p, &h );
+    allOkay = check( "Across micros() wrapping", okay && near( p.x, 10 ) && near( p.y, 15 ) && near( h, 25 ) ) && allOkay;
+
+    okay = history.getPoseAt( t0 + 100000, &p, &h );
+    allOkay = check( "At a pose", okay && near( p.x, 10 ) && near( p.y, 0 ) && near( h, 10 ) ) && allOkay;
+
+    okay = history.getPoseAt( t0 + 250000, &p, &h );
+    allOkay = check( "Extrapolated a little past the newest", okay && near( p.y, 30 ) && near( h, 40 ) ) && allOkay;
+
+    allOkay = check( "Not too far past the newest", !history.getPoseAt( t0 + 350000, &p, &h ) ) && allOkay;
+    allOkay = check( "Not before the oldest", !history.getPoseAt( t0 - 1, &p, &h ) ) && allOkay;
+
+    // Turning the other way through North
+    history.clear();
+    history.add( 0, Vector2Float( 0, 0 ), 5 );
+    history.add( 1000, Vector2Float( 0, 0 ), 345 );
+    okay = history.getPoseAt( 750, &p, &h );
+    allOkay = check( "Counter-clockwise through North", okay && near( h, 350 ) ) && allOkay;
+
+    // Older poses drop out once it's full
+    for ( int i = 0; i < PoseHistory::kSize + 4; ++i )
+    {
+        history.add( 2000 + i * 1000, Vector2Float( i, 0 ), 0 );
+    }
+    allOkay = check( "Holds kSize poses", history.nbrPoses() == PoseHistory::kSize ) && allOkay;
+    allOkay = check( "Oldest dropped", !history.getPoseAt( 2000 + 3 * 1000 - 1, &p, &h ) ) && allOkay;
+    allOkay = check( "Oldest kept", history.getPoseAt( 2000 + 4 * 1000, &p, &h ) && near( p.x, 4 ) ) && allOkay;
+
+    // A pose that comes in late (no later than the newest) doesn't go in
+    const uint32_t newest = 2000 + ( PoseHistory::kSize + 3 ) * 1000;
+    history.add( newest, Vector2Float( 99, 0 ), 90 );
+    history.add( newest - 500, Vector2Float( 99, 0 ), 90 );
+    okay = history.getPoseAt( newest, &p, &h );
+    allOkay = check( "Late poses ignored", okay && near( p.x, PoseHistory::kSize + 3 ) && near( h, 0 ) ) && allOkay;
+
+
+    // The Navigator's history, turning then driving in the simulator
+    HostSim::init();
+    EventManager::init();
+    Navigator::init();
+
+    std::vector<NavPose> navPoses;
+    for ( int tick = 0; tick < 24; ++tick )
+    {
+        if ( tick == 0 )
+        {
+            HostSim::setMotors( HostSim::kMotorsRotateRight, Motors::kFullSpeed );
+            Navigator::movingTurning();
+        }
+        else if ( tick == 12 )
+        {
+            HostSim::setMotors( HostSim::kMotorsForward, Motors::kFullSpeed );
+            Navigator::movingStraight();
+        }
+
+        int16_t sample;
+        if ( HostSim::doNavTick( &sample ) )
+        {
+            NavPose np = { ImuSampler::getSample( sample ).micros, Navigator::getCurrentPositionCm(),
+                           Navigator::getCurrentHeading() };
+            navPoses.push_back( np );
+        }
+    }
+
+    allOkay = check( "Every update sampled", navPoses.size() == 24 ) && allOkay;
+
+    // Convert the same relative point with the pose from the history and as it was
+    float maxError = 0;
+    int nbrFound = 0;
+    for ( size_t i = navPoses.size() - PoseHistory::kSize; i < navPoses.size(); ++i )
+    {
+        PoseSnapshot pose;
+        if ( Navigator::getPoseAt( navPoses[i].micros, &pose ) )
+        {
+            ++nbrFound;
+            PoseSnapshot expected( navPoses[i].position, navPoses[i].heading );
+            maxError = fmax( maxError, norm( pose.toAbsolute( 100, 50 ) - expected.toAbsolute( 100, 50 ) ) );
+        }
+    }
+    std::cout << "Navigator history:  " << nbrFound << " poses found, max error " << maxError << " cm" << std::endl;
+    allOkay = check( "Navigator keeps the last kSize poses", nbrFound == PoseHistory::kSize ) && allOkay;
+    allOkay = check( "Navigator poses as they were", maxError < 0.01 ) && allOkay;
+
+    PoseSnapshot tooOld;
+    allOkay = check( "Navigator forgets older poses",
+                     !Navigator::getPoseAt( navPoses[ navPoses.size() - PoseHistory::kSize - 1 ].micros, &tooOld ) ) && allOkay;
+
+    // Stopping in the middle of a turn:  the history holds the stop, and no more turning after it
+    HostSim::setMotors( HostSim::kMotorsRotateRight, Motors::kFullSpeed );
+    Navigator::movingTurning();
+    for ( int tick = 0; tick < 4; ++tick )
+    {
+        HostSim::doNavTick();
+    }
+
+    HostSim::setMotors( HostSim::kMotorsStopped, 0 );
+    Navigator::stopped();
+    uint32_t stopMicros = HostSim::getMicros();
+    PoseSnapshot stopPose = Navigator::getPoseSnapshot();
+
+    PoseSnapshot pose;
+    okay = Navigator::getPoseAt( stopMicros + kMicrosPerTick / 2, &pose );
+    float error = norm( pose.toAbsolute( 100, 50 ) - stopPose.toAbsolute( 100, 50 ) );
+    std::cout << "Navigator just after the stop:  error " << error << " cm" << std::endl;
+    allOkay = check( "Navigator query after stop returns the stop pose", okay && error < 0.01 ) && allOkay;
+
+    // Still there well after it (MainProcess updates the Navigator every tick, moving or not)
+    for ( int tick = 0; tick < 2 * PoseHistory::kSize; ++tick )
+    {
+        HostSim::doNavTick();
+    }
+
+    // ...including once CARRT drives off again
+    uint32_t stoppedMicros = HostSim::getMicros() - kMicrosPerTick / 2;
+    HostSim::setMotors( HostSim::kMotorsForward, Motors::kFullSpeed );
+    Navigator::movingStraight();
+    HostSim::doNavTick();
+    HostSim::doNavTick();
+
+    okay = Navigator::getPoseAt( stoppedMicros, &pose );
+    error = norm( pose.toAbsolute( 100, 50 ) - stopPose.toAbsolute( 100, 50 ) );
+    allOkay = check( "Navigator keeps the stop pose while stopped", okay && error < 0.01 ) && allOkay;
+
+    Navigator::reset();
+    allOkay = check( "Navigator history cleared by reset",
+                     !Navigator::getPoseAt( navPoses.back().micros, &tooOld ) ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+bool near( float a, float b )
+{
+    return fabs( a - b ) < 1e-3;
+}
@@ -0,0 +1,144 @@
+/*
+    LinuxPoseSnapshotTest.cpp - Check the pose snapshot's conversions from
+    relative to absolute coordinates against the polar conversion the
+    Navigator used to do for each point.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include "PoseSnapshot.h"
+#include "TestSupport.h"
+
+#include "Utils/FixedPoint.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    const int       kNbrPoses           = 200;
+    const int       kPointsPerPose      = 20;
+
+    const float     kDegreesToRadians   = M_PI / 180.0;
+};
+
+
+Vector2Float polarToAbsolute( const Vector2Float& position, float heading, float downRange, float crossRange );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    std::mt19937 random( 1 );
+    std::uniform_real_distribution<float> headings( 0, 360 );
+    std::uniform_real_distribution<float> positions( -1000, 1000 );
+    std::uniform_real_distribution<float> ranges( -400, 400 );
+
+    float maxFloatError = 0;
+    float maxBatchError = 0;
+    float maxFixedError = 0;
+    int maxIntError = 0;
+
+    for ( int i = 0; i < kNbrPoses; ++i )
+    {
+        Vector2Float position( positions( random ), positions( random ) );
+        float heading = headings( random );
+
+        // As the fixed-point Navigator would take it, at its heading resolution
+        uint16_t hdgCd = FixedPoint::convertDegreesToCentiDegrees( heading );
+        PoseSnapshot fixedPose( position, FixedPoint::sinCentiDegrees( hdgCd ), FixedPoint::cosCentiDegrees( hdgCd ) );
+
+        PoseSnapshot pose( position, heading );
+
+        Vector2Float relative[kPointsPerPose];
+        Vector2Float absolute[kPointsPerPose];
+        int16_t down[kPointsPerPose];
+        int16_t cross[kPointsPerPose];
+        int16_t x[kPointsPerPose];
+        int16_t y[kPointsPerPose];
+        for ( int j = 0; j < kPointsPerPose; ++j )
+        {
+            relative[j] = Vector2Float( ranges( random ), ranges( random ) );
+            down[j] = lround( relative[j].x );
+            cross[j] = lround( relative[j].y );
+        }
+
+        pose.toAbsolute( relative, absolute, kPointsPerPose );
+        pose.toAbsolute( down, cross, x, y, kPointsPerPose );
+
+        for ( int j = 0; j < kPointsPerPose; ++j )
+        {
+            Vector2Float expected = polarToAbsolute( position, heading, relative[j].x, relative[j].y );
+            maxFloatError = fmax( maxFloatError, norm( pose.toAbsolute( relative[j].x, relative[j].y ) - expected ) );
+            maxBatchError = fmax( maxBatchError, norm( absolute[j] - expected ) );
+
+            // Table lookups are good to a fraction of a degree, worth under 1 cm at 5.7 m
+            maxFixedError = fmax( maxFixedError, norm( fixedPose.toAbsolute( relative[j].x, relative[j].y ) - expected ) );
+
+            // Integers are rounded from the exact conversion of the integer inputs
+            Vector2Float exactInt = polarToAbsolute( Vector2Float( lround( position.x ), lround( position.y ) ),
+                                                     heading, down[j], cross[j] );
+            maxIntError = std::max( maxIntError, std::max( abs( x[j] - static_cast<int>( lround( exactInt.x ) ) ),
+                                                           abs( y[j] - static_cast<int>( lround( exactInt.y ) ) ) ) );
+        }
+    }
+
+    std::cout << "Max errors:  float " << maxFloatError << ", batch " << maxBatchError << ", fixed-point heading "
+              << maxFixedError << ", integer " << maxIntError << std::endl;
+
+    allOkay = check( "Float conversion matches", maxFloatError < 0.01 ) && allOkay;
+    allOkay = check( "Batch conversion matches", maxBatchError == maxFloatError ) && allOkay;
+    allOkay = check( "Fixed-point heading within 1 cm", maxFixedError < 1 ) && allOkay;
+    allOkay = check( "Integer conversion within 1", maxIntError <= 1 ) && allOkay;
+
+    // The directions:  forward along the heading, left is 90 deg counter-clockwise
+    PoseSnapshot east( Vector2Float( 100, 200 ), 90.0f );
+    Vector2Float ahead = east.toAbsolute( 10, 0 );
+    Vector2Float left = east.toAbsolute( 0, 10 );
+    allOkay = check( "Heading 90 forward is East (-y)", fabs( ahead.x - 100 ) < 1e-3 && fabs( ahead.y - 190 ) < 1e-3 ) && allOkay;
+    allOkay = check( "Heading 90 left is North (+x)", fabs( left.x - 110 ) < 1e-3 && fabs( left.y - 200 ) < 1e-3 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+Vector2Float polarToAbsolute( const Vector2Float& position, float heading, float downRange, float crossRange )
+{
+    // What Navigator::convertRelativeToAbsoluteCoordsCm() used to do
+    float hdg = ( 360 - heading ) * kDegreesToRadians;
+
+    float angle = atan2( crossRange, downRange ) + hdg;
+    float range = sqrt( downRange * downRange + crossRange * crossRange );
+
+    return Vector2Float( range * cos( angle ), range * sin( angle ) ) + position;
+}
@@ -0,0 +1,338 @@
+/*
+    LinuxQuadTreeMapTest.cpp - Test the quadtree map and benchmark path finding
+    on it against the dense grid map.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "NavigationMap.h"
+
+#include "PathSearch/PathFinder.h"
+#include "PathSearch/QuadTreeMap.h"
+
+
+
+
+const int kCmPerGrid    = 25;
+const int kRepetitions  = 20;
+
+
+
+void loadOpenFloor( Map* map );
+void loadWall( Map* map );
+void loadClutter( Map* map );
+
+bool checkPointQueries( const Map& map, const QuadTreeMap& qtMap );
+bool checkMarkAndMerge();
+bool checkCornerNeighbors();
+bool checkManyNeighbors();
+bool isPathClear( PathFinder::Path* p, const QuadTreeMap& qtMap );
+
+template <class MapType>
+void benchmark( const char* label, int startX, int startY, int goalX, int goalY, const MapType& map );
+
+float pathLength( PathFinder::Path* p );
+
+
+
+
+int main()
+{
+    std::cout << "Quadtree map vs dense grid map (" << kCarrtNavigationMapGridSize << " x "
+              << kCarrtNavigationMapGridSize << " grid, " << kCmPerGrid << " cm per grid)" << std::endl;
+
+    bool allOkay = checkMarkAndMerge();
+    allOkay = checkCornerNeighbors() && allOkay;
+    allOkay = checkManyNeighbors() && allOkay;
+
+    void (*loaders[])( Map* ) = { loadOpenFloor, loadWall, loadClutter };
+    const char* names[] = { "Open floor", "Wall", "Clutter" };
+
+    for ( int i = 0; i < 3; ++i )
+    {
+        Map map( kCmPerGrid, 0, 0 );
+        loaders[i]( &map );
+
+        QuadTreeMap qtMap( kCmPerGrid, 0, 0 );
+        if ( !qtMap.build( map ) )
+        {
+            std::cout << names[i] << ": quadtree node pool exhausted" << std::endl;
+            allOkay = false;
+            continue;
+        }
+
+        std::cout << std::endl << names[i] << std::endl;
+        std::cout << "  Dense map bytes:     " << map.memorySize() << std::endl;
+        std::cout << "  Quadtree bytes:      " << qtMap.memorySize()
+                  << "  (" << qtMap.nbrLeaves() << " leaves, " << qtMap.nbrNodes() << " nodes)" << std::endl;
+
+        allOkay = checkPointQueries( map, qtMap ) && allOkay;
+
+        int startX = map.minXCoord() + 3 * kCmPerGrid;
+        int startY = map.minYCoord() + 3 * kCmPerGrid;
+        int goalX = map.maxXCoord() - 4 * kCmPerGrid;
+        int goalY = map.maxYCoord() - 4 * kCmPerGrid;
+
+        benchmark( "  Dense grid", startX, startY, goalX, goalY, map );
+        benchmark( "  Quadtree  ", startX, startY, goalX, goalY, qtMap );
+    }
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+template <class MapType>
+void benchmark( const char* label, int startX, int startY, int goalX, int goalY, const MapType& map )
+{
+    // Silence the path finder's own debug output while timing
+    std::streambuf* saved = std::cerr.rdbuf( 0 );
+
+    clock_t start = clock();
+    for ( int i = 0; i < kRepetitions; ++i )
+    {
+        delete PathFinder::findPath( startX, startY, goalX, goalY, map );
+    }
+    clock_t elapsed = clock() - start;
+
+    PathFinder::Path* p = PathFinder::findPath( startX, startY, goalX, goalY, map );
+
+    std::cerr.rdbuf( saved );
+
+    std::cout << label << ":  ";
+    if ( p )
+    {
+        std::cout << "expanded " << std::setw( 5 ) << PathFinder::getNbrVerticesExpanded()
+                  << "   waypoints " << std::setw( 3 ) << p->len()
+                  << "   length (cm) " << std::setw( 6 ) << static_cast<int>( pathLength( p ) );
+    }
+    else
+    {
+        std::cout << "no path found";
+    }
+    std::cout << "   time (ms) " << ( 1000.0 * elapsed / CLOCKS_PER_SEC ) / kRepetitions << std::endl;
+
+    delete p;
+}
+
+
+
+
+bool checkPointQueries( const Map& map, const QuadTreeMap& qtMap )
+{
+    for ( int x = map.minXCoord() - kCmPerGrid; x < map.maxXCoord() + kCmPerGrid; x += kCmPerGrid / 2 )
+    {
+        for ( int y = map.minYCoord() - kCmPerGrid; y < map.maxYCoord() + kCmPerGrid; y += kCmPerGrid / 2 )
+        {
+            bool obs1 = false;
+            bool obs2 = false;
+            bool on1 = map.isThereAnObstacle( x, y, &obs1 );
+            bool on2 = qtMap.isThereAnObstacle( x, y, &obs2 );
+
+            if ( on1 != on2 || ( on1 && obs1 != obs2 ) )
+            {
+                std::cout << "  Point query mismatch at ( " << x << " , " << y << " )" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    std::cout << "  Point queries match dense map" << std::endl;
+    return true;
+}
+
+
+
+
+bool checkMarkAndMerge()
+{
+    QuadTreeMap qtMap( kCmPerGrid, 0, 0 );
+
+    // Marking one obstacle splits all the way down...
+    qtMap.markObstacle( 100, 100 );
+    int splitNodes = qtMap.nbrNodes();
+
+    // ... and clearing it merges everything back to a single leaf
+    qtMap.markClear( 100, 100 );
+    int mergedNodes = qtMap.nbrNodes();
+
+    bool okay = ( splitNodes > 1 && mergedNodes == 1 );
+
+    std::cout << "Split/merge: " << splitNodes << " nodes after mark, "
+              << mergedNodes << " after clear -- " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkCornerNeighbors()
+{
+    QuadTreeMap qtMap( kCmPerGrid, 0, 0 );
+
+    // Leaves of different sizes that only touch at a corner, with the line between their
+    // centers blocked by an obstacle
+    qtMap.markMapGridCoords( 8, 8, true );
+    qtMap.markMapGridCoords( 6, 9, true );
+
+    PathFinder::Path* p = PathFinder::findPath( qtMap.convertToNavX( 7 ), qtMap.convertToNavY( 8 ),
+                                                qtMap.convertToNavX( 12 ), qtMap.convertToNavY( 4 ), qtMap );
+
+    bool okay = p && isPathClear( p, qtMap );
+
+    std::cout << "Corner neighbors: " << ( p ? p->len() : 0 ) << " waypoints -- " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    delete p;
+    return okay;
+}
+
+
+
+
+bool checkManyNeighbors()
+{
+    QuadTreeMap qtMap( kCmPerGrid, 0, 0 );
+
+    // A free leaf a quarter of the map on a side, in the middle of the map, ringed by
+    // single-cell leaves (obstacles every other cell split everything around it down)
+    const int lo = kCarrtNavigationMapGridSize / 4;
+    const int hi = lo + kCarrtNavigationMapGridSize / 4;
+    for ( int i = lo - 2; i <= hi + 1; i += 2 )
+    {
+        qtMap.markMapGridCoords( i, lo - 2, true );
+        qtMap.markMapGridCoords( i, hi + 1, true );
+        qtMap.markMapGridCoords( lo - 2, i, true );
+        qtMap.markMapGridCoords( hi + 1, i, true );
+    }
+
+    PathFinder::Point neighbors[ PathFinder::MaxNeighbors<QuadTreeMap>::kValue ];
+    int n = qtMap.getNeighbors( lo, lo, neighbors, PathFinder::MaxNeighbors<QuadTreeMap>::kValue );
+
+    bool okay = !qtMap.hasOverflowed() && n == 4 * ( hi - lo ) + 4;
+
+    std::cout << "Many neighbors: " << n << " found -- " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool isPathClear( PathFinder::Path* p, const QuadTreeMap& qtMap )
+{
+    // Step along each leg in eighths of a grid cell, looking for obstacles
+    PathFinder::WayPoint* wp = p->getHead();
+    while ( wp && wp->next() )
+    {
+        float dx = wp->next()->x() - wp->x();
+        float dy = wp->next()->y() - wp->y();
+        int nbrSteps = static_cast<int>( 8 * sqrt( dx*dx + dy*dy ) / kCmPerGrid ) + 1;
+
+        for ( int i = 0; i <= nbrSteps; ++i )
+        {
+            bool isObstacle;
+            int x = static_cast<int>( lround( wp->x() + dx * i / nbrSteps ) );
+            int y = static_cast<int>( lround( wp->y() + dy * i / nbrSteps ) );
+            if ( !qtMap.isThereAnObstacle( x, y, &isObstacle ) || isObstacle )
+            {
+                return false;
+            }
+        }
+
+        wp = wp->next();
+    }
+
+    return true;
+}
+
+
+
+
+float pathLength( PathFinder::Path* p )
+{
+    float len = 0;
+    PathFinder::WayPoint* wp = p->getHead();
+    while ( wp && wp->next() )
+    {
+        float dx = wp->next()->x() - wp->x();
+        float dy = wp->next()->y() - wp->y();
+        len += sqrt( dx*dx + dy*dy );
+        wp = wp->next();
+    }
+
+    return len;
+}
+
+
+
+
+void loadOpenFloor( Map* map )
+{
+    // A single small obstacle in a large open room
+    for ( int x = -50; x <= 50; x += kCmPerGrid )
+    {
+        for ( int y = -50; y <= 50; y += kCmPerGrid )
+        {
+            map->markObstacle( x, y );
+        }
+    }
+}
+
+
+
+
+void loadWall( Map* map )
+{
+    // A long wall across the room with a gap at one end
+    for ( int x = map->minXCoord() + 10 * kCmPerGrid; x < map->maxXCoord(); x += kCmPerGrid )
+    {
+        map->markObstacle( x, 0 );
+        map->markObstacle( x, kCmPerGrid );
+    }
+}
+
+
+
+
+void loadClutter( Map* map )
+{
+    // Scattered furniture-sized blocks
+    srand( 2026 );
+    for ( int i = 0; i < 12; ++i )
+    {
+        int x0 = map->minXCoord() + ( rand() % ( kCarrtNavigationMapGridSize - 12 ) + 6 ) * kCmPerGrid;
+        int y0 = map->minYCoord() + ( rand() % ( kCarrtNavigationMapGridSize - 12 ) + 6 ) * kCmPerGrid;
+        for ( int x = x0; x < x0 + 3 * kCmPerGrid; x += kCmPerGrid )
+        {
+            for ( int y = y0; y < y0 + 2 * kCmPerGrid; y += kCmPerGrid )
+            {
+                map->markObstacle( x, y );
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+    LinuxSensorZeroingTest.cpp - Check the running statistics behind the
+    navigation sensors' zero points, and that zero points found in the host
+    simulator are reused from EEPROM only when they should be.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <random>
+
+#include "HostSim.h"
+#include "SensorZeroing.h"
+#include "TestSupport.h"
+
+#include "Drivers/Motors.h"
+#include "Utils/VectorUtils.h"
+
+
+
+
+namespace
+{
+    const int       kNbrSynthetic       = 2000;
+    const Vector3Float  kTrueMean( 12.3, -250.7, 1003.1 );
+    const float     kTrueSigma          = 4.0;
+};
+
+
+uint32_t timeZeroing( SensorZeroing::ZeroPoints* zero );
+bool same( const Vector3Int& a, const Vector3Int& b );
+
+
+
+
+int main()
+{
+    bool allOkay = true;
+
+    // Running statistics against known Gaussian readings
+    std::mt19937 random( 1 );
+    std::normal_distribution<float> noise( 0, kTrueSigma );
+
+    SensorZeroing::Stats stats;
+    SensorZeroing::reset( &stats );
+    allOkay = check( "No standard error from one reading", isinf( SensorZeroing::getStandardError( stats ) ) ) && allOkay;
+
+    Vector3Float sum( 0, 0, 0 );
+    for ( int i = 0; i < kNbrSynthetic; ++i )
+    {
+        Vector3Int r( lround( kTrueMean.x + noise( random ) ), lround( kTrueMean.y + noise( random ) ),
+                      lround( kTrueMean.z + noise( random ) ) );
+        SensorZeroing::add( &stats, r );
+        sum += Vector3Float( r.x, r.y, r.z );
+    }
+
+    // The running mean matches the plain one, and the standard error is sigma / sqrt( n )
+    Vector3Float plainMean = sum / kNbrSynthetic;
+    float se = SensorZeroing::getStandardError( stats );
+    float expectedSe = kTrueSigma / sqrt( kNbrSynthetic );
+    std::cout << "Standard error " << se << ", expected " << expectedSe << std::endl;
+    allOkay = check( "Running mean is the mean", norm( stats.mean - plainMean ) < 0.01 ) && allOkay;
+    allOkay = check( "Mean within 4 standard errors", norm( stats.mean - kTrueMean ) < 4 * expectedSe ) && allOkay;
+    allOkay = check( "Standard error within 10%", fabs( se / expectedSe - 1 ) < 0.1 ) && allOkay;
+
+
+    // In the simulator (its sensors are noiseless, so converge as soon as allowed)
+    HostSim::init();
+
+    SensorZeroing::ZeroPoints first;
+    uint32_t firstMs = timeZeroing( &first );
+    std::cout << "First:  " << first.nbrReadings << " readings in " << firstMs << " ms" << std::endl;
+    allOkay = check( "First zeroing is fresh", !first.fromEeprom ) && allOkay;
+    allOkay = check( "First zeroing stops early", first.nbrReadings < 320 ) && allOkay;
+    allOkay = check( "Accelerometer reads 1 g at rest", abs( first.accel.z - 1000 ) <= 1 && first.accel.x == 0 ) && allOkay;
+
+    SensorZeroing::ZeroPoints second;
+    uint32_t secondMs = timeZeroing( &second );
+    std::cout << "Second:  " << second.nbrReadings << " readings in " << secondMs << " ms" << std::endl;
+    allOkay = check( "Second zeroing reuses EEPROM", second.fromEeprom ) && allOkay;
+    allOkay = check( "Second zeroing is quicker", secondMs < firstMs ) && allOkay;
+    allOkay = check( "Same zero points", same( second.accel, first.accel ) && same( second.gyro, first.gyro ) ) && allOkay;
+
+    // Turning, the gyro's first block won't agree
+    HostSim::setMotors( HostSim::kMotorsRotateRight, Motors::kFullSpeed );
+    SensorZeroing::ZeroPoints turning;
+    timeZeroing( &turning );
+    HostSim::setMotors( HostSim::kMotorsStopped, 0 );
+    allOkay = check( "Disagreeing readings aren't replaced", !turning.fromEeprom && !same( turning.gyro, first.gyro ) ) && allOkay;
+
+    // That run overwrote the stored zero points, so find them at rest again, then warm up
+    timeZeroing( &second );
+    HostSim::setTempC( 30 );
+    SensorZeroing::ZeroPoints warm;
+    timeZeroing( &warm );
+    allOkay = check( "Warmer zeroing is fresh", !warm.fromEeprom ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+uint32_t timeZeroing( SensorZeroing::ZeroPoints* zero )
+{
+    uint32_t start = HostSim::getMillis();
+    SensorZeroing::findZeroPoints( zero );
+    return HostSim::getMillis() - start;
+}
+
+
+
+bool same( const Vector3Int& a, const Vector3Int& b )
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
@@ -0,0 +1,355 @@
+/*
+    LinuxTimerServiceTest.cpp - Test the software timer service against a
+    simple reference model, using a virtual clock.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+#include <stdlib.h>
+
+#include "EventManager.h"
+#include "TimerService.h"
+
+
+
+
+const uint8_t kTimerEvent = EventManager::kFirstUserEvent;
+
+
+// Reference model of a timer
+struct RefTimer
+{
+    bool        running;
+    uint32_t    expiry;
+    uint16_t    period;
+    int16_t     tag;            // the event parameter, unique to each start
+};
+
+RefTimer gRef[ kCarrtTimerServiceMaxTimers ];
+
+uint32_t gClock;
+long gNbrFired;
+long gNextTag;
+
+
+bool checkEachDelay();
+bool checkPeriodicAndCancel();
+bool checkStall();
+bool checkRandomAgainstReference( uint32_t startTime );
+bool advanceAndCheck( uint32_t newTime );
+
+
+
+
+int main()
+{
+    EventManager::init();
+
+    bool allOkay = checkEachDelay();
+    allOkay = checkPeriodicAndCancel() && allOkay;
+    allOkay = checkStall() && allOkay;
+
+    // Start just short of a 65536 ms boundary and at the point the clock wraps, too
+    allOkay = checkRandomAgainstReference( 0 ) && allOkay;
+    allOkay = checkRandomAgainstReference( 65536 - 3000 ) && allOkay;
+    allOkay = checkRandomAgainstReference( 0xFFFFFFFF - 100000 ) && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+bool checkEachDelay()
+{
+    // Delays at and around each level boundary, from start times that straddle them
+    const uint16_t delays[] = { 1, 2, 15, 16, 17, 255, 256, 257, 4095, 4096, 4097, 65535 };
+    const uint32_t starts[] = { 0, 7, 4090, 65530, 1000000 };
+
+    bool okay = true;
+
+    for ( uint32_t start : starts )
+    {
+        for ( uint16_t delay : delays )
+        {
+            TimerService::init( start );
+            EventManager::reset();
+
+            TimerService::startOneShot( delay, kTimerEvent, delay );
+
+            uint32_t firedAt = 0;
+            int nbrFired = 0;
+            for ( uint32_t t = start + 1; t <= start + delay + 20; ++t )
+            {
+                TimerService::advanceTo( t );
+
+                uint8_t code;
+                int16_t param;
+                while ( EventManager::getNextEvent( &code, &param ) )
+                {
+                    firedAt = t;
+                    ++nbrFired;
+                }
+            }
+
+            if ( nbrFired != 1 || firedAt != start + delay || TimerService::getNbrRunningTimers() )
+            {
+                std::cout << "  Delay " << delay << " from " << start << " fired " << nbrFired
+                          << " times, at " << firedAt << std::endl;
+                okay = false;
+            }
+        }
+    }
+
+    std::cout << "One-shot delays: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkPeriodicAndCancel()
+{
+    TimerService::init( 100 );
+    EventManager::reset();
+
+    uint8_t periodic = TimerService::startPeriodic( 7, kTimerEvent, 1 );
+    uint8_t canceled = TimerService::startOneShot( 50, kTimerEvent, 2 );
+
+    bool okay = TimerService::cancel( canceled ) && !TimerService::cancel( canceled );
+    okay = okay && !TimerService::isRunning( canceled ) && TimerService::isRunning( periodic );
+
+    int nbrFired = 0;
+    for ( uint32_t t = 101; t <= 1100; ++t )
+    {
+        TimerService::advanceTo( t );
+
+        uint8_t code;
+        int16_t param;
+        while ( EventManager::getNextEvent( &code, &param ) )
+        {
+            okay = okay && ( param == 1 ) && ( ( t - 100 ) % 7 == 0 );
+            ++nbrFired;
+        }
+    }
+    okay = okay && ( nbrFired == 1000 / 7 );
+
+    okay = okay && TimerService::cancel( periodic ) && !TimerService::getNbrRunningTimers();
+
+    // Use up every timer
+    for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        okay = okay && TimerService::startOneShot( 10, kTimerEvent, i ) != TimerService::kNoTimer;
+    }
+    okay = okay && TimerService::startOneShot( 10, kTimerEvent, 0 ) == TimerService::kNoTimer;
+
+    std::cout << "Periodic, cancel and exhaustion: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkStall()
+{
+    TimerService::init( 0 );
+    EventManager::reset();
+
+    TimerService::startPeriodic( 100, kTimerEvent, 1 );
+    TimerService::startOneShot( 250, kTimerEvent, 2 );
+    TimerService::startOneShot( 9000, kTimerEvent, 3 );
+
+    // A 10 second stall produces one event per timer, not one per period
+    TimerService::advanceTo( 10000 );
+
+    int nbrEvents = 0;
+    uint8_t code;
+    int16_t param;
+    while ( EventManager::getNextEvent( &code, &param ) )
+    {
+        ++nbrEvents;
+    }
+
+    bool okay = ( nbrEvents == 3 ) && ( TimerService::getNbrRunningTimers() == 1 );
+
+    // ... and the periodic timer stays on its original schedule
+    TimerService::advanceTo( 10099 );
+    okay = okay && !EventManager::getNextEvent( &code, &param );
+    TimerService::advanceTo( 10100 );
+    okay = okay && EventManager::getNextEvent( &code, &param ) && ( param == 1 );
+
+    // Time running backward is ignored
+    TimerService::advanceTo( 5000 );
+    okay = okay && ( TimerService::now() == 10100 );
+
+    okay = okay && !EventManager::hasEventQueueOverflowed();
+
+    std::cout << "Stall: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkRandomAgainstReference( uint32_t startTime )
+{
+    srand( 2026 );
+
+    TimerService::init( startTime );
+    EventManager::reset();
+
+    gClock = startTime;
+    gNbrFired = 0;
+    gNextTag = 1;
+    for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        gRef[i].running = false;
+    }
+
+    bool okay = true;
+
+    for ( long step = 0; step < 200000 && okay; ++step )
+    {
+        int action = rand() % 100;
+
+        if ( action < 4 )
+        {
+            // Start a timer, with a spread of delays across all levels
+            uint16_t delay = 1 + ( rand() % 4 == 0 ? rand() % 65535 : rand() % ( 1 << ( rand() % 12 ) ) );
+            bool periodic = rand() % 3 == 0;
+            int16_t tag = static_cast<int16_t>( gNextTag++ & 0x7FFF );
+            uint8_t id = periodic ? TimerService::startPeriodic( delay, kTimerEvent, tag )
+                                  : TimerService::startOneShot( delay, kTimerEvent, tag );
+            if ( id != TimerService::kNoTimer )
+            {
+                gRef[id].running = true;
+                gRef[id].tag = tag;
+                gRef[id].expiry = gClock + delay;
+                gRef[id].period = periodic ? delay : 0;
+            }
+        }
+        else if ( action < 6 )
+        {
+            uint8_t id = rand() % kCarrtTimerServiceMaxTimers;
+            bool canceled = TimerService::cancel( id );
+            okay = ( canceled == gRef[id].running );
+            gRef[id].running = false;
+        }
+        else
+        {
+            // Mostly small steps, with the occasional long jump
+            uint32_t dt = ( rand() % 500 == 0 ) ? rand() % 70000 : 1 + rand() % 40;
+            okay = advanceAndCheck( gClock + dt );
+        }
+    }
+
+    std::cout << "Random timers from " << startTime << ": " << gNbrFired << " expiries -- "
+              << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool advanceAndCheck( uint32_t newTime )
+{
+    // Expected events, in the style of the service:  each timer due by newTime
+    // fires once, and periodic timers skip to their next expiry after newTime
+    int expected[ kCarrtTimerServiceMaxTimers ] = { 0 };
+    for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        RefTimer* r = &gRef[i];
+        if ( r->running && static_cast<int32_t>( newTime - r->expiry ) >= 0 )
+        {
+            expected[i] = 1;
+            if ( r->period )
+            {
+                uint32_t e = r->expiry + r->period;
+                if ( static_cast<int32_t>( newTime - e ) >= 0 )
+                {
+                    e += ( ( newTime - e ) / r->period + 1 ) * r->period;
+                }
+                r->expiry = e;
+            }
+            else
+            {
+                r->running = false;
+            }
+        }
+    }
+
+    // Timers that expire are tagged by their event parameter
+    int16_t tags[ kCarrtTimerServiceMaxTimers ];
+    for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        tags[i] = gRef[i].tag;
+    }
+
+    TimerService::advanceTo( newTime );
+    gClock = newTime;
+
+    int nbrExpected = 0;
+    for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        nbrExpected += expected[i];
+    }
+
+    bool okay = true;
+    int nbrSeen = 0;
+    uint8_t code;
+    int16_t param;
+    while ( EventManager::getNextEvent( &code, &param ) )
+    {
+        ++nbrSeen;
+
+        // Each event must come from a timer that was due
+        bool found = false;
+        for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+        {
+            if ( expected[i] && tags[i] == param )
+            {
+                expected[i] = 0;
+                found = true;
+            }
+        }
+        okay = okay && found && ( code == kTimerEvent );
+    }
+    gNbrFired += nbrSeen;
+
+    okay = okay && ( nbrSeen == nbrExpected );
+
+    for ( int i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        okay = okay && ( TimerService::isRunning( i ) == gRef[i].running );
+    }
+
+    if ( !okay )
+    {
+        std::cout << "  Mismatch at time " << newTime << ": expected " << nbrExpected
+                  << " expiries, saw " << nbrSeen << std::endl;
+    }
+
+    return okay;
+}
@@ -0,0 +1,217 @@
+/*
+    LinuxTraceRecorderTest.cpp - Test the trace recorder's ring buffer, state
+    IDs and dump format.  The dump is left in TraceRecorderTest.log, which
+    TraceDecode can turn into a timeline.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "EventManager.h"
+#include "State.h"
+#include "TimerService.h"
+#include "TraceRecorder.h"
+
+
+
+
+// Stands in for an AVRTools Writer
+class StreamWriter
+{
+public:
+
+    explicit StreamWriter( std::ostream& out ) : mOut( out ) {}
+
+    void print( char c )            { mOut << c; }
+    void print( long n )            { mOut << n; }
+    void print( unsigned long n )   { mOut << n; }
+
+private:
+
+    std::ostream& mOut;
+};
+
+
+class StateA : public State {};
+class StateB : public State {};
+
+
+bool checkRecording();
+bool checkWrapAndOverflow();
+bool checkDump();
+
+
+
+
+int main()
+{
+    EventManager::init();
+
+    bool allOkay = checkRecording();
+    allOkay = checkWrapAndOverflow() && allOkay;
+    allOkay = checkDump() && allOkay;
+
+    std::cout << std::endl << ( allOkay ? "PASSED" : "FAILED" ) << std::endl;
+
+    return allOkay ? 0 : 1;
+}
+
+
+
+
+bool checkRecording()
+{
+    TraceRecorder::init();
+    TimerService::init( 70000 );
+    EventManager::reset();
+
+    StateA a;
+    StateB b;
+
+    TraceRecorder::recordStateChange( &a );
+    EventManager::queueEvent( EventManager::kKeypadButtonHitEvent, 4 );
+    TimerService::advanceTo( 70010 );
+    TraceRecorder::recordStateChange( &b );
+    TraceRecorder::record( TraceRecorder::kTraceError, 107 );
+    TraceRecorder::recordStateChange( &a );
+
+    const TraceRecorder::Record& r0 = TraceRecorder::getRecord( 0 );
+    const TraceRecorder::Record& r1 = TraceRecorder::getRecord( 1 );
+    const TraceRecorder::Record& r3 = TraceRecorder::getRecord( 3 );
+    const TraceRecorder::Record& r4 = TraceRecorder::getRecord( 4 );
+
+    bool okay = TraceRecorder::getNbrRecords() == 5 && TraceRecorder::getNbrStateIds() == 2;
+
+    okay = okay && r0.code == TraceRecorder::kTraceStateChange && r0.stateId == 1
+                && static_cast<uint16_t>( r0.param ) == getStateClassKey( &a );
+
+    okay = okay && r1.code == EventManager::kKeypadButtonHitEvent && r1.param == 4
+                && r1.stateId == 1 && r1.time == static_cast<uint16_t>( 70000 );
+
+    okay = okay && r3.code == TraceRecorder::kTraceError && r3.param == 107 && r3.stateId == 2
+                && r3.time == static_cast<uint16_t>( 70010 );
+
+    // The same class gets the same ID again
+    okay = okay && r4.stateId == 1 && TraceRecorder::getStateClassKeyForId( 2 ) == getStateClassKey( &b );
+
+    std::cout << "Recording: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkWrapAndOverflow()
+{
+    TraceRecorder::init();
+    TimerService::init( 0 );
+    EventManager::reset();
+
+    // Overfill the event queue, then the ring buffer
+    const int kNbrEvents = kCarrtTraceRecorderSize + 10;
+    int nbrQueued = 0;
+    for ( int i = 0; i < kNbrEvents; ++i )
+    {
+        if ( !EventManager::queueEvent( EventManager::kFirstUserEvent, i ) )
+        {
+            ++nbrQueued;
+        }
+    }
+
+    bool okay = TraceRecorder::getNbrRecords() == kCarrtTraceRecorderSize;
+
+    // Oldest surviving record is number 10; the ones that didn't fit in the queue are flagged
+    for ( int i = 0; i < kCarrtTraceRecorderSize && okay; ++i )
+    {
+        const TraceRecorder::Record& r = TraceRecorder::getRecord( i );
+        int n = i + 10;
+        if ( n < nbrQueued )
+        {
+            okay = r.code == EventManager::kFirstUserEvent && r.param == n;
+        }
+        else
+        {
+            okay = r.code == TraceRecorder::kTraceQueueOverflow && r.param == EventManager::kFirstUserEvent;
+        }
+    }
+
+    EventManager::reset();
+    EventManager::resetEventQueueOverflowFlag();
+
+    std::cout << "Wrap and overflow: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
+
+
+
+
+bool checkDump()
+{
+    TraceRecorder::init();
+    TimerService::init( 65530 );
+    EventManager::reset();
+
+    StateA a;
+    StateB b;
+
+    TraceRecorder::record( TraceRecorder::kTraceReset, 0 );
+    TraceRecorder::recordStateChange( &a );
+    EventManager::queueEvent( EventManager::kKeypadButtonHitEvent, 1 );
+    TimerService::advanceTo( 65540 );
+    TraceRecorder::recordStateChange( &b );
+    EventManager::queueEvent( EventManager::kErrorEvent, 603, EventManager::kHighPriority );
+    TraceRecorder::record( TraceRecorder::kTraceError, 603 );
+
+    std::ostringstream text;
+    StreamWriter writer( text );
+    TraceRecorder::dump( writer, 65541 );
+
+    std::ostringstream expected;
+    expected << "@T 1 65541 6 2\n"
+             << "@S 1 " << getStateClassKey( &a ) << "\n"
+             << "@S 2 " << getStateClassKey( &b ) << "\n"
+             << "65530 " << int( TraceRecorder::kTraceReset ) << " 0 0\n"
+             << "65530 " << int( TraceRecorder::kTraceStateChange ) << " 1 " << int16_t( getStateClassKey( &a ) ) << "\n"
+             << "65530 " << int( EventManager::kKeypadButtonHitEvent ) << " 1 1\n"
+             << "4 " << int( TraceRecorder::kTraceStateChange ) << " 2 " << int16_t( getStateClassKey( &b ) ) << "\n"
+             << "4 " << int( EventManager::kErrorEvent ) << " 2 603\n"
+             << "4 " << int( TraceRecorder::kTraceError ) << " 2 603\n"
+             << "@E\n";
+
+    bool okay = text.str() == expected.str();
+    if ( !okay )
+    {
+        std::cout << "  Got:\n" << text.str() << "  Expected:\n" << expected.str();
+    }
+
+    // Leave a sample for TraceDecode, amid other serial output
+    std::ofstream log( "TraceRecorderTest.log" );
+    log << "CARRT Debugging Output...\n" << text.str() << "Other output\n";
+
+    EventManager::reset();
+
+    std::cout << "Dump: " << ( okay ? "okay" : "WRONG" ) << std::endl;
+
+    return okay;
+}
@@ -0,0 +1,288 @@
+/*
+    NavReplay.cpp - Replay a sensor log (see SensorLog.h) through the
+    Navigator, as each of its builds, in the host simulator.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "NavReplay.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <iterator>
+#include <string>
+
+#include "HostSim.h"
+#include "Navigator.h"
+
+#include "Drivers/LSM303DLHC.h"
+#include "Utils/VectorUtils.h"
+
+
+namespace
+{
+    const char* const kVariantNames[ NavReplay::kNbrVariants ] =
+    {
+        "dr-float",
+        "dr-fixed",
+        "inertial",
+        "hybrid",
+        "compare"
+    };
+
+
+    bool same( const Vector3Int& a, const Vector3Int& b )
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+
+    float headingDifference( float a, float b )
+    {
+        float d = fabs( a - b );
+        return d > 180 ? 360 - d : d;
+    }
+};
+
+
+
+
+const char* NavReplay::getVariantName( int variant )
+{
+    return ( variant >= 0 && variant < kNbrVariants ) ? kVariantNames[ variant ] : "?";
+}
+
+
+
+int NavReplay::readLog( std::istream& in, std::vector<LogEntry>* entries )
+{
+    std::vector<uint8_t> data( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+    return readLog( data, entries );
+}
+
+
+
+int NavReplay::readLog( const std::vector<uint8_t>& data, std::vector<LogEntry>* entries )
+{
+    int n = 0;
+    uint32_t pos = 0;
+    uint8_t type;
+    const uint8_t* payload;
+
+    while ( SensorLog::findRecord( data.data(), data.size(), &pos, &type, &payload ) )
+    {
+        LogEntry entry;
+        entry.type = type;
+
+        switch ( type )
+        {
+            case SensorLog::kStartRecord:
+                SensorLog::decodeStart( payload, &entry.start );
+                break;
+
+            case SensorLog::kSampleRecord:
+                SensorLog::decodeSample( payload, &entry.sample );
+                break;
+
+            default:
+                SensorLog::decodeMotion( payload, &entry.motion );
+                break;
+        }
+
+        entries->push_back( entry );
+        ++n;
+    }
+
+    return n;
+}
+
+
+
+NavReplay::Result NavReplay::replay( const std::vector<LogEntry>& entries, int variant )
+{
+    Result result;
+    result.meanNsPerUpdate = 0;
+    result.maxNsPerUpdate = 0;
+    result.zeroPointsMatch = true;
+
+    HostSim::init();
+
+    HostSim::NavSensorReadings readings;
+    readings.accel = Vector3Int( 0, 0, 0 );
+    readings.gyro = Vector3Int( 0, 0, 0 );
+    readings.mag = Vector3Int( 0, 0, 0 );
+
+    bool started = false;
+    double totalNs = 0;
+
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        const LogEntry& entry = entries[i];
+
+        if ( entry.type == SensorLog::kStartRecord )
+        {
+            // The sensors read what they did when the Navigator started
+            readings.accel = entry.start.accelZero;
+            readings.gyro = entry.start.gyroZero;
+            readings.mag = entry.start.mag;
+            HostSim::setNavSensorReadings( &readings );
+            LSM303DLHC::setMagnetometerCalibration( entry.start.calibration );
+
+            Navigator::init();
+            Navigator::setModel( variant );
+
+            result.zeroPointsMatch = result.zeroPointsMatch
+                                        && same( Navigator::getRestStateAcceleration(), entry.start.accelZero )
+                                        && same( Navigator::getRestStateAngularRate(), entry.start.gyroZero );
+            started = true;
+            continue;
+        }
+
+        if ( !started )
+        {
+            // Picked up part way through:  wait for the Navigator to start
+            continue;
+        }
+
+        if ( entry.type == SensorLog::kSampleRecord )
+        {
+            readings.mag = entry.sample.mag;
+
+            int16_t eventParam = ImuSampler::replaySample( entry.sample );
+
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            Navigator::doNavSampleReady( eventParam );
+            std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+            double ns = std::chrono::duration<double, std::nano>( t1 - t0 ).count();
+            totalNs += ns;
+            if ( ns > result.maxNsPerUpdate )
+            {
+                result.maxNsPerUpdate = ns;
+            }
+
+            Vector2Float position = Navigator::getCurrentPositionCm();
+            TrajectoryPoint point = { entry.sample.micros, position.x, position.y, Navigator::getCurrentHeading() };
+            result.trajectory.push_back( point );
+        }
+        else
+        {
+            switch ( entry.motion.motion )
+            {
+                case SensorLog::kStraight:
+                    Navigator::movingStraight();
+                    break;
+
+                case SensorLog::kTurning:
+                    Navigator::movingTurning();
+                    break;
+
+                case SensorLog::kStopped:
+                    Navigator::stopped();
+                    break;
+
+                default:
+                    // The compass reads as it last did
+                    HostSim::setNavSensorReadings( &readings );
+                    Navigator::reset();
+                    break;
+            }
+        }
+    }
+
+    HostSim::setNavSensorReadings( 0 );
+
+    if ( !result.trajectory.empty() )
+    {
+        result.meanNsPerUpdate = totalNs / result.trajectory.size();
+    }
+
+    return result;
+}
+
+
+
+NavReplay::Divergence NavReplay::compare( const std::vector<TrajectoryPoint>& a, const std::vector<TrajectoryPoint>& b )
+{
+    Divergence d = { 0, 0, 0, 0 };
+
+    // Both in time order; pair up the points at the same times
+    size_t j = 0;
+    for ( size_t i = 0; i < a.size(); ++i )
+    {
+        while ( j < b.size() && static_cast<int32_t>( b[j].micros - a[i].micros ) < 0 )
+        {
+            ++j;
+        }
+
+        if ( j == b.size() )
+        {
+            break;
+        }
+
+        if ( b[j].micros == a[i].micros )
+        {
+            float distance = hypot( a[i].x - b[j].x, a[i].y - b[j].y );
+
+            ++d.nbrCompared;
+            d.maxDistance = fmax( d.maxDistance, distance );
+            d.maxHeading = fmax( d.maxHeading, headingDifference( a[i].heading, b[j].heading ) );
+            d.finalDistance = distance;
+        }
+    }
+
+    return d;
+}
+
+
+
+void NavReplay::writeTrajectory( std::ostream& out, const std::vector<TrajectoryPoint>& trajectory )
+{
+    out << "micros, x, y, heading\n";
+
+    char line[80];
+    for ( size_t i = 0; i < trajectory.size(); ++i )
+    {
+        // Enough digits to tell builds apart
+        const TrajectoryPoint& p = trajectory[i];
+        snprintf( line, sizeof line, "%u, %.9g, %.9g, %.9g\n", p.micros, p.x, p.y, p.heading );
+        out << line;
+    }
+}
+
+
+
+int NavReplay::readTrajectory( std::istream& in, std::vector<TrajectoryPoint>* trajectory )
+{
+    int n = 0;
+    std::string line;
+
+    while ( std::getline( in, line ) )
+    {
+        TrajectoryPoint p;
+        if ( sscanf( line.c_str(), "%u , %f , %f , %f", &p.micros, &p.x, &p.y, &p.heading ) == 4 )
+        {
+            trajectory->push_back( p );
+            ++n;
+        }
+    }
+
+    return n;
+}
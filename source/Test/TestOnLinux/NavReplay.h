@@ -0,0 +1,116 @@
+/*
+    NavReplay.h - Replay a sensor log (see SensorLog.h) through the
+    Navigator, as each of its builds, in the host simulator.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef NavReplay_h
+#define NavReplay_h
+
+#include <stdint.h>
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "ImuSampler.h"
+#include "Navigator.h"
+#include "SensorLog.h"
+
+
+
+/*
+ * The Navigator's code runs unchanged:  the simulated drivers read back the
+ * recorded zero points and compass readings (HostSim::setNavSensorReadings())
+ * when the Navigator reads the sensors itself, in init() and reset(), and
+ * the recorded samples go to doNavSampleReady() through ImuSampler.  Motion
+ * commands are replayed in their place among the samples.
+ *
+ * Each variant is one of the Navigator's models (Navigator::Model), chosen
+ * with Navigator::setModel() right after init(), so a log can go through
+ * all of them in one run.
+ */
+
+namespace NavReplay
+{
+
+    // Variants are Navigator::Model values
+    const int kNbrVariants = Navigator::kNbrModels;
+
+    const char* getVariantName( int variant );
+
+
+    struct LogEntry
+    {
+        uint8_t                     type;           // SensorLog::kSampleRecord, etc.
+        SensorLog::Start            start;
+        ImuSampler::Sample          sample;
+        SensorLog::MotionChange     motion;
+    };
+
+    // Appends the records in the log to entries (skipping anything else in it); returns
+    // the number read
+    int readLog( std::istream& in, std::vector<LogEntry>* entries );
+    int readLog( const std::vector<uint8_t>& data, std::vector<LogEntry>* entries );
+
+
+    // Where the Navigator was after each sample
+    struct TrajectoryPoint
+    {
+        uint32_t    micros;
+        float       x;          // cm
+        float       y;          // cm
+        float       heading;    // deg
+    };
+
+    struct Result
+    {
+        std::vector<TrajectoryPoint>    trajectory;
+
+        // Host time spent in doNavSampleReady()
+        double      meanNsPerUpdate;
+        double      maxNsPerUpdate;
+
+        // False if init() didn't come up with the recorded zero points
+        bool        zeroPointsMatch;
+    };
+
+    // Replays the log through the Navigator (resets the host simulator)
+    Result replay( const std::vector<LogEntry>& entries, int variant );
+
+
+    struct Divergence
+    {
+        int         nbrCompared;        // points at the same times
+        float       maxDistance;        // cm
+        float       maxHeading;         // deg
+        float       finalDistance;      // cm, at the last point compared
+    };
+
+    Divergence compare( const std::vector<TrajectoryPoint>& a, const std::vector<TrajectoryPoint>& b );
+
+
+    // As CSV:  micros, x, y, heading (with a header line)
+    void writeTrajectory( std::ostream& out, const std::vector<TrajectoryPoint>& trajectory );
+    int readTrajectory( std::istream& in, std::vector<TrajectoryPoint>* trajectory );
+
+};
+
+
+#endif
@@ -0,0 +1,128 @@
+/*
+    NavReplayTool.cpp - Replay a sensor log captured over debug serial through
+    each build of the Navigator:  trajectories, host CPU time per update, and
+    how far the builds (and any earlier runs) diverge.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "NavReplay.h"
+
+
+
+
+/*
+ * NavReplay <log> [<out prefix> [<reference prefix>]]
+ *
+ * Writes each build's trajectory to <out prefix>.<build>.csv, and compares it
+ * with <reference prefix>.<build>.csv (written by an earlier run, e.g., before
+ * a change to the Navigator) if there is one.
+ */
+
+void printDivergence( const char* label, const NavReplay::Divergence& d );
+
+
+
+
+int main( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <log> [<out prefix> [<reference prefix>]]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream logFile( argv[1], std::ios::binary );
+    if ( !logFile )
+    {
+        std::cerr << "Can't open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<NavReplay::LogEntry> entries;
+    int n = NavReplay::readLog( logFile, &entries );
+    std::cout << argv[1] << ": " << n << " records" << std::endl;
+
+    if ( entries.empty() )
+    {
+        std::cerr << "No sensor log records found" << std::endl;
+        return 1;
+    }
+
+    NavReplay::Result results[ NavReplay::kNbrVariants ];
+
+    for ( int v = 0; v < NavReplay::kNbrVariants; ++v )
+    {
+        const char* name = NavReplay::getVariantName( v );
+        NavReplay::Result& r = results[v];
+        r = NavReplay::replay( entries, v );
+
+        std::cout << std::endl << name << ":  " << r.trajectory.size() << " updates, "
+                  << r.meanNsPerUpdate << " ns per update (max " << r.maxNsPerUpdate << ")" << std::endl;
+
+        if ( !r.zeroPointsMatch )
+        {
+            std::cout << "    Zero points differ from the log's (stored ones reused?)" << std::endl;
+        }
+
+        if ( !r.trajectory.empty() )
+        {
+            const NavReplay::TrajectoryPoint& last = r.trajectory.back();
+            std::cout << "    Final pose:  " << last.x << ", " << last.y << " cm, heading " << last.heading << std::endl;
+        }
+
+        if ( v )
+        {
+            printDivergence( "vs dr-float", NavReplay::compare( r.trajectory, results[0].trajectory ) );
+        }
+
+        if ( argc > 2 )
+        {
+            std::string outName = std::string( argv[2] ) + "." + name + ".csv";
+            std::ofstream out( outName.c_str() );
+            NavReplay::writeTrajectory( out, r.trajectory );
+        }
+
+        if ( argc > 3 )
+        {
+            std::string refName = std::string( argv[3] ) + "." + name + ".csv";
+            std::ifstream ref( refName.c_str() );
+            std::vector<NavReplay::TrajectoryPoint> reference;
+            if ( ref && NavReplay::readTrajectory( ref, &reference ) )
+            {
+                printDivergence( "vs reference", NavReplay::compare( r.trajectory, reference ) );
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+
+
+void printDivergence( const char* label, const NavReplay::Divergence& d )
+{
+    std::cout << "    " << label << ":  " << d.nbrCompared << " points, max " << d.maxDistance << " cm and "
+              << d.maxHeading << " deg, final " << d.finalDistance << " cm" << std::endl;
+}
@@ -0,0 +1,39 @@
+/*
+    TestSupport.h - Reporting shared by the tests that run on Linux.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef TestSupport_h
+#define TestSupport_h
+
+
+#include <iostream>
+
+
+
+// Report one check (header only, so the tests built without HostSim can use it too)
+inline bool check( const char* what, bool okay )
+{
+    std::cout << what << ": " << ( okay ? "okay" : "WRONG" ) << std::endl;
+    return okay;
+}
+
+
+#endif
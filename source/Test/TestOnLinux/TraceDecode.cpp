@@ -0,0 +1,339 @@
+/*
+    TraceDecode.cpp - Turn a trace dumped by CARRT's TraceRecorder into a
+    readable timeline.
+
+    Usage:  TraceDecode [serial-log [symbols]]
+
+    The serial log (or stdin) may contain other output; every trace in it is
+    decoded.  Symbols is the output of "avr-nm -C -S Carrt.elf", used to name
+    the state classes from their vtable addresses.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ErrorCodes.h"
+#include "EventManager.h"
+#include "TraceRecorder.h"
+
+
+
+
+struct VtableSymbol
+{
+    uint32_t    size;
+    std::string className;
+};
+
+// Vtable symbols, by (16-bit) address
+std::map<uint16_t, VtableSymbol> gVtables;
+
+// State class keys, by state ID, for the trace being decoded
+std::map<int, uint16_t> gStateKeys;
+
+
+void readSymbols( std::istream& in );
+bool decodeTrace( std::istream& in, const std::string& header, std::ostream& out );
+std::string stateName( int stateId );
+std::string className( uint16_t classKey );
+std::string eventName( int code );
+std::string errorName( int code );
+
+
+
+
+int main( int argc, char** argv )
+{
+    std::ifstream logFile;
+    if ( argc > 1 )
+    {
+        logFile.open( argv[1] );
+        if ( !logFile )
+        {
+            std::cerr << "Can't open " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = ( argc > 1 ) ? static_cast<std::istream&>( logFile ) : std::cin;
+
+    if ( argc > 2 )
+    {
+        std::ifstream symbols( argv[2] );
+        if ( !symbols )
+        {
+            std::cerr << "Can't open " << argv[2] << std::endl;
+            return 1;
+        }
+        readSymbols( symbols );
+    }
+
+    int nbrTraces = 0;
+    bool allOkay = true;
+    std::string line;
+    while ( std::getline( in, line ) )
+    {
+        if ( line.compare( 0, 2, "@T" ) == 0 )
+        {
+            ++nbrTraces;
+            std::cout << "=== Trace " << nbrTraces << " ===" << std::endl;
+            allOkay = decodeTrace( in, line, std::cout ) && allOkay;
+        }
+    }
+
+    if ( !nbrTraces )
+    {
+        std::cerr << "No trace found" << std::endl;
+    }
+
+    return ( nbrTraces && allOkay ) ? 0 : 1;
+}
+
+
+
+
+void readSymbols( std::istream& in )
+{
+    // avr-nm -C -S lines look like "0080021c 00000012 d vtable for WelcomeState";
+    // without -S the size is missing
+
+    const std::string kVtable( "vtable for " );
+
+    std::string line;
+    while ( std::getline( in, line ) )
+    {
+        std::string::size_type pos = line.find( kVtable );
+        if ( pos == std::string::npos )
+        {
+            continue;
+        }
+
+        std::istringstream fields( line.substr( 0, pos ) );
+        std::string address;
+        std::string size;
+        std::string type;
+        fields >> address >> size >> type;
+        if ( type.empty() )
+        {
+            size = "0";
+        }
+
+        VtableSymbol sym;
+        sym.size = std::stoul( size, 0, 16 );
+        sym.className = line.substr( pos + kVtable.size() );
+
+        // AVR data addresses are offset by 0x800000 in the ELF file
+        gVtables[ static_cast<uint16_t>( std::stoul( address, 0, 16 ) ) ] = sym;
+    }
+}
+
+
+
+
+bool decodeTrace( std::istream& in, const std::string& header, std::ostream& out )
+{
+    int version = 0;
+    unsigned long nowMs = 0;
+    int nbrRecords = 0;
+    int nbrStates = 0;
+    if ( std::sscanf( header.c_str(), "@T %d %lu %d %d", &version, &nowMs, &nbrRecords, &nbrStates ) != 4
+         || version != TraceRecorder::kFormatVersion )
+    {
+        out << "  Unrecognized trace header: " << header << std::endl;
+        return false;
+    }
+
+    gStateKeys.clear();
+
+    std::vector<TraceRecorder::Record> records;
+    std::string line;
+    bool complete = false;
+    while ( std::getline( in, line ) )
+    {
+        int a, b, c, d;
+        if ( line.compare( 0, 2, "@E" ) == 0 )
+        {
+            complete = true;
+            break;
+        }
+        else if ( std::sscanf( line.c_str(), "@S %d %d", &a, &b ) == 2 )
+        {
+            gStateKeys[a] = static_cast<uint16_t>( b );
+        }
+        else if ( std::sscanf( line.c_str(), "%d %d %d %d", &a, &b, &c, &d ) == 4 )
+        {
+            TraceRecorder::Record r;
+            r.time = static_cast<uint16_t>( a );
+            r.code = static_cast<uint8_t>( b );
+            r.stateId = static_cast<uint8_t>( c );
+            r.param = static_cast<int16_t>( d );
+            records.push_back( r );
+        }
+    }
+
+    if ( !complete || static_cast<int>( records.size() ) != nbrRecords
+         || static_cast<int>( gStateKeys.size() ) != nbrStates )
+    {
+        out << "  Trace is truncated or garbled; decoding what is there" << std::endl;
+    }
+
+    // Records hold the low 16 bits of the time; rebuild the full times backward from
+    // the dump time (assumes no gaps of more than 65 seconds between records)
+    std::vector<unsigned long> times( records.size() );
+    unsigned long t = nowMs;
+    uint16_t low = static_cast<uint16_t>( nowMs );
+    for ( size_t i = records.size(); i-- > 0; )
+    {
+        t -= static_cast<uint16_t>( low - records[i].time );
+        low = records[i].time;
+        times[i] = t;
+    }
+
+    char buffer[32];
+    for ( size_t i = 0; i < records.size(); ++i )
+    {
+        const TraceRecorder::Record& r = records[i];
+
+        std::snprintf( buffer, sizeof( buffer ), "%9.3f", times[i] / 1000.0 );
+        out << buffer << "  " << stateName( r.stateId ) << "  ";
+
+        switch ( r.code )
+        {
+            case TraceRecorder::kTraceStateChange:
+                out << "-> " << className( static_cast<uint16_t>( r.param ) );
+                break;
+
+            case TraceRecorder::kTraceError:
+                out << "ERROR " << errorName( r.param );
+                break;
+
+            case TraceRecorder::kTraceUnrecoverableError:
+                out << "UNRECOVERABLE ERROR " << errorName( r.param );
+                break;
+
+            case TraceRecorder::kTraceQueueOverflow:
+                out << "QUEUE OVERFLOW dropped " << eventName( r.param );
+                break;
+
+            case TraceRecorder::kTraceReset:
+                out << "=== reset ===";
+                break;
+
+            case TraceRecorder::kTraceNavDeadlineMiss:
+                out << "NAV DEADLINE MISSED " << r.param << " tick(s)";
+                break;
+
+            default:
+                out << eventName( r.code ) << " (" << r.param << ")";
+                break;
+        }
+        out << std::endl;
+    }
+
+    out << std::endl;
+
+    return complete;
+}
+
+
+
+
+std::string stateName( int stateId )
+{
+    if ( !stateId )
+    {
+        return "[?]";
+    }
+
+    std::map<int, uint16_t>::const_iterator i = gStateKeys.find( stateId );
+    return "[" + ( i != gStateKeys.end() ? className( i->second ) : std::to_string( stateId ) ) + "]";
+}
+
+
+
+
+std::string className( uint16_t classKey )
+{
+    // The vtable pointer points into the vtable symbol (past the offset and RTTI words)
+    std::map<uint16_t, VtableSymbol>::const_iterator i = gVtables.upper_bound( classKey );
+    if ( i != gVtables.begin() )
+    {
+        --i;
+        uint32_t limit = i->second.size ? i->second.size : 8;
+        if ( static_cast<uint32_t>( classKey - i->first ) < limit )
+        {
+            return i->second.className;
+        }
+    }
+
+    char buffer[16];
+    std::snprintf( buffer, sizeof( buffer ), "State@%04x", classKey );
+    return buffer;
+}
+
+
+
+
+std::string eventName( int code )
+{
+    switch ( code )
+    {
+        case EventManager::kNullEvent:                  return "NullEvent";
+        case EventManager::kQuarterSecondTimerEvent:    return "QuarterSecondTimerEvent";
+        case EventManager::kOneSecondTimerEvent:        return "OneSecondTimerEvent";
+        case EventManager::kEightSecondTimerEvent:      return "EightSecondTimerEvent";
+        case EventManager::kNavUpdateEvent:             return "NavUpdateEvent";
+        case EventManager::kNavDriftCorrectionEvent:    return "NavDriftCorrectionEvent";
+        case EventManager::kNavSampleReadyEvent:        return "NavSampleReadyEvent";
+        case EventManager::kErrorEvent:                 return "ErrorEvent";
+        case EventManager::kKeypadButtonHitEvent:       return "KeypadButtonHitEvent";
+        case EventManager::kCoroutineResumeEvent:       return "CoroutineResumeEvent";
+        default:                                        return "UserEvent" + std::to_string( code );
+    }
+}
+
+
+
+
+std::string errorName( int code )
+{
+    switch ( code )
+    {
+        case kEventQueueOverflowError:      return "101 EventQueueOverflow";
+        case kNullStateError:               return "102 NullState";
+        case kBadHeadingError:              return "103 BadHeading";
+        case kNoReturnStateError:           return "104 NoReturnState";
+        case kUnconstrainedDriveError:      return "105 UnconstrainedDrive";
+        case kBadlyConstrainedDriveError:   return "106 BadlyConstrainedDrive";
+        case kNoTimerAvailableError:        return "107 NoTimerAvailable";
+        case kMotorBatteryLowError:         return "201 MotorBatteryLow";
+        case kCpuBatteryLowError:           return "202 CpuBatteryLow";
+        case kOutOfMemoryError:             return "301 OutOfMemory";
+        case kNullStateToChangeState:       return "402 NullStateToChangeState";
+        case kUnableToFindGlobalPath:       return "601 UnableToFindGlobalPath";
+        case kUnableToFindLocalPath:        return "602 UnableToFindLocalPath";
+        case kUnexpectedObstacle:           return "603 UnexpectedObstacle";
+        default:                            return std::to_string( code );
+    }
+}
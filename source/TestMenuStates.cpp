@@ -54,6 +54,7 @@ namespace
     const PROGMEM char sTestMenuItem11[] = "Lidar";
     const PROGMEM char sTestMenuItem12[] = "Range Scan";
     const PROGMEM char sTestMenuItem13[] = "Compass";
+    const PROGMEM char sTestMenuItem24[] = "Compass Calib.";
     const PROGMEM char sTestMenuItem14[] = "Accelerometer";
     const PROGMEM char sTestMenuItem15[] = "Gyroscope";
     const PROGMEM char sTestMenuItem16[] = "Drive Fwd/Rev";
@@ -61,6 +62,13 @@ namespace
     const PROGMEM char sTestMenuItem18[] = "Nav. Rotation";
     const PROGMEM char sTestMenuItem19[] = "Nav. Drive";
     const PROGMEM char sTestMenuItem20[] = "Error Handling";
+    const PROGMEM char sTestMenuItem21[] = "Event Loop Stats";
+#if CARRT_ENABLE_EVENT_PROFILING
+    const PROGMEM char sTestMenuItem22[] = "Event Profile";
+#endif
+#if CARRT_ENABLE_TRACE_RECORDER
+    const PROGMEM char sTestMenuItem23[] = "Trace Recorder";
+#endif
 
 
     const PROGMEM MenuList sTestMenu[] =
@@ -78,6 +86,7 @@ namespace
         { sTestMenuItem11,  11 },
         { sTestMenuItem12,  12 },
         { sTestMenuItem13,  13 },
+        { sTestMenuItem24,  24 },
         { sTestMenuItem14,  14 },
         { sTestMenuItem15,  15 },
         { sTestMenuItem16,  16 },
@@ -85,6 +94,13 @@ namespace
         { sTestMenuItem18,  18 },
         { sTestMenuItem19,  19 },
         { sTestMenuItem20,  20 },
+        { sTestMenuItem21,  21 },
+#if CARRT_ENABLE_EVENT_PROFILING
+        { sTestMenuItem22,  22 },
+#endif
+#if CARRT_ENABLE_TRACE_RECORDER
+        { sTestMenuItem23,  23 },
+#endif
 
         { sTestMenuItem00,  0 }
     };
@@ -136,6 +152,9 @@ namespace
             case 13:
                 return new CompassTestState;
 
+            case 24:
+                return new CompassCalibrationState;
+
             case 14:
                 return new AccelerometerTestState;
 
@@ -157,6 +176,19 @@ namespace
             case 20:
                 return new ErrorTestState;
 
+            case 21:
+                return new LoopStatsTestState;
+
+#if CARRT_ENABLE_EVENT_PROFILING
+            case 22:
+                return new EventProfileTestState;
+#endif
+
+#if CARRT_ENABLE_TRACE_RECORDER
+            case 23:
+                return new TraceRecorderTestState;
+#endif
+
             default:
                 return 0;
         }
@@ -174,6 +206,17 @@ MenuState( sTestMenuTitle, sTestMenu, sizeof( sTestMenu ) / sizeof( MenuItem ),
 }
 
 
+
+
+//****************************************************************************
+
+// States come from the state arena (see State.h)
+
+CARRT_CHECK_STATE_SIZE( TestMenuState );
+
+
+
+
 #endif  // CARRT_INCLUDE_TESTS_IN_BUILD
 
 
@@ -33,6 +33,7 @@
 #include "CarrtPins.h"
 #include "ErrorCodes.h"
 #include "EventManager.h"
+#include "MagCalibrator.h"
 #include "MainProcess.h"
 #include "Navigator.h"
 #include "TestMenuStates.h"
@@ -51,6 +52,14 @@
 
 #include "Utils/DebuggingMacros.h"
 
+#if CARRT_ENABLE_EVENT_PROFILING
+#include "EventProfiler.h"
+#endif
+
+#if CARRT_ENABLE_TRACE_RECORDER
+#include "TraceRecorder.h"
+#endif
+
 
 
 /******************************************/
@@ -71,9 +80,12 @@ bool Event1_4TestState::onEvent( uint8_t event, int16_t param )
 {
     if ( event == EventManager::kQuarterSecondTimerEvent )
     {
+        // Count any ticks that were coalesced away too
+        mCount += 1 + EventManager::getMissedTicks( param );
+
         Display::clearBottomRow();
         Display::setCursor( 1, 0 );
-        Display::print( ++mCount );
+        Display::print( mCount );
     }
     else if ( event == EventManager::kKeypadButtonHitEvent )
     {
@@ -105,9 +117,12 @@ bool Event1TestState::onEvent( uint8_t event, int16_t param )
 {
     if ( event == EventManager::kOneSecondTimerEvent )
     {
+        // Count any ticks that were coalesced away too
+        mCount += 1 + EventManager::getMissedTicks( param );
+
         Display::clearBottomRow();
         Display::setCursor( 1, 0 );
-        Display::print( ++mCount );
+        Display::print( mCount );
     }
     else if ( event == EventManager::kKeypadButtonHitEvent )
     {
@@ -140,9 +155,12 @@ bool Event8TestState::onEvent( uint8_t event, int16_t param )
 {
     if ( event == EventManager::kEightSecondTimerEvent )
     {
+        // Count any ticks that were coalesced away too
+        mCount += 1 + EventManager::getMissedTicks( param );
+
         Display::clearBottomRow();
         Display::setCursor( 1, 0 );
-        Display::print( ++mCount );
+        Display::print( mCount );
     }
     else if ( event == EventManager::kKeypadButtonHitEvent )
     {
@@ -979,6 +997,108 @@ void CompassTestState::getAndDisplayCompassHeading()
 
 
 
+/**************************************************************/
+
+
+namespace
+{
+    // Give up if a full turn takes longer than this
+    const uint8_t kMaxCalibrationQuarterSeconds     = 160;
+
+    //                                             1234567890123456
+    const PROGMEM char sLabelCompassCal[]       = "Compass Calib.";
+    const PROGMEM char sLabelCalStandClear[]    = "Stand clear";
+    const PROGMEM char sLabelCalReadings[]      = "Readings ";
+    const PROGMEM char sLabelCalSaved[]         = "Saved";
+    const PROGMEM char sLabelCalFitFailed[]     = "Fit failed";
+    const PROGMEM char sLabelCalNotAround[]     = "Didn't turn 360";
+};
+
+
+void CompassCalibrationState::onEntry()
+{
+    Display::clear();
+    Display::displayTopRowP16( sLabelCompassCal );
+    Display::displayBottomRowP16( sLabelCalStandClear );
+
+    CarrtCallback::yieldMilliseconds( 3000 );
+
+    mDone = false;
+    mElapsedQuarterSeconds = 0;
+
+    // Readings are taken as CARRT turns in place
+    MagCalibrator::start();
+    Motors::rotateLeft();
+}
+
+
+void CompassCalibrationState::onExit()
+{
+    Motors::stop();
+
+    delete this;
+}
+
+
+bool CompassCalibrationState::onEvent( uint8_t event, int16_t param )
+{
+    if ( event == EventManager::kQuarterSecondTimerEvent && !mDone )
+    {
+        MagCalibrator::addReading( LSM303DLHC::getMagnetometerRaw() );
+        ++mElapsedQuarterSeconds;
+
+        Display::displayBottomRowP16( sLabelCalReadings );
+        Display::setCursor( 1, 9 );
+        Display::print( MagCalibrator::nbrReadings() );
+
+        if ( MagCalibrator::isComplete() )
+        {
+            finishCalibration();
+        }
+        else if ( mElapsedQuarterSeconds >= kMaxCalibrationQuarterSeconds )
+        {
+            Motors::stop();
+            mDone = true;
+            Beep::errorChime();
+            Display::displayBottomRowP16( sLabelCalNotAround );
+        }
+    }
+    else if ( event == EventManager::kKeypadButtonHitEvent )
+    {
+        MainProcess::changeState( new TestMenuState );
+    }
+
+    return true;
+}
+
+
+void CompassCalibrationState::finishCalibration()
+{
+    Motors::stop();
+    mDone = true;
+
+    LSM303DLHC::MagCalibration calibration;
+    if ( MagCalibrator::fit( &calibration ) )
+    {
+        // From now on, and after restarts
+        MagCalibrator::saveCalibration( calibration );
+        Beep::chirp();
+        Display::displayBottomRowP16( sLabelCalSaved );
+    }
+    else
+    {
+        Beep::errorChime();
+        Display::displayBottomRowP16( sLabelCalFitFailed );
+    }
+}
+
+
+
+
+
+
+
+
 /**************************************************************/
 
 
@@ -1676,5 +1796,350 @@ bool ErrorTestState::onEvent( uint8_t event, int16_t param )
 
 
 
+/******************************************/
+
+
+void LoopStatsTestState::onEntry()
+{
+    Display::clear();
+    Display::displayTopRowP16( PSTR( "Event Loop Stats" ) );
+
+    mShowNavDeadlines = false;
+
+    MainProcess::resetLoopStats();
+}
+
+
+bool LoopStatsTestState::onEvent( uint8_t event, int16_t param )
+{
+    if ( event == EventManager::kOneSecondTimerEvent )
+    {
+        // Counts are per second (reset each time)
+        if ( mShowNavDeadlines )
+        {
+            displayNavDeadlines();
+        }
+        else
+        {
+            displayLoopStats();
+        }
+
+        MainProcess::resetLoopStats();
+    }
+    else if ( event == EventManager::kKeypadButtonHitEvent )
+    {
+        if ( param & ( Keypad::kButton_Left | Keypad::kButton_Right ) )
+        {
+            // Switch between the loop and nav deadline counts
+            mShowNavDeadlines = !mShowNavDeadlines;
+        }
+        else
+        {
+            MainProcess::changeState( new TestMenuState );
+        }
+    }
+
+    return true;
+}
+
+
+void LoopStatsTestState::displayLoopStats()
+{
+    const MainProcess::LoopStats& stats = MainProcess::getLoopStats();
+
+    // 0123456789012345
+    // Lp xxxxx Slp xx%
+    // Ev xxx Oth xxxxx
+
+    Display::clear();
+    Display::setCursor( 0, 0 );
+    Display::printP16( PSTR( "Lp" ) );
+    Display::setCursor( 0, 3 );
+    Display::print( stats.loopIterations );
+    Display::setCursor( 0, 9 );
+    Display::printP16( PSTR( "Slp" ) );
+    Display::setCursor( 0, 13 );
+    Display::print( stats.sleepMicroseconds / 10000 );
+    Display::print( '%' );
+
+    Display::setCursor( 1, 0 );
+    Display::printP16( PSTR( "Ev" ) );
+    Display::setCursor( 1, 3 );
+    Display::print( stats.wakesForEvent );
+    Display::setCursor( 1, 7 );
+    Display::printP16( PSTR( "Oth" ) );
+    Display::setCursor( 1, 11 );
+    Display::print( stats.wakesOther + stats.wakesForKeypadPoll );
+}
+
+
+void LoopStatsTestState::displayNavDeadlines()
+{
+    const MainProcess::LoopStats& stats = MainProcess::getLoopStats();
+
+    // 0123456789012345
+    // Nav xx  Miss xxx
+    // Late max xxxxxms
+
+    Display::clear();
+    Display::setCursor( 0, 0 );
+    Display::printP16( PSTR( "Nav" ) );
+    Display::setCursor( 0, 4 );
+    Display::print( stats.navUpdates );
+    Display::setCursor( 0, 8 );
+    Display::printP16( PSTR( "Miss" ) );
+    Display::setCursor( 0, 13 );
+    Display::print( stats.navDeadlinesMissed );
+
+    Display::setCursor( 1, 0 );
+    Display::printP16( PSTR( "Late max" ) );
+    Display::setCursor( 1, 9 );
+    Display::print( stats.maxNavLatenessMs );
+    Display::printP16( PSTR( "ms" ) );
+}
+
+
+
+/******************************************/
+
+#if CARRT_ENABLE_EVENT_PROFILING
+
+namespace
+{
+    // 90th percentile labels, one per profiler bucket
+    const PROGMEM char sBucket0[] = "<64u";
+    const PROGMEM char sBucket1[] = "<256u";
+    const PROGMEM char sBucket2[] = "<1m";
+    const PROGMEM char sBucket3[] = "<4m";
+    const PROGMEM char sBucket4[] = "<16m";
+    const PROGMEM char sBucket5[] = "<65m";
+    const PROGMEM char sBucket6[] = "<262m";
+    const PROGMEM char sBucket7[] = ">262m";
+
+    PGM_P const PROGMEM sBucketLabels[ EventProfiler::kNbrBuckets ] =
+    {
+        sBucket0, sBucket1, sBucket2, sBucket3, sBucket4, sBucket5, sBucket6, sBucket7
+    };
+
+    void displayPercentile( const EventProfiler::Histogram& h )
+    {
+        uint8_t bucket = EventProfiler::getPercentileBucket( h, 90 );
+        Display::printP16( reinterpret_cast<PGM_P>( pgm_read_word( &sBucketLabels[ bucket ] ) ) );
+    }
+};
+
+
+void EventProfileTestState::onEntry()
+{
+    mRow = 0;
+
+    Display::clear();
+    Display::displayTopRowP16( PSTR( "Event Profile" ) );
+}
+
+
+bool EventProfileTestState::onEvent( uint8_t event, int16_t param )
+{
+    // Rows are the event codes (the last covers all user events), then the states seen
+    uint8_t nbrRows = EventProfiler::kNbrEventRows + EventProfiler::getNbrStates();
+
+    if ( event == EventManager::kOneSecondTimerEvent )
+    {
+        displayRow();
+    }
+    else if ( event == EventManager::kKeypadButtonHitEvent )
+    {
+        if ( param & Keypad::kButton_Select )
+        {
+            MainProcess::changeState( new TestMenuState );
+        }
+        else if ( param & Keypad::kButton_Up )
+        {
+            mRow = mRow ? mRow - 1 : nbrRows - 1;
+            displayRow();
+        }
+        else if ( param & Keypad::kButton_Down )
+        {
+            mRow = ( mRow + 1 < nbrRows ) ? mRow + 1 : 0;
+            displayRow();
+        }
+        else if ( param & Keypad::kButton_Left )
+        {
+            EventProfiler::dump();
+        }
+        else if ( param & Keypad::kButton_Right )
+        {
+            EventProfiler::reset();
+            mRow = 0;
+            displayRow();
+        }
+    }
+
+    return true;
+}
+
+
+void EventProfileTestState::displayRow()
+{
+    // 0123456789012345
+    // Ev xx    N xxxxx
+    // L <256u  H <16m
+    //
+    // Stx 0xxxxx Nxxxx
+    //          H <16m
+
+    Display::clear();
+
+    if ( mRow < EventProfiler::kNbrEventRows )
+    {
+        const EventProfiler::Histogram& latency = EventProfiler::getLatencyHistogram( mRow );
+        const EventProfiler::Histogram& dispatch = EventProfiler::getDispatchHistogram( mRow );
+
+        Display::setCursor( 0, 0 );
+        Display::printP16( PSTR( "Ev" ) );
+        Display::setCursor( 0, 3 );
+        if ( mRow < EventManager::kFirstUserEvent )
+        {
+            Display::print( mRow );
+        }
+        else
+        {
+            Display::printP16( PSTR( "usr" ) );
+        }
+        Display::setCursor( 0, 9 );
+        Display::print( 'N' );
+        Display::setCursor( 0, 11 );
+        Display::print( EventProfiler::getNbrSamples( dispatch ) );
+
+        Display::setCursor( 1, 0 );
+        Display::print( 'L' );
+        Display::setCursor( 1, 2 );
+        displayPercentile( latency );
+        Display::setCursor( 1, 9 );
+        Display::print( 'H' );
+        Display::setCursor( 1, 11 );
+        displayPercentile( dispatch );
+    }
+    else
+    {
+        uint8_t i = mRow - EventProfiler::kNbrEventRows;
+        const EventProfiler::Histogram& handler = EventProfiler::getStateHistogram( i );
+
+        // The key is the state's vtable address; find the class in the symbol table
+        Display::setCursor( 0, 0 );
+        Display::printP16( PSTR( "St" ) );
+        Display::setCursor( 0, 2 );
+        Display::print( i );
+        Display::setCursor( 0, 4 );
+        Display::print( EventProfiler::getTrackedStateKey( i ), Display::kHex );
+        Display::setCursor( 0, 11 );
+        Display::print( 'N' );
+        Display::setCursor( 0, 12 );
+        Display::print( EventProfiler::getNbrSamples( handler ) );
+
+        Display::setCursor( 1, 9 );
+        Display::print( 'H' );
+        Display::setCursor( 1, 11 );
+        displayPercentile( handler );
+    }
+}
+
+#endif  // CARRT_ENABLE_EVENT_PROFILING
+
+
+
+/******************************************/
+
+#if CARRT_ENABLE_TRACE_RECORDER
+
+void TraceRecorderTestState::onEntry()
+{
+    Display::clear();
+    Display::displayTopRowP16( PSTR( "Trace Recorder" ) );
+    displayCount();
+}
+
+
+bool TraceRecorderTestState::onEvent( uint8_t event, int16_t param )
+{
+    if ( event == EventManager::kKeypadButtonHitEvent )
+    {
+        if ( param & Keypad::kButton_Select )
+        {
+            MainProcess::changeState( new TestMenuState );
+        }
+        else if ( param & Keypad::kButton_Left )
+        {
+            Display::displayBottomRowP16( PSTR( "Dumping..." ) );
+            TraceRecorder::dumpToSerial();
+            displayCount();
+        }
+        else if ( param & Keypad::kButton_Right )
+        {
+            TraceRecorder::init();
+            displayCount();
+        }
+    }
+
+    return true;
+}
+
+
+void TraceRecorderTestState::displayCount()
+{
+    // 0123456789012345
+    // Rec xxx  Sts xx
+
+    Display::clearBottomRow();
+    Display::setCursor( 1, 0 );
+    Display::printP16( PSTR( "Rec" ) );
+    Display::setCursor( 1, 4 );
+    Display::print( TraceRecorder::getNbrRecords() );
+    Display::setCursor( 1, 9 );
+    Display::printP16( PSTR( "Sts" ) );
+    Display::setCursor( 1, 13 );
+    Display::print( TraceRecorder::getNbrStateIds() );
+}
+
+#endif  // CARRT_ENABLE_TRACE_RECORDER
+
+
+
+
+//****************************************************************************
+
+// States come from the state arena (see State.h)
+
+CARRT_CHECK_STATE_SIZE( Event1_4TestState );
+CARRT_CHECK_STATE_SIZE( Event1TestState );
+CARRT_CHECK_STATE_SIZE( Event8TestState );
+CARRT_CHECK_STATE_SIZE( BeepTestState );
+CARRT_CHECK_STATE_SIZE( TempSensorTestState );
+CARRT_CHECK_STATE_SIZE( BatteryLedTestState );
+CARRT_CHECK_STATE_SIZE( MotorBatteryVoltageTestState );
+CARRT_CHECK_STATE_SIZE( CpuBatteryVoltageTestState );
+CARRT_CHECK_STATE_SIZE( AvailableMemoryTestState );
+CARRT_CHECK_STATE_SIZE( SonarTestState );
+CARRT_CHECK_STATE_SIZE( LidarTestState );
+CARRT_CHECK_STATE_SIZE( RangeScanTestState );
+CARRT_CHECK_STATE_SIZE( CompassTestState );
+CARRT_CHECK_STATE_SIZE( CompassCalibrationState );
+CARRT_CHECK_STATE_SIZE( AccelerometerTestState );
+CARRT_CHECK_STATE_SIZE( GyroscopeTestState );
+CARRT_CHECK_STATE_SIZE( MotorFwdRevTestState );
+CARRT_CHECK_STATE_SIZE( MotorLeftRightTestState );
+CARRT_CHECK_STATE_SIZE( NavigatorRotateTestState );
+CARRT_CHECK_STATE_SIZE( NavigatorDriveTestState );
+CARRT_CHECK_STATE_SIZE( ErrorTestState );
+CARRT_CHECK_STATE_SIZE( LoopStatsTestState );
+#if CARRT_ENABLE_TRACE_RECORDER
+CARRT_CHECK_STATE_SIZE( TraceRecorderTestState );
+#endif
+#if CARRT_ENABLE_EVENT_PROFILING
+CARRT_CHECK_STATE_SIZE( EventProfileTestState );
+#endif
+
+
+
 
 #endif  // CARRT_INCLUDE_TESTS_IN_BUILD
@@ -258,6 +258,26 @@ private:
 
 
 
+// cppcheck-suppress noConstructor
+class CompassCalibrationState : public State
+{
+public:
+
+    virtual void onEntry();
+    virtual void onExit();
+    virtual bool onEvent( uint8_t event, int16_t param );
+
+private:
+
+    void finishCalibration();
+
+    bool    mDone;
+    uint8_t mElapsedQuarterSeconds;
+};
+
+
+
+
 // cppcheck-suppress noConstructor
 class AccelerometerTestState : public State
 {
@@ -442,6 +462,62 @@ private:
 
 
 
+// cppcheck-suppress noConstructor
+class LoopStatsTestState : public State
+{
+public:
+
+    virtual void onEntry();
+    virtual bool onEvent( uint8_t event, int16_t param );
+
+private:
+
+    void displayLoopStats();
+    void displayNavDeadlines();
+
+    bool mShowNavDeadlines;
+};
+
+
+
+#if CARRT_ENABLE_TRACE_RECORDER
+
+class TraceRecorderTestState : public State
+{
+public:
+
+    virtual void onEntry();
+    virtual bool onEvent( uint8_t event, int16_t param );
+
+private:
+
+    void displayCount();
+};
+
+#endif
+
+
+
+#if CARRT_ENABLE_EVENT_PROFILING
+
+class EventProfileTestState : public State
+{
+public:
+
+    virtual void onEntry();
+    virtual bool onEvent( uint8_t event, int16_t param );
+
+private:
+
+    void displayRow();
+
+    uint8_t mRow;
+};
+
+#endif
+
+
+
 
 
 #endif
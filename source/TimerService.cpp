@@ -0,0 +1,387 @@
+/*
+    TimerService.cpp - Software timers for CARRT, kept in a hierarchical
+    timing wheel.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+
+#include "TimerService.h"
+
+
+
+#if kCarrtTimerServiceMaxTimers >= 255
+#error "kCarrtTimerServiceMaxTimers must be less than 255"
+#endif
+
+
+
+/*
+
+    A timer expiring at time E is kept in the level given by the highest
+    4-bit digit in which E and the current time differ, in the slot given
+    by E's digit at that level.  So level 0 holds timers due within the
+    current 16 ms block, level 1 those due within the current 256 ms block,
+    and so on.  Anything due beyond the current 65536 ms block goes in the
+    overflow list.
+
+    Each time the clock reaches the start of a block at some level, the
+    matching slot of that level is emptied and its timers relinked, which
+    drops them to a finer level.  When a level 0 slot comes up, its timers
+    are due.
+
+    Each bucket (slot or overflow list) is a doubly linked list of timers
+    threaded through the timer pool by index, so linking and unlinking
+    a timer are O(1).
+
+*/
+
+
+
+namespace TimerService
+{
+
+    enum
+    {
+        kBitsPerLevel       = 4,
+        kSlotsPerLevel      = 1 << kBitsPerLevel,
+        kSlotMask           = kSlotsPerLevel - 1,
+        kNbrLevels          = 4,
+        kOverflowBucket     = kNbrLevels * kSlotsPerLevel,
+        kNbrBuckets         = kOverflowBucket + 1,
+        kNoBucket           = 0xFF,
+        kNoLink             = kNoTimer
+    };
+
+
+    struct Timer
+    {
+        uint32_t    expiry;
+        uint16_t    period;         // 0 for a one-shot timer
+        int16_t     param;
+        uint8_t     code;
+        uint8_t     pri;
+        uint8_t     bucket;         // kNoBucket if not running
+        uint8_t     next;
+        uint8_t     prev;
+    };
+
+
+    Timer       sTimers[ kCarrtTimerServiceMaxTimers ];
+    uint8_t     sBuckets[ kNbrBuckets ];
+    uint8_t     sFreeTimers;
+    uint8_t     sNbrRunning;
+
+    uint32_t    sNow;
+    uint32_t    sTarget;
+
+
+    uint8_t startTimer( uint16_t delayMs, uint16_t periodMs, uint8_t eventCode, int16_t eventParam,
+                        EventManager::EventPriority pri );
+    uint8_t getBucket( uint32_t expiry );
+    void link( uint8_t id );
+    void unlink( uint8_t id );
+    void cascade( uint8_t bucket );
+    void expire( uint8_t bucket );
+    void releaseTimer( uint8_t id );
+    void doTick();
+
+};
+
+
+
+
+void TimerService::init( uint32_t nowMs )
+{
+    for ( uint8_t b = 0; b < kNbrBuckets; ++b )
+    {
+        sBuckets[b] = kNoLink;
+    }
+
+    // Chain all the timers into the free list
+    for ( uint8_t i = 0; i < kCarrtTimerServiceMaxTimers; ++i )
+    {
+        sTimers[i].bucket = kNoBucket;
+        sTimers[i].next = ( i + 1 < kCarrtTimerServiceMaxTimers ) ? i + 1 : kNoLink;
+    }
+    sFreeTimers = 0;
+    sNbrRunning = 0;
+
+    sNow = nowMs;
+    sTarget = nowMs;
+}
+
+
+
+void TimerService::advanceTo( uint32_t nowMs )
+{
+    if ( static_cast<int32_t>( nowMs - sNow ) <= 0 )
+    {
+        return;
+    }
+
+    sTarget = nowMs;
+
+    if ( !sNbrRunning )
+    {
+        // Nothing to cascade or expire, so just jump ahead
+        sNow = nowMs;
+        return;
+    }
+
+    while ( sNow != sTarget )
+    {
+        ++sNow;
+        doTick();
+    }
+}
+
+
+
+uint32_t TimerService::now()
+{
+    return sNow;
+}
+
+
+
+uint8_t TimerService::startOneShot( uint16_t delayMs, uint8_t eventCode, int16_t eventParam,
+                                    EventManager::EventPriority pri )
+{
+    return startTimer( delayMs, 0, eventCode, eventParam, pri );
+}
+
+
+
+uint8_t TimerService::startPeriodic( uint16_t periodMs, uint8_t eventCode, int16_t eventParam,
+                                     EventManager::EventPriority pri )
+{
+    if ( !periodMs )
+    {
+        periodMs = 1;
+    }
+
+    return startTimer( periodMs, periodMs, eventCode, eventParam, pri );
+}
+
+
+
+bool TimerService::cancel( uint8_t timerId )
+{
+    if ( !isRunning( timerId ) )
+    {
+        return false;
+    }
+
+    unlink( timerId );
+    releaseTimer( timerId );
+
+    return true;
+}
+
+
+
+bool TimerService::isRunning( uint8_t timerId )
+{
+    return timerId < kCarrtTimerServiceMaxTimers && sTimers[ timerId ].bucket != kNoBucket;
+}
+
+
+
+uint8_t TimerService::getNbrRunningTimers()
+{
+    return sNbrRunning;
+}
+
+
+
+
+/******************************************************************************/
+
+
+
+
+uint8_t TimerService::startTimer( uint16_t delayMs, uint16_t periodMs, uint8_t eventCode, int16_t eventParam,
+                                  EventManager::EventPriority pri )
+{
+    if ( sFreeTimers == kNoLink )
+    {
+        return kNoTimer;
+    }
+
+    uint8_t id = sFreeTimers;
+    sFreeTimers = sTimers[ id ].next;
+    ++sNbrRunning;
+
+    Timer* t = &sTimers[ id ];
+    t->expiry   = sNow + ( delayMs ? delayMs : 1 );
+    t->period   = periodMs;
+    t->param    = eventParam;
+    t->code     = eventCode;
+    t->pri      = pri;
+
+    link( id );
+
+    return id;
+}
+
+
+
+uint8_t TimerService::getBucket( uint32_t expiry )
+{
+    uint32_t diff = expiry ^ sNow;
+
+    for ( uint8_t level = 0; level < kNbrLevels; ++level )
+    {
+        if ( diff < ( static_cast<uint32_t>( kSlotsPerLevel ) << ( level * kBitsPerLevel ) ) )
+        {
+            return level * kSlotsPerLevel + ( ( expiry >> ( level * kBitsPerLevel ) ) & kSlotMask );
+        }
+    }
+
+    return kOverflowBucket;
+}
+
+
+
+void TimerService::link( uint8_t id )
+{
+    Timer* t = &sTimers[ id ];
+    uint8_t b = getBucket( t->expiry );
+
+    t->bucket = b;
+    t->prev = kNoLink;
+    t->next = sBuckets[ b ];
+    if ( t->next != kNoLink )
+    {
+        sTimers[ t->next ].prev = id;
+    }
+    sBuckets[ b ] = id;
+}
+
+
+
+void TimerService::unlink( uint8_t id )
+{
+    Timer* t = &sTimers[ id ];
+
+    if ( t->prev != kNoLink )
+    {
+        sTimers[ t->prev ].next = t->next;
+    }
+    else
+    {
+        sBuckets[ t->bucket ] = t->next;
+    }
+
+    if ( t->next != kNoLink )
+    {
+        sTimers[ t->next ].prev = t->prev;
+    }
+}
+
+
+
+void TimerService::releaseTimer( uint8_t id )
+{
+    sTimers[ id ].bucket = kNoBucket;
+    sTimers[ id ].next = sFreeTimers;
+    sFreeTimers = id;
+    --sNbrRunning;
+}
+
+
+
+void TimerService::cascade( uint8_t bucket )
+{
+    // Detach the whole list first; relinking can't put a timer back in this bucket
+    uint8_t id = sBuckets[ bucket ];
+    sBuckets[ bucket ] = kNoLink;
+
+    while ( id != kNoLink )
+    {
+        uint8_t next = sTimers[ id ].next;
+        link( id );
+        id = next;
+    }
+}
+
+
+
+void TimerService::expire( uint8_t bucket )
+{
+    uint8_t id = sBuckets[ bucket ];
+    sBuckets[ bucket ] = kNoLink;
+
+    while ( id != kNoLink )
+    {
+        Timer* t = &sTimers[ id ];
+        uint8_t next = t->next;
+
+        EventManager::queueEvent( t->code, t->param, static_cast<EventManager::EventPriority>( t->pri ) );
+
+        if ( t->period )
+        {
+            // Skip any expiries that fall within the rest of this advance (the
+            // main loop stalled), so a stall produces just one event
+            uint32_t expiry = t->expiry + t->period;
+            if ( static_cast<int32_t>( sTarget - expiry ) >= 0 )
+            {
+                expiry += ( ( sTarget - expiry ) / t->period + 1 ) * t->period;
+            }
+            t->expiry = expiry;
+            link( id );
+        }
+        else
+        {
+            releaseTimer( id );
+        }
+
+        id = next;
+    }
+}
+
+
+
+void TimerService::doTick()
+{
+    // Cascade coarsest first, so timers can drop through several levels in one tick
+
+    if ( ( sNow & 0xFFFF ) == 0 )
+    {
+        cascade( kOverflowBucket );
+    }
+
+    if ( ( sNow & 0x0FFF ) == 0 )
+    {
+        cascade( 3 * kSlotsPerLevel + ( ( sNow >> 12 ) & kSlotMask ) );
+    }
+
+    if ( ( sNow & 0x00FF ) == 0 )
+    {
+        cascade( 2 * kSlotsPerLevel + ( ( sNow >> 8 ) & kSlotMask ) );
+    }
+
+    if ( ( sNow & 0x000F ) == 0 )
+    {
+        cascade( kSlotsPerLevel + ( ( sNow >> 4 ) & kSlotMask ) );
+    }
+
+    expire( sNow & kSlotMask );
+}
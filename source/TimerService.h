@@ -0,0 +1,96 @@
+/*
+    TimerService.h - Software timers for CARRT.  States schedule their
+    own one-shot or periodic deadlines (at millisecond resolution) and
+    receive an event of their choosing when each expires.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef TimerService_h
+#define TimerService_h
+
+#include <stdint.h>
+
+#include "EventManager.h"
+
+
+
+// Maximum number of timers that can run at once (each takes 13 bytes of SRAM)
+
+#ifndef kCarrtTimerServiceMaxTimers
+#define kCarrtTimerServiceMaxTimers         8
+#endif
+
+
+
+/*
+ * Timers live in a hierarchical timing wheel:  four levels of 16 slots, each
+ * level 16 times coarser than the one below (1 ms, 16 ms, 256 ms, 4096 ms),
+ * plus an overflow list.  Starting and canceling a timer are O(1); timers are
+ * moved to finer levels as their expiry approaches.
+ *
+ * The service keeps no clock of its own.  The main loop feeds it the current
+ * time via advanceTo() (on CARRT, EventClock::getMilliseconds()), so it can be
+ * driven by a virtual clock for testing.  Expiries post events via
+ * EventManager::queueEvent(), so they are handled like any other event.
+ */
+
+namespace TimerService
+{
+
+    enum
+    {
+        kNoTimer = 0xFF
+    };
+
+
+    // Discard all timers and set the current time
+    void init( uint32_t nowMs );
+
+    // Bring the service up to the given time, posting events for all timers
+    // that expire along the way.  Time that runs backward is ignored.
+    void advanceTo( uint32_t nowMs );
+
+    // The time the service was last advanced to
+    uint32_t now();
+
+    // Start a timer that expires once, delayMs (>= 1) after now().  Returns the
+    // timer's ID, or kNoTimer if all timers are in use.  The ID is only valid
+    // until the timer expires or is canceled.
+    uint8_t startOneShot( uint16_t delayMs, uint8_t eventCode, int16_t eventParam,
+                          EventManager::EventPriority pri = EventManager::kDefaultPriority );
+
+    // Start a timer that expires every periodMs (>= 1), starting periodMs after now().
+    // If the main loop stalls past several periods, the missed expiries are skipped
+    // (only one event is posted) and the timer stays on its original schedule.
+    uint8_t startPeriodic( uint16_t periodMs, uint8_t eventCode, int16_t eventParam,
+                           EventManager::EventPriority pri = EventManager::kDefaultPriority );
+
+    // Cancel a timer; returns false if it isn't running.  States should cancel
+    // their timers in onExit(), or the events will go to the next state.
+    bool cancel( uint8_t timerId );
+
+    bool isRunning( uint8_t timerId );
+
+    uint8_t getNbrRunningTimers();
+
+};
+
+
+#endif
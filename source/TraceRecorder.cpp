@@ -0,0 +1,191 @@
+/*
+    TraceRecorder.cpp - A compact binary trace of CARRT's recent events,
+    state changes, and errors, kept in an SRAM ring buffer.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#if CARRT_ENABLE_TRACE_RECORDER
+
+
+
+#include "TraceRecorder.h"
+
+#include "State.h"
+#include "TimerService.h"
+
+#if __AVR__
+#include "AVRTools/SystemClock.h"
+#include "AVRTools/USART0.h"
+#include "Utils/DebuggingMacros.h"
+#endif
+
+
+
+#if ( kCarrtTraceRecorderSize & ( kCarrtTraceRecorderSize - 1 ) ) || kCarrtTraceRecorderSize > 128
+#error "kCarrtTraceRecorderSize must be a power of 2 no larger than 128"
+#endif
+
+
+
+namespace TraceRecorder
+{
+    const uint8_t kRecordMask = kCarrtTraceRecorderSize - 1;
+
+    Record      sRecords[ kCarrtTraceRecorderSize ];
+
+    // Where the next record goes, and how many records are held
+    uint8_t     sNext;
+    uint8_t     sNbrRecords;
+
+    // State class keys, indexed by state ID - 1
+    uint16_t    sStateKeys[ kMaxStateIds ];
+    uint8_t     sNbrStateIds;
+
+    uint8_t     sCurrentStateId;
+
+    uint8_t getStateId( uint16_t classKey );
+};
+
+
+
+
+void TraceRecorder::init()
+{
+    sNext = 0;
+    sNbrRecords = 0;
+    sNbrStateIds = 0;
+    sCurrentStateId = 0;
+}
+
+
+
+void TraceRecorder::record( uint8_t code, int16_t param )
+{
+    Record* r = &sRecords[ sNext ];
+
+    r->time     = static_cast<uint16_t>( TimerService::now() );
+    r->code     = code;
+    r->stateId  = sCurrentStateId;
+    r->param    = param;
+
+    sNext = ( sNext + 1 ) & kRecordMask;
+    if ( sNbrRecords < kCarrtTraceRecorderSize )
+    {
+        ++sNbrRecords;
+    }
+}
+
+
+
+void TraceRecorder::recordStateChange( const State* newState )
+{
+    uint16_t classKey = getStateClassKey( newState );
+
+    sCurrentStateId = getStateId( classKey );
+
+    record( kTraceStateChange, static_cast<int16_t>( classKey ) );
+}
+
+
+
+uint8_t TraceRecorder::getNbrRecords()
+{
+    return sNbrRecords;
+}
+
+
+
+const TraceRecorder::Record& TraceRecorder::getRecord( uint8_t i )
+{
+    return sRecords[ ( sNext - sNbrRecords + i ) & kRecordMask ];
+}
+
+
+
+uint8_t TraceRecorder::getNbrStateIds()
+{
+    return sNbrStateIds;
+}
+
+
+
+uint16_t TraceRecorder::getStateClassKeyForId( uint8_t stateId )
+{
+    return ( stateId && stateId <= sNbrStateIds ) ? sStateKeys[ stateId - 1 ] : 0;
+}
+
+
+
+#if __AVR__
+
+void TraceRecorder::dumpToSerial()
+{
+#if CARRT_ENABLE_DEBUG_SERIAL
+
+    dump( gDebugSerial, TimerService::now() );
+
+#else
+
+    Serial0 out;
+    out.start( 115200 );
+
+    dump( out, TimerService::now() );
+
+    // Let the output drain before shutting the line down
+    delayMilliseconds( 500 );
+    out.stop();
+
+#endif
+}
+
+#endif
+
+
+
+
+/******************************************************************************/
+
+
+
+
+uint8_t TraceRecorder::getStateId( uint16_t classKey )
+{
+    for ( uint8_t i = 0; i < sNbrStateIds; ++i )
+    {
+        if ( sStateKeys[i] == classKey )
+        {
+            return i + 1;
+        }
+    }
+
+    if ( sNbrStateIds == kMaxStateIds )
+    {
+        // Table full; the class key is still in the state change record
+        return 0;
+    }
+
+    sStateKeys[ sNbrStateIds ] = classKey;
+    return ++sNbrStateIds;
+}
+
+
+
+
+#endif  // CARRT_ENABLE_TRACE_RECORDER
@@ -0,0 +1,188 @@
+/*
+    TraceRecorder.h - A compact binary trace of CARRT's recent events,
+    state changes, and errors, kept in an SRAM ring buffer.
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef TraceRecorder_h
+#define TraceRecorder_h
+
+
+#if CARRT_ENABLE_TRACE_RECORDER
+
+
+#include <stdint.h>
+
+
+class State;
+
+
+
+// Number of records kept (a power of 2, no more than 128); each takes 6 bytes of SRAM
+
+#ifndef kCarrtTraceRecorderSize
+#define kCarrtTraceRecorderSize         64
+#endif
+
+
+
+/*
+ * Each record holds the low 16 bits of TimerService::now() (milliseconds, as
+ * of the current pass through the event loop), a code, the ID of the state
+ * current at the time, and a parameter.  Codes below 0x80 are events queued by
+ * normal code; codes from 0x80 up are the trace records listed below.
+ *
+ * Recording is only a handful of stores, so the recorder can stay on in operational
+ * builds.  It is NOT interrupt safe:  record only from normal code.  (Periodic timer
+ * events queued by interrupt handlers are therefore not traced.)
+ *
+ * State IDs are small integers handed out as new state classes are seen (0 means
+ * none, or the table is full).  The dump lists each ID with its class key (see
+ * getStateClassKey()), so the decoder can name the states.
+ *
+ * Dump format (text, one item per line, decimal):
+ *
+ *      @T version nowMs nbrRecords nbrStates
+ *      @S id classKey                              (nbrStates lines)
+ *      time code stateId param                     (nbrRecords lines, oldest first)
+ *      @E
+ *
+ * Decode it with the TraceDecode tool (Test/TestOnLinux).
+ */
+
+namespace TraceRecorder
+{
+
+    enum
+    {
+        kFormatVersion          = 1,
+
+        kMaxStateIds            = 16,
+
+        kFirstTraceCode         = 0x80,
+
+        // param = the new state's class key
+        kTraceStateChange       = kFirstTraceCode,
+
+        // param = error code
+        kTraceError,
+
+        // param = error code; the last record before CARRT halts
+        kTraceUnrecoverableError,
+
+        // param = code of the event that didn't fit in the queue
+        kTraceQueueOverflow,
+
+        // param = 0; marks a (re)start of the main process
+        kTraceReset,
+
+        // param = number of EventClock ticks that passed with no nav update
+        kTraceNavDeadlineMiss
+    };
+
+
+    struct Record
+    {
+        uint16_t    time;
+        uint8_t     code;
+        uint8_t     stateId;
+        int16_t     param;
+    };
+
+
+    void init();
+
+    void record( uint8_t code, int16_t param );
+
+    // Record a change to a new state (which becomes the current state for later records)
+    void recordStateChange( const State* newState );
+
+    uint8_t getNbrRecords();
+
+    // Records numbered from the oldest (0) to the newest
+    const Record& getRecord( uint8_t i );
+
+    uint8_t getNbrStateIds();
+
+    // Class key of a state ID (1 to getNbrStateIds())
+    uint16_t getStateClassKeyForId( uint8_t stateId );
+
+
+    // Write the trace to any AVRTools Writer-like output (e.g., Serial0).  Only single
+    // characters and numbers are written, so the format costs no SRAM for strings.
+    template< typename W > void dump( W& out, uint32_t nowMs );
+
+    // Dump the trace on USART0 (the debug serial line); the host simulation supplies its own
+    void dumpToSerial();
+
+};
+
+
+
+
+template< typename W > void TraceRecorder::dump( W& out, uint32_t nowMs )
+{
+    out.print( '@' );
+    out.print( 'T' );
+    out.print( ' ' );
+    out.print( static_cast<long>( kFormatVersion ) );
+    out.print( ' ' );
+    out.print( static_cast<unsigned long>( nowMs ) );
+    out.print( ' ' );
+    out.print( static_cast<long>( getNbrRecords() ) );
+    out.print( ' ' );
+    out.print( static_cast<long>( getNbrStateIds() ) );
+    out.print( '\n' );
+
+    for ( uint8_t id = 1; id <= getNbrStateIds(); ++id )
+    {
+        out.print( '@' );
+        out.print( 'S' );
+        out.print( ' ' );
+        out.print( static_cast<long>( id ) );
+        out.print( ' ' );
+        out.print( static_cast<unsigned long>( getStateClassKeyForId( id ) ) );
+        out.print( '\n' );
+    }
+
+    for ( uint8_t i = 0; i < getNbrRecords(); ++i )
+    {
+        const Record& r = getRecord( i );
+
+        out.print( static_cast<unsigned long>( r.time ) );
+        out.print( ' ' );
+        out.print( static_cast<long>( r.code ) );
+        out.print( ' ' );
+        out.print( static_cast<long>( r.stateId ) );
+        out.print( ' ' );
+        out.print( static_cast<long>( r.param ) );
+        out.print( '\n' );
+    }
+
+    out.print( '@' );
+    out.print( 'E' );
+    out.print( '\n' );
+}
+
+
+#endif  // CARRT_ENABLE_TRACE_RECORDER
+
+
+#endif
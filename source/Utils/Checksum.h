@@ -0,0 +1,46 @@
+/*
+    Checksum.h - A simple checksum for data kept in EEPROM
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef Checksum_h
+#define Checksum_h
+
+#include <stdint.h>
+
+
+
+// Rotate and add each byte (the seed tells apart records of the same size)
+
+inline uint16_t computeChecksum( const void* data, uint8_t size, uint16_t seed )
+{
+    const uint8_t* p = static_cast<const uint8_t*>( data );
+
+    uint16_t sum = seed;
+    for ( uint8_t i = 0; i < size; ++i )
+    {
+        sum = ( sum << 1 | sum >> 15 ) + p[i];
+    }
+
+    return sum;
+}
+
+
+#endif
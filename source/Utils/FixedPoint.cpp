@@ -0,0 +1,119 @@
+/*
+    FixedPoint.cpp - Fixed-point arithmetic and integer trig for the Navigator
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "FixedPoint.h"
+
+#include <avr/pgmspace.h>
+
+
+
+// Extend the namespace with functions and variables used internally in this module
+
+namespace FixedPoint
+{
+
+    // sin( 0 ) to sin( 90 ) degrees, in Q1.15
+    const int16_t kSineTable[] PROGMEM =
+    {
+            0,   572,  1144,  1715,  2286,  2856,  3425,  3993,
+         4560,  5126,  5690,  6252,  6813,  7371,  7927,  8481,
+         9032,  9580, 10126, 10668, 11207, 11743, 12275, 12803,
+        13328, 13848, 14364, 14876, 15383, 15886, 16383, 16876,
+        17364, 17846, 18323, 18794, 19260, 19720, 20173, 20621,
+        21062, 21497, 21925, 22347, 22762, 23170, 23571, 23964,
+        24351, 24730, 25101, 25465, 25821, 26169, 26509, 26841,
+        27165, 27481, 27788, 28087, 28377, 28659, 28932, 29196,
+        29451, 29697, 29934, 30162, 30381, 30591, 30791, 30982,
+        31163, 31335, 31498, 31650, 31794, 31927, 32051, 32165,
+        32269, 32364, 32448, 32523, 32587, 32642, 32687, 32722,
+        32747, 32762, 32767
+    };
+
+    const uint16_t kQuarterCircle = kCentiDegreesPerCircle / 4;
+
+    int16_t sinFirstQuadrant( uint16_t angle );
+
+};
+
+
+
+
+uint16_t FixedPoint::convertDegreesToCentiDegrees( float degrees )
+{
+    int32_t angle = static_cast<int32_t>( degrees >= 0 ? degrees * 100 + 0.5 : degrees * 100 - 0.5 );
+
+    angle %= kCentiDegreesPerCircle;
+    if ( angle < 0 )
+    {
+        angle += kCentiDegreesPerCircle;
+    }
+
+    return angle;
+}
+
+
+
+int16_t FixedPoint::sinCentiDegrees( uint16_t angle )
+{
+    angle %= kCentiDegreesPerCircle;
+
+    switch ( angle / kQuarterCircle )
+    {
+        case 0:
+            return sinFirstQuadrant( angle );
+
+        case 1:
+            return sinFirstQuadrant( 2 * kQuarterCircle - angle );
+
+        case 2:
+            return -sinFirstQuadrant( angle - 2 * kQuarterCircle );
+
+        default:
+            return -sinFirstQuadrant( kCentiDegreesPerCircle - angle );
+    }
+}
+
+
+
+int16_t FixedPoint::cosCentiDegrees( uint16_t angle )
+{
+    return sinCentiDegrees( angle % kCentiDegreesPerCircle + kQuarterCircle );
+}
+
+
+
+
+int16_t FixedPoint::sinFirstQuadrant( uint16_t angle )
+{
+    // Interpolate between whole degrees
+    uint8_t degrees = angle / 100;
+    uint8_t fraction = angle % 100;
+
+    int16_t s = pgm_read_word( &kSineTable[ degrees ] );
+    if ( fraction )
+    {
+        int16_t next = pgm_read_word( &kSineTable[ degrees + 1 ] );
+        s += ( static_cast<int32_t>( next - s ) * fraction + 50 ) / 100;
+    }
+
+    return s;
+}
@@ -0,0 +1,82 @@
+/*
+    FixedPoint.h - Fixed-point arithmetic and integer trig for the Navigator
+
+    Copyright (c) 2026 Igor Mikolic-Torreira.  All right reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef FixedPoint_h
+#define FixedPoint_h
+
+#include <inttypes.h>
+
+
+
+/*
+ * Formats used:
+ *
+ *   Q16.16 (int32_t) for positions (m) and velocities (m/s)
+ *   Q1.15 (int16_t) for sines and cosines
+ *   Q4.12 (int16_t) for time steps (s)
+ *   centi-degrees (uint16_t, 0 to 35999) for headings
+ *
+ * The AVR multiplies 16 by 16 bits in hardware, so multiply() builds its
+ * product from two of those rather than a 64-bit multiply.
+ */
+
+namespace FixedPoint
+{
+
+    const int32_t   kQ16One             = 65536L;
+    const int16_t   kQ15One             = 32767;
+    const int16_t   kQ12One             = 4096;
+
+    const uint16_t  kCentiDegreesPerCircle  = 36000U;
+
+
+    // a (Q16.16) times b (with bFractionBits fraction bits), as Q16.16
+    inline int32_t multiply( int32_t a, int16_t b, uint8_t bFractionBits )
+    {
+        int16_t aHi = a >> 16;
+        uint16_t aLo = a & 0xFFFF;
+        return ( ( static_cast<int32_t>( aHi ) * b ) << ( 16 - bFractionBits ) )
+                + ( ( static_cast<int32_t>( aLo ) * b ) >> bFractionBits );
+    }
+
+
+    inline int32_t convertToQ16( float x )
+    { return static_cast<int32_t>( x >= 0 ? x * kQ16One + 0.5 : x * kQ16One - 0.5 ); }
+
+    inline float convertFromQ16( int32_t x )
+    { return x * ( 1.0 / kQ16One ); }
+
+    inline int16_t convertToQ12( float x )
+    { return static_cast<int16_t>( x * kQ12One + 0.5 ); }
+
+
+    // Heading in degrees (any) to centi-degrees (0 to 35999)
+    uint16_t convertDegreesToCentiDegrees( float degrees );
+
+    // Sine and cosine (Q1.15) of an angle in centi-degrees, from a table in 1 degree steps
+    int16_t sinCentiDegrees( uint16_t angle );
+    int16_t cosCentiDegrees( uint16_t angle );
+
+};
+
+
+#endif
@@ -386,6 +386,52 @@ inline float norm( const Vector2Float& a )
 
 
 
+// Fixed-point (Q16.16) 2D vectors, for integer-only navigation (see FixedPoint.h)
+
+struct Vector2Fixed
+{
+    int32_t     x;
+    int32_t     y;
+
+    Vector2Fixed() {}
+    Vector2Fixed( int32_t xx, int32_t yy )
+    : x( xx ), y( yy ) {}
+
+    explicit Vector2Fixed( const Vector2Float& v )
+    : x( v.x * 65536.0 + ( v.x >= 0 ? 0.5 : -0.5 ) ), y( v.y * 65536.0 + ( v.y >= 0 ? 0.5 : -0.5 ) ) {}
+
+    Vector2Float toFloat() const
+    { return Vector2Float( x * ( 1.0 / 65536.0 ), y * ( 1.0 / 65536.0 ) ); }
+
+
+    // Operator assignments
+    Vector2Fixed& operator+=( const Vector2Fixed& rhs )
+    { x += rhs.x; y += rhs.y; return *this; }
+
+    Vector2Fixed& operator-=( const Vector2Fixed& rhs )
+    { x -= rhs.x; y -= rhs.y; return *this; }
+
+    Vector2Fixed& operator>>=( uint8_t rhs )
+    { x >>= rhs; y >>= rhs; return *this; }
+};
+
+
+inline Vector2Fixed operator+( const Vector2Fixed& a, const Vector2Fixed& b )
+{
+    Vector2Fixed tmp( a ); tmp += b; return tmp;
+}
+
+
+inline Vector2Fixed operator-( const Vector2Fixed& a, const Vector2Fixed& b )
+{
+    Vector2Fixed tmp( a ); tmp -= b; return tmp;
+}
+
+
+
+
+
+
 
 #endif
 
@@ -69,6 +69,7 @@ namespace
 
     const PROGMEM char sWelcomeMenuItem4[] = "Nav Info...";
 
+    const PROGMEM char sWelcomeMenuItem6[] = "Nav Model...";
 
     const PROGMEM char sWelcomeMenuItem5[] = "About...";
 
@@ -89,6 +90,7 @@ namespace
 #endif
 
         { sWelcomeMenuItem4,    4 },
+        { sWelcomeMenuItem6,    6 },
         { sWelcomeMenuItem5,    5 }
 
     };
@@ -123,6 +125,9 @@ namespace
             case 5:
                 return new AboutState;
 
+            case 6:
+                return new NavModelMenuState;
+
             default:
                 return 0;
         }
@@ -210,6 +215,115 @@ void NavInfoState::displayInfo()
 
 
 
+//***********************************************************************
+
+
+namespace
+{
+
+    //                                             1234567890123456
+    const PROGMEM char sNavModelMenuTitle[]     = "Nav Model?";
+    const PROGMEM char sNavModelMenuItem00[]    = "Exit...";
+    const PROGMEM char sNavModelMenuItem01[]    = "Dead Reckoning";
+    const PROGMEM char sNavModelMenuItem02[]    = "DR Fixed Point";
+    const PROGMEM char sNavModelMenuItem03[]    = "Inertial";
+    const PROGMEM char sNavModelMenuItem04[]    = "DR + IMU Turns";
+    const PROGMEM char sNavModelMenuItem05[]    = "Compare All";
+
+
+    // Ids are the Navigator::Model plus one
+    const PROGMEM MenuList sNavModelMenu[] =
+    {
+        { sNavModelMenuItem01,  1 },
+        { sNavModelMenuItem02,  2 },
+        { sNavModelMenuItem03,  3 },
+        { sNavModelMenuItem04,  4 },
+        { sNavModelMenuItem05,  5 },
+
+        { sNavModelMenuItem00,  0 }
+    };
+
+
+    PGM_P getNavModelName( uint8_t model )
+    {
+        switch ( model )
+        {
+            case Navigator::kModelDeadReckoning:
+                return sNavModelMenuItem01;
+
+            case Navigator::kModelDeadReckoningFixed:
+                return sNavModelMenuItem02;
+
+            case Navigator::kModelInertial:
+                return sNavModelMenuItem03;
+
+            case Navigator::kModelHybrid:
+                return sNavModelMenuItem04;
+
+            default:
+                return sNavModelMenuItem05;
+        }
+    }
+
+
+    State* getNavModelMenuState( uint8_t menuId, int8_t /* not used */ )
+    {
+        if ( menuId == 0 )
+        {
+            return new WelcomeState;
+        }
+
+        return new SetNavModelState( menuId - 1 );
+    }
+}
+
+
+
+NavModelMenuState::NavModelMenuState() :
+MenuState( sNavModelMenuTitle, sNavModelMenu, sizeof( sNavModelMenu ) / sizeof( MenuItem ), getNavModelMenuState, 0 )
+{
+    // Nothing else to do
+}
+
+
+
+SetNavModelState::SetNavModelState( uint8_t model ) :
+mModel( model )
+{
+    // Nothing else to do
+}
+
+
+void SetNavModelState::onEntry()
+{
+    // Takes effect now, and sticks (in EEPROM) for the next time CARRT starts
+    Navigator::setModel( mModel );
+
+    Display::clear();
+    //                                1234567890123456
+    Display::displayTopRowP16( PSTR( "Nav Model Set" ) );
+    Display::displayBottomRowP16( getNavModelName( Navigator::getModel() ) );
+}
+
+
+bool SetNavModelState::onEvent( uint8_t event, int16_t button )
+{
+    if ( event == EventManager::kKeypadButtonHitEvent )
+    {
+        MainProcess::changeState( new WelcomeState );
+    }
+
+    return true;
+}
+
+
+
+
+
+
+
+
+
 //***********************************************************************
 
 
@@ -288,3 +402,16 @@ void AboutState::displayInfo()
     }
 
 }
+
+
+
+
+//****************************************************************************
+
+// States come from the state arena (see State.h)
+
+CARRT_CHECK_STATE_SIZE( WelcomeState );
+CARRT_CHECK_STATE_SIZE( NavInfoState );
+CARRT_CHECK_STATE_SIZE( NavModelMenuState );
+CARRT_CHECK_STATE_SIZE( SetNavModelState );
+CARRT_CHECK_STATE_SIZE( AboutState );
@@ -54,6 +54,31 @@ private:
 
 
 
+class NavModelMenuState : public MenuState
+{
+public:
+
+    NavModelMenuState();
+};
+
+
+
+class SetNavModelState : public State
+{
+public:
+
+    explicit SetNavModelState( uint8_t model );
+
+    virtual void onEntry();
+    virtual bool onEvent( uint8_t event, int16_t button );
+
+private:
+
+    uint8_t mModel;
+};
+
+
+
 class AboutState : public State
 {
 public: